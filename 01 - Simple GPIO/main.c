@@ -16,8 +16,33 @@
 #endif
 #include <intrinsics.h>
 
+//
+//  The system clock runs from the HSI at 16 MHz and TIM4 times the delays
+//  between the changes of the output.
+//
+#define CLOCK_PERIPHERALS       (CLOCK_TIM4)
+#include "../Common/SystemClock.h"
+#include "../Common/Delay.h"
+
+//
+//  Half of the period of the output.
+//
+#define HALF_PERIOD_MS          25
+
+//
+//  TIM4 overflow, part of a delay has finished.
+//
+#pragma vector = TIM4_OVR_UIF_vector
+__interrupt void TIM4_UPD_OVF_IRQHandler(void)
+{
+    DelayInterrupt();
+}
+
 int main()
 {
+    __disable_interrupt();
+    InitialiseSystemClock();
+    __enable_interrupt();
     //
     //  Initialise Port D.
     //
@@ -31,8 +56,8 @@ int main()
     while (1)
     {
         PD_ODR_ODR3 = 1;    // Turn Port D, Pin 4 on.
-        for (int index = 0; index < 10000; index++);
+        DelayMilliseconds(HALF_PERIOD_MS);
         PD_ODR_ODR3 = 0;    // Turn Port D, Pin 4 off.
-        for (int index = 0; index < 10000; index++);
+        DelayMilliseconds(HALF_PERIOD_MS);
     }
 }
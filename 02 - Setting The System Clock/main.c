@@ -19,25 +19,11 @@
 #include <intrinsics.h>
 
 //
-//  Setup the system clock to run at 16MHz using the internal oscillator.
+//  The system clock runs from the HSI at 16 MHz, none of the gated
+//  peripherals are used so their clocks are turned off.
 //
-void InitialiseSystemClock()
-{
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 0;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
-}
+#define CLOCK_PERIPHERALS       (0)
+#include "../Common/SystemClock.h"
 
 //
 //  Main program loop.
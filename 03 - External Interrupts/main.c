@@ -17,12 +17,87 @@
 #include <intrinsics.h>
 
 //
-//  Process the interrupt generated by the pressing of the button on PD4.
+//  The system clock runs from the HSI at 16 MHz.  TIM1 timestamps the
+//  edges, TIM4 is the debounce tick and the UART reports the edges.
+//
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM4 | CLOCK_UART1)
+#include "../Common/SystemClock.h"
+#include "../Common/UARTPrint.h"
+
+//
+//  Every edge passed to a handler is logged with the time it arrived and
+//  printed by the main loop.
+//
+#include "../Common/EdgeLog.h"
+#include "../Common/PinInterrupts.h"
+#include "../Common/Debounce.h"
+
+//
+//  Handlers for the port D inputs.
+//
+PinInterrupts _portD;
+
+//
+//  The button on PD4, it must be stable for 10 ms (ticks) to count and a
+//  press held for 1 second is a long press.
+//
+Button _button;
+#define BUTTON_INTEGRATION      10
+#define BUTTON_LONG_PRESS_TICKS 1000
+
+//
+//  TIM4 counts at F_MASTER / 128 and overflows every millisecond.
+//
+#define TICK_PRESCALER          0x07                    //  Prescaler = 128.
+#define TICK_RELOAD             ((F_MASTER / 128 / 1000) - 1)
+
+//
+//  The button has settled, toggle PD3 on each press and PD2 on a long
+//  press.
+//
+void ButtonEvent(Button *button, unsigned char event)
+{
+    if (event == BUTTON_PRESSED)
+    {
+        PD_ODR_ODR3 = !PD_ODR_ODR3;     //  Toggle Port D, pin 3.
+    }
+    else if (event == BUTTON_LONG_PRESS)
+    {
+        PD_ODR_ODR2 = !PD_ODR_ODR2;     //  Toggle Port D, pin 2.
+    }
+}
+
+//
+//  First edge from the button on PD4, the debouncer turns off the pin
+//  interrupt and samples the pin from the tick until it settles.
+//
+void ButtonEdge(unsigned char pin, unsigned char level)
+{
+    DebounceStart(&_button);
+    TIM4_CR1_CEN = 1;
+}
+
+//
+//  Process the interrupts generated by the port D inputs, the dispatcher
+//  works out which pin has changed.
 //
 #pragma vector = 8
 __interrupt void EXTI_PORTD_IRQHandler(void)
 {
-    PD_ODR_ODR3 = !PD_ODR_ODR3;     //  Toggle Port D, pin 3.
+    PinInterruptsDispatch(&_portD, PD_IDR);
+}
+
+//
+//  TIM4 tick, only running while the button is being debounced.
+//
+#pragma vector = TIM4_OVR_UIF_vector
+__interrupt void TIM4_UPD_OVF_IRQHandler(void)
+{
+    TIM4_SR_UIF = 0;
+    if (DebounceTick() == 0)
+    {
+        TIM4_CR1_CEN = 0;
+    }
 }
 
 //
@@ -34,6 +109,9 @@ void main()
     //  Initialise the system.
     //
     __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    EdgeLogInitialise();
     PD_ODR = 0;             //  All pins are turned off.
     PD_DDR = 0xff;          //  All pins are outputs.
     PD_CR1 = 0xff;          //  Push-Pull outputs.
@@ -44,14 +122,35 @@ void main()
     PD_DDR_DDR4 = 0;        //  PD4 is input.
     PD_CR1_C14 = 0;         //  PD4 is floating input.
     //
-    //  Set up the interrupt.
+    //  The debounce tick, started by the first edge of a press.
     //
-    EXTI_CR1_PDIS = 2;      //  Interrupt on falling edge.
+    TIM4_PSCR = TICK_PRESCALER;
+    TIM4_ARR = TICK_RELOAD;
+    TIM4_IER_UIE = 1;
+    //
+    //  Set up the interrupt, the port interrupts on both edges and the
+    //  dispatcher passes the first edge of a press to the debouncer.
+    //
+    PinInterruptsInitialise(&_portD, PD_IDR);
+    DebounceAttach(&_button, &_portD, DEBOUNCE_PORT_D, 4, 0, BUTTON_INTEGRATION, BUTTON_LONG_PRESS_TICKS, ButtonEvent);
+    PinInterruptsAttach(&_portD, 4, PIN_FALLING_EDGE, ButtonEdge);
+    EXTI_CR1_PDIS = 3;      //  Interrupt on rising and falling edges.
     EXTI_CR2_TLIS = 0;      //  Falling edge only.
     __enable_interrupt();
 
+    //
+    //  Print the edges logged and wait for an interrupt when there are
+    //  none.  The log is checked with interrupts disabled so an edge
+    //  arriving after the check wakes the core (WFI enables interrupts).
+    //
     while (1)
     {
-        __wait_for_interrupt();
+        EdgeLogDump();
+        __disable_interrupt();
+        if (EdgeLogEmpty())
+        {
+            __wait_for_interrupt();
+        }
+        __enable_interrupt();
     }
-}
\ No newline at end of file
+}
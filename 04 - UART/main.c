@@ -17,87 +17,179 @@
 #include <intrinsics.h>
 
 //
-//  Setup the system clock to run at 16MHz using the internal oscillator.
+//  The system clock runs from the HSI at 16 MHz, only the peripherals
+//  used by this example are clocked.
 //
-void InitialiseSystemClock()
+#define CLOCK_PERIPHERALS       (CLOCK_UART1 | CLOCK_TIM2)
+#include "../Common/SystemClock.h"
+#include "../Common/ClockScaling.h"
+
+//
+//  The UART (UART1, or UART2 on the Discovery board) runs at 115200 baud
+//  with interrupt driven transmit and receive buffers, the receive errors
+//  are logged.  The baud rate registers are calculated from the master
+//  clock and recalculated when it changes.
+//
+void LogReceiveError(unsigned char error, unsigned short count);
+
+#define UART_RX_ERROR(error, count) LogReceiveError(error, count)
+#include "../Common/UARTBuffer.h"
+
+//
+//  The master clock is divided by IDLE_HSI_DIVIDER while waiting for a
+//  command and runs at F_MASTER while a command is processed.  The baud
+//  rate must be possible at both speeds.
+//
+#if !defined(IDLE_HSI_DIVIDER)
+    #define IDLE_HSI_DIVIDER        4
+#endif
+
+UART_CHECK_BAUD_RATE(F_MASTER / IDLE_HSI_DIVIDER, UART_BUFFER_BAUD_RATE);
+
+//
+//  The log timestamp is counted by TIM2 in 1.024 ms steps.
+//
+#define TIMESTAMP_PRESCALER     0x0e                    //  Prescaler = 16384 at F_MASTER.
+
+//--------------------------------------------------------------------------------
+//
+//  Keep the timestamp counting at 1.024 ms when the master clock changes.
+//  The prescaler is only loaded by an update event, which also clears the
+//  counter, so the count is saved and written back afterwards with the
+//  update interrupt suppressed (URS).  Up to one count is lost each time.
+//
+void TimestampClockChanged(unsigned char phase, unsigned long fMaster)
 {
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 0;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
+    if (phase == CLOCK_SCALING_CHANGED)
+    {
+        unsigned char high = TIM2_CNTRH;
+        unsigned char low = TIM2_CNTRL;
+        TIM2_PSCR = (unsigned char) (TIMESTAMP_PRESCALER - ClockScalingShift(fMaster));
+        TIM2_CR1_URS = 1;
+        TIM2_EGR_UG = 1;
+        TIM2_CNTRH = high;
+        TIM2_CNTRL = low;
+        TIM2_CR1_URS = 0;
+    }
 }
 
+//--------------------------------------------------------------------------------
 //
-//  Setup the UART to run at 115200 baud, no parity, one stop bit, 8 data bits.
+//  Setup TIM2 as a free running counter to timestamp the log messages.
+//  Each count is 16 MHz / 16384 = 1.024 ms and the counter wraps after
+//  about 67 seconds.
 //
-//  Important: This relies upon the systemk clock being set to run at 16 MHz.
+void InitialiseTimestamp()
+{
+    TIM2_PSCR = TIMESTAMP_PRESCALER;
+    TIM2_ARRH = 0xff;       //  Count all the way to 65535.
+    TIM2_ARRL = 0xff;
+    TIM2_EGR_UG = 1;        //  Load the prescaler.
+    TIM2_CR1_CEN = 1;       //  Finally enable the timer.
+    ClockScalingRegister(TimestampClockChanged);
+}
+
 //
-void InitialiseUART()
+//  Current TIM2 count.  Reading the high byte latches the low byte.
+//
+unsigned short ReadTimestamp()
 {
-    //
-    //  Clear the Idle Line Detected bit in the status rerister by a read
-    //  to the UART1_SR register followed by a Read to the UART1_DR register.
-    //
-    unsigned char tmp = UART1_SR;
-    tmp = UART1_DR;
-    //
-    //  Reset the UART registers to the reset values.
-    //
-    UART1_CR1 = 0;
-    UART1_CR2 = 0;
-    UART1_CR4 = 0;
-    UART1_CR3 = 0;
-    UART1_CR5 = 0;
-    UART1_GTR = 0;
-    UART1_PSCR = 0;
-    //
-    //  Now setup the port to 115200,n,8,1.
-    //
-    UART1_CR1_M = 0;        //  8 Data bits.
-    UART1_CR1_PCEN = 0;     //  Disable parity.
-    UART1_CR3_STOP = 0;     //  1 stop bit.
-    UART1_BRR2 = 0x0a;      //  Set the baud rate registers to 115200 baud
-    UART1_BRR1 = 0x08;      //  based upon a 16 MHz system clock.
-    //
-    //  Disable the transmitter and receiver.
-    //
-    UART1_CR2_TEN = 0;      //  Disable transmit.
-    UART1_CR2_REN = 0;      //  Disable receive.
-    //
-    //  Set the clock polarity, lock phase and last bit clock pulse.
-    //
-    UART1_CR3_CPOL = 1;
-    UART1_CR3_CPHA = 1;
-    UART1_CR3_LBCL = 1;
-    //
-    //  Turn on the UART transmit, receive and the UART clock.
-    //
-    UART1_CR2_TEN = 1;
-    UART1_CR2_REN = 1;
-    UART1_CR3_CKEN = 1;
+    unsigned char high = TIM2_CNTRH;
+    return (unsigned short) ((high << 8) | TIM2_CNTRL);
 }
 
+//--------------------------------------------------------------------------------
+//
+//  Log messages.  These are sent as binary records and turned back into
+//  text on the PC with:
+//
+//      stm8log "04 - UART/main.c" capture.bin
+//
+//  New messages must be added to the end of the table.
+//
+#define LOG_MESSAGES(LOG_MESSAGE)                                               \
+    LOG_MESSAGE(LOG_HELLO, "Hello from my microcontroller....")                 \
+    LOG_MESSAGE(LOG_COMMAND, "Command of %u characters, %u lines waiting")      \
+    LOG_MESSAGE(LOG_RX_OVERRUN, "RX overrun, %u so far")                        \
+    LOG_MESSAGE(LOG_RX_FRAMING_ERROR, "RX framing error, %u so far")
+#define LOG_PUT_CHAR(ch)            UARTPutChar(ch)
+#define LOG_TIMESTAMP()             ReadTimestamp()
+#define LOG_FREE_SPACE()            UARTTransmitFree()
+#include "../Common/BinaryLog.h"
+
 //
-//  Send the message in the string to UART1.
+//  Receive errors reported by the UART receive interrupt.
 //
-void UARTPrintF(char *message)
+void LogReceiveError(unsigned char error, unsigned short count)
 {
-    char *ch = message;
-    while (*ch)
+    if (error == UART_RX_OVERRUN)
+    {
+        LogMessage1(LOG_RX_OVERRUN, count);
+    }
+    else
+    {
+        LogMessage1(LOG_RX_FRAMING_ERROR, count);
+    }
+}
+
+//
+//  Report how full the transmit buffer has been and how many characters
+//  have been lost in each direction so that the buffers can be sized.
+//
+void UARTPrintStatistics()
+{
+    unsigned char highWaterMark = _txHighWaterMark;
+    unsigned short dropped = _txDropped;
+    UARTPrintF("TX buffer high water mark: ");
+    UARTPrintNumber(highWaterMark);
+    UARTPrintF(", dropped: ");
+    UARTPrintNumber(dropped);
+    UARTPrintF("\n\rRX overruns: ");
+    UARTPrintNumber(_rxOverruns);
+    UARTPrintF(", framing errors: ");
+    UARTPrintNumber(_rxFramingErrors);
+    UARTPrintF(", dropped: ");
+    UARTPrintNumber(_rxDropped);
+    UARTPrintF("\n\rLog records dropped: ");
+    UARTPrintNumber(_logDropped);
+    UARTPrintF("\n\rClock changes: ");
+    UARTPrintNumber(_clockScalingChanges);
+    UARTPrintF("\n\r");
+}
+
+//
+//  Compare two strings.
+//
+int StringsEqual(const char *a, const char *b)
+{
+    while (*a && (*a == *b))
+    {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+//
+//  Act on a command received from the UART.
+//
+void ProcessCommand(char *command)
+{
+    unsigned char length = 0;
+    while (command[length])
+    {
+        length++;
+    }
+    LogMessage2(LOG_COMMAND, length, UARTLinesWaiting() - 1);
+    if (StringsEqual(command, "stats"))
+    {
+        UARTPrintStatistics();
+    }
+    else
     {
-        UART1_DR = (unsigned char) *ch;     //  Put the next character into the data transmission register.
-        while (UART1_SR_TXE == 0);          //  Wait for transmission to complete.
-        ch++;                               //  Grab the next character.
+        UARTPrintF("Received: ");
+        UARTPrintF(command);
+        UARTPrintF("\n\r");
     }
 }
 
@@ -105,11 +197,49 @@ int main( void )
 {
     __disable_interrupt();
     InitialiseSystemClock();
-    InitialiseUART();
+    UARTInitialise();
+    InitialiseTimestamp();
     __enable_interrupt();
+    LogMessage0(LOG_HELLO);
     while (1)
     {
-        UARTPrintF("Hello from my microcontroller....\n\r");
-		for (long counter = 0; counter < 250000; counter++);
+        //
+        //  Look for a line with interrupts disabled so that one received
+        //  between the check and the WFI still wakes the core (WFI enables
+        //  interrupts as it waits).
+        //
+        __disable_interrupt();
+        char *command = UARTGetLine();
+        if (command == 0)
+        {
+            //
+            //  Slow down once the replies have been sent and the receive
+            //  line is quiet.
+            //
+            if (UARTTransmitEmpty() && UARTReceiverIdle())
+            {
+                ClockScalingSetDividers(IDLE_HSI_DIVIDER, 1);
+            }
+            __wait_for_interrupt();
+        }
+        else
+        {
+            //
+            //  Speed up for the command, waiting for the idle line
+            //  interrupt if another character is on its way.
+            //
+            while ((MasterClockFrequency() != F_MASTER) && !UARTReceiverIdle())
+            {
+                __wait_for_interrupt();
+                __disable_interrupt();
+            }
+            ClockScalingSetDividers(1, 1);
+        }
+        __enable_interrupt();
+        if (command)
+        {
+            ProcessCommand(command);
+            UARTReleaseLine();
+        }
     }
 }
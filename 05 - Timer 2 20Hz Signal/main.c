@@ -17,25 +17,42 @@
 #include <intrinsics.h>
 
 //
-//  Setup the system clock to run at 16MHz using the internal oscillator.
+//  The system clock runs from the HSI at 16 MHz, only the peripherals
+//  used by this example are clocked.
 //
-void InitialiseSystemClock()
-{
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 0;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
-}
+//  Define JITTER_MEASURE to time the output with Timer 1: wire PD4 to
+//  Timer 1, channel 3 (PC3) and the jitter of the rising edges is printed
+//  on the UART every second (Common/Jitter.h).
+//
+#if defined(JITTER_MEASURE)
+    #define CLOCK_PERIPHERALS   (CLOCK_TIM1 | CLOCK_TIM2 | CLOCK_UART1)
+#else
+    #define CLOCK_PERIPHERALS   (CLOCK_TIM2)
+#endif
+#include "../Common/SystemClock.h"
+#if defined(JITTER_MEASURE)
+    #include "../Common/UARTPrint.h"
+    #include "../Common/Jitter.h"
+#endif
+
+//
+//  Timer 2 counts at F_MASTER / 8 and overflows 40 times a second, the
+//  output is toggled on each overflow giving a 20 Hz signal.  The counter
+//  runs from 0 to ARR so ARR is one less than the counts in each overflow.
+//
+#define TIMER2_PRESCALER        0x03                    //  Prescaler = 8.
+#define TIMER2_RELOAD           (F_MASTER / 8 / 40)
+
+#if (TIMER2_RELOAD - 1) > 0xffff
+    #error "The timer 2 reload value does not fit in 16 bits, increase the prescaler."
+#endif
+
+//
+//  The rising edges are two overflows, 2 x 8 x TIMER2_RELOAD cycles (the
+//  nominal 800,000 at 16 MHz), apart and 20 of them take a second.
+//
+#define JITTER_EXPECTED         (16UL * TIMER2_RELOAD)
+#define JITTER_REPORT_EDGES     20
 
 //
 //  Timer 2 Overflow handler.
@@ -60,13 +77,13 @@ void SetupOutputPorts()
 }
 
 //
-//  Setup Timer 2 to generate a 20 Hz interrupt based upon a 16 MHz timer.
+//  Setup Timer 2 to generate a 40 Hz interrupt from the master clock.
 //
 void SetupTimer2()
 {
-    TIM2_PSCR = 0x03;       //  Prescaler = 8.
-    TIM2_ARRH = 0xc3;       //  High byte of 50,000.
-    TIM2_ARRL = 0x50;       //  Low byte of 50,000.
+    TIM2_PSCR = TIMER2_PRESCALER;
+    TIM2_ARRH = (unsigned char) ((TIMER2_RELOAD - 1) >> 8);     //  49,999 at 16 MHz.
+    TIM2_ARRL = (unsigned char) ((TIMER2_RELOAD - 1) & 0xff);
     TIM2_IER_UIE = 1;       //  Enable the update interrupts.
     TIM2_CR1_CEN = 1;       //  Finally enable the timer.
 }
@@ -80,9 +97,20 @@ int main()
     InitialiseSystemClock();
     SetupOutputPorts();
     SetupTimer2();
+#if defined(JITTER_MEASURE)
+    UARTPrintInitialise();
+    JitterInitialise(JITTER_EXPECTED);
+#endif
     __enable_interrupt();
     while (1)
     {
         __wait_for_interrupt();
+#if defined(JITTER_MEASURE)
+        if (_jitterEdges >= JITTER_REPORT_EDGES)
+        {
+            JitterReport();
+            JitterReset();
+        }
+#endif
     }
 }
\ No newline at end of file
@@ -16,50 +16,125 @@
 #endif
 #include <intrinsics.h>
 
+//
+//  The system clock runs from the HSI at 16 MHz.  The peripheral clocks
+//  are turned on by the clock gate manager, the ADC is only clocked
+//  while it is powered up for a conversion.
+//
+//  Define CLOCK_GATE_MEASURE to time how long the ADC clock is on.  The
+//  time is taken from Timer 2 and the total on time, the number of times
+//  the clock was turned on and the elapsed time (all in microseconds) are
+//  printed on the UART every second.  PD5 is the UART1 TX pin so it no
+//  longer shows the trigger.
+//
+#if defined(CLOCK_GATE_MEASURE)
+    #define CLOCK_PERIPHERALS   (CLOCK_UART1)
+#else
+    #define CLOCK_PERIPHERALS   (0)
+#endif
+#include "../Common/SystemClock.h"
+
+//
+//  Timer 2 counts 2 us ticks and overflows every 50,000 (see SetupTimer2).
+//
+#define TIMER2_RELOAD           50000U
+#define TIMER2_TICK_US          2
+
+//
+//  Time the ADC needs to stabilise after it is powered up (t_STAB, 7 us)
+//  in Timer 2 ticks, rounded up.  The conversion is started by a Timer 2
+//  channel 1 compare one tick further on as the power up can come at any
+//  point in the tick it is made in.
+//
+#define ADC_STABILISE_TICKS     ((7 + TIMER2_TICK_US - 1) / TIMER2_TICK_US)
+
 //--------------------------------------------------------------------------------
 //
-//  Setup the system clock to run at 16MHz using the internal oscillator.
+//  Read the Timer 2 counter, the high byte first to latch the low byte.
 //
-void InitialiseSystemClock()
+unsigned short Timer2Counter()
 {
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 0;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
+    unsigned char high = TIM2_CNTRH;
+    return (unsigned short) ((high << 8) | TIM2_CNTRL);
 }
 
+#if defined(CLOCK_GATE_MEASURE)
+static volatile unsigned short _timer2Overflows;
+static volatile unsigned char _adcSamples;
+
 //--------------------------------------------------------------------------------
 //
-//  Set up Timer 1, channel 3 to output PWM signal.
+//  Microseconds since Timer 2 was started.  An overflow which is still
+//  waiting to be serviced belongs to a small counter value.
+//
+unsigned long Timer2Microseconds()
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    unsigned short counter = Timer2Counter();
+    unsigned long overflows = _timer2Overflows;
+    if (TIM2_SR1_UIF && (counter < (TIMER2_RELOAD / 2)))
+    {
+        overflows++;
+    }
+    __set_interrupt_state(state);
+    return ((overflows * TIMER2_RELOAD) + counter) * TIMER2_TICK_US;
+}
+
+    #define CLOCK_GATE_TIMESTAMP()  Timer2Microseconds()
+#endif
+#include "../Common/ClockGate.h"
+#if defined(CLOCK_GATE_MEASURE)
+    #include "../Common/UARTPrint.h"
+#endif
+
+//
+//  The PWM duty is changed with the timer running, the new value is
+//  loaded at the end of a period.
+//
+#include "../Common/Pwm.h"
+
+//
+//  The 10 bit reading is output on a 1024 >> PWM_DITHER_BITS count period
+//  with the lower bits dithered over successive periods (Dither.h), the
+//  carrier is 62.5 kHz rather than 15.6 kHz for 2 bits.  0 outputs the
+//  reading on a 1024 count period without the update interrupt.
+//
+#define PWM_DITHER_BITS         2
+#if PWM_DITHER_BITS > 0
+    #include "../Common/Dither.h"
+
+    Dither _dither;
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  Set up Timer 1, channel 4 to output PWM signal with 10 bits of
+//  resolution, starting with the PWM signal off.
 //
 void SetupTimer1()
 {
-    TIM1_ARRH = 0x03;       //  Reload counter = 1023 (10 bits)
-    TIM1_ARRL = 0xff;
-    TIM1_PSCRH = 0;         //  Prescalar = 0 (i.e. 1)
-    TIM1_PSCRL = 0;
-    TIM1_CR1_DIR = 1;       //  Down counter.
-    TIM1_CR1_CMS = 0;       //  Edge aligned counter.
-    TIM1_RCR = 0;           //  Repetition count.
-    TIM1_CCMR4_OC4M = 7;    //  Set up to use PWM mode 2.
-    TIM1_CCER2_CC4E = 1;    //  Output is enabled.
-    TIM1_CCER2_CC4P = 0;    //  Active is defined as high.
-    TIM1_CCR4H = 0x03;      //  Start with the PWM signal off.
-    TIM1_CCR4L = 0xff;
-    TIM1_BKR_MOE = 1;       //  Enable the main output.
-    TIM1_CR1_CEN = 1;
+    ClockGateAcquire(CLOCK_GATE_TIM1);
+    PwmTimer1Initialise(0, 1024 >> PWM_DITHER_BITS, PWM_CHANNEL(4));
+#if PWM_DITHER_BITS > 0
+    DitherInitialise(&_dither, PwmTimer1Duty, 4, PWM_DITHER_BITS);
+    TIM1_IER_UIE = 1;       //  Dither on each update event.
+#endif
 }
 
+#if PWM_DITHER_BITS > 0
+//--------------------------------------------------------------------------------
+//
+//  Timer 1 Overflow handler, the duty for the next period.
+//
+#pragma vector = TIM1_OVR_UIF_vector
+__interrupt void TIM1_UPD_OVF_IRQHandler(void)
+{
+    TIM1_SR1_UIF = 0;
+    DitherUpdate(&_dither);
+}
+#endif
+
 //--------------------------------------------------------------------------------
 //
 //  Timer 2 Overflow handler.
@@ -67,13 +142,41 @@ void SetupTimer1()
 #pragma vector = TIM2_OVR_UIF_vector
 __interrupt void TIM2_UPD_OVF_IRQHandler(void)
 {
-    PD_ODR_ODR5 = !PD_ODR_ODR5;        //  Indicate that the ADC has completed.
-
-    ADC_CR1_ADON = 1;       //  Second write starts the conversion.
+#if defined(CLOCK_GATE_MEASURE)
+    TIM2_SR1_UIF = 0;       //  Cleared first so Timer2Microseconds does not count the overflow twice.
+    _timer2Overflows++;
+#endif
+    PD_ODR_ODR5 = !PD_ODR_ODR5;        //  Indicate that the ADC has been triggered.
+    //
+    //  Clock and power up the ADC and set the channel 1 compare for when it
+    //  has stabilised, the compare interrupt starts the conversion.  The
+    //  conversion complete interrupt powers the ADC down and releases the
+    //  clock.
+    //
+    ClockGateAcquire(CLOCK_GATE_ADC);
+    ADC_CR1_ADON = 1;       //  First write powers the ADC up.
+    unsigned short compare = Timer2Counter() + ADC_STABILISE_TICKS + 1;
+    TIM2_CCR1H = (unsigned char) (compare >> 8);
+    TIM2_CCR1L = (unsigned char) compare;
+    TIM2_SR1_CC1IF = 0;
+    TIM2_IER_CC1IE = 1;
 
     TIM2_SR1_UIF = 0;       //  Reset the interrupt otherwise it will fire again straight away.
 }
 
+//--------------------------------------------------------------------------------
+//
+//  Timer 2 channel 1 compare, the ADC has stabilised.  Channel 1 is left
+//  frozen with its output disabled so PD4 is still a port pin.
+//
+#pragma vector = TIM2_CAPCOM_CC1IF_vector
+__interrupt void TIM2_CAPCOM_IRQHandler(void)
+{
+    TIM2_IER_CC1IE = 0;
+    TIM2_SR1_CC1IF = 0;
+    ADC_CR1_ADON = 1;       //  Second write starts the conversion.
+}
+
 //--------------------------------------------------------------------------------
 //
 //  Setup Timer 2 to generate an interrupt every 1/10th second based on a
@@ -81,6 +184,7 @@ __interrupt void TIM2_UPD_OVF_IRQHandler(void)
 //
 void SetupTimer2()
 {
+    ClockGateAcquire(CLOCK_GATE_TIM2);
     TIM2_PSCR = 0x05;       //  Prescaler = 32.
     TIM2_ARRH = 0xc3;       //  High byte of 50,000.
     TIM2_ARRL = 0x50;       //  Low byte of 50,000.
@@ -99,20 +203,26 @@ __interrupt void ADC1_EOC_IRQHandler()
     int reading;
 
     ADC_CR1_ADON = 0;       //  Disable the ADC.
-    TIM1_CR1_CEN = 0;       //  Disable Timer 1.
     ADC_CSR_EOC = 0;		// 	Indicate that ADC conversion is complete.
 
     low = ADC_DRL;			//	Extract the ADC reading.
     high = ADC_DRH;
-    reading = 1023 - ((high * 256) + low);
+    ClockGateRelease(CLOCK_GATE_ADC);   //  Powered down until the next trigger.
+#if defined(CLOCK_GATE_MEASURE)
+    _adcSamples++;
+#endif
+    reading = (high * 256) + low;
     //
-    //	Calculate the values for the capture compare register and restart Timer 1.
+    //	The reading is the new duty, both bytes are loaded together at the
+    //  end of the current period.
     //
-    low = reading & 0xff;
-    high = (reading >> 8) & 0xff;
-    TIM1_CCR4H = high;      //  Reset the PWM counters.
-    TIM1_CCR4L = low;
-    TIM1_CR1_CEN = 1;       //  Restart Timer 1.
+#if PWM_DITHER_BITS > 0
+    DitherSet(&_dither, reading);
+#else
+    PwmTimer1Begin();
+    PwmTimer1Duty(4, reading);
+    PwmTimer1End();
+#endif
 
     PD_ODR_ODR4 = !PD_ODR_ODR4;     //  Indicate we have processed an ADC interrupt.
 }
@@ -123,7 +233,7 @@ __interrupt void ADC1_EOC_IRQHandler()
 //
 void SetupADC()
 {
-    ADC_CR1_ADON = 1;       //  Turn ADC on, note a second set is required to start the conversion.
+    ClockGateAcquire(CLOCK_GATE_ADC);   //  The registers can only be written while clocked.
 
 #if defined PROTOMODULE
     ADC_CSR_CH = 0x03;
@@ -134,6 +244,7 @@ void SetupADC()
     ADC_CR3_DBUF = 0;
     ADC_CR2_ALIGN = 1;      //  Data is right aligned.
     ADC_CSR_EOCIE = 1;      //  Enable the interrupt after conversion completed.
+    ClockGateRelease(CLOCK_GATE_ADC);   //  Powered up and clocked by Timer 2 for each conversion.
 }
 
 //--------------------------------------------------------------------------------
@@ -175,9 +286,28 @@ void main()
     SetupTimer2();
     SetupOutputPorts();
     SetupADC();
+#if defined(CLOCK_GATE_MEASURE)
+    UARTPrintInitialise();
+#endif
     __enable_interrupt();
     while (1)
     {
+#if defined(CLOCK_GATE_MEASURE)
+        __disable_interrupt();
+        if (_adcSamples < 10)
+        {
+            __wait_for_interrupt();
+        }
+        __enable_interrupt();
+        if (_adcSamples >= 10)
+        {
+            _adcSamples = 0;
+            UARTPrintValue("adc_on_us", ClockGateOnTime(CLOCK_GATE_ADC), ' ');
+            UARTPrintValue("adc_enables", ClockGateEnables(CLOCK_GATE_ADC), ' ');
+            UARTPrintValue("elapsed_us", Timer2Microseconds(), '\n');
+        }
+#else
         __wait_for_interrupt();
+#endif
     }
 }
\ No newline at end of file
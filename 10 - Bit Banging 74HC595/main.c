@@ -17,6 +17,19 @@
 #include <stdlib.h>
 #include <intrinsics.h>
 
+//
+//  The system clock runs from the HSI at 16 MHz, only TIM4 is clocked to
+//  time the delay between each step of the display.
+//
+#define CLOCK_PERIPHERALS       (CLOCK_TIM4)
+#include "../Common/SystemClock.h"
+#include "../Common/Delay.h"
+
+//
+//  Time each bit is displayed for.
+//
+#define STEP_MS                 50
+
 //
 //  Define the pins which we will be using to control the shift registers.
 //
@@ -32,27 +45,6 @@
 unsigned char *registers;                          //  Data in the registers.
 unsigned char numberOfRegisters;                   //  Number of registers in the chain.
 
-//
-//  Setup the system clock to run at 16MHz using the internal oscillator.
-//
-void InitialiseSystemClock()
-{
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 0;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
-}
-
 //
 //  BitBang the data through the GPIO ports.
 //
@@ -91,6 +83,15 @@ void OutputData(unsigned char *data, int numberOfBytes)
     SR_OUTPUT_ENABLE = 0;               //  Turn on the outputs.
 }
 
+//
+//  TIM4 overflow, part of a delay has finished.
+//
+#pragma vector = TIM4_OVR_UIF_vector
+__interrupt void TIM4_UPD_OVF_IRQHandler(void)
+{
+    DelayInterrupt();
+}
+
 //
 //  Clear all of the bytes in the registers to 0.
 //
@@ -150,7 +151,7 @@ int main(void)
                 registers[1] = (unsigned char) ((1 << (c - 8)) & 0xff);
             }
             OutputData(registers, 2);
-            for (unsigned long counter = 0; counter < 100000; counter++);
+            DelayMilliseconds(STEP_MS);
         }
     }
 }
\ No newline at end of file
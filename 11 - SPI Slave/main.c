@@ -11,6 +11,30 @@
 #include <iostm8S105c6.h>
 #include <intrinsics.h>
 
+//
+//  The system clock runs from the HSI at 16 MHz, only the peripherals
+//  used by this example are clocked.  TIM1 timestamps the chip select
+//  edges which are reported on UART2.
+//
+#define CLOCK_PERIPHERALS       (CLOCK_SPI | CLOCK_TIM1 | CLOCK_UART2)
+#include "../Common/SystemClock.h"
+#define UART_PRINT_UART2
+#include "../Common/UARTPrint.h"
+
+//
+//  The main loop is replaced by the scheduler, the SPI interrupt posts an
+//  event for each buffer received so none are missed.
+//
+#include "../Common/Scheduler.h"
+
+//
+//  The chip select handler is attached to its pin, changes on the other
+//  port B pins are ignored.  Each chip select edge is logged with the
+//  time it arrived.
+//
+#include "../Common/EdgeLog.h"
+#include "../Common/PinInterrupts.h"
+
 //--------------------------------------------------------------------------------
 //
 //  Define the status codes.
@@ -32,23 +56,42 @@
 #define PIN_BIT_BANG_CLOCK      PD_ODR_ODR4
 #define PIN_BIT_BANG_DATA       PD_ODR_ODR6
 
+//--------------------------------------------------------------------------------
+//
+//  SPI chip select (port B).
+//
+#define SPI_CS_PIN              0
+
 //--------------------------------------------------------------------------------
 //
 //  Miscellaneous constants
 //
 #define BUFFER_SIZE             17
+//
+//  The data is received into two buffers in turn so a full buffer is not
+//  overwritten while the receiver task works on it.  The index of the
+//  buffer goes to the task in the top four bits of the event.
+//
+#define RX_BUFFERS              2
+#define RX_EVENT(code, buffer)  ((code) | ((buffer) << 4))
+#define RX_EVENT_CODE(event)    ((event) & 0x0f)
+#define RX_EVENT_BUFFER(event)  ((event) >> 4)
 
 //--------------------------------------------------------------------------------
 //
 //  Application global variables.
 //
-unsigned char _rxBuffer[BUFFER_SIZE];       // Buffer holding the received data.
+unsigned char _rxBuffers[RX_BUFFERS][BUFFER_SIZE];  // Buffers holding the received data.
+volatile unsigned char _rxFull[RX_BUFFERS]; // Buffer posted and not yet handled.
+unsigned char _rxBuffer;                    // Buffer being filled.
+unsigned short _rxDropped;                  // Buffers lost as both were full.
 unsigned char _txBuffer[BUFFER_SIZE];       // Buffer holding the data to send.
 unsigned char *_rx;                         // Place to put the next byte received.
 unsigned char *_tx;                         // Next byte to send.
 int _rxCount;                               // Number of characters received.
 int _txCount;                               // Number of characters sent.
-int _status;                                // Application status code.
+Task _receiver;                             // Task handling the received data.
+PinInterrupts _portB;                       // Port B pin change handlers.
 
 //--------------------------------------------------------------------------------
 //
@@ -108,26 +151,23 @@ void ResetSPIBuffers()
     SPI_DR = 0xff;
     _rxCount = 0;
     _txCount = 0;
-    _rx = _rxBuffer;
+    _rx = _rxBuffers[_rxBuffer];
     _tx = _txBuffer;
 }
 
 //--------------------------------------------------------------------------------
 //
-//  SPI chip select interrupt service routine.
+//  SPI chip select has changed.
 //
-#pragma vector = 6
-__interrupt void EXTI_PORTC_IRQHandler(void)
+void ChipSelect(unsigned char pin, unsigned char level)
 {
-    if (EXTI_CR1_PBIS == 1)
+    if (level)
     {
         //
         //  Transition from low to high disables SPI
         //
         SPI_CR1_SPE = 0;                        //  Disable SPI.
         SPI_CR2_SSI = 1;
-        EXTI_CR1_PBIS = 2;                      //  Waiting for falling edge next.
-        _status = SC_UNKNOWN;
         OutputStatusCode(SC_CS_RISING_EDGE);
     }
     else
@@ -135,7 +175,6 @@ __interrupt void EXTI_PORTC_IRQHandler(void)
         //
         //  Transition from high to low selects this slave device.
         //
-        EXTI_CR1_PBIS = 1;                      //  Waiting for rising edge next.
         ResetSPIBuffers();
         (void) SPI_DR;
         (void) SPI_SR;
@@ -148,6 +187,17 @@ __interrupt void EXTI_PORTC_IRQHandler(void)
     }
 }
 
+//--------------------------------------------------------------------------------
+//
+//  Port B interrupt service routine, call the handler for the pin which
+//  has changed.
+//
+#pragma vector = 6
+__interrupt void EXTI_PORTB_IRQHandler(void)
+{
+    PinInterruptsDispatch(&_portB, PB_IDR);
+}
+
 //--------------------------------------------------------------------------------
 //
 //  SPI Interrupt service routine.
@@ -162,8 +212,7 @@ __interrupt void SPI_IRQHandler(void)
     {
         (void) SPI_DR;                      // These two reads clear the overflow
         (void) SPI_SR;                      // error.
-        _status = SC_OVERFLOW;
-        OutputStatusCode(_status);
+        OutputStatusCode(SC_OVERFLOW);
         return;
     }
     //
@@ -179,9 +228,23 @@ __interrupt void SPI_IRQHandler(void)
         _rxCount++;
         if (_rxCount == BUFFER_SIZE)
         {
-            _status = SC_RX_BUFFER_FULL;
-            OutputStatusCode(_status);
-            _rx = _rxBuffer;
+            //
+            //  Hand the buffer to the receiver task and fill the other
+            //  one.  If the task still has the other buffer the data
+            //  just received is dropped and this buffer is filled again.
+            //
+            unsigned char next = _rxBuffer ^ 1;
+            if (!_rxFull[next] && SchedulerPost(&_receiver, RX_EVENT(SC_RX_BUFFER_FULL, _rxBuffer)))
+            {
+                _rxFull[_rxBuffer] = 1;
+                OutputStatusCode(SC_RX_BUFFER_FULL);
+                _rxBuffer = next;
+            }
+            else
+            {
+                _rxDropped++;
+            }
+            _rx = _rxBuffers[_rxBuffer];
             _rxCount = 0;
         }
     }
@@ -202,28 +265,6 @@ __interrupt void SPI_IRQHandler(void)
     }
 }
 
-//--------------------------------------------------------------------------------
-//
-//  Setup the system clock to run at 16MHz using the internal oscillator.
-//
-void InitialiseSystemClock()
-{
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 0;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
-}
-
 //--------------------------------------------------------------------------------
 //
 //  Initialise SPI to be SPI slave.
@@ -262,7 +303,24 @@ void InitialisePorts()
     //
     //  Now set up the interrupt behaviour.
     //
-    EXTI_CR1_PBIS = 2;      //  Port B interrupt on falling edge.
+    PinInterruptsInitialise(&_portB, PB_IDR);
+    PinInterruptsAttach(&_portB, SPI_CS_PIN, PIN_BOTH_EDGES, ChipSelect);
+    EXTI_CR1_PBIS = 3;      //  Port B interrupt on rising and falling edges.
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Receiver task, output each buffer received on the diagnostic pins and
+//  then give the buffer back to the interrupt service routine.
+//
+void Receive(unsigned char event)
+{
+    if (RX_EVENT_CODE(event) == SC_RX_BUFFER_FULL)
+    {
+        unsigned char buffer = RX_EVENT_BUFFER(event);
+        BitBangBuffer(_rxBuffers[buffer], BUFFER_SIZE);
+        _rxFull[buffer] = 0;
+    }
 }
 
 //--------------------------------------------------------------------------------
@@ -276,6 +334,8 @@ int main(void)
     //
     __disable_interrupt();
     InitialiseSystemClock();
+    UARTPrintInitialise();
+    EdgeLogInitialise();
     InitialiseSPIAsSlave();
     ResetSPIBuffers();
     for (unsigned char index = 0; index < BUFFER_SIZE; index++)
@@ -283,18 +343,19 @@ int main(void)
         _txBuffer[index] = index + 100;
     }
     InitialisePorts();
-    _status = SC_UNKNOWN;
+    SchedulerAddTask(&_receiver, 0, Receive);
     __enable_interrupt();
     //
-    //  Main program loop.
+    //  Main program loop, handle the events posted by the interrupts and
+    //  print the chip select edges logged, wait for an interrupt when there
+    //  is nothing to do.  An edge logged just before the wait is printed
+    //  after the next interrupt.
     //
     while (1)
     {
-        __wait_for_interrupt();
-        if (_status == SC_RX_BUFFER_FULL)
+        if ((SchedulerDispatch() == 0) && (EdgeLogDump() == 0))
         {
-            BitBangBuffer(_rxBuffer, BUFFER_SIZE);
+            SchedulerIdle();
         }
-        _status = SC_UNKNOWN;
     }
 }
\ No newline at end of file
@@ -11,6 +11,24 @@
 #include <iostm8S105c6.h>
 #include <intrinsics.h>
 
+//
+//  The system clock runs from the HSI at 16 MHz, only the peripherals
+//  used by this example are clocked.  TIM1 timestamps the chip select
+//  edges which are reported on UART2.
+//
+#define CLOCK_PERIPHERALS       (CLOCK_SPI | CLOCK_TIM1 | CLOCK_UART2)
+#include "../Common/SystemClock.h"
+#define UART_PRINT_UART2
+#include "../Common/UARTPrint.h"
+
+//
+//  The chip select handler is attached to its pin, changes on the other
+//  port B pins are ignored.  Each chip select edge is logged with the
+//  time it arrived.
+//
+#include "../Common/EdgeLog.h"
+#include "../Common/PinInterrupts.h"
+
 //--------------------------------------------------------------------------------
 //
 //  Define the status codes.
@@ -32,6 +50,12 @@
 #define PIN_BIT_BANG_CLOCK      PD_ODR_ODR4
 #define PIN_BIT_BANG_DATA       PD_ODR_ODR6
 
+//--------------------------------------------------------------------------------
+//
+//  SPI chip select (port B).
+//
+#define SPI_CS_PIN              0
+
 //--------------------------------------------------------------------------------
 //
 //  Miscellaneous constants
@@ -49,6 +73,7 @@ unsigned char *_tx;                         // Next byte to send.
 int _rxCount;                               // Number of characters received.
 int _txCount;                               // Number of characters sent.
 int _status;                                // Application status code.
+PinInterrupts _portB;                       // Port B pin change handlers.
 
 //--------------------------------------------------------------------------------
 //
@@ -114,14 +139,12 @@ void ResetSPIBuffers()
 
 //--------------------------------------------------------------------------------
 //
-//  SPI chip select interrupt service routine.
+//  SPI chip select has changed.
 //
-#pragma vector = 6
-__interrupt void EXTI_PORTB_IRQHandler(void)
+void ChipSelect(unsigned char pin, unsigned char level)
 {
-//    if (EXTI_CR1_PBIS != 1)
     PIN_STATUS_CODE = 1;
-    if (EXTI_CR1_PBIS == 2)
+    if (level == 0)
     {
         //
         //  Transition from high to low selects this slave device.
@@ -135,7 +158,6 @@ __interrupt void EXTI_PORTB_IRQHandler(void)
         SPI_CR1_MSTR = 0;
         SPI_CR1_SPE = 1;                        // Enable SPI.
         PIN_STATUS_CODE = 0;
-        EXTI_CR1_PBIS = 1;                      //  Waiting for rising edge next.
     }
     else
     {
@@ -145,11 +167,21 @@ __interrupt void EXTI_PORTB_IRQHandler(void)
         SPI_CR1_SPE = 0;                        //  Disable SPI.
         SPI_CR2_SSI = 1;
         PIN_STATUS_CODE = 0;
-        EXTI_CR1_PBIS = 2;                      //  Waiting for falling edge next.
         ResetSPIBuffers();
     }
 }
 
+//--------------------------------------------------------------------------------
+//
+//  Port B interrupt service routine, call the handler for the pin which
+//  has changed.
+//
+#pragma vector = 6
+__interrupt void EXTI_PORTB_IRQHandler(void)
+{
+    PinInterruptsDispatch(&_portB, PB_IDR);
+}
+
 //--------------------------------------------------------------------------------
 //
 //  SPI Interrupt service routine.
@@ -204,28 +236,6 @@ __interrupt void SPI_IRQHandler(void)
     }
 }
 
-//--------------------------------------------------------------------------------
-//
-//  Setup the system clock to run at 16MHz using the internal oscillator.
-//
-void InitialiseSystemClock()
-{
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 0;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
-}
-
 //--------------------------------------------------------------------------------
 //
 //  Initialise SPI to be SPI slave.
@@ -265,7 +275,9 @@ void InitialisePorts()
     //
     //  Now set up the interrupt behaviour.
     //
-    EXTI_CR1_PBIS = 2;      //  Port B interrupt on falling edge.
+    PinInterruptsInitialise(&_portB, PB_IDR);
+    PinInterruptsAttach(&_portB, SPI_CS_PIN, PIN_BOTH_EDGES, ChipSelect);
+    EXTI_CR1_PBIS = 3;      //  Port B interrupt on rising and falling edges.
     ITC_SPR2_VECT6SPR = 1;  //  Interrupt Priority 1 for Port B intrrupt.
 }
 
@@ -280,6 +292,8 @@ int main(void)
     //
     __disable_interrupt();
     InitialiseSystemClock();
+    UARTPrintInitialise();
+    EdgeLogInitialise();
     InitialiseSPIAsSlave();
     ResetSPIBuffers();
     for (unsigned char index = 0; index < BUFFER_SIZE; index++)
@@ -290,7 +304,8 @@ int main(void)
     _status = SC_UNKNOWN;
     __enable_interrupt();
     //
-    //  Main program loop.
+    //  Main program loop, print the chip select edges logged after each
+    //  interrupt.
     //
     while (1)
     {
@@ -300,5 +315,6 @@ int main(void)
             BitBangBuffer(_rxBuffer, BUFFER_SIZE);
         }
         _status = SC_UNKNOWN;
+        EdgeLogDump();
     }
 }
\ No newline at end of file
@@ -21,6 +21,40 @@
 
 #include <intrinsics.h>
 
+//
+//  The system clock runs from the HSI at 16 MHz, only the peripherals
+//  used by this example are clocked.  The HSI is also output on the CCO
+//  pin.  Define LOG_CHIP_SELECT to have TIM1 timestamp the port interrupts
+//  and report them on the UART (UART1, or UART2 on the Discovery board).
+//  The UART transmits on PD5 so the bit bang data moves to PD3.
+//
+#if defined(LOG_CHIP_SELECT)
+    #define CLOCK_PERIPHERALS   (CLOCK_SPI | CLOCK_TIM1 | CLOCK_UART1)
+#else
+    #define CLOCK_PERIPHERALS   (CLOCK_SPI)
+#endif
+#define CLOCK_OUTPUT            0
+#include "../Common/SystemClock.h"
+#if defined(LOG_CHIP_SELECT)
+    #include "../Common/UARTPrint.h"
+#endif
+
+//
+//  The main loop is replaced by the scheduler, the SPI interrupt posts an
+//  event for each frame received so none are missed.
+//
+#include "../Common/Scheduler.h"
+
+//
+//  The chip select handler is attached to its pin, changes on the other
+//  pins of the port are ignored.  Each port interrupt can be logged with
+//  the time it arrived.
+//
+#if defined(LOG_CHIP_SELECT)
+    #include "../Common/EdgeLog.h"
+#endif
+#include "../Common/PinInterrupts.h"
+
 //--------------------------------------------------------------------------------
 //
 //  Function table structure.
@@ -52,7 +86,11 @@ typedef struct
     #define PIN_STATUS_CODE         PD_ODR_ODR6
 #endif
 #define PIN_BIT_BANG_CLOCK      PD_ODR_ODR4
-#define PIN_BIT_BANG_DATA       PD_ODR_ODR5
+#if defined(LOG_CHIP_SELECT)
+    #define PIN_BIT_BANG_DATA       PD_ODR_ODR3     //  PD5 is the UART TX pin.
+#else
+    #define PIN_BIT_BANG_DATA       PD_ODR_ODR5
+#endif
 //
 //  Pin to notify the GO main board that we have some data ready for processing.
 //
@@ -62,14 +100,18 @@ typedef struct
     #define PIN_GOBUS_INTERRUPT     PD_ODR_ODR2
 #endif
 //
-//  SPI Chip select IRQ and vector information.
+//  SPI Chip select pin, IRQ and vector information.
 //
 #if defined(DISCOVERY)
     #define SPI_CHIP_SELECT_VECTOR      6
     #define SPI_CS_IRQ_DIRECTION        EXTI_CR1_PBIS
+    #define SPI_CS_PORT_IDR             PB_IDR
+    #define SPI_CS_PIN                  0
 #else
     #define SPI_CHIP_SELECT_VECTOR      5
     #define SPI_CS_IRQ_DIRECTION        EXTI_CR1_PAIS
+    #define SPI_CS_PORT_IDR             PA_IDR
+    #define SPI_CS_PIN                  3           //  NSS.
 #endif
 //
 //  Constants having a special meaning in the GoBus 1.0 protocol.
@@ -78,18 +120,32 @@ typedef struct
 #define GO_FRAME_PREFIX         0x2a
 #define GO_MODULE_ID_REQUEST    0xfe
 #define GO_BUFFER_SIZE          17
+//
+//  Frames are received into two buffers in turn so the next frame does not
+//  overwrite the one the command task is working on.  The index of the
+//  buffer goes to the task in the top four bits of the event.
+//
+#define RX_BUFFERS              2
+#define RX_EVENT(code, buffer)  ((code) | ((buffer) << 4))
+#define RX_EVENT_CODE(event)    ((event) & 0x0f)
+#define RX_EVENT_BUFFER(event)  ((event) >> 4)
 
 //--------------------------------------------------------------------------------
 //
 //  Application global variables.
 //
-unsigned char _rxBuffer[GO_BUFFER_SIZE + 1];    // Buffer holding the received data plus a CRC.
+unsigned char _rxBuffers[RX_BUFFERS][GO_BUFFER_SIZE + 1];  // Buffers holding the received data plus a CRC.
+volatile unsigned char _rxFull[RX_BUFFERS];     // Buffer posted and not yet handled.
+unsigned char _rxBuffer;                        // Buffer being filled.
+unsigned short _rxDropped;                      // Frames lost as both buffers were full.
+unsigned char *_command;                        // Frame holding the command being run.
 unsigned char _txBuffer[GO_BUFFER_SIZE];        // Buffer holding the data to send.
 unsigned char *_rx;                             // Place to put the next byte received.
 unsigned char *_tx;                             // Next byte to send.
 int _rxCount;                                   // Number of characters received.
 int _txCount;                                   // Number of characters sent.
-volatile int _status;                           // Application status code.
+Task _commandTask;                              // Task running the commands received.
+PinInterrupts _csPort;                          // Chip select port pin change handlers.
 //
 //  GUID which identifies this module.
 //
@@ -131,7 +187,7 @@ void NotifyGOBoard()
 //
 void AddFive()
 {
-    _txBuffer[1] = _rxBuffer[2] + 5;
+    _txBuffer[1] = _command[2] + 5;
     NotifyGOBoard();
 }
 
@@ -219,8 +275,14 @@ void ResetGoFrame()
         _txBuffer[0] = _moduleID[0];            //  Second byte in the response.
         //
         //  Now reset the buffer pointers and counters ready for data transfer.
+        //  A frame which has been posted to the command task stays with it
+        //  and the next frame goes into the other buffer.
         //
-        _rx = _rxBuffer;
+        if (_rxFull[_rxBuffer])
+        {
+            _rxBuffer ^= 1;
+        }
+        _rx = _rxBuffers[_rxBuffer];
         _tx = _txBuffer;
         _rxCount = 0;
         _txCount = 0;
@@ -239,15 +301,14 @@ void ResetGoFrame()
 
 //--------------------------------------------------------------------------------
 //
-//  SPI chip select interrupt service routine.
+//  SPI chip select has changed.
 //
-#pragma vector = SPI_CHIP_SELECT_VECTOR
-__interrupt void EXTI_SPI_CS_PORT_IRQHandler(void)
+void ChipSelect(unsigned char pin, unsigned char level)
 {
     #if defined (DEBUG)
         PIN_STATUS_CODE = 1;
     #endif
-    if (SPI_CS_IRQ_DIRECTION == 2)
+    if (level == 0)
     {
         //
         //  Transition from high to low selects this slave device.
@@ -257,7 +318,6 @@ __interrupt void EXTI_SPI_CS_PORT_IRQHandler(void)
         #if defined (DEBUG)
             PIN_STATUS_CODE = 0;
         #endif
-        SPI_CS_IRQ_DIRECTION = 1;               //  Waiting for rising edge next.
     }
     else
     {
@@ -266,7 +326,6 @@ __interrupt void EXTI_SPI_CS_PORT_IRQHandler(void)
         //
         SPI_CR1_SPE = 0;                        //  Disable SPI.
         SPI_CR2_SSI = 1;
-        SPI_CS_IRQ_DIRECTION = 2;               //  Waiting for falling edge next.
         ResetGoFrame();
         #if defined (DEBUG)
             PIN_STATUS_CODE = 0;
@@ -274,6 +333,17 @@ __interrupt void EXTI_SPI_CS_PORT_IRQHandler(void)
     }
 }
 
+//--------------------------------------------------------------------------------
+//
+//  SPI chip select port interrupt service routine, call the handler for
+//  the pin which has changed.
+//
+#pragma vector = SPI_CHIP_SELECT_VECTOR
+__interrupt void EXTI_SPI_CS_PORT_IRQHandler(void)
+{
+    PinInterruptsDispatch(&_csPort, SPI_CS_PORT_IDR);
+}
+
 //--------------------------------------------------------------------------------
 //
 //  SPI Interrupt service routine.
@@ -287,7 +357,7 @@ __interrupt void SPI_IRQHandler(void)
     if (SPI_SR_OVR)
     {
         SPI_CR1_SPE = 0;
-        _status = SC_OVERFLOW;
+        SchedulerPost(&_commandTask, SC_OVERFLOW);
         return;
     }
     //
@@ -296,7 +366,7 @@ __interrupt void SPI_IRQHandler(void)
     if (SPI_SR_CRCERR)
     {
         SPI_CR1_SPE = 0;
-        _status = SC_CRC_ERROR;
+        SchedulerPost(&_commandTask, SC_CRC_ERROR);
         return;
     }
     //
@@ -335,34 +405,24 @@ __interrupt void SPI_IRQHandler(void)
             _rxCount++;
             if (_rxCount == (GO_BUFFER_SIZE - 1))
             {
-                _status = SC_RX_BUFFER_FULL;
+                //
+                //  Only post the frame if the other buffer is free for
+                //  the next one, otherwise this frame is dropped and its
+                //  buffer reused.
+                //
+                if (!_rxFull[_rxBuffer ^ 1] && SchedulerPost(&_commandTask, RX_EVENT(SC_RX_BUFFER_FULL, _rxBuffer)))
+                {
+                    _rxFull[_rxBuffer] = 1;
+                }
+                else
+                {
+                    _rxDropped++;
+                }
             }
         }
     }
 }
 
-//--------------------------------------------------------------------------------
-//
-//  Setup the system clock to run at 16MHz using the internal oscillator.
-//
-void InitialiseSystemClock()
-{
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 1;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
-}
-
 //--------------------------------------------------------------------------------
 //
 //  Initialise SPI to be a slave device.
@@ -402,14 +462,53 @@ void InitialisePorts()
     PB_DDR = 0;             //  All pins are inputs.
     PB_CR1 = 0xff;          //  All inputs have pull-ups enabled.
     PB_CR2 = 0xff;          //  Interrupts enabled on all pins.
-    EXTI_CR1_PBIS = 2;      //  Port B interrupt on falling edge (initially).
 #else
     PA_ODR = 0;             //  Turn the outputs off.
     PA_DDR = 0;             //  All pins are inputs.
     PA_CR1 = 0xff;          //  All inputs have pull-ups enabled.
     PA_CR2 = 0xff;          //  Interrupts enabled on all pins.
-    EXTI_CR1_PAIS = 2;      //  Port A interrupt on falling edge (initially).
 #endif
+    PinInterruptsInitialise(&_csPort, SPI_CS_PORT_IDR);
+    PinInterruptsAttach(&_csPort, SPI_CS_PIN, PIN_BOTH_EDGES, ChipSelect);
+    SPI_CS_IRQ_DIRECTION = 3;   //  Interrupt on rising and falling edges.
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Command task, run the function for each complete frame received and
+//  then give the buffer back to the interrupt service routine.  The SPI
+//  errors are posted too but need no action here as the next frame
+//  restarts the SPI.
+//
+void RunCommand(unsigned char event)
+{
+    if (RX_EVENT_CODE(event) != SC_RX_BUFFER_FULL)
+    {
+        return;
+    }
+    unsigned char buffer = RX_EVENT_BUFFER(event);
+    _command = _rxBuffers[buffer];
+    if (_command[0] == GO_COMMAND_RESPONSE)
+    {
+        #if defined(DEBUG)
+            BitBangBuffer(_command, GO_BUFFER_SIZE);
+        #endif
+        //
+        //  Work out which function to call.
+        //
+        if (_numberOfFunctions > 0)
+        {
+            for (int index = 0; index < _numberOfFunctions; index++)
+            {
+                if (_functionTable[index].command == _command[1])
+                {
+                    (*(_functionTable[index].functionPointer))();
+                    break;
+                }
+            }
+        }
+    }
+    _rxFull[buffer] = 0;
 }
 
 //--------------------------------------------------------------------------------
@@ -423,37 +522,30 @@ int main(void)
     //
     __disable_interrupt();
     InitialiseSystemClock();
+#if defined(LOG_CHIP_SELECT)
+    UARTPrintInitialise();
+    EdgeLogInitialise();
+#endif
     InitialiseSPIAsSlave();
     ResetGoFrame();
     InitialisePorts();
-    _status = SC_UNKNOWN;
+    SchedulerAddTask(&_commandTask, 0, RunCommand);
     __enable_interrupt();
     //
-    //  Main program loop.
+    //  Main program loop, handle the events posted by the interrupts and
+    //  print the port interrupts logged, wait for an interrupt when there
+    //  is nothing to do.  An interrupt logged just before the wait is
+    //  printed after the next interrupt.
     //
     while (1)
     {
-        __wait_for_interrupt();
-        if ((_status == SC_RX_BUFFER_FULL) && (_rxBuffer[0] == GO_COMMAND_RESPONSE))
+#if defined(LOG_CHIP_SELECT)
+        if ((SchedulerDispatch() == 0) && (EdgeLogDump() == 0))
+#else
+        if (SchedulerDispatch() == 0)
+#endif
         {
-            #if defined(DEBUG)
-                BitBangBuffer(_rxBuffer, GO_BUFFER_SIZE);
-            #endif
-            //
-            //  Work out which function to call.
-            //
-            if (_numberOfFunctions > 0)
-            {
-                for (int index = 0; index < _numberOfFunctions; index++)
-                {
-                    if (_functionTable[index].command == _rxBuffer[1])
-                    {
-                        (*(_functionTable[index].functionPointer))();
-                        break;
-                    }
-                }
-            }
+            SchedulerIdle();
         }
-        _status = SC_UNKNOWN;
     }
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+//
+//  Calibrated delays for the STM32F4 using SysTick and the DWT cycle
+//  counter.
+//
+//  This is the STM32 version of Common/Delay.h.  Millisecond delays are
+//  timed by SysTick interrupting every millisecond and the core waits for
+//  the interrupt (WFI) between the ticks.  The SysTick handler in
+//  stm32f4xx_it.c does not need to do anything, the tick is seen through
+//  the COUNTFLAG bit.  Microsecond delays are too short to sleep through
+//  and are timed by polling the DWT cycle counter.
+//
+//  Both are calculated from SystemCoreClock so DelayInitialise must be
+//  called again if the clock is changed.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef __DELAY_H
+#define __DELAY_H
+
+#include "stm32f4xx.h"
+
+//
+//  Core clock cycles in a microsecond.
+//
+static uint32_t _cyclesPerMicrosecond;
+
+//--------------------------------------------------------------------------------
+//
+//  Start SysTick interrupting every millisecond and the cycle counter.
+//
+static void DelayInitialise()
+{
+    SystemCoreClockUpdate();
+    _cyclesPerMicrosecond = SystemCoreClock / 1000000;
+    SysTick_Config(SystemCoreClock / 1000);
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Wait for at least us microseconds by counting core clock cycles.
+//
+static void DelayMicroseconds(uint32_t us)
+{
+    uint32_t start = DWT->CYCCNT;
+    uint32_t cycles = us * _cyclesPerMicrosecond;
+    while ((DWT->CYCCNT - start) < cycles);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Wait for ms whole SysTick periods, sleeping between the ticks.  The
+//  first tick can come at any time so the delay is between ms - 1 and ms
+//  milliseconds, one more tick is waited for to make it at least ms.
+//
+//  COUNTFLAG is tested with interrupts masked so a tick between the test
+//  and the WFI leaves the SysTick interrupt pending, which wakes the WFI
+//  at once instead of sleeping through to the next tick.  The interrupt
+//  is taken when they are unmasked again.
+//
+static void DelayMilliseconds(uint32_t ms)
+{
+    (void) (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk);      //  Reading clears the flag.
+    for (uint32_t tick = 0; tick <= ms; tick++)
+    {
+        __disable_irq();
+        while ((SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) == 0)
+        {
+            __WFI();
+            __enable_irq();
+            __disable_irq();
+        }
+        __enable_irq();
+    }
+}
+
+#endif
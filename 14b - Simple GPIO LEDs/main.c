@@ -1,6 +1,12 @@
 #include "stm32f4xx.h"
 #include "stm32f4xx_gpio.h"
 #include "stm32f4xx_rcc.h"
+#include "delay.h"
+
+//
+//  Time the LED spends on and off.
+//
+#define HALF_PERIOD_MS  250
 
 int main()
 {
@@ -15,13 +21,13 @@ int main()
     GPIOD->OSPEEDR |= speed;
     GPIOD->OTYPER |= type;
     GPIOD->PUPDR |= pullup;
+    DelayInitialise();
 
 	while (1)
 	{
 		GPIOD->BSRRL = (1 << pin);
-		int index;
-		for (index = 0; index < 500000; index++);
+		DelayMilliseconds(HALF_PERIOD_MS);
 		GPIOD->BSRRH = (1 << pin);
-		for (index = 0; index < 500000; index++);
+		DelayMilliseconds(HALF_PERIOD_MS);
 	}
 }
\ No newline at end of file
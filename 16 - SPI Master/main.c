@@ -11,6 +11,19 @@
 #include <iostm8S105c6.h>
 #include <intrinsics.h>
 
+//
+//  The system clock runs from the HSI at 16 MHz, only the peripherals
+//  used by this example are clocked.
+//
+#define CLOCK_PERIPHERALS       (CLOCK_SPI)
+#include "../Common/SystemClock.h"
+
+//
+//  The main loop is replaced by the scheduler, the SPI interrupt posts an
+//  event for each buffer received so none are missed.
+//
+#include "../Common/Scheduler.h"
+
 //--------------------------------------------------------------------------------
 //
 //  Define the status codes.
@@ -37,18 +50,30 @@
 //  Miscellaneous constants
 //
 #define BUFFER_SIZE             17
+//
+//  The data is received into two buffers in turn so a full buffer is not
+//  overwritten while the receiver task works on it.  The index of the
+//  buffer goes to the task in the top four bits of the event.
+//
+#define RX_BUFFERS              2
+#define RX_EVENT(code, buffer)  ((code) | ((buffer) << 4))
+#define RX_EVENT_CODE(event)    ((event) & 0x0f)
+#define RX_EVENT_BUFFER(event)  ((event) >> 4)
 
 //--------------------------------------------------------------------------------
 //
 //  Application global variables.
 //
-unsigned char _rxBuffer[BUFFER_SIZE];       // Buffer holding the received data.
+unsigned char _rxBuffers[RX_BUFFERS][BUFFER_SIZE];  // Buffers holding the received data.
+volatile unsigned char _rxFull[RX_BUFFERS]; // Buffer posted and not yet handled.
+unsigned char _rxBuffer;                    // Buffer being filled.
+unsigned short _rxDropped;                  // Buffers lost as both were full.
 unsigned char _txBuffer[BUFFER_SIZE];       // Buffer holding the data to send.
 unsigned char *_rx;                         // Place to put the next byte received.
 unsigned char *_tx;                         // Next byte to send.
 int _rxCount;                               // Number of characters received.
 int _txCount;                               // Number of characters sent.
-int _status;                                // Application status code.
+Task _receiver;                             // Task handling the received data.
 
 //--------------------------------------------------------------------------------
 //
@@ -108,7 +133,7 @@ void ResetSPIBuffers()
     SPI_DR = 0xff;
     _rxCount = 0;
     _txCount = 0;
-    _rx = _rxBuffer;
+    _rx = _rxBuffers[_rxBuffer];
     _tx = _txBuffer;
 }
 
@@ -126,8 +151,7 @@ __interrupt void SPI_IRQHandler(void)
     {
         (void) SPI_DR;                      // These two reads clear the overflow
         (void) SPI_SR;                      // error.
-        _status = SC_OVERFLOW;
-        OutputStatusCode(_status);
+        OutputStatusCode(SC_OVERFLOW);
         return;
     }
     //
@@ -143,9 +167,23 @@ __interrupt void SPI_IRQHandler(void)
         _rxCount++;
         if (_rxCount == BUFFER_SIZE)
         {
-            _status = SC_RX_BUFFER_FULL;
-            OutputStatusCode(_status);
-            _rx = _rxBuffer;
+            //
+            //  Hand the buffer to the receiver task and fill the other
+            //  one.  If the task still has the other buffer the data
+            //  just received is dropped and this buffer is filled again.
+            //
+            unsigned char next = _rxBuffer ^ 1;
+            if (!_rxFull[next] && SchedulerPost(&_receiver, RX_EVENT(SC_RX_BUFFER_FULL, _rxBuffer)))
+            {
+                _rxFull[_rxBuffer] = 1;
+                OutputStatusCode(SC_RX_BUFFER_FULL);
+                _rxBuffer = next;
+            }
+            else
+            {
+                _rxDropped++;
+            }
+            _rx = _rxBuffers[_rxBuffer];
             _rxCount = 0;
         }
     }
@@ -166,28 +204,6 @@ __interrupt void SPI_IRQHandler(void)
     }
 }
 
-//--------------------------------------------------------------------------------
-//
-//  Setup the system clock to run at 16MHz using the internal oscillator.
-//
-void InitialiseSystemClock()
-{
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 0;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
-}
-
 //--------------------------------------------------------------------------------
 //
 //  Initialise SPI to be SPI slave.
@@ -231,6 +247,21 @@ void InitialisePorts()
     ITC_SPR2_VECT6SPR = 1;  //  Priority 1 for Port B interrupt.
 }
 
+//--------------------------------------------------------------------------------
+//
+//  Receiver task, output each buffer received on the diagnostic pins and
+//  then give the buffer back to the interrupt service routine.
+//
+void Receive(unsigned char event)
+{
+    if (RX_EVENT_CODE(event) == SC_RX_BUFFER_FULL)
+    {
+        unsigned char buffer = RX_EVENT_BUFFER(event);
+        BitBangBuffer(_rxBuffers[buffer], BUFFER_SIZE);
+        _rxFull[buffer] = 0;
+    }
+}
+
 //--------------------------------------------------------------------------------
 //
 //  Main program loop.
@@ -249,18 +280,17 @@ int main(void)
         _txBuffer[index] = index + 100;
     }
     InitialisePorts();
-    _status = SC_UNKNOWN;
+    SchedulerAddTask(&_receiver, 0, Receive);
     __enable_interrupt();
     //
-    //  Main program loop.
+    //  Main program loop, handle the events posted by the interrupts and
+    //  wait for an interrupt when there are none.
     //
     while (1)
     {
-        __wait_for_interrupt();
-        if (_status == SC_RX_BUFFER_FULL)
+        if (SchedulerDispatch() == 0)
         {
-            BitBangBuffer(_rxBuffer, BUFFER_SIZE);
+            SchedulerIdle();
         }
-        _status = SC_UNKNOWN;
     }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 //
 //  Write a series of bytes to the EEPROM of the STM8S105C6 and then
-//  verify that the data has been written correctly.
+//  verify that the data has been written correctly.  The data is an IR
+//  remote style sequence of marks and spaces which is then played from
+//  the EEPROM on Timer 1, channel 3 with a 38 kHz carrier.
 //
 //  This software is provided under the CC BY-SA 3.0 licence.  A
 //  copy of this licence can be found at:
@@ -12,11 +14,26 @@
 #else
     #include <iostm8s103f3.h>
 #endif
+#include <intrinsics.h>
 
 //
-//  Define where we will be working in the EEPROM.
+//  The system clock runs from the HSI at 16 MHz, only Timer 1 is clocked.
 //
-#define EEPROM_BASE_ADDRESS         0x4000
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1)
+#include "../Common/SystemClock.h"
+
+//
+//  Marks and spaces are played by Timer 1 straight from the EEPROM.
+//
+#include "../Common/PulseSequence.h"
+
+//
+//  Define where we will be working in the EEPROM.  The host simulation
+//  supplies its own base address.
+//
+#if !defined(EEPROM_BASE_ADDRESS)
+    #define EEPROM_BASE_ADDRESS     0x4000
+#endif
 #define EEPROM_INITIAL_OFFSET       0x0040
 #define EEPROM_DATA_START           (EEPROM_BASE_ADDRESS + EEPROM_INITIAL_OFFSET)
 
@@ -107,13 +124,36 @@ void SetupPorts()
     PD_CR2 = 0xff;          //  Pins can run up to 10 MHz.
 }
 
+//--------------------------------------------------------------------------------
+//
+//  Play the sequence from the EEPROM, marks are a 38 kHz carrier (26 uS
+//  period, high for 9 uS).
+//
+void PlaySequence()
+{
+    unsigned char *address = (unsigned char *) EEPROM_DATA_START;
+    PulseSequenceInitialise(3, 26, 9);
+    PulseSequencePlay(address + 1, *address);
+}
+
 //--------------------------------------------------------------------------------
 //
 //  Main program loop.
 //
 void main()
 {
+    __disable_interrupt();
+    InitialiseSystemClock();
     SetupPorts();
     SetDefaultValues();
     VerifyEEPROMData();
+    if (PD_ODR_ODR3 == 0)       //  Only play the sequence if it verified.
+    {
+        PlaySequence();
+    }
+    __enable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
 }
\ No newline at end of file
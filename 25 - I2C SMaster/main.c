@@ -15,6 +15,28 @@
 #endif
 #include <intrinsics.h>
 
+//
+//  The system clock runs from the HSI at 16 MHz, only the peripherals
+//  used by this example are clocked.
+//
+#define CLOCK_PERIPHERALS       (CLOCK_I2C)
+#include "../Common/SystemClock.h"
+
+//
+//  I2C bus timing calculated from the master clock, standard mode with SCL
+//  at 50 KHz.  The peripheral needs the master clock as a whole number of
+//  MHz and the maximum rise time (1000 ns in standard mode) in master
+//  clock cycles plus one.
+//
+#define SCL_FREQUENCY           50000UL
+#define I2C_CLOCK_MHZ           (F_MASTER / 1000000UL)
+#define SCL_DIVIDER             (F_MASTER / (2 * SCL_FREQUENCY))
+#define SCL_RISE_TIME           (I2C_CLOCK_MHZ + 1)
+
+#if (I2C_CLOCK_MHZ < 1) || ((F_MASTER % 1000000UL) != 0)
+    #error "The I2C peripheral needs a master clock of a whole number of MHz."
+#endif
+
 //
 //  Define some pins to output diagnostic data.
 //
@@ -57,27 +79,6 @@ void BitBang(unsigned char byte)
     PIN_BIT_BANG_DATA = 0;
 }
 
-//
-//  Setup the system clock to run at 16MHz using the internal oscillator.
-//
-void InitialiseSystemClock()
-{
-    CLK_ICKR = 0;                       //  Reset the Internal Clock Register.
-    CLK_ICKR_HSIEN = 1;                 //  Enable the HSI.
-    CLK_ECKR = 0;                       //  Disable the external clock.
-    while (CLK_ICKR_HSIRDY == 0);       //  Wait for the HSI to be ready for use.
-    CLK_CKDIVR = 0;                     //  Ensure the clocks are running at full speed.
-    CLK_PCKENR1 = 0xff;                 //  Enable all peripheral clocks.
-    CLK_PCKENR2 = 0xff;                 //  Ditto.
-    CLK_CCOR = 0;                       //  Turn off CCO.
-    CLK_HSITRIMR = 0;                   //  Turn off any HSIU trimming.
-    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
-    CLK_SWR = 0xe1;                     //  Use HSI as the clock source.
-    CLK_SWCR = 0;                       //  Reset the clock switch control register.
-    CLK_SWCR_SWEN = 1;                  //  Enable switching.
-    while (CLK_SWCR_SWBSY != 0);        //  Pause while the clock switch is busy.
-}
-
 //
 //  Initialise the I2C system.
 //
@@ -87,10 +88,10 @@ void InitialiseI2C()
     //
     //  Setup the clock information.
     //
-    I2C_FREQR = 16;                     //  Set the internal clock frequency (MHz).
+    I2C_FREQR = I2C_CLOCK_MHZ;          //  Set the internal clock frequency (MHz).
     I2C_CCRH_F_S = 0;                   //  I2C running is standard mode.
-    I2C_CCRL = 0xa0;                    //  SCL clock speed is 50 KHz.
-    I2C_CCRH_CCR = 0x00;
+    I2C_CCRL = (unsigned char) (SCL_DIVIDER & 0xff);    //  SCL clock speed is 50 KHz.
+    I2C_CCRH_CCR = (unsigned char) (SCL_DIVIDER >> 8);
     //
     //  Set the address of this device.
     //
@@ -99,7 +100,7 @@ void InitialiseI2C()
     //
     //  Setup the bus characteristics.
     //
-    I2C_TRISER = 17;
+    I2C_TRISER = SCL_RISE_TIME;
     //
     //  Turn on the interrupts.
     //
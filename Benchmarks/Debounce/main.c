@@ -0,0 +1,227 @@
+//
+//  Benchmark for the button debouncer (Common/Debounce.h).
+//
+//  PA1 plays the part of a bouncing button and is wired to PC3 (on the
+//  host: --connect PA1=PC3).  Each press and release bounces 12 times
+//  with gaps of 40 to 480 us before settling, the button is held for
+//  30 ms and the last press for 600 ms.  The presses are read twice,
+//  first with a handler on every edge and then through the debouncer
+//  sampling every millisecond, and one line is printed for each:
+//
+//      mode=raw presses=8 port_interrupts=... tick_interrupts=0 pressed=... released=... long_presses=0
+//      mode=debounced presses=8 port_interrupts=8 tick_interrupts=... pressed=8 released=8 long_presses=1
+//
+//  port_interrupts is the number of port C interrupts and pressed,
+//  released and long_presses the events reported.  Without debouncing
+//  every bounce is a press, with it each press takes one port interrupt.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM2 | CLOCK_TIM4 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/Delay.h"
+#include "../../Common/Debounce.h"
+
+//
+//  Presses in each run, the bounces on each edge and the debounce
+//  settings (in 1 ms ticks).
+//
+#define PRESSES                 8
+#define BOUNCES                 12
+#define BOUNCE_GAP_US           40
+#define HOLD_MS                 30
+#define LONG_HOLD_MS            600
+#define INTEGRATION             5
+#define LONG_PRESS_TICKS        500
+
+//
+//  TIM2 counts microseconds and overflows every millisecond.
+//
+#define TICK_PRESCALER          CLOCK_LOG2(F_MASTER / 1000000UL)
+#define TICK_RELOAD             999
+
+PinInterrupts _portC;
+Button _button;
+
+//
+//  Interrupts taken and events reported in the current run.
+//
+volatile unsigned short _portInterrupts;
+volatile unsigned short _tickInterrupts;
+volatile unsigned short _pressed;
+volatile unsigned short _released;
+volatile unsigned short _longPresses;
+
+//
+//  Port C interrupt, PC3 is the only input.
+//
+#pragma vector = 7
+__interrupt void EXTI_PORTC_IRQHandler(void)
+{
+    _portInterrupts++;
+    PinInterruptsDispatch(&_portC, PC_IDR);
+}
+
+//
+//  TIM2 tick, stopped when the button has settled.
+//
+#pragma vector = TIM2_OVR_UIF_vector
+__interrupt void TIM2_UPD_OVF_IRQHandler(void)
+{
+    TIM2_SR1_UIF = 0;
+    _tickInterrupts++;
+    if (DebounceTick() == 0)
+    {
+        TIM2_CR1_CEN = 0;
+    }
+}
+
+//
+//  TIM4 overflow for the delays.
+//
+#pragma vector = TIM4_OVR_UIF_vector
+__interrupt void TIM4_UPD_OVF_IRQHandler(void)
+{
+    DelayInterrupt();
+}
+
+//
+//  Every edge is an event (raw run).
+//
+void RawEdge(unsigned char pin, unsigned char level)
+{
+    if (level == 0)
+    {
+        _pressed++;
+    }
+    else
+    {
+        _released++;
+    }
+}
+
+//
+//  First edge of a press, start the debouncer and the tick.
+//
+void DebounceEdge(unsigned char pin, unsigned char level)
+{
+    DebounceStart(&_button);
+    TIM2_CR1_CEN = 1;
+}
+
+//
+//  Debounced events.
+//
+void ButtonEvent(Button *button, unsigned char event)
+{
+    switch (event)
+    {
+        case BUTTON_PRESSED:
+            _pressed++;
+            break;
+        case BUTTON_RELEASED:
+            _released++;
+            break;
+        case BUTTON_LONG_PRESS:
+            _longPresses++;
+            break;
+    }
+}
+
+//
+//  Move PA1 to level, bouncing on the way.
+//
+void Bounce(unsigned char level)
+{
+    for (unsigned char bounce = 0; bounce < BOUNCES; bounce++)
+    {
+        PA_ODR_ODR1 = (bounce & 1) ? !level : level;
+        DelayMicroseconds(BOUNCE_GAP_US * (bounce + 1));
+    }
+    PA_ODR_ODR1 = level;
+}
+
+//
+//  Press and release the button PRESSES times, the button is pulled up
+//  (released at 1).
+//
+void Run(const char *mode)
+{
+    _portInterrupts = 0;
+    _tickInterrupts = 0;
+    _pressed = 0;
+    _released = 0;
+    _longPresses = 0;
+    for (unsigned char press = 0; press < PRESSES; press++)
+    {
+        Bounce(0);
+        DelayMilliseconds((press == (PRESSES - 1)) ? LONG_HOLD_MS : HOLD_MS);
+        Bounce(1);
+        DelayMilliseconds(HOLD_MS);
+    }
+    UARTPrintString("mode=");
+    UARTPrintString(mode);
+    UARTPrintValue(" presses", PRESSES, ' ');
+    UARTPrintValue("port_interrupts", _portInterrupts, ' ');
+    UARTPrintValue("tick_interrupts", _tickInterrupts, ' ');
+    UARTPrintValue("pressed", _pressed, ' ');
+    UARTPrintValue("released", _released, ' ');
+    UARTPrintValue("long_presses", _longPresses, '\n');
+}
+
+//
+//  PA1 output (released), PC3 input interrupting on both edges and the
+//  TIM2 tick ready to start.
+//
+void Initialise()
+{
+    PA_ODR_ODR1 = 1;
+    PA_DDR_DDR1 = 1;
+    PA_CR1_C11 = 1;
+    PC_DDR_DDR3 = 0;
+    PC_CR1_C13 = 0;
+    PC_CR2_C23 = 1;
+    EXTI_CR1_PCIS = 3;
+    TIM2_PSCR = TICK_PRESCALER;
+    TIM2_ARRH = (unsigned char) (TICK_RELOAD >> 8);
+    TIM2_ARRL = (unsigned char) TICK_RELOAD;
+    TIM2_IER_UIE = 1;
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    Initialise();
+    PinInterruptsInitialise(&_portC, PC_IDR);
+    PinInterruptsAttach(&_portC, 3, PIN_BOTH_EDGES, RawEdge);
+    __enable_interrupt();
+    Run("raw");
+    PinInterruptsInitialise(&_portC, PC_IDR);
+    DebounceAttach(&_button, &_portC, DEBOUNCE_PORT_C, 3, 0, INTEGRATION, LONG_PRESS_TICKS, ButtonEvent);
+    PinInterruptsAttach(&_portC, 3, PIN_FALLING_EDGE, DebounceEdge);
+    Run("debounced");
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
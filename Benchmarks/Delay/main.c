@@ -0,0 +1,129 @@
+//
+//  Self-test for the TIM4 delay service (Common/Delay.h).
+//
+//  Each delay is timed with TIM1 and the result printed on the UART, one
+//  line for each delay:
+//
+//      requested_us=1000 measured_us=... error_us=... wakeups=...
+//
+//  Delays up to 50 ms are measured in microseconds, the one second delay
+//  in units of 64 us (rounded to microseconds).  error_us is measured_us
+//  less requested_us and wakeups the number of TIM4 interrupts taken
+//  during the delay, a busy loop would not sleep at all.
+//
+//  On the host only register accesses take time so the error shows the
+//  rounding of the delay into timer counts rather than the set up time.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM4 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/Delay.h"
+
+//
+//  Delays tested in microseconds.
+//
+const unsigned long _delays[] = { 1, 10, 100, 257, 1000, 2049, 10000, 50000 };
+#define NUMBER_OF_DELAYS        (sizeof(_delays) / sizeof(_delays[0]))
+
+//
+//  TIM4 overflow, the end of part of a delay.
+//
+#pragma vector = TIM4_OVR_UIF_vector
+__interrupt void TIM4_UPD_OVF_IRQHandler()
+{
+    DelayInterrupt();
+}
+
+//
+//  Run TIM1 from 0 with a prescaler of prescaler + 1.
+//
+void StartReference(unsigned short prescaler)
+{
+    TIM1_CR1_CEN = 0;
+    TIM1_PSCRH = (unsigned char) (prescaler >> 8);
+    TIM1_PSCRL = (unsigned char) prescaler;
+    TIM1_ARRH = 0xff;
+    TIM1_ARRL = 0xff;
+    TIM1_EGR_UG = 1;                                //  Load the prescaler and clear the counter.
+    TIM1_CR1_CEN = 1;
+}
+
+//
+//  Current TIM1 count, reading the high byte latches the low byte.
+//
+unsigned short ReferenceCount()
+{
+    unsigned char high = TIM1_CNTRH;
+    return (unsigned short) ((high << 8) | TIM1_CNTRL);
+}
+
+//
+//  Print the result of one delay.
+//
+void PrintResult(unsigned long requested, unsigned long measured, unsigned long wakeups)
+{
+    UARTPrintValue("requested_us", requested, ' ');
+    UARTPrintValue("measured_us", measured, ' ');
+    UARTPrintString("error_us=");
+    if (measured < requested)
+    {
+        UARTPrintChar('-');
+        UARTPrintUnsigned(requested - measured);
+    }
+    else
+    {
+        UARTPrintUnsigned(measured - requested);
+    }
+    UARTPrintChar(' ');
+    UARTPrintValue("wakeups", wakeups, '\n');
+}
+
+//
+//  Time a delay of us microseconds with the reference counting in units of
+//  2^shift microseconds.
+//
+void TestDelay(unsigned long us, unsigned char shift)
+{
+    unsigned long wakeups = _delayWakeups;
+    StartReference((unsigned short) ((F_MASTER / 1000000UL << shift) - 1));
+    unsigned short start = ReferenceCount();
+    DelayMicroseconds(us);
+    unsigned short end = ReferenceCount();
+    PrintResult(us, (unsigned long) (unsigned short) (end - start) << shift, _delayWakeups - wakeups);
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    __enable_interrupt();
+    for (unsigned char index = 0; index < NUMBER_OF_DELAYS; index++)
+    {
+        TestDelay(_delays[index], 0);
+    }
+    TestDelay(1000000UL, 6);
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
@@ -0,0 +1,168 @@
+//
+//  Benchmark for the dithered PWM (Common/Dither.h).
+//
+//  TIM1 channel 4 runs a 256 count period at 16 MHz (a 62.5 kHz carrier)
+//  dithered by 2 bits to give the 10 bit resolution of a 1024 count
+//  period.  Each duty is held for PERIODS periods and the duties written
+//  by the update interrupt are averaged, one line for each duty:
+//
+//      duty=513 periods=1024 mean_x1000=513000 error_x1000=0 isr_cycles_avg=... isr_cycles_max=...
+//
+//  mean_x1000 is the average duty in 1/1024 of the period (times 1000) and
+//  error_x1000 its difference from the duty requested.  The values written
+//  are loaded whole at the next update event (Benchmarks/PWM Preload), so
+//  this is the average of the output; run with --timer-updates 1 to see
+//  the compare values loaded.  isr_cycles_xxx is the cost of the update
+//  interrupt for each period measured with TIM2 at f_master.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM2 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/Pwm.h"
+#include "../../Common/Dither.h"
+
+//
+//  Period, dither bits and the periods each duty is held for.
+//
+#define PERIOD                  256
+#define DITHER_BITS             2
+#define PERIODS                 1024
+const unsigned short _duties[] = { 0, 1, 2, 3, 513, 682, 1022, 1023 };
+#define NUMBER_OF_DUTIES        (sizeof(_duties) / sizeof(_duties[0]))
+
+Dither _dither;
+
+//
+//  Periods counted and the duties written in the current run.
+//
+volatile unsigned short _periods;
+unsigned long _sum;
+unsigned long _isrCycles;
+unsigned short _isrLongest;
+
+//
+//  Current TIM2 count, reading the high byte latches the low byte.
+//
+unsigned short CycleCount()
+{
+    unsigned char high = TIM2_CNTRH;
+    return (unsigned short) ((high << 8) | TIM2_CNTRL);
+}
+
+//
+//  Output function for the dither, totals the duties written.
+//
+void Output(unsigned char channel, unsigned short duty)
+{
+    PwmTimer1Duty(channel, duty);
+    if (_periods < PERIODS)
+    {
+        _sum += duty;
+    }
+}
+
+//
+//  TIM1 update, the duty for the next period.
+//
+#pragma vector = TIM1_OVR_UIF_vector
+__interrupt void TIM1_UPD_OVF_IRQHandler(void)
+{
+    unsigned short start = CycleCount();
+    TIM1_SR1_UIF = 0;
+    DitherUpdate(&_dither);
+    if (_periods < PERIODS)
+    {
+        _periods++;
+        unsigned short duration = (unsigned short) (CycleCount() - start);
+        _isrCycles += duration;
+        if (duration > _isrLongest)
+        {
+            _isrLongest = duration;
+        }
+    }
+}
+
+//
+//  TIM2 free running at f_master.
+//
+void InitialiseCycleCounter()
+{
+    TIM2_PSCR = 0;
+    TIM2_ARRH = 0xff;
+    TIM2_ARRL = 0xff;
+    TIM2_EGR_UG = 1;
+    TIM2_CR1_CEN = 1;
+}
+
+//
+//  Hold a duty for PERIODS periods and print the average.
+//
+void Measure(unsigned short duty)
+{
+    DitherSet(&_dither, duty);
+    __disable_interrupt();
+    _sum = 0;
+    _isrCycles = 0;
+    _isrLongest = 0;
+    _periods = 0;
+    while (_periods < PERIODS)
+    {
+        __wait_for_interrupt();
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+    unsigned long mean = (_sum * (1000UL << DITHER_BITS)) / PERIODS;
+    long error = (long) mean - (long) duty * 1000L;
+    UARTPrintValue("duty", duty, ' ');
+    UARTPrintValue("periods", PERIODS, ' ');
+    UARTPrintValue("mean_x1000", mean, ' ');
+    UARTPrintString("error_x1000=");
+    if (error < 0)
+    {
+        UARTPrintChar('-');
+        error = -error;
+    }
+    UARTPrintUnsigned((unsigned long) error);
+    UARTPrintValue(" isr_cycles_avg", _isrCycles / PERIODS, ' ');
+    UARTPrintValue("isr_cycles_max", _isrLongest, '\n');
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    InitialiseCycleCounter();
+    PwmTimer1Initialise(0, PERIOD, PWM_CHANNEL(4));
+    DitherInitialise(&_dither, Output, 4, DITHER_BITS);
+    TIM1_IER_UIE = 1;
+    __enable_interrupt();
+    for (unsigned char index = 0; index < NUMBER_OF_DUTIES; index++)
+    {
+        Measure(_duties[index]);
+    }
+    TIM1_IER_UIE = 0;
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
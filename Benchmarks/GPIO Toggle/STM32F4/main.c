@@ -0,0 +1,191 @@
+//
+//  GPIO toggle rate on the STM32F4 Discovery board for the different ways
+//  of writing to an output.  This replaces main.c in the
+//  "14 - STM32F4 Discovery GPIO" project and toggles PD13 (orange LED):
+//
+//      bsrr16              GPIOD->BSRRL = pin; GPIOD->BSRRH = pin;
+//      bsrr32              One 32 bit write to BSRR for each edge.
+//      odr_xor             GPIOD->ODR ^= pin;
+//      odr_write           GPIOD->ODR = pin; GPIOD->ODR = 0;
+//      bsrr16_unrolled     bsrr16 with eight pulses per loop.
+//      bsrr32_unrolled     bsrr32 with eight pulses per loop.
+//
+//  Each style makes PULSES pulses timed by the DWT cycle counter with
+//  interrupts disabled, including the loop overhead.  The results are
+//  written through the ITM (stimulus port 0, view them with the SWO
+//  viewer), one line for each style:
+//
+//      style=bsrr16 edges=512 cycles=... cycles_per_edge_x100=... square_wave_hz=...
+//
+//  The instruction count for each style can be read from the disassembly
+//  of the function of the same name.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#include "stm32f4xx.h"
+#include "stm32f4xx_gpio.h"
+#include "stm32f4xx_rcc.h"
+
+//
+//  Pulses made by each style, a multiple of 8 for the unrolled loops.
+//
+#define PULSES          256
+
+//
+//  BSRR as a single 32 bit register, the set bits are in the low half
+//  and the reset bits in the high half.
+//
+#define GPIOD_BSRR      (*(volatile uint32_t *) &GPIOD->BSRRL)
+#define PIN             GPIO_Pin_13
+#define PIN_SET         ((uint32_t) PIN)
+#define PIN_RESET       ((uint32_t) PIN << 16)
+
+//
+//  The styles.
+//
+void ToggleBsrr16(uint32_t pulses)
+{
+    for (uint32_t count = 0; count < pulses; count++)
+    {
+        GPIOD->BSRRL = PIN;
+        GPIOD->BSRRH = PIN;
+    }
+}
+
+void ToggleBsrr32(uint32_t pulses)
+{
+    for (uint32_t count = 0; count < pulses; count++)
+    {
+        GPIOD_BSRR = PIN_SET;
+        GPIOD_BSRR = PIN_RESET;
+    }
+}
+
+void ToggleOdrXor(uint32_t pulses)
+{
+    for (uint32_t count = 0; count < pulses; count++)
+    {
+        GPIOD->ODR ^= PIN;
+        GPIOD->ODR ^= PIN;
+    }
+}
+
+void ToggleOdrWrite(uint32_t pulses)
+{
+    for (uint32_t count = 0; count < pulses; count++)
+    {
+        GPIOD->ODR = PIN;
+        GPIOD->ODR = 0;
+    }
+}
+
+void ToggleBsrr16Unrolled(uint32_t pulses)
+{
+    for (uint32_t count = 0; count < pulses; count += 8)
+    {
+        GPIOD->BSRRL = PIN; GPIOD->BSRRH = PIN;
+        GPIOD->BSRRL = PIN; GPIOD->BSRRH = PIN;
+        GPIOD->BSRRL = PIN; GPIOD->BSRRH = PIN;
+        GPIOD->BSRRL = PIN; GPIOD->BSRRH = PIN;
+        GPIOD->BSRRL = PIN; GPIOD->BSRRH = PIN;
+        GPIOD->BSRRL = PIN; GPIOD->BSRRH = PIN;
+        GPIOD->BSRRL = PIN; GPIOD->BSRRH = PIN;
+        GPIOD->BSRRL = PIN; GPIOD->BSRRH = PIN;
+    }
+}
+
+void ToggleBsrr32Unrolled(uint32_t pulses)
+{
+    for (uint32_t count = 0; count < pulses; count += 8)
+    {
+        GPIOD_BSRR = PIN_SET; GPIOD_BSRR = PIN_RESET;
+        GPIOD_BSRR = PIN_SET; GPIOD_BSRR = PIN_RESET;
+        GPIOD_BSRR = PIN_SET; GPIOD_BSRR = PIN_RESET;
+        GPIOD_BSRR = PIN_SET; GPIOD_BSRR = PIN_RESET;
+        GPIOD_BSRR = PIN_SET; GPIOD_BSRR = PIN_RESET;
+        GPIOD_BSRR = PIN_SET; GPIOD_BSRR = PIN_RESET;
+        GPIOD_BSRR = PIN_SET; GPIOD_BSRR = PIN_RESET;
+        GPIOD_BSRR = PIN_SET; GPIOD_BSRR = PIN_RESET;
+    }
+}
+
+//
+//  Output through ITM stimulus port 0.
+//
+void PrintString(const char *text)
+{
+    while (*text)
+    {
+        ITM_SendChar(*text++);
+    }
+}
+
+void PrintValue(const char *name, uint32_t value, char separator)
+{
+    char digits[11];
+    char *ch = digits + sizeof(digits) - 1;
+    *ch = 0;
+    do
+    {
+        *--ch = (char) ('0' + (value % 10));
+        value /= 10;
+    }
+    while (value != 0);
+    PrintString(name);
+    ITM_SendChar('=');
+    PrintString(ch);
+    ITM_SendChar(separator);
+}
+
+//
+//  Time one style and print the result.
+//
+void Benchmark(const char *name, void (*toggle)(uint32_t))
+{
+    GPIOD->BSRRH = PIN;
+    __disable_irq();
+    uint32_t start = DWT->CYCCNT;
+    toggle(PULSES);
+    uint32_t cycles = DWT->CYCCNT - start;
+    __enable_irq();
+    PrintString("style=");
+    PrintString(name);
+    ITM_SendChar(' ');
+    PrintValue("edges", 2 * PULSES, ' ');
+    PrintValue("cycles", cycles, ' ');
+    PrintValue("cycles_per_edge_x100", (cycles * 100) / (2 * PULSES), ' ');
+    PrintValue("square_wave_hz", (uint32_t) (((uint64_t) SystemCoreClock * PULSES) / cycles), '\n');
+}
+
+int main()
+{
+    //
+    //  PD13 is a 100 MHz push-pull output.
+    //
+    RCC->AHB1ENR |= RCC_AHB1Periph_GPIOD;
+    GPIOD->MODER |= (GPIO_Mode_OUT << 26);
+    GPIOD->OSPEEDR |= (GPIO_Speed_100MHz << 26);
+    GPIOD->OTYPER |= (GPIO_OType_PP << 13);
+    GPIOD->PUPDR |= (GPIO_PuPd_NOPULL << 26);
+    //
+    //  Cycle counter.
+    //
+    SystemCoreClockUpdate();
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Benchmark("bsrr16", ToggleBsrr16);
+    Benchmark("bsrr32", ToggleBsrr32);
+    Benchmark("odr_xor", ToggleOdrXor);
+    Benchmark("odr_write", ToggleOdrWrite);
+    Benchmark("bsrr16_unrolled", ToggleBsrr16Unrolled);
+    Benchmark("bsrr32_unrolled", ToggleBsrr32Unrolled);
+    while (1)
+    {
+        __WFI();
+    }
+}
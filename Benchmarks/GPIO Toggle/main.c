@@ -0,0 +1,224 @@
+//
+//  GPIO toggle rate for the different ways of writing to an output.
+//
+//  Chapter 2 toggles PD4 as fast as it can to show the clock speed.  This
+//  benchmark does the same with each of the idioms used in the chapters so
+//  that the fastest can be picked for a bit banged bus:
+//
+//      bitfield            PD_ODR_ODR4 = 1; PD_ODR_ODR4 = 0;
+//      bitfield_not        PD_ODR_ODR4 = !PD_ODR_ODR4;
+//      port_xor            PD_ODR ^= 0x10;
+//      port_write          PD_ODR = 0x10; PD_ODR = 0;
+//      bset_bres           BSET / BRES written in assembler.
+//      bcpl                BCPL (complement a bit) written in assembler.
+//      bitfield_unrolled   bitfield with eight pulses per loop.
+//      bset_bres_unrolled  bset_bres with eight pulses per loop.
+//
+//  Each style makes PULSES pulses (two edges each) timed by TIM1 counting
+//  at f_master with interrupts disabled, including the loop overhead.  One
+//  line is printed on the UART for each style:
+//
+//      style=bitfield edges=512 cycles=... cycles_per_edge_x100=... square_wave_hz=...
+//
+//  Each style is a separate function so running the IAR or SDCC build
+//  under the instruction set simulator with a profile gives the number of
+//  instructions executed by each style:
+//
+//      ./build/stm8iss --time 0.1 --profile profile.csv toggle.out
+//
+//  The host build has no assembler (bset_bres and bcpl fall back to the
+//  bitfield) and only charges for register accesses so its results only
+//  show the number of register accesses made.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+
+//
+//  Pulses made by each style, a multiple of 8 for the unrolled loops.
+//
+#define PULSES                  256
+
+#if (F_CPU * PULSES) > 0xffffffffUL
+    #error "F_CPU * PULSES must fit in an unsigned long."
+#endif
+
+//
+//  PD4 (PD_ODR is at 0x500f) set, reset and complemented by the bit
+//  instructions.
+//
+#if defined(__IAR_SYSTEMS_ICC__)
+    #define PIN_BSET()          asm("bset 0x500f, #4")
+    #define PIN_BRES()          asm("bres 0x500f, #4")
+    #define PIN_BCPL()          asm("bcpl 0x500f, #4")
+#elif defined(__SDCC)
+    #define PIN_BSET()          __asm__("bset 0x500f, #4")
+    #define PIN_BRES()          __asm__("bres 0x500f, #4")
+    #define PIN_BCPL()          __asm__("bcpl 0x500f, #4")
+#else
+    #define PIN_BSET()          PD_ODR_ODR4 = 1
+    #define PIN_BRES()          PD_ODR_ODR4 = 0
+    #define PIN_BCPL()          PD_ODR_ODR4 = !PD_ODR_ODR4
+#endif
+
+//
+//  The styles.
+//
+void ToggleBitfield(unsigned short pulses)
+{
+    for (unsigned short count = 0; count < pulses; count++)
+    {
+        PD_ODR_ODR4 = 1;
+        PD_ODR_ODR4 = 0;
+    }
+}
+
+void ToggleBitfieldNot(unsigned short pulses)
+{
+    for (unsigned short count = 0; count < pulses; count++)
+    {
+        PD_ODR_ODR4 = !PD_ODR_ODR4;
+        PD_ODR_ODR4 = !PD_ODR_ODR4;
+    }
+}
+
+void TogglePortXor(unsigned short pulses)
+{
+    for (unsigned short count = 0; count < pulses; count++)
+    {
+        PD_ODR ^= 0x10;
+        PD_ODR ^= 0x10;
+    }
+}
+
+void TogglePortWrite(unsigned short pulses)
+{
+    for (unsigned short count = 0; count < pulses; count++)
+    {
+        PD_ODR = 0x10;
+        PD_ODR = 0;
+    }
+}
+
+void ToggleBsetBres(unsigned short pulses)
+{
+    for (unsigned short count = 0; count < pulses; count++)
+    {
+        PIN_BSET();
+        PIN_BRES();
+    }
+}
+
+void ToggleBcpl(unsigned short pulses)
+{
+    for (unsigned short count = 0; count < pulses; count++)
+    {
+        PIN_BCPL();
+        PIN_BCPL();
+    }
+}
+
+void ToggleBitfieldUnrolled(unsigned short pulses)
+{
+    for (unsigned short count = 0; count < pulses; count += 8)
+    {
+        PD_ODR_ODR4 = 1; PD_ODR_ODR4 = 0;
+        PD_ODR_ODR4 = 1; PD_ODR_ODR4 = 0;
+        PD_ODR_ODR4 = 1; PD_ODR_ODR4 = 0;
+        PD_ODR_ODR4 = 1; PD_ODR_ODR4 = 0;
+        PD_ODR_ODR4 = 1; PD_ODR_ODR4 = 0;
+        PD_ODR_ODR4 = 1; PD_ODR_ODR4 = 0;
+        PD_ODR_ODR4 = 1; PD_ODR_ODR4 = 0;
+        PD_ODR_ODR4 = 1; PD_ODR_ODR4 = 0;
+    }
+}
+
+void ToggleBsetBresUnrolled(unsigned short pulses)
+{
+    for (unsigned short count = 0; count < pulses; count += 8)
+    {
+        PIN_BSET(); PIN_BRES();
+        PIN_BSET(); PIN_BRES();
+        PIN_BSET(); PIN_BRES();
+        PIN_BSET(); PIN_BRES();
+        PIN_BSET(); PIN_BRES();
+        PIN_BSET(); PIN_BRES();
+        PIN_BSET(); PIN_BRES();
+        PIN_BSET(); PIN_BRES();
+    }
+}
+
+//
+//  Current TIM1 count, reading the high byte latches the low byte.
+//
+unsigned short CycleCount()
+{
+    unsigned char high = TIM1_CNTRH;
+    return (unsigned short) ((high << 8) | TIM1_CNTRL);
+}
+
+//
+//  Time one style and print the result.
+//
+void Benchmark(const char *name, void (*toggle)(unsigned short))
+{
+    PD_ODR_ODR4 = 0;
+    __disable_interrupt();
+    unsigned short start = CycleCount();
+    toggle(PULSES);
+    unsigned long cycles = (unsigned short) (CycleCount() - start);
+    __enable_interrupt();
+    UARTPrintString("style=");
+    UARTPrintString(name);
+    UARTPrintChar(' ');
+    UARTPrintValue("edges", 2 * PULSES, ' ');
+    UARTPrintValue("cycles", cycles, ' ');
+    UARTPrintValue("cycles_per_edge_x100", (cycles * 100) / (2 * PULSES), ' ');
+    UARTPrintValue("square_wave_hz", (F_CPU * PULSES) / cycles, '\n');
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    PD_ODR = 0;
+    PD_DDR_DDR4 = 1;                                //  PD4 is a fast push-pull output.
+    PD_CR1_C14 = 1;
+    PD_CR2_C24 = 1;
+    TIM1_ARRH = 0xff;                               //  TIM1 free running at f_master.
+    TIM1_ARRL = 0xff;
+    TIM1_CR1_CEN = 1;
+    __enable_interrupt();
+    Benchmark("bitfield", ToggleBitfield);
+    Benchmark("bitfield_not", ToggleBitfieldNot);
+    Benchmark("port_xor", TogglePortXor);
+    Benchmark("port_write", TogglePortWrite);
+    Benchmark("bset_bres", ToggleBsetBres);
+    Benchmark("bcpl", ToggleBcpl);
+    Benchmark("bitfield_unrolled", ToggleBitfieldUnrolled);
+    Benchmark("bset_bres_unrolled", ToggleBsetBresUnrolled);
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
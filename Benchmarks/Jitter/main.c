@@ -0,0 +1,158 @@
+//
+//  Benchmark for the jitter measurement (Common/Jitter.h), comparing an
+//  output toggled from an interrupt with one toggled by a timer compare.
+//
+//  TIM2 has a 2000 cycle period and PD4 (TIM2 channel 1) toggles once a
+//  period, so its rising edges should be 4000 cycles apart.  PD4 is wired
+//  to TIM1 channel 3 (on the host: --connect PD4=PC3) and three runs of
+//  EDGES or more edges are measured:
+//
+//      output=software load=0 edges=... expected=4000 deviation_min=0 deviation_max=0 histogram=...
+//      output=software load=1 edges=... expected=4000 deviation_min=... deviation_max=... histogram=...
+//      output=hardware load=1 edges=... expected=4000 deviation_min=0 deviation_max=0 histogram=...
+//
+//  software is PD4 toggled by the TIM2 update interrupt (as chapter 05)
+//  and hardware is TIM2 channel 1 in toggle on match mode.  With load=1
+//  TIM4 interrupts every 3056 cycles and its service routine takes a
+//  while, an update interrupt which arrives during it waits for it to
+//  finish.  The histogram bins are described in Common/Jitter.h.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM2 | CLOCK_TIM4 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/Jitter.h"
+
+//
+//  Output period, edges in each run and the work in the load interrupt
+//  (register reads).
+//
+#define PERIOD                  2000
+#define EDGES                   200
+#define LOAD_READS              40
+
+//--------------------------------------------------------------------------------
+//
+//  TIM2 update, the software toggled output.
+//
+#pragma vector = TIM2_OVR_UIF_vector
+__interrupt void TIM2_UPD_OVF_IRQHandler(void)
+{
+    PD_ODR_ODR4 = !PD_ODR_ODR4;
+    TIM2_SR1_UIF = 0;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  TIM4 update, the interrupt load.
+//
+#pragma vector = TIM4_OVR_UIF_vector
+__interrupt void TIM4_UPD_OVF_IRQHandler(void)
+{
+    for (unsigned char index = 0; index < LOAD_READS; index++)
+    {
+        (void) TIM4_CNTR;
+    }
+    TIM4_SR_UIF = 0;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Start TIM2 toggling PD4, from the update interrupt or from channel 1.
+//
+void StartOutput(unsigned char hardware)
+{
+    TIM2_CR1 = 0;
+    TIM2_IER = 0;
+    TIM2_CCER1 = 0;
+    PD_ODR_ODR4 = 0;
+    TIM2_PSCR = 0;
+    TIM2_ARRH = (unsigned char) ((PERIOD - 1) >> 8);
+    TIM2_ARRL = (unsigned char) (PERIOD - 1);
+    if (hardware)
+    {
+        TIM2_CCMR1 = 0x30;              //  OC1M = 011, toggle on match.
+        TIM2_CCR1H = 0;
+        TIM2_CCR1L = 0;
+        TIM2_CCER1_CC1E = 1;
+    }
+    else
+    {
+        TIM2_IER_UIE = 1;
+    }
+    TIM2_EGR_UG = 1;
+    TIM2_SR1 = 0;
+    TIM2_CR1_CEN = 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Turn the load on or off.
+//
+void SetLoad(unsigned char on)
+{
+    TIM4_CR1 = 0;
+    TIM4_PSCR = 4;                      //  f_master / 16.
+    TIM4_ARR = 190;                     //  191 x 16 = 3056 cycles.
+    TIM4_IER_UIE = on;
+    TIM4_CR1_CEN = on;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Measure EDGES edges and print the result.
+//
+void Measure(const char *output, unsigned char hardware, unsigned char load)
+{
+    StartOutput(hardware);
+    SetLoad(load);
+    JitterReset();
+    __disable_interrupt();
+    while (_jitterEdges < EDGES)
+    {
+        __wait_for_interrupt();
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+    UARTPrintString("output=");
+    UARTPrintString(output);
+    UARTPrintValue(" load", load, ' ');
+    JitterReport();
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    PD_DDR_DDR4 = 1;
+    PD_CR1_C14 = 1;
+    JitterInitialise(2UL * PERIOD);
+    __enable_interrupt();
+    Measure("software", 0, 0);
+    Measure("software", 0, 1);
+    Measure("hardware", 1, 1);
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
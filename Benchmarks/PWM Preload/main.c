@@ -0,0 +1,113 @@
+//
+//  Verification of the glitch free PWM updates in Common/Pwm.h.
+//
+//  TIM1 channels 1 to 4 and TIM2 channels 1 to 3 run with a 512 count
+//  (32 us) period.  Every channel is changed together CHANGES times,
+//  stepping through four duties chosen so that both bytes of the compare
+//  registers change each time:
+//
+//      255 (0x00ff), 256 (0x0100), 510 (0x01fe), 1 (0x0001)
+//
+//  The changes are spaced by a varying number of timer reads so that they
+//  land at every point in the period.  Run on the host with the update
+//  events of both timers recorded:
+//
+//      --timer-updates 1 --timer-updates 2
+//
+//  The report lists every set of shadow registers loaded by an update
+//  event.  Each must have the same duty on every channel and be one of
+//  the four above (or 0 from the start), any other set is a period which
+//  mixed old and new values.  Define PWM_PRELOAD_DIRECT to write the
+//  preload registers without PwmTimerxBegin / End (the
+//  benchmark_pwm_preload_direct build) and see the mixed periods.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM2 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/Pwm.h"
+
+//
+//  Number of changes, the period and the duties stepped through.
+//
+#define CHANGES                 2000
+#define PERIOD                  512
+const unsigned short _duties[] = { 0x00ff, 0x0100, 0x01fe, 0x0001 };
+
+//
+//  Pseudo random spacing between the changes, 0 to 63 timer reads.
+//
+unsigned char _random = 0x5a;
+
+unsigned char NextGap()
+{
+    _random = (unsigned char) ((_random >> 1) ^ ((_random & 1) ? 0xb8 : 0));
+    return (unsigned char) (_random & 0x3f);
+}
+
+//
+//  Write one duty to every channel of both timers.
+//
+void SetAll(unsigned short duty)
+{
+#if !defined(PWM_PRELOAD_DIRECT)
+    PwmTimer1Begin();
+    PwmTimer2Begin();
+#endif
+    for (unsigned char channel = 1; channel <= 4; channel++)
+    {
+        PwmTimer1Duty(channel, duty);
+    }
+    for (unsigned char channel = 1; channel <= 3; channel++)
+    {
+        PwmTimer2Duty(channel, duty);
+    }
+#if !defined(PWM_PRELOAD_DIRECT)
+    PwmTimer1End();
+    PwmTimer2End();
+#endif
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    PwmTimer1Initialise(0, PERIOD, PWM_CHANNEL(1) | PWM_CHANNEL(2) | PWM_CHANNEL(3) | PWM_CHANNEL(4));
+    PwmTimer2Initialise(0, PERIOD, PWM_CHANNEL(1) | PWM_CHANNEL(2) | PWM_CHANNEL(3));
+    for (unsigned short change = 0; change < CHANGES; change++)
+    {
+        SetAll(_duties[change & 3]);
+        for (unsigned char gap = NextGap(); gap > 0; gap--)
+        {
+            (void) TIM1_CNTRL;
+        }
+    }
+#if defined(PWM_PRELOAD_DIRECT)
+    UARTPrintString("mode=direct");
+#else
+    UARTPrintString("mode=grouped");
+#endif
+    UARTPrintValue(" changes", CHANGES, '\n');
+    UARTPrintFlush();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
@@ -0,0 +1,221 @@
+//
+//  Benchmark for the port interrupt dispatcher (Common/PinInterrupts.h).
+//
+//  Five outputs are wired to the port C inputs which share one interrupt
+//  vector:
+//
+//      PA1 -> PC3, PA2 -> PC4, PA3 -> PC5, PD2 -> PC6, PD3 -> PC7
+//
+//  (on the host: --connect PA1=PC3 --connect PA2=PC4 --connect PA3=PC5
+//  --connect PD2=PC6 --connect PD3=PC7).  Each pin has its own handler
+//  which records the time from the write to the outputs to the handler
+//  being called, measured with TIM1 counting at f_master.  1, 3 and then
+//  5 pins are changed together and one line is printed for each:
+//
+//      pins=3 edges=192 handled=192 latency_min=... latency_max=... dispatch_latency_max=... dispatch_max=... missed=0
+//
+//  latency_xxx covers the interrupt entry as well as the dispatch,
+//  dispatch_latency_max is the longest from the start of the dispatch to
+//  a handler being called and dispatch_max the longest dispatch.  With 5
+//  pins the port D pins are written just after the port A pins, both with
+//  interrupts disabled so that one dispatch sees every change.
+//
+//  The cycle counts are only meaningful on the microcontroller or the
+//  instruction set simulator (stm8iss), the host build only charges for
+//  register accesses and interrupt entry.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+
+unsigned short CycleCount();
+#define PIN_INTERRUPTS_MEASURE
+#define PIN_INTERRUPTS_TIMESTAMP()  CycleCount()
+#include "../../Common/PinInterrupts.h"
+
+//
+//  Number of times the outputs are changed for each number of pins, half
+//  rising and half falling.
+//
+#define CHANGES                 64
+
+//
+//  Outputs changed for 1, 3 and 5 pins.
+//
+typedef struct
+{
+    unsigned char pins;
+    unsigned char portA;
+    unsigned char portD;
+} Round;
+
+const Round _rounds[] =
+{
+    { 1, 0x02, 0x00 },
+    { 3, 0x0e, 0x00 },
+    { 5, 0x0e, 0x0c }
+};
+#define NUMBER_OF_ROUNDS        (sizeof(_rounds) / sizeof(_rounds[0]))
+
+PinInterrupts _portC;
+
+//
+//  Time the outputs were last written and the handler results.
+//
+unsigned short _edgeTime;
+volatile unsigned short _handled;
+unsigned short _latencyMinimum;
+unsigned short _latencyMaximum;
+
+//
+//  Current TIM1 count, reading the high byte latches the low byte.
+//
+unsigned short CycleCount()
+{
+    unsigned char high = TIM1_CNTRH;
+    return (unsigned short) ((high << 8) | TIM1_CNTRL);
+}
+
+//
+//  Port C interrupt, all the inputs share it.
+//
+#pragma vector = 7
+__interrupt void EXTI_PORTC_IRQHandler(void)
+{
+    PinInterruptsDispatch(&_portC, PC_IDR);
+}
+
+//
+//  Handler for every input, record the time since the outputs changed.
+//
+void InputChanged(unsigned char pin, unsigned char level)
+{
+    (void) pin;
+    (void) level;
+    unsigned short latency = (unsigned short) (CycleCount() - _edgeTime);
+    if (latency < _latencyMinimum)
+    {
+        _latencyMinimum = latency;
+    }
+    if (latency > _latencyMaximum)
+    {
+        _latencyMaximum = latency;
+    }
+    _handled++;
+}
+
+//
+//  TIM1 free running at f_master.
+//
+void InitialiseCycleCounter()
+{
+    TIM1_PSCRH = 0;
+    TIM1_PSCRL = 0;
+    TIM1_ARRH = 0xff;
+    TIM1_ARRL = 0xff;
+    TIM1_EGR_UG = 1;
+    TIM1_CR1_CEN = 1;
+}
+
+//
+//  PA1-3 and PD2-3 are outputs, PC3-7 inputs interrupting on both edges.
+//
+void InitialisePorts()
+{
+    PA_ODR = 0;
+    PA_DDR = 0x0e;
+    PA_CR1 = 0x0e;
+    PD_ODR_ODR2 = 0;
+    PD_ODR_ODR3 = 0;
+    PD_DDR_DDR2 = 1;
+    PD_DDR_DDR3 = 1;
+    PD_CR1_C12 = 1;
+    PD_CR1_C13 = 1;
+    PC_DDR = 0;
+    PC_CR1 = 0;
+    PC_CR2 = 0xf8;
+    EXTI_CR1_PCIS = 3;
+    PinInterruptsInitialise(&_portC, PC_IDR);
+    for (unsigned char pin = 3; pin <= 7; pin++)
+    {
+        PinInterruptsAttach(&_portC, pin, PIN_BOTH_EDGES, InputChanged);
+    }
+}
+
+//
+//  Change the outputs of a round CHANGES times and wait for the handlers
+//  each time.
+//
+void Benchmark(const Round *round)
+{
+    _latencyMinimum = 0xffff;
+    _latencyMaximum = 0;
+    _handled = 0;
+    _portC.missed = 0;
+    _portC.longestLatency = 0;
+    _portC.longestDispatch = 0;
+    unsigned short expected = 0;
+    for (unsigned char change = 0; change < CHANGES; change++)
+    {
+        unsigned char level = (change & 1) ? 0 : 1;
+        expected += round->pins;
+        __disable_interrupt();
+        _edgeTime = CycleCount();
+        PA_ODR = level ? round->portA : 0;
+        if (round->portD != 0)
+        {
+            PD_ODR = level ? round->portD : 0;
+        }
+        while (_handled < expected)
+        {
+            __wait_for_interrupt();
+            __disable_interrupt();
+        }
+        __enable_interrupt();
+    }
+    UARTPrintValue("pins", round->pins, ' ');
+    UARTPrintValue("edges", (unsigned long) round->pins * CHANGES, ' ');
+    UARTPrintValue("handled", _handled, ' ');
+    UARTPrintValue("latency_min", _latencyMinimum, ' ');
+    UARTPrintValue("latency_max", _latencyMaximum, ' ');
+    UARTPrintValue("dispatch_latency_max", _portC.longestLatency, ' ');
+    UARTPrintValue("dispatch_max", _portC.longestDispatch, ' ');
+    UARTPrintValue("missed", _portC.missed, '\n');
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    InitialiseCycleCounter();
+    InitialisePorts();
+    __enable_interrupt();
+    for (unsigned char index = 0; index < NUMBER_OF_ROUNDS; index++)
+    {
+        Benchmark(&_rounds[index]);
+    }
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
@@ -0,0 +1,227 @@
+//
+//  Benchmark for the pulse sequence player (Common/PulseSequence.h).
+//
+//  The chapter 17 sequence (seven marks and spaces) after a 9 ms mark and
+//  4.5 ms space leader as used by NEC remote controls is written to data
+//  EEPROM and played from there on TIM1 channel 3 (PC3), which is wired
+//  to PD4 (on the host: --connect PC3=PD4).  TIM2 counts microseconds and
+//  captures the rising (channel 1) and falling (channel 2) edges on PD4.
+//  The sequence is played twice, with steady marks and with marks on a
+//  26 us (38.5 kHz) carrier, and one line is printed for each:
+//
+//      carrier=0 entries=9 edges=10 max_error_us=0 updates=9
+//      carrier=26 pulses=468 expected=468 period_us=26..26 updates=10
+//
+//  max_error_us is the largest difference between the length of a mark or
+//  space and the length in EEPROM, pulses the carrier cycles seen against
+//  the cycles the marks round to and period_us the shortest and longest
+//  carrier period.  updates is the number of update interrupts for the
+//  sequence, one for each entry plus one for each further 256 carrier
+//  cycles in a mark (the 346 cycle leader takes two).
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM2 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/PulseSequence.h"
+
+//
+//  Where the sequence is stored, the host simulation supplies its own base
+//  address.
+//
+#if !defined(EEPROM_BASE_ADDRESS)
+    #define EEPROM_BASE_ADDRESS     0x4000
+#endif
+#define EEPROM_DATA_START           (EEPROM_BASE_ADDRESS + 0x0040)
+
+//
+//  A leader longer than 256 carrier cycles and the chapter 17 sequence.
+//
+const unsigned short _pulseLength[] = { 9000U, 4500U, 2000U, 27830U, 400U, 1580U, 400U, 3580U, 400U };
+const unsigned char _onOrOff[] =      {   1,     0,     1,      0,     1,     0,    1,     0,    1 };
+#define NUMBER_OF_ENTRIES       9
+#define CARRIER_PERIOD          26
+#define CARRIER_HIGH            9
+
+//
+//  Edges captured in the current run.
+//
+#define MAXIMUM_EDGES           16
+
+volatile unsigned short _edgeTime[MAXIMUM_EDGES];
+volatile unsigned char _numberOfEdges;
+volatile unsigned short _pulses;
+volatile unsigned short _lastRise;
+volatile unsigned short _periodMinimum;
+volatile unsigned short _periodMaximum;
+
+//
+//  TIM2 capture, rising edges on channel 1 and falling edges on channel 2.
+//
+#pragma vector = TIM2_CAPCOM_CC1IF_vector
+__interrupt void TIM2_CAPCOM_IRQHandler(void)
+{
+    if (TIM2_SR1_CC1IF)
+    {
+        TIM2_SR1_CC1IF = 0;
+        unsigned char high = TIM2_CCR1H;
+        unsigned short time = (unsigned short) ((high << 8) | TIM2_CCR1L);
+        if (_pulses != 0)
+        {
+            unsigned short period = (unsigned short) (time - _lastRise);
+            if (period < 2 * CARRIER_PERIOD)
+            {
+                if (period < _periodMinimum)
+                {
+                    _periodMinimum = period;
+                }
+                if (period > _periodMaximum)
+                {
+                    _periodMaximum = period;
+                }
+            }
+        }
+        _lastRise = time;
+        _pulses++;
+        if (_numberOfEdges < MAXIMUM_EDGES)
+        {
+            _edgeTime[_numberOfEdges++] = time;
+        }
+    }
+    if (TIM2_SR1_CC2IF)
+    {
+        TIM2_SR1_CC2IF = 0;
+        unsigned char high = TIM2_CCR2H;
+        unsigned short time = (unsigned short) ((high << 8) | TIM2_CCR2L);
+        if (_numberOfEdges < MAXIMUM_EDGES)
+        {
+            _edgeTime[_numberOfEdges++] = time;
+        }
+    }
+}
+
+//
+//  Write the sequence to EEPROM in the chapter 17 layout.
+//
+void WriteSequence()
+{
+    if (FLASH_IAPSR_DUL == 0)
+    {
+        FLASH_DUKR = 0xae;
+        FLASH_DUKR = 0x56;
+    }
+    unsigned char *address = (unsigned char *) EEPROM_DATA_START;
+    *address++ = NUMBER_OF_ENTRIES;
+    for (unsigned char index = 0; index < NUMBER_OF_ENTRIES; index++)
+    {
+        *address++ = (unsigned char) (_pulseLength[index] >> 8);
+        *address++ = (unsigned char) _pulseLength[index];
+        *address++ = _onOrOff[index];
+    }
+    FLASH_IAPSR_DUL = 0;
+}
+
+//
+//  Play the sequence from EEPROM and wait for it to finish.
+//
+void Play(unsigned char carrierPeriod)
+{
+    __disable_interrupt();
+    _numberOfEdges = 0;
+    _pulses = 0;
+    _periodMinimum = 0xffff;
+    _periodMaximum = 0;
+    _pulseSequenceUpdates = 0;
+    __enable_interrupt();
+    PulseSequenceInitialise(3, carrierPeriod, CARRIER_HIGH);
+    const unsigned char *sequence = (const unsigned char *) EEPROM_DATA_START;
+    PulseSequencePlay(sequence + 1, sequence[0]);
+    __disable_interrupt();
+    while (PulseSequencePlaying())
+    {
+        __wait_for_interrupt();
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    WriteSequence();
+    TIM2_PSCR = CLOCK_LOG2(F_MASTER / 1000000UL);
+    TIM2_ARRH = 0xff;
+    TIM2_ARRL = 0xff;
+    TIM2_EGR_UG = 1;
+    TIM2_CCMR1 = 0x01;                  //  CC1 captures TI1 (PD4).
+    TIM2_CCMR2 = 0x02;                  //  CC2 captures TI1 as well.
+    TIM2_CCER1 = 0x31;                  //  CC1 rising, CC2 falling.
+    TIM2_IER_CC1IE = 1;
+    TIM2_IER_CC2IE = 1;
+    TIM2_CR1_CEN = 1;
+    __enable_interrupt();
+    //
+    //  Steady marks, every edge is an entry boundary.
+    //
+    Play(0);
+    unsigned short maximumError = 0;
+    for (unsigned char index = 1; index < _numberOfEdges; index++)
+    {
+        unsigned short length = (unsigned short) (_edgeTime[index] - _edgeTime[index - 1]);
+        unsigned short expected = _pulseLength[index - 1];
+        unsigned short error = (length > expected) ? (unsigned short) (length - expected) : (unsigned short) (expected - length);
+        if (error > maximumError)
+        {
+            maximumError = error;
+        }
+    }
+    UARTPrintValue("carrier", 0, ' ');
+    UARTPrintValue("entries", NUMBER_OF_ENTRIES, ' ');
+    UARTPrintValue("edges", _numberOfEdges, ' ');
+    UARTPrintValue("max_error_us", maximumError, ' ');
+    UARTPrintValue("updates", _pulseSequenceUpdates, '\n');
+    //
+    //  Marks on the carrier.
+    //
+    Play(CARRIER_PERIOD);
+    unsigned short expected = 0;
+    for (unsigned char index = 0; index < NUMBER_OF_ENTRIES; index++)
+    {
+        if (_onOrOff[index])
+        {
+            expected += (_pulseLength[index] + (CARRIER_PERIOD / 2)) / CARRIER_PERIOD;
+        }
+    }
+    UARTPrintValue("carrier", CARRIER_PERIOD, ' ');
+    UARTPrintValue("pulses", _pulses, ' ');
+    UARTPrintValue("expected", expected, ' ');
+    UARTPrintString("period_us=");
+    UARTPrintUnsigned(_periodMinimum);
+    UARTPrintString("..");
+    UARTPrintUnsigned(_periodMaximum);
+    UARTPrintValue(" updates", _pulseSequenceUpdates, '\n');
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
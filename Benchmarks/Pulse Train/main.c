@@ -0,0 +1,254 @@
+//
+//  Benchmark for the TIM1 pulse trains (Common/PulseTrain.h).
+//
+//  TIM1 channel 4 (PC4) is wired to PD4 and the trigger output PD2 to the
+//  TIM1 channel 1 input (PC1 on the STM8S105, PC6 with the AFR0 remap on
+//  the STM8S103).  The host simulation has no trigger mode and starts the
+//  train from the port D interrupt instead, so there PD2 is wired to PD3
+//  (--connect PC4=PD4 --connect PD2=PD3).  Two trains are sent, the first
+//  started from the main program and the second armed and started by a
+//  falling edge from PD2.  Every edge of the train is captured
+//  on PD4 by TIM2 counting at f_master (channel 1 the rising edges and
+//  channel 2 the falling edges), one line is printed for each train:
+//
+//      start=software pulses=8 width=64..64 period=160..160 first_edge=... end_interrupts=1
+//      start=edge pulses=4 width=32..32 period=100..100 first_edge=... end_interrupts=1
+//
+//  width and period are the shortest and longest seen in cycles, the
+//  difference between the two is the jitter.  first_edge is the time from
+//  the start (or the write to PD2) to the first rising edge, period - width
+//  counts plus the start latency: the input synchronisation in trigger mode
+//  or the port interrupt on the host.  end_interrupts is the number of TIM1
+//  interrupts in the train, the generator takes no CPU time between its
+//  start and its end.  Run with --watch PC4 to see the output times.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM2 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/PinInterrupts.h"
+#include "../../Common/PulseTrain.h"
+
+//
+//  Edges recorded in the current train.
+//
+#define MAXIMUM_EDGES           32
+
+volatile unsigned short _edgeTime[MAXIMUM_EDGES];
+volatile unsigned char _edgeLevel[MAXIMUM_EDGES];
+volatile unsigned char _numberOfEdges;
+volatile unsigned char _endInterrupts;
+
+PinInterrupts _portD;
+
+//
+//  Current TIM2 count, reading the high byte latches the low byte.
+//
+unsigned short CycleCount()
+{
+    unsigned char high = TIM2_CNTRH;
+    return (unsigned short) ((high << 8) | TIM2_CNTRL);
+}
+
+//
+//  Record one captured edge.
+//
+void RecordEdge(unsigned char high, unsigned char low, unsigned char level)
+{
+    if (_numberOfEdges < MAXIMUM_EDGES)
+    {
+        _edgeTime[_numberOfEdges] = (unsigned short) ((high << 8) | low);
+        _edgeLevel[_numberOfEdges] = level;
+        _numberOfEdges++;
+    }
+}
+
+//
+//  TIM2 capture, an edge of the train on PD4.
+//
+#pragma vector = TIM2_CAPCOM_CC1IF_vector
+__interrupt void TIM2_CAPCOM_IRQHandler(void)
+{
+    if (TIM2_SR1_CC1IF)
+    {
+        TIM2_SR1_CC1IF = 0;
+        RecordEdge(TIM2_CCR1H, TIM2_CCR1L, 1);
+    }
+    if (TIM2_SR1_CC2IF)
+    {
+        TIM2_SR1_CC2IF = 0;
+        RecordEdge(TIM2_CCR2H, TIM2_CCR2L, 0);
+    }
+}
+
+#if defined(STM8S_HOST_H)
+//
+//  Port D interrupt, the trigger on PD3 standing in for TI1 on the host.
+//
+#pragma vector = 8
+__interrupt void EXTI_PORTD_IRQHandler(void)
+{
+    PinInterruptsDispatch(&_portD, PD_IDR);
+}
+#endif
+
+//
+//  End of a train.
+//
+#pragma vector = TIM1_OVR_UIF_vector
+__interrupt void TIM1_UPD_OVF_IRQHandler(void)
+{
+    TIM1_SR1_UIF = 0;
+    _endInterrupts++;
+}
+
+//
+//  Wait for the train to finish.
+//
+void WaitForTrain()
+{
+    __disable_interrupt();
+    while (_endInterrupts == 0)
+    {
+        __wait_for_interrupt();
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+}
+
+//
+//  Print the pulses recorded.
+//
+void Report(char *name, unsigned short start)
+{
+    unsigned short pulses = 0;
+    unsigned short widthMinimum = 0xffff, widthMaximum = 0;
+    unsigned short periodMinimum = 0xffff, periodMaximum = 0;
+    unsigned short firstEdge = 0;
+    unsigned short lastRise = 0;
+    for (unsigned char index = 0; index < _numberOfEdges; index++)
+    {
+        unsigned short time = _edgeTime[index];
+        if (_edgeLevel[index])
+        {
+            if (pulses == 0)
+            {
+                firstEdge = (unsigned short) (time - start);
+            }
+            else
+            {
+                unsigned short period = (unsigned short) (time - lastRise);
+                if (period < periodMinimum)
+                {
+                    periodMinimum = period;
+                }
+                if (period > periodMaximum)
+                {
+                    periodMaximum = period;
+                }
+            }
+            lastRise = time;
+            pulses++;
+        }
+        else if (pulses != 0)
+        {
+            unsigned short width = (unsigned short) (time - lastRise);
+            if (width < widthMinimum)
+            {
+                widthMinimum = width;
+            }
+            if (width > widthMaximum)
+            {
+                widthMaximum = width;
+            }
+        }
+    }
+    UARTPrintString("start=");
+    UARTPrintString(name);
+    UARTPrintValue(" pulses", pulses, ' ');
+    UARTPrintString("width=");
+    UARTPrintUnsigned(widthMinimum);
+    UARTPrintString("..");
+    UARTPrintUnsigned(widthMaximum);
+    UARTPrintString(" period=");
+    UARTPrintUnsigned(periodMinimum);
+    UARTPrintString("..");
+    UARTPrintUnsigned(periodMaximum);
+    UARTPrintValue(" first_edge", firstEdge, ' ');
+    UARTPrintValue("end_interrupts", _endInterrupts, '\n');
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    TIM2_PSCR = 0;                      //  Free running at f_master.
+    TIM2_ARRH = 0xff;
+    TIM2_ARRL = 0xff;
+    TIM2_EGR_UG = 1;
+    TIM2_CCMR1 = 0x01;                  //  CC1 captures TI1 (PD4).
+    TIM2_CCMR2 = 0x02;                  //  CC2 captures TI1 as well.
+    TIM2_CCER1 = 0x31;                  //  CC1 rising, CC2 falling.
+    TIM2_IER_CC1IE = 1;
+    TIM2_IER_CC2IE = 1;
+    TIM2_CR1_CEN = 1;
+    //
+    //  PD2 drives the trigger on PD3.
+    //
+    PD_ODR_ODR2 = 1;
+    PD_DDR_DDR2 = 1;
+    PD_CR1_C12 = 1;
+#if defined(STM8S_HOST_H)
+    PD_CR1_C13 = 1;
+    PinInterruptsInitialise(&_portD, PD_IDR);
+    PinInterruptsAttach(&_portD, 3, PIN_FALLING_EDGE, PulseTrainEdge);
+    PD_CR2_C23 = 1;
+    EXTI_CR1_PDIS = 3;
+#endif
+    PulseTrainInitialise(0, 4);
+    TIM1_IER_UIE = 1;
+    __enable_interrupt();
+    //
+    //  Eight 4 us pulses every 10 us from the main program.
+    //
+    unsigned short start = CycleCount();
+    PulseTrainStart(8, 64, 160);
+    WaitForTrain();
+    Report("software", start);
+    //
+    //  Four 2 us pulses every 6.25 us from the edge.
+    //
+    __disable_interrupt();
+    _numberOfEdges = 0;
+    _endInterrupts = 0;
+    __enable_interrupt();
+    PulseTrainArmOnEdge(4, 32, 100, 1);
+    start = CycleCount();
+    PD_ODR_ODR2 = 0;
+    WaitForTrain();
+    PulseTrainDisarm();
+    Report("edge", start);
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
@@ -0,0 +1,467 @@
+//
+//  Comparison of the register templates (Common/Register.h) with the bit
+//  field macros of the device headers.
+//
+//  The set up functions of chapters 5 to 9 are written twice, once as in
+//  the chapter and once with the templates, merging the writes to fields
+//  of the same register.  Each pair is run from the same reset state,
+//  timed with TIM4 counting at f_master and the registers the chapter
+//  configures compared afterwards.  One line is printed for each pair:
+//
+//      setup=07_timer1 macro_cycles=... template_cycles=... registers=12 match=1
+//
+//  match=1 shows both versions leave every register with the same value.
+//  On the host the cycles are the number of register accesses as only
+//  these take time.  Build for the microcontroller (this is C++, compile
+//  with --ec++ or equivalent) and run under stm8iss to compare real cycles
+//  and code size:
+//
+//      stm8iss --profile profile.csv registers.out
+//
+//  which lists the bytes in each function, Chapter05Timer2Macros against
+//  Chapter05Timer2Templates and so on.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM2 | CLOCK_TIM4 | CLOCK_ADC | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/RegisterMap.h"
+
+//
+//  Chapter 5 timer settings.
+//
+#define TIMER2_PRESCALER        0x03                    //  Prescaler = 8.
+#define TIMER2_RELOAD           (F_MASTER / 8 / 40)
+
+//
+//  Largest number of registers compared after a set up function.
+//
+#define MAXIMUM_REGISTERS       16
+
+//--------------------------------------------------------------------------------
+//
+//  Chapter 5 (and chapter 7 part 1), PD4 output and the TIM2 update
+//  interrupt.
+//
+void Chapter05PortsMacros()
+{
+    PD_ODR = 0;
+    PD_DDR_DDR4 = 1;
+    PD_CR1_C14 = 1;
+    PD_CR2_C24 = 1;
+}
+
+void Chapter05PortsTemplates()
+{
+    PD::ODR::Write(0);
+    PD::DDR::Pin<4>::Set<1>();
+    PD::CR1::Pin<4>::Set<1>();
+    PD::CR2::Pin<4>::Set<1>();
+}
+
+void Chapter05Timer2Macros()
+{
+    TIM2_PSCR = TIMER2_PRESCALER;
+    TIM2_ARRH = (unsigned char) (TIMER2_RELOAD >> 8);
+    TIM2_ARRL = (unsigned char) (TIMER2_RELOAD & 0xff);
+    TIM2_IER_UIE = 1;
+    TIM2_CR1_CEN = 1;
+}
+
+void Chapter05Timer2Templates()
+{
+    TIM2::PSCR::Write(TIMER2_PRESCALER);
+    TIM2::ARR::Write(TIMER2_RELOAD);
+    TIM2::IER::UIE::Set<1>();
+    TIM2::CR1::CEN::Set<1>();
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Chapter 6, PWM on TIM2 channel 1.
+//
+void Chapter06Timer2Macros()
+{
+    TIM2_PSCR = 0x00;
+    TIM2_ARRH = 0x10;
+    TIM2_ARRL = 0x00;
+    TIM2_CCR1H = 0x08;
+    TIM2_CCR1L = 0x00;
+    TIM2_CCER1_CC1P = 0;
+    TIM2_CCER1_CC1E = 1;
+    TIM2_CCMR1_OC1M = 6;
+    TIM2_CR1_CEN = 1;
+}
+
+void Chapter06Timer2Templates()
+{
+    TIM2::PSCR::Write(0);
+    TIM2::ARR::Write(0x1000);
+    TIM2::CCR1::Write(0x0800);
+    TIM2::CCER1::Set<TIM2::CCER1::CC1P::Is<0>, TIM2::CCER1::CC1E::Is<1> >();
+    TIM2::CCMR1::OC1M::Set<6>();
+    TIM2::CR1::CEN::Set<1>();
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Chapter 7 part 2, PWM mode 2 on TIM1 channel 4.
+//
+void Chapter07Timer1Macros()
+{
+    TIM1_ARRH = 0x03;
+    TIM1_ARRL = 0xc0;
+    TIM1_PSCRH = 0;
+    TIM1_PSCRL = 0;
+    TIM1_CR1_DIR = 0;
+    TIM1_CR1_CMS = 0;
+    TIM1_RCR = 0;
+    TIM1_CCMR4_OC4M = 7;
+    TIM1_CCER2_CC4E = 1;
+    TIM1_CCER2_CC4P = 0;
+    TIM1_CCR4H = 0x01;
+    TIM1_CCR4L = 0xe0;
+    TIM1_BKR_MOE = 1;
+    TIM1_CR1_CEN = 1;
+}
+
+void Chapter07Timer1Templates()
+{
+    TIM1::ARR::Write(960);
+    TIM1::PSCR::Write(0);
+    TIM1::CR1::Set<TIM1::CR1::DIR::Is<0>, TIM1::CR1::CMS::Is<0> >();
+    TIM1::RCR::Write(0);
+    TIM1::CCMR4::OC4M::Set<7>();
+    TIM1::CCER2::Set<TIM1::CCER2::CC4E::Is<1>, TIM1::CCER2::CC4P::Is<0> >();
+    TIM1::CCR4::Write(480);
+    TIM1::BKR::MOE::Set<1>();
+    TIM1::CR1::CEN::Set<1>();
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Chapter 8, TIM1 update interrupt.
+//
+void Chapter08Timer1Macros()
+{
+    TIM1_ARRH = 0x02;
+    TIM1_ARRL = 0x00;
+    TIM1_PSCRH = 0xf4;
+    TIM1_PSCRL = 0x24;
+    TIM1_IER_UIE = 1;
+}
+
+void Chapter08Timer1Templates()
+{
+    TIM1::ARR::Write(0x0200);
+    TIM1::PSCR::Write(0xf424);
+    TIM1::IER::UIE::Set<1>();
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Chapter 9, the ADC triggered from TIM2 with the result shown as PWM on
+//  TIM1 channel 4.  The clock gates are left to CLOCK_PERIPHERALS.
+//
+void Chapter09Timer1Macros()
+{
+    TIM1_ARRH = 0x03;
+    TIM1_ARRL = 0xff;
+    TIM1_PSCRH = 0;
+    TIM1_PSCRL = 0;
+    TIM1_CR1_DIR = 1;
+    TIM1_CR1_CMS = 0;
+    TIM1_RCR = 0;
+    TIM1_CCMR4_OC4M = 7;
+    TIM1_CCER2_CC4E = 1;
+    TIM1_CCER2_CC4P = 0;
+    TIM1_CCR4H = 0x03;
+    TIM1_CCR4L = 0xff;
+    TIM1_BKR_MOE = 1;
+    TIM1_CR1_CEN = 1;
+}
+
+void Chapter09Timer1Templates()
+{
+    TIM1::ARR::Write(0x03ff);
+    TIM1::PSCR::Write(0);
+    TIM1::CR1::Set<TIM1::CR1::DIR::Is<1>, TIM1::CR1::CMS::Is<0> >();
+    TIM1::RCR::Write(0);
+    TIM1::CCMR4::OC4M::Set<7>();
+    TIM1::CCER2::Set<TIM1::CCER2::CC4E::Is<1>, TIM1::CCER2::CC4P::Is<0> >();
+    TIM1::CCR4::Write(0x03ff);
+    TIM1::BKR::MOE::Set<1>();
+    TIM1::CR1::CEN::Set<1>();
+}
+
+void Chapter09Timer2Macros()
+{
+    TIM2_PSCR = 0x05;
+    TIM2_ARRH = 0xc3;
+    TIM2_ARRL = 0x50;
+    TIM2_IER_UIE = 1;
+    TIM2_CR1_CEN = 1;
+}
+
+void Chapter09Timer2Templates()
+{
+    TIM2::PSCR::Write(0x05);
+    TIM2::ARR::Write(50000);
+    TIM2::IER::UIE::Set<1>();
+    TIM2::CR1::CEN::Set<1>();
+}
+
+void Chapter09ADCMacros()
+{
+    ADC_CR1_ADON = 1;
+    ADC_CSR_CH = 0x04;
+    ADC_CR3_DBUF = 0;
+    ADC_CR2_ALIGN = 1;
+    ADC_CSR_EOCIE = 1;
+}
+
+//
+//  The channel is selected with the interrupt enable so that CSR is only
+//  written once.
+//
+void Chapter09ADCTemplates()
+{
+    ADC::CR1::ADON::Set<1>();
+    ADC::CR3::DBUF::Set<0>();
+    ADC::CR2::ALIGN::Set<1>();
+    ADC::CSR::Set<ADC::CSR::CH::Is<0x04>, ADC::CSR::EOCIE::Is<1> >();
+}
+
+void Chapter09PortsMacros()
+{
+    PD_ODR = 0;
+    PD_DDR_DDR5 = 1;
+    PD_CR1_C15 = 1;
+    PD_CR2_C25 = 1;
+    PD_DDR_DDR4 = 1;
+    PD_CR1_C14 = 1;
+    PD_CR2_C24 = 1;
+}
+
+void Chapter09PortsTemplates()
+{
+    PD::ODR::Write(0);
+    PD::DDR::Set<PD::DDR::Pin<5>::Is<1>, PD::DDR::Pin<4>::Is<1> >();
+    PD::CR1::Set<PD::CR1::Pin<5>::Is<1>, PD::CR1::Pin<4>::Is<1> >();
+    PD::CR2::Set<PD::CR2::Pin<5>::Is<1>, PD::CR2::Pin<4>::Is<1> >();
+}
+
+//
+//  The merged masks, checked at compile time.
+//
+static_assert(RegisterMerge<TIM1::CR1::DIR::Is<1>, TIM1::CR1::CMS::Is<0> >::mask == 0x70, "TIM1_CR1 DIR and CMS");
+static_assert(RegisterMerge<TIM1::CR1::DIR::Is<1>, TIM1::CR1::CMS::Is<0> >::value == 0x10, "TIM1_CR1 DIR and CMS");
+static_assert(RegisterMerge<ADC::CSR::CH::Is<0x04>, ADC::CSR::EOCIE::Is<1> >::mask == 0x2f, "ADC_CSR CH and EOCIE");
+static_assert(RegisterMerge<ADC::CSR::CH::Is<0x04>, ADC::CSR::EOCIE::Is<1> >::value == 0x24, "ADC_CSR CH and EOCIE");
+static_assert(RegisterMerge<PD::DDR::Pin<5>::Is<1>, PD::DDR::Pin<4>::Is<1> >::bitFields == 2, "PD_DDR pins 4 and 5");
+
+//--------------------------------------------------------------------------------
+//
+//  Registers configured by the set up functions, read with the macros so
+//  the addresses in RegisterMap.h are checked as well.
+//
+unsigned char SnapshotPorts(unsigned char *values)
+{
+    values[0] = PD_ODR;
+    values[1] = PD_DDR;
+    values[2] = PD_CR1;
+    values[3] = PD_CR2;
+    return 4;
+}
+
+unsigned char SnapshotTimer1(unsigned char *values)
+{
+    values[0] = TIM1_CR1;
+    values[1] = TIM1_IER;
+    values[2] = TIM1_CCMR4;
+    values[3] = TIM1_CCER2;
+    values[4] = TIM1_PSCRH;
+    values[5] = TIM1_PSCRL;
+    values[6] = TIM1_ARRH;
+    values[7] = TIM1_ARRL;
+    values[8] = TIM1_RCR;
+    values[9] = TIM1_CCR4H;
+    values[10] = TIM1_CCR4L;
+    values[11] = TIM1_BKR;
+    return 12;
+}
+
+unsigned char SnapshotTimer2(unsigned char *values)
+{
+    values[0] = TIM2_CR1;
+    values[1] = TIM2_IER;
+    values[2] = TIM2_CCMR1;
+    values[3] = TIM2_CCER1;
+    values[4] = TIM2_PSCR;
+    values[5] = TIM2_ARRH;
+    values[6] = TIM2_ARRL;
+    values[7] = TIM2_CCR1H;
+    values[8] = TIM2_CCR1L;
+    return 9;
+}
+
+unsigned char SnapshotADC(unsigned char *values)
+{
+    values[0] = ADC_CSR;
+    values[1] = ADC_CR1;
+    values[2] = ADC_CR2;
+    values[3] = ADC_CR3;
+    return 4;
+}
+
+//
+//  Put the registers back to a known state before each run, the timers
+//  are stopped first.
+//
+void ResetRegisters()
+{
+    TIM1_CR1 = 0;
+    TIM2_CR1 = 0;
+    PD_ODR = 0;
+    PD_DDR = 0;
+    PD_CR1 = 0;
+    PD_CR2 = 0;
+    TIM1_IER = 0;
+    TIM1_CCMR4 = 0;
+    TIM1_CCER2 = 0;
+    TIM1_PSCRH = 0;
+    TIM1_PSCRL = 0;
+    TIM1_ARRH = 0;
+    TIM1_ARRL = 0;
+    TIM1_RCR = 0;
+    TIM1_CCR4H = 0;
+    TIM1_CCR4L = 0;
+    TIM1_BKR = 0;
+    TIM2_IER = 0;
+    TIM2_CCMR1 = 0;
+    TIM2_CCER1 = 0;
+    TIM2_PSCR = 0;
+    TIM2_ARRH = 0;
+    TIM2_ARRL = 0;
+    TIM2_CCR1H = 0;
+    TIM2_CCR1L = 0;
+    ADC_CR1 = 0;
+    ADC_CSR = 0;
+    ADC_CR2 = 0;
+    ADC_CR3 = 0;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Time a set up function with TIM4 counting at f_master, the count may
+//  overflow once.  The time taken to start and read the timer is removed
+//  by subtracting the time for an empty function.
+//
+void Nothing()
+{
+}
+
+unsigned short Time(void (*setup)())
+{
+    TIM4_CR1 = 0;
+    TIM4_CNTR = 0;
+    TIM4_SR_UIF = 0;
+    TIM4_CR1_CEN = 1;
+    setup();
+    unsigned char count = TIM4_CNTR;
+    TIM4_CR1_CEN = 0;
+    return (unsigned short) ((TIM4_SR_UIF ? 256 : 0) + count);
+}
+
+//
+//  A set up function in both forms and the registers it configures.
+//
+typedef struct
+{
+    const char *name;
+    void (*macros)();
+    void (*templates)();
+    unsigned char (*snapshot)(unsigned char *values);
+} Comparison;
+
+const Comparison _comparisons[] =
+{
+    { "05_ports", Chapter05PortsMacros, Chapter05PortsTemplates, SnapshotPorts },
+    { "05_timer2", Chapter05Timer2Macros, Chapter05Timer2Templates, SnapshotTimer2 },
+    { "06_timer2", Chapter06Timer2Macros, Chapter06Timer2Templates, SnapshotTimer2 },
+    { "07_timer1", Chapter07Timer1Macros, Chapter07Timer1Templates, SnapshotTimer1 },
+    { "08_timer1", Chapter08Timer1Macros, Chapter08Timer1Templates, SnapshotTimer1 },
+    { "09_timer1", Chapter09Timer1Macros, Chapter09Timer1Templates, SnapshotTimer1 },
+    { "09_timer2", Chapter09Timer2Macros, Chapter09Timer2Templates, SnapshotTimer2 },
+    { "09_adc", Chapter09ADCMacros, Chapter09ADCTemplates, SnapshotADC },
+    { "09_ports", Chapter09PortsMacros, Chapter09PortsTemplates, SnapshotPorts }
+};
+#define NUMBER_OF_COMPARISONS   (sizeof(_comparisons) / sizeof(_comparisons[0]))
+
+//
+//  Run both forms of a set up function and compare the results.
+//
+void Compare(const Comparison *comparison, unsigned short overhead)
+{
+    unsigned char macroValues[MAXIMUM_REGISTERS];
+    unsigned char templateValues[MAXIMUM_REGISTERS];
+
+    ResetRegisters();
+    unsigned short macroCycles = (unsigned short) (Time(comparison->macros) - overhead);
+    unsigned char registers = comparison->snapshot(macroValues);
+    ResetRegisters();
+    unsigned short templateCycles = (unsigned short) (Time(comparison->templates) - overhead);
+    comparison->snapshot(templateValues);
+    unsigned char match = 1;
+    for (unsigned char index = 0; index < registers; index++)
+    {
+        if (macroValues[index] != templateValues[index])
+        {
+            match = 0;
+        }
+    }
+    UARTPrintString("setup=");
+    UARTPrintString(comparison->name);
+    UARTPrintValue(" macro_cycles", macroCycles, ' ');
+    UARTPrintValue("template_cycles", templateCycles, ' ');
+    UARTPrintValue("registers", registers, ' ');
+    UARTPrintValue("match", match, '\n');
+}
+
+//
+//  Main program loop, interrupts stay disabled as the set up functions
+//  enable the timer interrupts.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    TIM4_PSCR = 0;
+    TIM4_ARR = 0xff;
+    TIM4_EGR_UG = 1;
+    unsigned short overhead = Time(Nothing);
+    for (unsigned char index = 0; index < NUMBER_OF_COMPARISONS; index++)
+    {
+        Compare(&_comparisons[index], overhead);
+    }
+    ResetRegisters();
+    UARTPrintFlush();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
@@ -0,0 +1,215 @@
+//
+//  Benchmark for the cooperative scheduler (Common/Scheduler.h).
+//
+//  Three tasks share the CPU for one second:
+//
+//      sampler     Priority 0, an event from TIM2 every 250 us.
+//      clock       Priority 1, an event from TIM4 every millisecond.
+//      worker      Priority 2, posted by the clock task every 100 ms and
+//                  busy for a few milliseconds each time.
+//
+//  While the worker runs the sampler events queue up in the sampler queue
+//  and are handled as soon as the worker returns, so the sampler queue
+//  depth shows the delay a long low priority handler causes.  Times are
+//  measured in microseconds with TIM1 and the results printed on the UART,
+//  one line for each task and one for the time spent waiting:
+//
+//      task=sampler runs=... run_time=... longest=... deepest=... dropped=...
+//      idle sleeps=... idle_time=... elapsed=...
+//
+//  The times are only meaningful on the microcontroller or the instruction
+//  set simulator (stm8iss), the host build only charges for register
+//  accesses.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM2 | CLOCK_TIM4 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+
+unsigned short Microseconds();
+#define SCHEDULER_MEASURE
+#define SCHEDULER_TIMESTAMP()   Microseconds()
+#define SCHEDULER_QUEUE_SIZE    16
+#include "../../Common/Scheduler.h"
+
+//
+//  Length of the run, the worker period and the work it does.
+//
+#define BENCHMARK_TICKS         1000
+#define WORKER_PERIOD           100
+#define WORKER_TOGGLES          12000
+
+//
+//  Events.
+//
+#define EVENT_SAMPLE            1
+#define EVENT_TICK              2
+#define EVENT_WORK              3
+
+Task _sampler;
+Task _clock;
+Task _worker;
+unsigned short _ticks;
+unsigned char _finished;
+
+//
+//  TIM1 count in microseconds, reading the high byte latches the low byte.
+//
+unsigned short Microseconds()
+{
+    unsigned char high = TIM1_CNTRH;
+    return (unsigned short) ((high << 8) | TIM1_CNTRL);
+}
+
+//
+//  TIM2 sample interrupt.
+//
+#pragma vector = TIM2_OVR_UIF_vector
+__interrupt void TIM2_UPD_OVF_IRQHandler()
+{
+    TIM2_SR1_UIF = 0;
+    SchedulerPost(&_sampler, EVENT_SAMPLE);
+}
+
+//
+//  TIM4 millisecond interrupt.
+//
+#pragma vector = TIM4_OVR_UIF_vector
+__interrupt void TIM4_UPD_OVF_IRQHandler()
+{
+    TIM4_SR_UIF = 0;
+    SchedulerPost(&_clock, EVENT_TICK);
+}
+
+//
+//  Sampler task, a short piece of work.
+//
+void Sample(unsigned char event)
+{
+    (void) event;
+    PD_ODR_ODR3 = !PD_ODR_ODR3;
+}
+
+//
+//  Clock task, start the worker every WORKER_PERIOD ticks and stop at the
+//  end of the run.
+//
+void Tick(unsigned char event)
+{
+    (void) event;
+    _ticks++;
+    if ((_ticks % WORKER_PERIOD) == 0)
+    {
+        SchedulerPost(&_worker, EVENT_WORK);
+    }
+    if (_ticks == BENCHMARK_TICKS)
+    {
+        _finished = 1;
+    }
+}
+
+//
+//  Worker task, a long piece of work.
+//
+void Work(unsigned char event)
+{
+    (void) event;
+    for (unsigned short count = 0; count < WORKER_TOGGLES; count++)
+    {
+        PD_ODR_ODR2 = !PD_ODR_ODR2;
+    }
+}
+
+//
+//  Print the statistics for a task.
+//
+void PrintTask(const char *name, Task *task)
+{
+    UARTPrintString("task=");
+    UARTPrintString(name);
+    UARTPrintChar(' ');
+    UARTPrintValue("runs", task->runs, ' ');
+    UARTPrintValue("run_time", task->runTime, ' ');
+    UARTPrintValue("longest", task->longestRun, ' ');
+    UARTPrintValue("deepest", task->deepest, ' ');
+    UARTPrintValue("dropped", task->dropped, '\n');
+}
+
+//
+//  TIM1 counts microseconds, TIM2 overflows every 250 us and TIM4 every
+//  millisecond.
+//
+void InitialiseTimers()
+{
+    TIM1_PSCRH = 0;
+    TIM1_PSCRL = (unsigned char) ((F_MASTER / 1000000UL) - 1);
+    TIM1_ARRH = 0xff;
+    TIM1_ARRL = 0xff;
+    TIM1_EGR_UG = 1;
+    TIM1_CR1_CEN = 1;
+    TIM2_PSCR = 0x04;                               //  Prescaler = 16, 1 MHz at 16 MHz.
+    TIM2_ARRH = 0;
+    TIM2_ARRL = (unsigned char) ((F_MASTER / 16 / 4000) - 1);
+    TIM2_EGR_UG = 1;
+    TIM2_SR1_UIF = 0;
+    TIM2_IER_UIE = 1;
+    TIM4_PSCR = 0x07;                               //  Prescaler = 128.
+    TIM4_ARR = (unsigned char) ((F_MASTER / 128 / 1000) - 1);
+    TIM4_EGR_UG = 1;
+    TIM4_SR_UIF = 0;
+    TIM4_IER_UIE = 1;
+    TIM2_CR1_CEN = 1;
+    TIM4_CR1_CEN = 1;
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    PD_DDR = 0x0c;
+    PD_CR1 = 0x0c;
+    SchedulerAddTask(&_worker, 2, Work);
+    SchedulerAddTask(&_sampler, 0, Sample);
+    SchedulerAddTask(&_clock, 1, Tick);
+    InitialiseTimers();
+    __enable_interrupt();
+    while (!_finished)
+    {
+        if (SchedulerDispatch() == 0)
+        {
+            SchedulerIdle();
+        }
+    }
+    __disable_interrupt();
+    TIM2_CR1_CEN = 0;
+    TIM4_CR1_CEN = 0;
+    PrintTask("sampler", &_sampler);
+    PrintTask("clock", &_clock);
+    PrintTask("worker", &_worker);
+    UARTPrintString("idle ");
+    UARTPrintValue("sleeps", _schedulerSleeps, ' ');
+    UARTPrintValue("idle_time", _schedulerIdleTime, ' ');
+    UARTPrintValue("elapsed", _ticks * 1000UL, '\n');
+    UARTPrintFlush();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
@@ -0,0 +1,118 @@
+//
+//  Benchmark for the software PWM (Common/SoftPwm.h).
+//
+//  Sixteen channels on ports B and C are run from TIM2 at 1 MHz with a 256
+//  count period (3.9 kHz).  The channels are first given sixteen different
+//  duties and then five duties (off, three dimmed and full on) shared by
+//  three or four channels each.  For each set the compare interrupts are
+//  counted over PERIODS periods:
+//
+//      duties=spread channels=16 edges=16 interrupts_x100=1600
+//      duties=grouped channels=16 edges=3 interrupts_x100=300
+//
+//  edges is the number of edges in the schedule and interrupts_x100 the
+//  compare interrupts per period (times 100), one for each distinct duty
+//  rather than one for each channel.  Run with --watch PB0 (or any other
+//  channel) to see the output times.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM2 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/SoftPwm.h"
+
+#define PERIOD                  256
+#define PERIODS                 64
+#define NUMBER_OF_CHANNELS      16
+
+unsigned char _channels[NUMBER_OF_CHANNELS];
+
+//
+//  Wait until the update interrupt has run count more times.
+//
+void WaitForPeriods(unsigned long count)
+{
+    __disable_interrupt();
+    unsigned long end = _softPwmPeriods + count;
+    while (_softPwmPeriods < end)
+    {
+        __wait_for_interrupt();
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+}
+
+//
+//  Play the duties set and print the compare interrupts per period.
+//
+void Measure(char *name)
+{
+    SoftPwmCommit();
+    WaitForPeriods(2);
+    __disable_interrupt();
+    unsigned long edges = _softPwmEdges;
+    __enable_interrupt();
+    WaitForPeriods(PERIODS);
+    __disable_interrupt();
+    edges = _softPwmEdges - edges;
+    __enable_interrupt();
+    UARTPrintString("duties=");
+    UARTPrintString(name);
+    UARTPrintValue(" channels", NUMBER_OF_CHANNELS, ' ');
+    UARTPrintValue("edges", _softPwmActive->numberOfEdges, ' ');
+    UARTPrintValue("interrupts_x100", (edges * 100) / PERIODS, '\n');
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    for (unsigned char pin = 0; pin < 8; pin++)
+    {
+        _channels[pin] = SoftPwmChannel(SOFT_PWM_PORT_B, pin);
+        _channels[pin + 8] = SoftPwmChannel(SOFT_PWM_PORT_C, pin);
+    }
+    SoftPwmInitialise(4, PERIOD);
+    __enable_interrupt();
+    //
+    //  Every channel on its own edge.
+    //
+    for (unsigned char index = 0; index < NUMBER_OF_CHANNELS; index++)
+    {
+        SoftPwmDuty(_channels[index], (unsigned short) ((index * 16) + 8));
+    }
+    Measure("spread");
+    //
+    //  Three or four channels on each edge, one group full on and one off
+    //  with no edge at all.
+    //
+    for (unsigned char index = 0; index < NUMBER_OF_CHANNELS; index++)
+    {
+        static const unsigned short duties[] = { 0, 32, 128, 200, 1000 };
+        SoftPwmDuty(_channels[index], duties[index % 5]);
+    }
+    Measure("grouped");
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
@@ -0,0 +1,133 @@
+//
+//  Benchmark for the tickless timer mode (Common/TicklessTimer.h).
+//
+//  Three periodic timers (50 ms, 200 ms and 1 s) run for ten seconds with
+//  the core waiting for an interrupt whenever there is nothing to do.  At
+//  the end one line of results is printed on the UART:
+//
+//      seconds=10 ticks=... interrupts=... fixed_tick_interrupts=... callbacks=... late_max=... backwards=...
+//
+//  interrupts is the number of TIM2 overflows taken and
+//  fixed_tick_interrupts the number a 1 ms periodic tick would have needed
+//  over the same time.  late_max is the most ticks (64 us by default)
+//  between a timer falling due and its callback running and backwards the
+//  number of times TicklessNow went back in time (should be 0).
+//
+//  On the host the wakeups from WFI are also shown in the simulator report
+//  and the simulated time can be compared with ticks.  The host WFI
+//  services an interrupt which is already pending, so a lost wakeup (see
+//  TicklessIdle) would not show in late_max on the host.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM2 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/TicklessTimer.h"
+
+//
+//  Length of the run.
+//
+#define BENCHMARK_SECONDS       10
+
+TicklessTimer _fast;
+TicklessTimer _medium;
+TicklessTimer _slow;
+TicklessTimer _end;
+volatile unsigned char _finished;
+
+//
+//  Results.
+//
+unsigned long _callbacks;
+unsigned long _lateMaximum;
+unsigned long _backwards;
+unsigned long _lastNow;
+
+//
+//  TIM2 overflow, the next deadline (or the end of a long period).
+//
+#pragma vector = TIM2_OVR_UIF_vector
+__interrupt void TIM2_UPD_OVF_IRQHandler()
+{
+    TicklessInterrupt();
+}
+
+//
+//  Periodic timer callback, the timer has already been restarted so it
+//  fell due one period before its expiry time.
+//
+void TimerExpired(TicklessTimer *timer)
+{
+    unsigned long now = TicklessNow();
+    unsigned long late = now - (timer->expires - timer->period);
+    if (late > _lateMaximum)
+    {
+        _lateMaximum = late;
+    }
+    if ((long) (now - _lastNow) < 0)
+    {
+        _backwards++;
+    }
+    _lastNow = now;
+    _callbacks++;
+}
+
+//
+//  One shot timer marking the end of the run.
+//
+void RunFinished(TicklessTimer *timer)
+{
+    (void) timer;
+    _finished = 1;
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    TicklessInitialise();
+    TicklessStart(&_fast, TICKLESS_MS(50), TICKLESS_MS(50), TimerExpired);
+    TicklessStart(&_medium, TICKLESS_MS(200), TICKLESS_MS(200), TimerExpired);
+    TicklessStart(&_slow, TICKLESS_MS(1000), TICKLESS_MS(1000), TimerExpired);
+    TicklessStart(&_end, TICKLESS_MS(BENCHMARK_SECONDS * 1000UL), 0, RunFinished);
+    __enable_interrupt();
+    while (!_finished)
+    {
+        TicklessRun();
+        TicklessIdle();
+    }
+    TicklessStop(&_fast);
+    TicklessStop(&_medium);
+    TicklessStop(&_slow);
+    unsigned long now = TicklessNow();
+    UARTPrintValue("seconds", BENCHMARK_SECONDS, ' ');
+    UARTPrintValue("ticks", now, ' ');
+    UARTPrintValue("interrupts", _ticklessInterrupts, ' ');
+    UARTPrintValue("fixed_tick_interrupts", BENCHMARK_SECONDS * 1000UL, ' ');
+    UARTPrintValue("callbacks", _callbacks, ' ');
+    UARTPrintValue("late_max", _lateMaximum, ' ');
+    UARTPrintValue("backwards", _backwards, '\n');
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
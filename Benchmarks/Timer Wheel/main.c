@@ -0,0 +1,195 @@
+//
+//  Benchmark for the software timer wheel (Common/TimerWheel.h).
+//
+//  TIM4 generates a 1 ms tick which drives the wheel.  For 1, 16 and 64
+//  running periodic timers the tick interrupt is timed with TIM1 counting
+//  at f_master and the results are printed on the UART, one line for each
+//  number of timers:
+//
+//      timers=16 ticks=2048 isr_min=... isr_avg=... isr_max=... moves=... most_moves=... callbacks=...
+//
+//  isr_xxx are the cycles taken by the tick interrupt from reading the
+//  start time to reading the end time, moves the number of timers expired
+//  or moved down a level of the wheel and most_moves the largest number
+//  handled in a single tick.
+//
+//  The cycle counts are only meaningful on the microcontroller or the
+//  instruction set simulator (stm8iss), the host build only charges for
+//  register accesses.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM4 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+
+#define TIMER_WHEEL_STATISTICS
+#include "../../Common/TimerWheel.h"
+
+//
+//  TIM4 counts at F_MASTER / 128 and overflows every millisecond.
+//
+#define TICK_PRESCALER          0x07                    //  Prescaler = 128.
+#define TICK_RELOAD             ((F_MASTER / 128 / 1000) - 1)
+
+#if (TICK_RELOAD > 0xff) || (TICK_RELOAD < 1)
+    #error "The tick does not fit in the 8 bit TIM4 counter."
+#endif
+
+//
+//  Number of ticks each run lasts and the largest number of timers.
+//
+#define BENCHMARK_TICKS         2048
+#define MAXIMUM_TIMERS          64
+
+SoftwareTimer _timers[MAXIMUM_TIMERS];
+volatile unsigned short _ticks;
+unsigned long _callbacks;
+
+//
+//  Tick interrupt timing.
+//
+unsigned short _isrMinimum;
+unsigned short _isrMaximum;
+unsigned long _isrTotal;
+
+//
+//  Current TIM1 count, reading the high byte latches the low byte.
+//
+unsigned short CycleCount()
+{
+    unsigned char high = TIM1_CNTRH;
+    return (unsigned short) ((high << 8) | TIM1_CNTRL);
+}
+
+//
+//  Tick interrupt, advance the wheel and record how long it took.
+//
+#pragma vector = TIM4_OVR_UIF_vector
+__interrupt void TIM4_UPD_OVF_IRQHandler()
+{
+    unsigned short start = CycleCount();
+    TIM4_SR_UIF = 0;
+    TimerWheelTick();
+    unsigned short cycles = (unsigned short) (CycleCount() - start);
+    if (cycles < _isrMinimum)
+    {
+        _isrMinimum = cycles;
+    }
+    if (cycles > _isrMaximum)
+    {
+        _isrMaximum = cycles;
+    }
+    _isrTotal += cycles;
+    _ticks++;
+}
+
+//
+//  Timer callback, just count.
+//
+void TimerExpired(SoftwareTimer *timer)
+{
+    (void) timer;
+    _callbacks++;
+}
+
+//
+//  TIM1 free running at f_master to time the interrupt.
+//
+void InitialiseCycleCounter()
+{
+    TIM1_PSCRH = 0;
+    TIM1_PSCRL = 0;
+    TIM1_ARRH = 0xff;
+    TIM1_ARRL = 0xff;
+    TIM1_CR1_CEN = 1;
+}
+
+//
+//  TIM4 generates the 1 ms tick.
+//
+void InitialiseTick()
+{
+    TIM4_PSCR = TICK_PRESCALER;
+    TIM4_ARR = (unsigned char) TICK_RELOAD;
+    TIM4_IER_UIE = 1;
+    TIM4_CR1_CEN = 1;
+}
+
+//
+//  Run BENCHMARK_TICKS ticks with count periodic timers.  The periods are
+//  spread from 2 ticks to a little over 2 seconds so that timers expire
+//  from every level of the wheel.
+//
+void Benchmark(unsigned char count)
+{
+    __disable_interrupt();
+    for (unsigned char index = 0; index < count; index++)
+    {
+        unsigned short period = (unsigned short) (2 + ((index * 337U) % 2100));
+        TimerWheelStart(&_timers[index], period, period, TimerExpired);
+    }
+    _isrMinimum = 0xffff;
+    _isrMaximum = 0;
+    _isrTotal = 0;
+    _ticks = 0;
+    _callbacks = 0;
+    _timerWheelMoves = 0;
+    _timerWheelMostMoves = 0;
+    __enable_interrupt();
+    while (_ticks < BENCHMARK_TICKS)
+    {
+        TimerWheelRun();
+        TimerWheelIdle();
+    }
+    __disable_interrupt();
+    for (unsigned char index = 0; index < count; index++)
+    {
+        TimerWheelStop(&_timers[index]);
+    }
+    unsigned short ticks = _ticks;
+    unsigned long total = _isrTotal;
+    __enable_interrupt();
+    UARTPrintValue("timers", count, ' ');
+    UARTPrintValue("ticks", ticks, ' ');
+    UARTPrintValue("isr_min", _isrMinimum, ' ');
+    UARTPrintValue("isr_avg", total / ticks, ' ');
+    UARTPrintValue("isr_max", _isrMaximum, ' ');
+    UARTPrintValue("moves", _timerWheelMoves, ' ');
+    UARTPrintValue("most_moves", _timerWheelMostMoves, ' ');
+    UARTPrintValue("callbacks", _callbacks, '\n');
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    InitialiseCycleCounter();
+    InitialiseTick();
+    __enable_interrupt();
+    Benchmark(1);
+    Benchmark(16);
+    Benchmark(MAXIMUM_TIMERS);
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
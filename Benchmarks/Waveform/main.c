@@ -0,0 +1,173 @@
+//
+//  Benchmark for the waveform player (Common/Waveform.h).
+//
+//  TIM2 runs a 256 count PWM period at 16 MHz, an update every 16 us
+//  (62.5 kHz).  Channel 1 loops a 64 sample sine at 1 kHz and half way
+//  through the run a half amplitude sine is queued behind it, channel 2
+//  plays a gamma corrected fade up once over 50 ms and holds.  After
+//  RUN_UPDATES updates one line is printed:
+//
+//      updates=6250 sine_cycles=... expected_cycles=... switched_at=... fade_done=1 isr_cycles_max=... sine=128,255,128,1 fade=0,25,106,255
+//
+//  sine_cycles is the passes through the sine tables and expected_cycles
+//  the passes the phase step gives for the number of updates.  switched_at
+//  is the update at which the queued table took over, it is the end of a
+//  pass.  isr_cycles_max is the longest update interrupt measured with
+//  TIM1 at f_master.  The last two fields are samples from the tables the
+//  compiler built (sine at 0, 90, 180 and 270 degrees and the fade at
+//  0, 1/3, 2/3 and the end).
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#if defined DISCOVERY
+    #include <iostm8S105c6.h>
+#elif defined PROTOMODULE
+    #include <iostm8s103k3.h>
+#else
+    #include <iostm8s103f3.h>
+#endif
+#include <intrinsics.h>
+
+#define CLOCK_PERIPHERALS       (CLOCK_TIM1 | CLOCK_TIM2 | CLOCK_UART1)
+#include "../../Common/SystemClock.h"
+#include "../../Common/UARTPrint.h"
+#include "../../Common/Pwm.h"
+#include "../../Common/Waveform.h"
+
+//
+//  PWM period, update rate and run length.
+//
+#define PERIOD                  256
+#define UPDATE_RATE             (F_MASTER / PERIOD)
+#define RUN_UPDATES             6250
+#define SINE_STEP               WAVEFORM_STEP(1000, UPDATE_RATE)
+#define FADE_STEP               WAVEFORM_STEP(20, UPDATE_RATE)
+
+//
+//  Tables built by the compiler.
+//
+#define SINE(i)                 WAVEFORM_SINE(i, 64, 128, 127)
+#define HALF_SINE(i)            WAVEFORM_SINE(i, 64, 128, 63)
+#define FADE(i)                 WAVEFORM_GAMMA(i, 64, 255)
+const unsigned short _sine[64] = { WAVEFORM_64(SINE) };
+const unsigned short _halfSine[64] = { WAVEFORM_64(HALF_SINE) };
+const unsigned short _fade[64] = { WAVEFORM_64(FADE) };
+
+Waveform _tone;
+Waveform _fadeUp;
+volatile unsigned short _updates;
+unsigned short _switchedAt;
+unsigned short _longest;
+
+//
+//  Current TIM1 count, reading the high byte latches the low byte.
+//
+unsigned short CycleCount()
+{
+    unsigned char high = TIM1_CNTRH;
+    return (unsigned short) ((high << 8) | TIM1_CNTRL);
+}
+
+//
+//  TIM2 update, the next sample for each channel.
+//
+#pragma vector = TIM2_OVR_UIF_vector
+__interrupt void TIM2_UPD_OVF_IRQHandler(void)
+{
+    unsigned short start = CycleCount();
+    TIM2_SR1_UIF = 0;
+    const unsigned short *table = _tone.table;
+    WaveformUpdate(&_tone);
+    WaveformUpdate(&_fadeUp);
+    if (_tone.table != table)
+    {
+        _switchedAt = _updates;
+    }
+    _updates++;
+    unsigned short duration = (unsigned short) (CycleCount() - start);
+    if (duration > _longest)
+    {
+        _longest = duration;
+    }
+}
+
+//
+//  TIM1 free running at f_master.
+//
+void InitialiseCycleCounter()
+{
+    TIM1_PSCRH = 0;
+    TIM1_PSCRL = 0;
+    TIM1_ARRH = 0xff;
+    TIM1_ARRL = 0xff;
+    TIM1_EGR_UG = 1;
+    TIM1_CR1_CEN = 1;
+}
+
+//
+//  Wait until the update interrupt has run count times.
+//
+void WaitForUpdates(unsigned short count)
+{
+    __disable_interrupt();
+    while (_updates < count)
+    {
+        __wait_for_interrupt();
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+}
+
+//
+//  Print four samples from a table.
+//
+void PrintSamples(const char *name, const unsigned short *table, unsigned char a, unsigned char b, unsigned char c, unsigned char d, char separator)
+{
+    UARTPrintString(name);
+    UARTPrintChar('=');
+    UARTPrintUnsigned(table[a]);
+    UARTPrintChar(',');
+    UARTPrintUnsigned(table[b]);
+    UARTPrintChar(',');
+    UARTPrintUnsigned(table[c]);
+    UARTPrintChar(',');
+    UARTPrintUnsigned(table[d]);
+    UARTPrintChar(separator);
+}
+
+//
+//  Main program loop.
+//
+int main()
+{
+    __disable_interrupt();
+    InitialiseSystemClock();
+    UARTPrintInitialise();
+    InitialiseCycleCounter();
+    PwmTimer2Initialise(0, PERIOD, PWM_CHANNEL(1) | PWM_CHANNEL(2));
+    WaveformPlay(&_tone, PwmTimer2Duty, 1, _sine, 6, SINE_STEP, 1);
+    WaveformPlay(&_fadeUp, PwmTimer2Duty, 2, _fade, 6, FADE_STEP, 0);
+    TIM2_IER_UIE = 1;
+    __enable_interrupt();
+    WaitForUpdates(RUN_UPDATES / 2);
+    WaveformQueue(&_tone, _halfSine);
+    WaitForUpdates(RUN_UPDATES);
+    TIM2_IER_UIE = 0;
+    UARTPrintValue("updates", _updates, ' ');
+    UARTPrintValue("sine_cycles", _tone.cycles, ' ');
+    UARTPrintValue("expected_cycles", ((unsigned long) _updates * SINE_STEP) >> 16, ' ');
+    UARTPrintValue("switched_at", _switchedAt, ' ');
+    UARTPrintValue("fade_done", !WaveformPlaying(&_fadeUp), ' ');
+    UARTPrintValue("isr_cycles_max", _longest, ' ');
+    PrintSamples("sine", _sine, 0, 16, 32, 48, ' ');
+    PrintSamples("fade", _fade, 0, 21, 42, 63, '\n');
+    UARTPrintFlush();
+    __disable_interrupt();
+    while (1)
+    {
+        __wait_for_interrupt();
+    }
+}
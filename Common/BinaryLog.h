@@ -0,0 +1,129 @@
+//
+//  Deferred binary logging.
+//
+//  Rather than formatting text on the microcontroller each log message is
+//  sent as a short binary record and the text is rebuilt on the PC by the
+//  stm8log decoder (see Host/LogDecoder.cpp).  Each record is:
+//
+//      0xa5            Start of record, never part of normal ASCII text.
+//      id              Message number, 1 for the first message in the table.
+//      timestamp       16 bits, high byte first.
+//      arguments       0 to 3 16 bit values, high byte first.
+//
+//  Text written to the UART by other means is passed through unchanged by
+//  the decoder so binary records and text can share the same line.
+//
+//  The messages are defined by the application before including this file
+//  as a table of LOG_MESSAGE(id, format) entries, the format strings are
+//  never compiled into the program.  The table is one macro with an entry
+//  on each line, every line but the last ending in a backslash:
+//
+//      #define LOG_MESSAGES(LOG_MESSAGE)
+//          LOG_MESSAGE(LOG_STARTED, "Started")
+//          LOG_MESSAGE(LOG_COUNTER, "Counter %u, limit %u")
+//
+//  along with:
+//
+//      LOG_PUT_CHAR(ch)    Send one byte (for example to a UART buffer).
+//      LOG_TIMESTAMP()     16 bit timestamp, usually a free running timer.
+//      LOG_FREE_SPACE()    Optional, bytes which can be sent without
+//                          waiting.  When defined a record which will not
+//                          fit is dropped (and counted in _logDropped)
+//                          rather than waiting, this makes logging from
+//                          an interrupt service routine safe.
+//
+//  The decoder reads the message table from the source file so the entries
+//  must stay in the same order as the program was built with.  Arguments
+//  are formatted with %d, %u, %x, %X or %c.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <intrinsics.h>
+
+#if !defined(LOG_MESSAGES) || !defined(LOG_PUT_CHAR) || !defined(LOG_TIMESTAMP)
+    #error "LOG_MESSAGES, LOG_PUT_CHAR and LOG_TIMESTAMP must be defined before including BinaryLog.h"
+#endif
+
+//
+//  First byte of every record.
+//
+#define LOG_SYNC                    0xa5
+
+//
+//  Message numbers, the first message is 1.
+//
+#define LOG_MESSAGE_ID(id, format)  id,
+enum LogMessageID
+{
+    LOG_NO_MESSAGE,
+    LOG_MESSAGES(LOG_MESSAGE_ID)
+    LOG_NUMBER_OF_MESSAGES
+};
+#undef LOG_MESSAGE_ID
+
+//
+//  Number of records which have been dropped.
+//
+static unsigned short _logDropped;
+
+//--------------------------------------------------------------------------------
+//
+//  Send a 16 bit value, high byte first.
+//
+static void LogPutShort(unsigned short value)
+{
+    LOG_PUT_CHAR((unsigned char) (value >> 8));
+    LOG_PUT_CHAR((unsigned char) value);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Send a record.  Interrupts are disabled while the record is written so
+//  that records written by interrupt service routines are not mixed up
+//  with the one being written.
+//
+static void LogRecord(unsigned char id, unsigned char count, unsigned short a, unsigned short b, unsigned short c)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+#if defined(LOG_FREE_SPACE)
+    if (LOG_FREE_SPACE() < (unsigned char) (4 + (2 * count)))
+    {
+        _logDropped++;
+        __set_interrupt_state(state);
+        return;
+    }
+#endif
+    LOG_PUT_CHAR(LOG_SYNC);
+    LOG_PUT_CHAR(id);
+    LogPutShort(LOG_TIMESTAMP());
+    if (count > 0)
+    {
+        LogPutShort(a);
+    }
+    if (count > 1)
+    {
+        LogPutShort(b);
+    }
+    if (count > 2)
+    {
+        LogPutShort(c);
+    }
+    __set_interrupt_state(state);
+}
+
+//
+//  Log a message with 0 to 3 arguments.
+//
+#define LogMessage0(id)             LogRecord((id), 0, 0, 0, 0)
+#define LogMessage1(id, a)          LogRecord((id), 1, (unsigned short) (a), 0, 0)
+#define LogMessage2(id, a, b)       LogRecord((id), 2, (unsigned short) (a), (unsigned short) (b), 0)
+#define LogMessage3(id, a, b, c)    LogRecord((id), 3, (unsigned short) (a), (unsigned short) (b), (unsigned short) (c))
+
+#endif
@@ -0,0 +1,174 @@
+//
+//  Reference counted peripheral clock gating.
+//
+//  SystemClock.h clocks a fixed set of peripherals (CLOCK_PERIPHERALS) for
+//  the whole run.  This module lets each driver turn on the clock of the
+//  peripheral it is about to use and turn it off again when it has
+//  finished so that CLK_PCKENR1 and CLK_PCKENR2 only ever enable the
+//  peripherals which are actually in use.  Acquire and release calls must
+//  be paired; a gate is turned on by the first acquire and turned off by
+//  the last release.  Gates in CLOCK_PERIPHERALS are never turned off.
+//
+//  Set CLOCK_PERIPHERALS to 0 (or the peripherals which must always run)
+//  and include this file after SystemClock.h:
+//
+//      #define CLOCK_PERIPHERALS   (0)
+//      #include "../Common/SystemClock.h"
+//      #include "../Common/ClockGate.h"
+//
+//      ClockGateAcquire(CLOCK_GATE_ADC);
+//      ...
+//      ClockGateRelease(CLOCK_GATE_ADC);
+//
+//  The peripheral registers cannot be written while the clock is off so
+//  the gate must be acquired before the peripheral is configured.
+//
+//  Measurement mode records how long each gate has been on.  Define
+//  CLOCK_GATE_MEASURE and CLOCK_GATE_TIMESTAMP() before including this
+//  file, the timestamp being an unsigned long count in any unit (a timer
+//  overflow count for instance).  ClockGateOnTime returns the total on time
+//  in the same units and ClockGateEnables the number of times the gate has
+//  been turned on.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef CLOCK_GATE_H
+#define CLOCK_GATE_H
+
+#include <intrinsics.h>
+
+#if !defined(SYSTEM_CLOCK_H)
+    #error "SystemClock.h must be included before ClockGate.h"
+#endif
+#if defined(CLOCK_GATE_MEASURE) && !defined(CLOCK_GATE_TIMESTAMP)
+    #error "CLOCK_GATE_TIMESTAMP must be defined when using CLOCK_GATE_MEASURE"
+#endif
+
+//
+//  Gate numbers, the bit number of the PCKEN bit in the 16 bit value made
+//  from CLK_PCKENR2 (high byte) and CLK_PCKENR1 (low byte) as used by
+//  CLOCK_PERIPHERALS.  The beeper shares the AWU gate.
+//
+#define CLOCK_GATE_I2C              0
+#define CLOCK_GATE_SPI              1
+#define CLOCK_GATE_UART1            3
+#define CLOCK_GATE_UART2            3
+#define CLOCK_GATE_TIM4             4
+#define CLOCK_GATE_TIM2             5
+#define CLOCK_GATE_TIM3             6
+#define CLOCK_GATE_TIM1             7
+#define CLOCK_GATE_AWU              10
+#define CLOCK_GATE_BEEP             10
+#define CLOCK_GATE_ADC              11
+#define CLOCK_GATE_CAN              15
+#define CLOCK_GATES                 16
+
+//
+//  Number of users of each gate.
+//
+static unsigned char _clockGateUsers[CLOCK_GATES];
+
+//
+//  Gates which are currently on, in the CLOCK_PERIPHERALS format.
+//
+static unsigned short _clockGatesLive = CLOCK_PERIPHERALS;
+
+#if defined(CLOCK_GATE_MEASURE)
+static unsigned long _clockGateOnTime[CLOCK_GATES];
+static unsigned long _clockGateOnSince[CLOCK_GATES];
+static unsigned short _clockGateEnables[CLOCK_GATES];
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  Write the live gates to the clock controller.
+//
+static void ClockGateUpdate()
+{
+    CLK_PCKENR1 = (unsigned char) (_clockGatesLive & 0xff);
+    CLK_PCKENR2 = (unsigned char) (_clockGatesLive >> 8);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Add a user to a gate, turning the peripheral clock on for the first.
+//
+void ClockGateAcquire(unsigned char gate)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    if (_clockGateUsers[gate]++ == 0)
+    {
+        unsigned short mask = (unsigned short) (1 << gate);
+        if ((_clockGatesLive & mask) == 0)
+        {
+            _clockGatesLive |= mask;
+            ClockGateUpdate();
+#if defined(CLOCK_GATE_MEASURE)
+            _clockGateOnSince[gate] = CLOCK_GATE_TIMESTAMP();
+            _clockGateEnables[gate]++;
+#endif
+        }
+    }
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Remove a user from a gate, the peripheral clock is turned off when the
+//  last user releases the gate unless the gate is in CLOCK_PERIPHERALS.
+//  Releasing a gate which has no users is ignored.
+//
+void ClockGateRelease(unsigned char gate)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    if ((_clockGateUsers[gate] != 0) && (--_clockGateUsers[gate] == 0))
+    {
+        unsigned short mask = (unsigned short) (1 << gate);
+        if ((CLOCK_PERIPHERALS & mask) == 0)
+        {
+            _clockGatesLive &= (unsigned short) ~mask;
+            ClockGateUpdate();
+#if defined(CLOCK_GATE_MEASURE)
+            _clockGateOnTime[gate] += CLOCK_GATE_TIMESTAMP() - _clockGateOnSince[gate];
+#endif
+        }
+    }
+    __set_interrupt_state(state);
+}
+
+//
+//  Gates currently on (CLOCK_PERIPHERALS format) and whether a single gate
+//  is on.
+//
+#define ClockGatesLive()            (_clockGatesLive)
+#define ClockGateLive(gate)         ((_clockGatesLive & (1 << (gate))) != 0)
+
+#if defined(CLOCK_GATE_MEASURE)
+//--------------------------------------------------------------------------------
+//
+//  Total time the gate has been on in CLOCK_GATE_TIMESTAMP units, including
+//  the current period if it is on now.  Gates in CLOCK_PERIPHERALS are not
+//  measured.
+//
+unsigned long ClockGateOnTime(unsigned char gate)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    unsigned long total = _clockGateOnTime[gate];
+    if (((CLOCK_PERIPHERALS & (1 << gate)) == 0) && ClockGateLive(gate))
+    {
+        total += CLOCK_GATE_TIMESTAMP() - _clockGateOnSince[gate];
+    }
+    __set_interrupt_state(state);
+    return total;
+}
+
+#define ClockGateEnables(gate)      (_clockGateEnables[(gate)])
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+//
+//  Run time clock scaling.
+//
+//  SystemClock.h sets the clock tree up once at start-up.  This module
+//  allows the HSI and CPU dividers in CLK_CKDIVR to be changed while the
+//  program is running, for instance dropping to a quarter of the speed
+//  while waiting for work and returning to 16 MHz under load.
+//
+//  Changing HSIDIV changes f_master and with it the clock of every
+//  peripheral, so any driver whose timing is calculated from f_master
+//  (timer prescalers, UART BRR, I2C FREQR / CCR / TRISER) registers a
+//  handler which is called twice for each change:
+//
+//      CLOCK_SCALING_PREPARE   Before CLK_CKDIVR is written, finish or
+//                              pause anything which would be upset by
+//                              the change (a character being transmitted
+//                              for example).
+//      CLOCK_SCALING_CHANGED   After CLK_CKDIVR is written, recalculate
+//                              the timing registers from fMaster.
+//
+//  The handlers are called in the order they were registered with
+//  interrupts disabled so no interrupt service routine can run with the
+//  peripherals part way through the change.  Changing only the CPU
+//  divider leaves f_master alone and the handlers are not called.
+//
+//  The frequencies at start-up are F_MASTER and F_CPU from SystemClock.h,
+//  which must be included first.  The HSI divider can only be changed when
+//  running from the HSI.
+//
+//      CLOCK_SCALING_HANDLERS  Maximum number of handlers (default 4).
+//
+//  Because both dividers are powers of two, f_master is always F_MASTER
+//  divided by a power of two as long as the application starts at the
+//  fastest clock it uses.  A peripheral with a power of two prescaler
+//  (TIM2, TIM3 and TIM4) can keep counting at the same rate by reducing
+//  its prescaler by ClockScalingShift(fMaster).  The new prescaler is only
+//  loaded by an update event, which clears the counter, so a free running
+//  count loses up to one count each time f_master changes.
+//
+//  UARTBuffer.h and TicklessTimer.h register their own handlers when this
+//  file is included before them.  TimerWheel.h and Debounce.h count the
+//  ticks of a timer set up by the application, which must register a
+//  handler for it.  Delay.h cannot be used with clock scaling.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef CLOCK_SCALING_H
+#define CLOCK_SCALING_H
+
+#include <intrinsics.h>
+
+#if !defined(SYSTEM_CLOCK_H)
+    #error "SystemClock.h must be included before ClockScaling.h"
+#endif
+
+#if !defined(CLOCK_SCALING_HANDLERS)
+    #define CLOCK_SCALING_HANDLERS  4
+#endif
+
+//
+//  Handler phases.
+//
+#define CLOCK_SCALING_PREPARE       0
+#define CLOCK_SCALING_CHANGED       1
+
+typedef void (*ClockScalingHandler)(unsigned char phase, unsigned long fMaster);
+
+//
+//  Registered handlers.
+//
+static ClockScalingHandler _clockScalingHandlers[CLOCK_SCALING_HANDLERS];
+static unsigned char _clockScalingHandlerCount;
+
+//
+//  Current clock frequencies and the number of times f_master has changed.
+//
+static unsigned long _fMaster = F_MASTER;
+static unsigned long _fCpu = F_CPU;
+static unsigned short _clockScalingChanges;
+
+#define MasterClockFrequency()      (_fMaster)
+#define CpuClockFrequency()         (_fCpu)
+
+//--------------------------------------------------------------------------------
+//
+//  Add a handler to the list of handlers notified of f_master changes.
+//  Returns 0 if the list is full.
+//
+unsigned char ClockScalingRegister(ClockScalingHandler handler)
+{
+    if (_clockScalingHandlerCount == CLOCK_SCALING_HANDLERS)
+    {
+        return 0;
+    }
+    _clockScalingHandlers[_clockScalingHandlerCount++] = handler;
+    return 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Number of times f_master has been halved from F_MASTER.
+//
+unsigned char ClockScalingShift(unsigned long fMaster)
+{
+    unsigned char shift = 0;
+    while ((fMaster << shift) < F_MASTER)
+    {
+        shift++;
+    }
+    return shift;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Divider as a power of two, 0xff if it is not a power of two between 1
+//  and limit.
+//
+static unsigned char ClockScalingLog2(unsigned char divider, unsigned char limit)
+{
+    if ((divider == 0) || (divider > limit) || ((divider & (divider - 1)) != 0))
+    {
+        return 0xff;
+    }
+    unsigned char log2 = 0;
+    while ((1 << log2) != divider)
+    {
+        log2++;
+    }
+    return log2;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Change the HSI divider (1, 2, 4 or 8) and the CPU divider (1, 2 ... 128).
+//
+//  Returns 0 if the dividers are not valid, in which case the clock is not
+//  changed, or 1 once the clock and all of the registered peripherals are
+//  running at the new frequency.
+//
+unsigned char ClockScalingSetDividers(unsigned char hsiDivider, unsigned char cpuDivider)
+{
+    unsigned char hsiShift = ClockScalingLog2(hsiDivider, 8);
+    unsigned char cpuShift = ClockScalingLog2(cpuDivider, 128);
+    if ((hsiShift == 0xff) || (cpuShift == 0xff) || ((CLOCK_SOURCE != CLOCK_SOURCE_HSI) && (hsiDivider != 1)))
+    {
+        return 0;
+    }
+    unsigned long fMaster = (CLOCK_SOURCE == CLOCK_SOURCE_HSI) ? (HSI_FREQUENCY >> hsiShift) : F_MASTER;
+    unsigned char changed = fMaster != _fMaster;
+
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    if (changed)
+    {
+        for (unsigned char index = 0; index < _clockScalingHandlerCount; index++)
+        {
+            _clockScalingHandlers[index](CLOCK_SCALING_PREPARE, fMaster);
+        }
+    }
+    CLK_CKDIVR = (unsigned char) ((hsiShift << 3) | cpuShift);
+    _fMaster = fMaster;
+    _fCpu = fMaster >> cpuShift;
+    if (changed)
+    {
+        _clockScalingChanges++;
+        for (unsigned char index = 0; index < _clockScalingHandlerCount; index++)
+        {
+            _clockScalingHandlers[index](CLOCK_SCALING_CHANGED, fMaster);
+        }
+    }
+    __set_interrupt_state(state);
+    return 1;
+}
+
+#endif
@@ -0,0 +1,290 @@
+//
+//  Debounced buttons sampled from a periodic tick.
+//
+//  A mechanical switch bounces for a few milliseconds when it is pressed
+//  and released, so a port interrupt on every edge runs the service
+//  routine tens of times for one press.  Here the first edge starts the
+//  debouncer and turns off the pin interrupt (Px_CR2), the pin is then
+//  sampled on each tick of a periodic timer until it has settled back to
+//  the released level.  The interrupt is turned on again after the
+//  release so one press costs one port interrupt and a few tens of ticks:
+//
+//      Button _button;
+//
+//      void ButtonEvent(Button *button, unsigned char event)
+//      {
+//          if (event == BUTTON_PRESSED)
+//          {
+//              ...
+//          }
+//      }
+//
+//      void ButtonEdge(unsigned char pin, unsigned char level)
+//      {
+//          DebounceStart(&_button);
+//          TIM4_CR1_CEN = 1;                       //  Start the tick.
+//      }
+//
+//      #pragma vector = TIM4_OVR_UIF_vector
+//      __interrupt void TIM4_UPD_OVF_IRQHandler(void)
+//      {
+//          TIM4_SR_UIF = 0;
+//          if (DebounceTick() == 0)
+//          {
+//              TIM4_CR1_CEN = 0;                   //  Nothing to sample.
+//          }
+//      }
+//
+//      DebounceAttach(&_button, &_portD, DEBOUNCE_PORT_D, 4, 0, 10, 1000, ButtonEvent);
+//      PinInterruptsAttach(&_portD, 4, PIN_BOTH_EDGES, ButtonEdge);
+//
+//  Each sample moves an integrator one step towards the level read, it
+//  runs from 0 (released) to integration (pressed).  The button is pressed
+//  when the integrator reaches integration and released when it gets back
+//  to 0, so a level must be held for integration ticks more than it is
+//  broken by bounces before it counts.  Sampling stops once the integrator
+//  has stayed at 0 for another integration ticks so that the last bounces
+//  of a release do not start it again.  The handler is called from the
+//  tick with one of:
+//
+//      BUTTON_PRESSED          The button has settled at the pressed level.
+//      BUTTON_RELEASED         The button has settled at the released level.
+//      BUTTON_LONG_PRESS       The button has been held for longPress ticks
+//                              (0 turns this off), once per press.
+//
+//  When sampling ends the level is stored in the dispatcher (PinInterrupts)
+//  so the next edge is seen as a change.  The pin is read again after the
+//  interrupt is turned on and sampling restarts if it was pressed in the
+//  mean time.  The tick clears and sets the Px_CR2 bit with a read-modify-
+//  write, the main program must not write Px_CR2 of the port while a
+//  button is being sampled.
+//
+//      DEBOUNCE_BUTTONS        Maximum number of buttons (default 4).
+//
+//  integration and longPress are counted in ticks of the application's
+//  timer.  A program which changes f_master with ClockScaling.h must keep
+//  the tick length itself by registering a handler which reduces the tick
+//  timer's prescaler by ClockScalingShift(fMaster), otherwise the times
+//  stretch as the clock is slowed.
+//
+//  edges counts the port interrupts which started the debouncer and
+//  presses the presses reported.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <intrinsics.h>
+#include "PinInterrupts.h"
+
+#if !defined(DEBOUNCE_BUTTONS)
+    #define DEBOUNCE_BUTTONS        4
+#endif
+
+//
+//  Base address of each port (Px_ODR), the input and interrupt control
+//  registers follow it.
+//
+#define DEBOUNCE_PORT_A             0x5000
+#define DEBOUNCE_PORT_B             0x5005
+#define DEBOUNCE_PORT_C             0x500a
+#define DEBOUNCE_PORT_D             0x500f
+#define DEBOUNCE_PORT_E             0x5014
+#define DEBOUNCE_IDR                1
+#define DEBOUNCE_CR2                4
+
+#if defined(STM8S_HOST_H)
+    #define DEBOUNCE_REGISTER(address)  STM8_REGISTER(address)
+#else
+    #define DEBOUNCE_REGISTER(address)  (*(volatile unsigned char *) (address))
+#endif
+
+//
+//  Events passed to the button handler.
+//
+#define BUTTON_PRESSED              1
+#define BUTTON_RELEASED             2
+#define BUTTON_LONG_PRESS           3
+
+struct Button;
+typedef void (*ButtonHandler)(struct Button *button, unsigned char event);
+
+//
+//  A button on a port pin.
+//
+typedef struct Button
+{
+    PinInterrupts *dispatcher;              //  Dispatcher for the port interrupt.
+    unsigned short port;                    //  DEBOUNCE_PORT_x.
+    unsigned char mask;                     //  Pin as a bit mask.
+    unsigned char pressedLevel;             //  Pin level (0 or 1) when pressed.
+    unsigned char integration;              //  Ticks needed to change state.
+    unsigned char integrator;
+    unsigned char sampling;                 //  Non-zero while the pin interrupt is off.
+    unsigned char quiet;                    //  Ticks released with the integrator at 0.
+    unsigned char pressed;                  //  Debounced state.
+    unsigned short longPress;               //  Ticks held for BUTTON_LONG_PRESS, 0 for none.
+    unsigned short held;                    //  Ticks held in this press.
+    ButtonHandler handler;
+    unsigned long edges;                    //  Port interrupts which started sampling.
+    unsigned long presses;
+} Button;
+
+static Button *_debounceButtons[DEBOUNCE_BUTTONS];
+static unsigned char _debounceNumberOfButtons;
+
+//--------------------------------------------------------------------------------
+//
+//  Add a button on pin of port (DEBOUNCE_PORT_x) which interrupts through
+//  dispatcher.  pressedLevel is the pin level when the button is pressed
+//  (0 for a button to ground with a pull up), integration (1 to 255) and
+//  longPress are in ticks.  Returns 0 if there are already
+//  DEBOUNCE_BUTTONS buttons.
+//
+unsigned char DebounceAttach(Button *button, PinInterrupts *dispatcher, unsigned short port, unsigned char pin,
+                             unsigned char pressedLevel, unsigned char integration, unsigned short longPress, ButtonHandler handler)
+{
+    if (_debounceNumberOfButtons == DEBOUNCE_BUTTONS)
+    {
+        return 0;
+    }
+    button->dispatcher = dispatcher;
+    button->port = port;
+    button->mask = (unsigned char) (1 << pin);
+    button->pressedLevel = pressedLevel;
+    button->integration = integration ? integration : 1;
+    button->integrator = 0;
+    button->sampling = 0;
+    button->quiet = 0;
+    button->pressed = 0;
+    button->longPress = longPress;
+    button->held = 0;
+    button->handler = handler;
+    button->edges = 0;
+    button->presses = 0;
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    _debounceButtons[_debounceNumberOfButtons++] = button;
+    __set_interrupt_state(state);
+    return 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  An edge has been seen on the pin, turn off its interrupt and sample it
+//  from the tick.  Call this from the pin handler.
+//
+void DebounceStart(Button *button)
+{
+    if (!button->sampling)
+    {
+        DEBOUNCE_REGISTER(button->port + DEBOUNCE_CR2) &= (unsigned char) ~button->mask;
+        button->sampling = 1;
+        button->quiet = 0;
+        button->edges++;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Sample the pin, returns non-zero while it is still to be sampled.
+//
+static unsigned char DebounceSample(Button *button)
+{
+    unsigned char level = (DEBOUNCE_REGISTER(button->port + DEBOUNCE_IDR) & button->mask) ? 1 : 0;
+    if (level == button->pressedLevel)
+    {
+        if (button->integrator < button->integration)
+        {
+            button->integrator++;
+        }
+    }
+    else if (button->integrator > 0)
+    {
+        button->integrator--;
+    }
+    if (button->pressed)
+    {
+        if (button->integrator == 0)
+        {
+            button->pressed = 0;
+            button->handler(button, BUTTON_RELEASED);
+        }
+        else if (button->held != 0xffff)
+        {
+            button->held++;
+            if (button->held == button->longPress)
+            {
+                button->handler(button, BUTTON_LONG_PRESS);
+            }
+        }
+    }
+    else if (button->integrator == button->integration)
+    {
+        button->pressed = 1;
+        button->held = 0;
+        button->presses++;
+        button->handler(button, BUTTON_PRESSED);
+    }
+    if (button->pressed || (button->integrator != 0))
+    {
+        button->quiet = 0;
+        return 1;
+    }
+    if (++button->quiet < button->integration)
+    {
+        return 1;
+    }
+    //
+    //  Settled at the released level, record it in the dispatcher and turn
+    //  the pin interrupt on again.  An edge since the sample would have
+    //  been missed so check the pin once more.
+    //
+    if (button->pressedLevel)
+    {
+        button->dispatcher->last &= (unsigned char) ~button->mask;
+    }
+    else
+    {
+        button->dispatcher->last |= button->mask;
+    }
+    DEBOUNCE_REGISTER(button->port + DEBOUNCE_CR2) |= button->mask;
+    level = (DEBOUNCE_REGISTER(button->port + DEBOUNCE_IDR) & button->mask) ? 1 : 0;
+    if (level != button->pressedLevel)
+    {
+        button->sampling = 0;
+        return 0;
+    }
+    DEBOUNCE_REGISTER(button->port + DEBOUNCE_CR2) &= (unsigned char) ~button->mask;
+    button->quiet = 0;
+    return 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Sample the buttons which are settling, call this from the periodic
+//  tick.  Returns the number of buttons still being sampled, the tick can
+//  be stopped when this is 0 and started again by the next edge.
+//
+unsigned char DebounceTick()
+{
+    unsigned char active = 0;
+    for (unsigned char index = 0; index < _debounceNumberOfButtons; index++)
+    {
+        Button *button = _debounceButtons[index];
+        if (button->sampling)
+        {
+            if (DebounceSample(button))
+            {
+                active++;
+            }
+        }
+    }
+    return active;
+}
+
+#endif
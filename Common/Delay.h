@@ -0,0 +1,168 @@
+//
+//  Calibrated delays using TIM4.
+//
+//  A busy loop such as
+//
+//      for (long counter = 0; counter < 250000; counter++);
+//
+//  takes a time which depends on the compiler, the optimisation level and
+//  the clock and keeps the CPU running flat out while it waits.  These
+//  delays are timed by TIM4 instead and the core waits for the timer
+//  interrupt (WFI) so it is stopped for almost all of the delay.
+//
+//  TIM4 counts microseconds (the prescaler is chosen from F_MASTER) and
+//  overflows after up to 256 counts.  Longer delays raise the prescaler
+//  (up to 128) so each count covers several microseconds and the timer is
+//  left running for as many full length overflows as fit in the delay, at
+//  16 MHz the core wakes about every 2 ms.  The remainder is made up by
+//  at most two shorter overflows, one with the smallest prescaler which
+//  covers it in 256 counts and one counting the microseconds left over.
+//  The application forwards the TIM4 interrupt:
+//
+//      #pragma vector = TIM4_OVR_UIF_vector
+//      __interrupt void TIM4_UPD_OVF_IRQHandler(void)
+//      {
+//          DelayInterrupt();
+//      }
+//
+//      DelayMilliseconds(500);
+//
+//  TIM4 must be clocked, either in CLOCK_PERIPHERALS or, when ClockGate.h
+//  is included first, acquired for the length of each delay.  f_master
+//  must be 1, 2, 4, 8 or 16 MHz so that a count is a whole number of
+//  microseconds.  The prescaler is fixed from F_MASTER when the program is
+//  compiled so f_master must equal F_MASTER at all times, the dividers must
+//  not be changed with ClockScaling.h in a program which uses Delay.h.  The
+//  delay is never shorter than requested, a few cycles are added for
+//  setting up the timer each time the overflow length changes.
+//
+//  The delay enables interrupts while it waits (WFI does this) and
+//  restores the interrupt state before it returns.  Other interrupts are
+//  served during the delay.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef DELAY_H
+#define DELAY_H
+
+#include <intrinsics.h>
+
+#if !defined(SYSTEM_CLOCK_H)
+    #error "SystemClock.h must be included before Delay.h"
+#endif
+#if !defined(CLOCK_GATE_H) && (((CLOCK_PERIPHERALS) & CLOCK_TIM4) == 0)
+    #error "TIM4 must be in CLOCK_PERIPHERALS to use Delay.h"
+#endif
+
+//
+//  TIM4 prescaler for one microsecond counts and the most the prescaler
+//  can be raised above that.
+//
+#define DELAY_PRESCALER             CLOCK_LOG2(F_MASTER / 1000000UL)
+#define DELAY_LONGEST_SHIFT         (7 - DELAY_PRESCALER)
+
+#if (F_MASTER < 1000000UL) || ((1000000UL << DELAY_PRESCALER) != F_MASTER)
+    #error "Delay.h needs f_master to be 1, 2, 4, 8 or 16 MHz."
+#endif
+
+//
+//  Overflows still to come with the current prescaler and reload.
+//
+static volatile unsigned long _delayOverflows;
+
+//
+//  Number of times the core has been woken by the delay timer.
+//
+static unsigned long _delayWakeups;
+
+//--------------------------------------------------------------------------------
+//
+//  TIM4 overflow, call this from TIM4_UPD_OVF_IRQHandler.  The timer is
+//  stopped after the last overflow.
+//
+void DelayInterrupt()
+{
+    TIM4_SR_UIF = 0;
+    _delayWakeups++;
+    if (--_delayOverflows == 0)
+    {
+        TIM4_CR1_CEN = 0;
+        TIM4_IER_UIE = 0;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Wait for overflows periods of ticks (1 to 256) counts of 2^shift
+//  microseconds.
+//
+static void DelayTicks(unsigned char shift, unsigned short ticks, unsigned long overflows)
+{
+    TIM4_CR1 = 0x04;                                //  URS, stopped.
+    TIM4_PSCR = (unsigned char) (DELAY_PRESCALER + shift);
+    TIM4_ARR = (unsigned char) (ticks - 1);
+    TIM4_EGR_UG = 1;                                //  Load the prescaler and clear the counter.
+    TIM4_SR_UIF = 0;
+    _delayOverflows = overflows;
+    TIM4_IER_UIE = 1;
+    TIM4_CR1_CEN = 1;
+    __disable_interrupt();
+    while (_delayOverflows != 0)
+    {
+        __wait_for_interrupt();
+        __disable_interrupt();
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Wait for at least us microseconds.
+//
+void DelayMicroseconds(unsigned long us)
+{
+    __istate_t state = __get_interrupt_state();
+#if defined(CLOCK_GATE_H)
+    ClockGateAcquire(CLOCK_GATE_TIM4);
+#endif
+    unsigned long overflows = us >> (DELAY_LONGEST_SHIFT + 8);
+    if (overflows != 0)
+    {
+        DelayTicks(DELAY_LONGEST_SHIFT, 256, overflows);
+        us -= overflows << (DELAY_LONGEST_SHIFT + 8);
+    }
+    if (us != 0)
+    {
+        //
+        //  us is now less than 256 counts at the longest shift.
+        //
+        unsigned char shift = 0;
+        while ((us >> shift) > 256)
+        {
+            shift++;
+        }
+        DelayTicks(shift, (unsigned short) (us >> shift), 1);
+        us &= (1UL << shift) - 1;
+        if (us != 0)
+        {
+            DelayTicks(0, (unsigned short) us, 1);
+        }
+    }
+#if defined(CLOCK_GATE_H)
+    ClockGateRelease(CLOCK_GATE_TIM4);
+#endif
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Wait for at least ms milliseconds.
+//
+void DelayMilliseconds(unsigned short ms)
+{
+    DelayMicroseconds(ms * 1000UL);
+}
+
+#endif
@@ -0,0 +1,121 @@
+//
+//  Dithered (sigma-delta) PWM for more resolution than the period gives.
+//
+//  A PWM period of N counts gives N duty steps, so 10 bits of resolution
+//  at 16 MHz means a 1024 count period and a 15.6 kHz carrier, which can
+//  be heard.  Here the period is shortened by a number of dither bits (256
+//  counts and a 62.5 kHz carrier for 2 bits) and the duty is held with the
+//  extra bits below the period resolution.  On each update event the fraction
+//  is added to an error accumulator and the duty written for the next
+//  period is rounded up when the accumulator carries:
+//
+//      duty 513 (of 1024), 2 bits      128 + 1/4: 128, 128, 128, 129, ...
+//
+//  so the average over 2^bits periods is the full resolution duty and the
+//  carrier and resolution can be chosen separately.  The error left over
+//  is carried into the next period so every run of 2^bits periods has
+//  exactly the requested average.
+//
+//      Dither _led;
+//
+//      #pragma vector = TIM1_OVR_UIF_vector
+//      __interrupt void TIM1_UPD_OVF_IRQHandler(void)
+//      {
+//          TIM1_SR1_UIF = 0;
+//          DitherUpdate(&_led);
+//      }
+//
+//      PwmTimer1Initialise(0, 256, PWM_CHANNEL(4));
+//      DitherInitialise(&_led, PwmTimer1Duty, 4, 2);
+//      DitherSet(&_led, 513);
+//      TIM1_IER_UIE = 1;
+//
+//  The output function is one of the Pwm.h duty functions, the value is
+//  written to the preload register straight after an update event and is
+//  loaded whole at the next one.  The cost is one update interrupt per
+//  period, see Benchmarks/Dither for the cycles this takes.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef DITHER_H
+#define DITHER_H
+
+#include <intrinsics.h>
+
+//
+//  Writes the duty for the next period to a channel (PwmTimer1Duty or
+//  PwmTimer2Duty).
+//
+typedef void (*DitherOutput)(unsigned char channel, unsigned short value);
+
+//
+//  Dithering state for one channel.
+//
+typedef struct
+{
+    DitherOutput output;
+    unsigned char channel;
+    unsigned char bits;                     //  Bits of the duty below the period resolution.
+    unsigned char mask;                     //  2^bits - 1.
+    unsigned char error;                    //  Fraction carried to the next period.
+    unsigned short coarse;                  //  Duty in period counts.
+    unsigned char fine;                     //  Duty below a count, 0 to mask.
+} Dither;
+
+//--------------------------------------------------------------------------------
+//
+//  Dither channel with bits (0 to 7) extra bits of resolution, the duty
+//  starts at 0.
+//
+void DitherInitialise(Dither *dither, DitherOutput output, unsigned char channel, unsigned char bits)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    dither->output = output;
+    dither->channel = channel;
+    dither->bits = bits;
+    dither->mask = (unsigned char) ((1 << bits) - 1);
+    dither->error = 0;
+    dither->coarse = 0;
+    dither->fine = 0;
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Set the duty in units of 1 / 2^bits counts, for example 0 to 1023 for
+//  a 256 count period and 2 bits.
+//
+void DitherSet(Dither *dither, unsigned short duty)
+{
+    unsigned short coarse = duty >> dither->bits;
+    unsigned char fine = (unsigned char) (duty & dither->mask);
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    dither->coarse = coarse;
+    dither->fine = fine;
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Write the duty for the next period, call this from the timer update
+//  interrupt.
+//
+void DitherUpdate(Dither *dither)
+{
+    unsigned char error = (unsigned char) (dither->error + dither->fine);
+    unsigned short duty = dither->coarse;
+    if (error > dither->mask)
+    {
+        error = (unsigned char) (error - dither->mask - 1);
+        duty++;
+    }
+    dither->error = error;
+    dither->output(dither->channel, duty);
+}
+
+#endif
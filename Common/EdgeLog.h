@@ -0,0 +1,245 @@
+//
+//  Timestamped log of the edges seen by the port interrupts.
+//
+//  Knowing that an edge arrived is often not enough to diagnose a problem
+//  in the field, the time it arrived and the order of the edges on
+//  different pins matter too.  Formatting and sending that from the
+//  interrupt service routine would delay the handler the edge is meant
+//  for, so the dispatcher in PinInterrupts.h only stores a four byte
+//  record of each edge in a ring buffer and the main loop sends the
+//  records at its leisure:
+//
+//      #include "../Common/EdgeLog.h"
+//      #include "../Common/PinInterrupts.h"
+//
+//      EdgeLogInitialise();
+//      while (1)
+//      {
+//          EdgeLogDump();
+//          __disable_interrupt();
+//          if (EdgeLogEmpty())
+//          {
+//              __wait_for_interrupt();
+//          }
+//          __enable_interrupt();
+//      }
+//
+//  EdgeLog.h must be included before PinInterrupts.h.  Every port
+//  interrupt is then recorded by the dispatcher before it calls any
+//  handler, with the time the dispatch started: one record for each pin
+//  which has changed, whether or not it has a handler, or a single
+//  no_change record when the interrupt finds no pin changed (a pulse
+//  shorter than the interrupt latency).  Each record is printed on the
+//  UART (UARTPrint.h) as:
+//
+//      pin=4 level=0 time=12345
+//      no_change time=12400
+//
+//  The timestamp is TIM1 counting microseconds and wraps every 65.536 ms,
+//  define EDGE_LOG_TIMESTAMP() (an unsigned short from a free running
+//  timer) before including this file to use another timer.  TIM1 is
+//  started by EdgeLogInitialise and must be clocked.  An application which
+//  already defines PIN_INTERRUPTS_TIMESTAMP has its edges timed by that.
+//
+//  The buffer is a lock free ring like the Scheduler.h queues: head is
+//  only written by the dispatcher and tail only by the main loop.  All of
+//  the port interrupts which log edges must have the same priority so
+//  that they cannot interrupt one another.  A full buffer drops the
+//  record and counts it in _edgeLogDropped, EdgeLogDump prints the count
+//  when it changes:
+//
+//      dropped=3
+//
+//      EDGE_LOG_SIZE           Records in the buffer, a power of two up to
+//                              128 (default 16).
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef EDGE_LOG_H
+#define EDGE_LOG_H
+
+#include <intrinsics.h>
+
+#if defined(PIN_INTERRUPTS_H)
+    #error "EdgeLog.h must be included before PinInterrupts.h"
+#endif
+
+#if !defined(EDGE_LOG_SIZE)
+    #define EDGE_LOG_SIZE           16
+#endif
+#if (EDGE_LOG_SIZE > 128) || ((EDGE_LOG_SIZE & (EDGE_LOG_SIZE - 1)) != 0)
+    #error "EDGE_LOG_SIZE must be a power of two no larger than 128."
+#endif
+#define EDGE_LOG_MASK               (EDGE_LOG_SIZE - 1)
+
+//
+//  pin of the record for an interrupt in which no pin changed.
+//
+#define EDGE_LOG_NO_CHANGE          0xff
+
+#if !defined(EDGE_LOG_TIMESTAMP)
+    #if !defined(SYSTEM_CLOCK_H)
+        #error "SystemClock.h must be included before EdgeLog.h"
+    #endif
+    #if (F_MASTER % 1000000UL) != 0
+        #error "EdgeLog.h needs f_master to be a whole number of MHz to count microseconds on TIM1."
+    #endif
+    #define EDGE_LOG_TIMESTAMP()    EdgeLogTimestamp()
+    #define EDGE_LOG_TIM1
+#endif
+
+//
+//  One edge.
+//
+typedef struct
+{
+    unsigned char pin;
+    unsigned char level;                    //  Level after the edge.
+    unsigned short time;                    //  EDGE_LOG_TIMESTAMP at the dispatch.
+} EdgeRecord;
+
+static EdgeRecord _edgeLog[EDGE_LOG_SIZE];
+static volatile unsigned char _edgeLogHead;
+static volatile unsigned char _edgeLogTail;
+static volatile unsigned short _edgeLogDropped;
+static unsigned short _edgeLogReported;
+
+#define EdgeLogEmpty()              (_edgeLogHead == _edgeLogTail)
+
+#if defined(EDGE_LOG_TIM1)
+//--------------------------------------------------------------------------------
+//
+//  Current TIM1 count, reading the high byte latches the low byte.
+//
+unsigned short EdgeLogTimestamp()
+{
+    unsigned char high = TIM1_CNTRH;
+    return (unsigned short) ((high << 8) | TIM1_CNTRL);
+}
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  Empty the log and start TIM1 counting microseconds (unless another
+//  timestamp has been given).
+//
+void EdgeLogInitialise()
+{
+    _edgeLogHead = 0;
+    _edgeLogTail = 0;
+    _edgeLogDropped = 0;
+    _edgeLogReported = 0;
+#if defined(EDGE_LOG_TIM1)
+    TIM1_PSCRH = (unsigned char) ((F_MASTER / 1000000UL - 1) >> 8);
+    TIM1_PSCRL = (unsigned char) (F_MASTER / 1000000UL - 1);
+    TIM1_ARRH = 0xff;
+    TIM1_ARRL = 0xff;
+    TIM1_EGR_UG = 1;
+    TIM1_CR1_CEN = 1;
+#endif
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Add a record.
+//
+void EdgeLogPush(unsigned char pin, unsigned char level, unsigned short time)
+{
+    unsigned char head = _edgeLogHead;
+    if ((unsigned char) (head - _edgeLogTail) == EDGE_LOG_SIZE)
+    {
+        _edgeLogDropped++;
+        return;
+    }
+    EdgeRecord *record = &_edgeLog[head & EDGE_LOG_MASK];
+    record->pin = pin;
+    record->level = level;
+    record->time = time;
+    _edgeLogHead = (unsigned char) (head + 1);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Record one port interrupt, called by the dispatcher before the handlers
+//  with the pins which have changed and the input register.
+//
+void EdgeLogInterrupt(unsigned char changed, unsigned char idr, unsigned short time)
+{
+    if (changed == 0)
+    {
+        EdgeLogPush(EDGE_LOG_NO_CHANGE, 0, time);
+        return;
+    }
+    unsigned char mask = 0x01;
+    for (unsigned char pin = 0; changed != 0; pin++, mask <<= 1)
+    {
+        if (changed & mask)
+        {
+            changed &= (unsigned char) ~mask;
+            EdgeLogPush(pin, (idr & mask) ? 1 : 0, time);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Take the oldest record from the log, returns 0 if it is empty.
+//
+unsigned char EdgeLogRead(EdgeRecord *record)
+{
+    unsigned char tail = _edgeLogTail;
+    if (tail == _edgeLogHead)
+    {
+        return 0;
+    }
+    *record = _edgeLog[tail & EDGE_LOG_MASK];
+    _edgeLogTail = (unsigned char) (tail + 1);
+    return 1;
+}
+
+#if defined(UART_PRINT_H)
+//--------------------------------------------------------------------------------
+//
+//  Print the records in the log and the number dropped if it has changed,
+//  returns the number of records printed.
+//
+unsigned char EdgeLogDump()
+{
+    EdgeRecord record;
+    unsigned char printed = 0;
+    while (EdgeLogRead(&record))
+    {
+        if (record.pin == EDGE_LOG_NO_CHANGE)
+        {
+            UARTPrintString("no_change ");
+        }
+        else
+        {
+            UARTPrintValue("pin", record.pin, ' ');
+            UARTPrintValue("level", record.level, ' ');
+        }
+        UARTPrintValue("time", record.time, '\n');
+        printed++;
+    }
+    unsigned short dropped = _edgeLogDropped;
+    if (dropped != _edgeLogReported)
+    {
+        UARTPrintValue("dropped", dropped, '\n');
+        _edgeLogReported = dropped;
+    }
+    return printed;
+}
+#endif
+
+//
+//  Record every interrupt the dispatcher sees.
+//
+#if !defined(PIN_INTERRUPTS_TIMESTAMP)
+    #define PIN_INTERRUPTS_TIMESTAMP()  EDGE_LOG_TIMESTAMP()
+#endif
+#define PIN_INTERRUPTS_EVENT(changed, idr, timestamp)   EdgeLogInterrupt(changed, idr, timestamp)
+
+#endif
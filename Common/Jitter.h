@@ -0,0 +1,218 @@
+//
+//  Jitter measurement of an output using TIM1 input capture.
+//
+//  An output toggled from an interrupt service routine moves with the
+//  interrupt latency, which grows with every other interrupt and critical
+//  section in the program, while an output driven by a timer compare does
+//  not.  To see how much an output moves it is wired to TIM1 channel 3
+//  (as in chapter 23) and every rising edge is captured.  The interval
+//  between edges is compared with the expected interval and the difference
+//  is counted in a histogram:
+//
+//      #include "../Common/UARTPrint.h"
+//      #include "../Common/Jitter.h"
+//
+//      JitterInitialise(800000UL);             //  Rising edges 50 ms apart.
+//      ...
+//      if (_jitterEdges >= 20)
+//      {
+//          JitterReport();
+//          JitterReset();
+//      }
+//
+//  TIM1 counts at f_master and the overflows are counted in its update
+//  interrupt, so the edge times are 32 bit cycle counts and any interval
+//  up to 268 s can be measured to a cycle.  The report is one line:
+//
+//      edges=20 expected=800000 deviation_min=-3 deviation_max=12 histogram=8,2,4,3,2,1,0,0
+//
+//  deviation_xxx is the interval less the expected interval in cycles and
+//  histogram the intervals by the size of the deviation:
+//
+//      bin 0           0 cycles.
+//      bin n           2^(n - 1) to 2^n - 1 cycles.
+//      last bin        2^(JITTER_BINS - 2) cycles or more.
+//
+//  JitterReport is only available when UARTPrint.h is included first.
+//  TIM1 must be clocked and is used for nothing else, its update and
+//  capture / compare interrupts are handled here.
+//
+//      JITTER_BINS             Number of histogram bins (default 8).
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef JITTER_H
+#define JITTER_H
+
+#include <intrinsics.h>
+
+#if !defined(JITTER_BINS)
+    #define JITTER_BINS             8
+#endif
+
+static unsigned long _jitterExpected;
+static volatile unsigned short _jitterOverflows;
+static unsigned long _jitterLast;                               //  Time of the last edge.
+volatile unsigned short _jitterEdges;                           //  Intervals measured.
+volatile long _jitterMinimum;
+volatile long _jitterMaximum;
+volatile unsigned short _jitterHistogram[JITTER_BINS];
+
+//--------------------------------------------------------------------------------
+//
+//  Clear the histogram, the next edge starts the first interval.
+//
+void JitterReset()
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    _jitterEdges = 0;
+    _jitterLast = 0;
+    _jitterMinimum = 0x7fffffffL;
+    _jitterMaximum = -0x7fffffffL;
+    for (unsigned char bin = 0; bin < JITTER_BINS; bin++)
+    {
+        _jitterHistogram[bin] = 0;
+    }
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Start TIM1 counting at f_master and capturing the rising edges on
+//  channel 3, expected is the interval between them in cycles.
+//
+void JitterInitialise(unsigned long expected)
+{
+    _jitterExpected = expected;
+    _jitterOverflows = 0;
+    JitterReset();
+    TIM1_CR1 = 0;
+    TIM1_PSCRH = 0;
+    TIM1_PSCRL = 0;
+    TIM1_ARRH = 0xff;
+    TIM1_ARRL = 0xff;
+    TIM1_CCMR3_CC3S = 1;                //  CC3 captures TI3.
+    TIM1_CCER2_CC3P = 0;                //  Rising edges.
+    TIM1_CCER2_CC3E = 1;
+    TIM1_EGR_UG = 1;
+    TIM1_SR1 = 0;
+    TIM1_IER_UIE = 1;
+    TIM1_IER_CC3IE = 1;
+    TIM1_CR1_CEN = 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Overflow, the top 16 bits of the time.
+//
+#pragma vector = TIM1_OVR_UIF_vector
+__interrupt void TIM1_UPD_OVF_IRQHandler(void)
+{
+    TIM1_SR1_UIF = 0;
+    _jitterOverflows++;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  An edge has been captured.  An overflow which is still pending belongs
+//  to a capture taken after it, those are the small capture values.
+//
+#pragma vector = TIM1_CAPCOM_CC3IF_vector
+__interrupt void TIM1_CAPCOM_IRQHandler(void)
+{
+    unsigned char high = TIM1_CCR3H;
+    unsigned short capture = (unsigned short) ((high << 8) | TIM1_CCR3L);
+    TIM1_SR1_CC3IF = 0;
+    unsigned short overflows = _jitterOverflows;
+    if (TIM1_SR1_UIF && (capture < 0x8000))
+    {
+        overflows++;
+    }
+    unsigned long time = ((unsigned long) overflows << 16) | capture;
+    unsigned long last = _jitterLast;
+    _jitterLast = time;
+    if (last == 0)
+    {
+        return;
+    }
+    long deviation = (long) (time - last - _jitterExpected);
+    if (deviation < _jitterMinimum)
+    {
+        _jitterMinimum = deviation;
+    }
+    if (deviation > _jitterMaximum)
+    {
+        _jitterMaximum = deviation;
+    }
+    unsigned long size = (unsigned long) ((deviation < 0) ? -deviation : deviation);
+    unsigned char bin = 0;
+    while ((size != 0) && (bin < (JITTER_BINS - 1)))
+    {
+        size >>= 1;
+        bin++;
+    }
+    _jitterHistogram[bin]++;
+    _jitterEdges++;
+}
+
+#if defined(UART_PRINT_H)
+//--------------------------------------------------------------------------------
+//
+//  Print a signed number.
+//
+static void JitterPrintSigned(long value)
+{
+    if (value < 0)
+    {
+        UARTPrintChar('-');
+        value = -value;
+    }
+    UARTPrintUnsigned((unsigned long) value);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Print the intervals measured since the last reset.
+//
+void JitterReport()
+{
+    unsigned short histogram[JITTER_BINS];
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    unsigned short edges = _jitterEdges;
+    long minimum = _jitterMinimum;
+    long maximum = _jitterMaximum;
+    for (unsigned char bin = 0; bin < JITTER_BINS; bin++)
+    {
+        histogram[bin] = _jitterHistogram[bin];
+    }
+    __set_interrupt_state(state);
+    if (edges == 0)
+    {
+        minimum = 0;
+        maximum = 0;
+    }
+    UARTPrintValue("edges", edges, ' ');
+    UARTPrintValue("expected", _jitterExpected, ' ');
+    UARTPrintString("deviation_min=");
+    JitterPrintSigned(minimum);
+    UARTPrintString(" deviation_max=");
+    JitterPrintSigned(maximum);
+    UARTPrintString(" histogram=");
+    for (unsigned char bin = 0; bin < JITTER_BINS; bin++)
+    {
+        if (bin != 0)
+        {
+            UARTPrintChar(',');
+        }
+        UARTPrintUnsigned(histogram[bin]);
+    }
+    UARTPrintChar('\n');
+}
+#endif
+
+#endif
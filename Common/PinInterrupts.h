@@ -0,0 +1,181 @@
+//
+//  Per pin handlers for the port external interrupts.
+//
+//  The STM8S has one interrupt vector for each port and one sensitivity
+//  setting (EXTI_CR1_PxIS) for every pin on it, so the service routine
+//  cannot tell from the interrupt which pin changed or in which direction.
+//  The dispatcher reads the input register once, compares it with the
+//  value at the previous interrupt and calls the handler attached to each
+//  pin which has changed, lowest pin first:
+//
+//      PinInterrupts _portB;
+//
+//      void ChipSelect(unsigned char pin, unsigned char level)
+//      {
+//          ...
+//      }
+//
+//      #pragma vector = 6
+//      __interrupt void EXTI_PORTB_IRQHandler(void)
+//      {
+//          PinInterruptsDispatch(&_portB, PB_IDR);
+//      }
+//
+//      PinInterruptsInitialise(&_portB, PB_IDR);
+//      PinInterruptsAttach(&_portB, 0, PIN_BOTH_EDGES, ChipSelect);
+//      PB_CR2_C20 = 1;
+//      EXTI_CR1_PBIS = 3;                          //  Rising and falling edges.
+//
+//  The port must interrupt on both edges (sensitivity 3) so that every
+//  change is seen, the edges each pin is interested in are selected here.
+//  A change after the input register has been read sets the interrupt
+//  pending again and is handled by the next dispatch, but a pulse which
+//  starts and ends before the read (shorter than the interrupt latency)
+//  leaves the register unchanged.  Such interrupts, and those from pins
+//  without a handler, are counted in missed.
+//
+//  Handlers run in the service routine and should be short as each one
+//  delays the pins after it.  Define PIN_INTERRUPTS_MEASURE and
+//  PIN_INTERRUPTS_TIMESTAMP() (an unsigned short from a free running
+//  timer) before including this file to record the longest time from the
+//  start of a dispatch to the call of a handler (longestLatency) and to
+//  the end of the dispatch (longestDispatch).
+//
+//  Define PIN_INTERRUPTS_EVENT(changed, idr, timestamp) as well to be told
+//  of every interrupt before any handler is called, whether or not a pin
+//  with a handler has changed: changed has a bit set for each pin which
+//  differs from the last dispatch (0 for a pulse too short to be seen),
+//  idr is the input register and timestamp is read once at the start of
+//  the dispatch.  EdgeLog.h uses this to record the edges.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef PIN_INTERRUPTS_H
+#define PIN_INTERRUPTS_H
+
+#include <intrinsics.h>
+
+#if defined(PIN_INTERRUPTS_MEASURE) && !defined(PIN_INTERRUPTS_TIMESTAMP)
+    #error "PIN_INTERRUPTS_TIMESTAMP must be defined when using PIN_INTERRUPTS_MEASURE"
+#endif
+#if defined(PIN_INTERRUPTS_EVENT) && !defined(PIN_INTERRUPTS_TIMESTAMP)
+    #error "PIN_INTERRUPTS_TIMESTAMP must be defined when using PIN_INTERRUPTS_EVENT"
+#endif
+
+//
+//  Edges a handler is called for.
+//
+#define PIN_RISING_EDGE             0x01
+#define PIN_FALLING_EDGE            0x02
+#define PIN_BOTH_EDGES              0x03
+
+//
+//  Handler for a pin, level is the new level of the pin (0 or 1).
+//
+typedef void (*PinHandler)(unsigned char pin, unsigned char level);
+
+//
+//  Handlers and state for one port.
+//
+typedef struct
+{
+    unsigned char last;                     //  Input register at the last dispatch.
+    unsigned char rising;                   //  Pins handled on a rising edge.
+    unsigned char falling;                  //  Pins handled on a falling edge.
+    PinHandler handlers[8];
+    unsigned long interrupts;               //  Number of dispatches.
+    unsigned long missed;                   //  Dispatches which called no handler.
+#if defined(PIN_INTERRUPTS_MEASURE)
+    unsigned short longestLatency;          //  Dispatch start to a handler being called.
+    unsigned short longestDispatch;         //  Dispatch start to end.
+#endif
+} PinInterrupts;
+
+//--------------------------------------------------------------------------------
+//
+//  Remove all handlers, idr is the current value of the input register.
+//
+void PinInterruptsInitialise(PinInterrupts *port, unsigned char idr)
+{
+    port->last = idr;
+    port->rising = 0;
+    port->falling = 0;
+    for (unsigned char pin = 0; pin < 8; pin++)
+    {
+        port->handlers[pin] = 0;
+    }
+    port->interrupts = 0;
+    port->missed = 0;
+#if defined(PIN_INTERRUPTS_MEASURE)
+    port->longestLatency = 0;
+    port->longestDispatch = 0;
+#endif
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Call handler when pin changes in the direction(s) given by edges, or
+//  remove the handler if edges is 0.
+//
+void PinInterruptsAttach(PinInterrupts *port, unsigned char pin, unsigned char edges, PinHandler handler)
+{
+    unsigned char mask = (unsigned char) (1 << pin);
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    port->handlers[pin] = handler;
+    port->rising = (edges & PIN_RISING_EDGE) ? (port->rising | mask) : (port->rising & ~mask);
+    port->falling = (edges & PIN_FALLING_EDGE) ? (port->falling | mask) : (port->falling & ~mask);
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Call the handlers for the pins which have changed since the last
+//  dispatch, call this from the port interrupt with the input register.
+//
+void PinInterruptsDispatch(PinInterrupts *port, unsigned char idr)
+{
+#if defined(PIN_INTERRUPTS_MEASURE) || defined(PIN_INTERRUPTS_EVENT)
+    unsigned short start = PIN_INTERRUPTS_TIMESTAMP();
+#endif
+    unsigned char changed = idr ^ port->last;
+    port->last = idr;
+#if defined(PIN_INTERRUPTS_EVENT)
+    PIN_INTERRUPTS_EVENT(changed, idr, start);
+#endif
+    unsigned char pending = (unsigned char) ((changed & idr & port->rising) | (changed & ~idr & port->falling));
+    port->interrupts++;
+    if (pending == 0)
+    {
+        port->missed++;
+        return;
+    }
+    unsigned char mask = 0x01;
+    for (unsigned char pin = 0; pending != 0; pin++, mask <<= 1)
+    {
+        if (pending & mask)
+        {
+            pending &= (unsigned char) ~mask;
+#if defined(PIN_INTERRUPTS_MEASURE)
+            unsigned short latency = (unsigned short) (PIN_INTERRUPTS_TIMESTAMP() - start);
+            if (latency > port->longestLatency)
+            {
+                port->longestLatency = latency;
+            }
+#endif
+            port->handlers[pin](pin, (idr & mask) ? 1 : 0);
+        }
+    }
+#if defined(PIN_INTERRUPTS_MEASURE)
+    unsigned short duration = (unsigned short) (PIN_INTERRUPTS_TIMESTAMP() - start);
+    if (duration > port->longestDispatch)
+    {
+        port->longestDispatch = duration;
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,284 @@
+//
+//  Play a sequence of timed marks and spaces (an IR remote code for
+//  instance) from TIM1, reading the sequence from data EEPROM as it plays.
+//
+//  Each entry of the sequence is three bytes, the length in microseconds
+//  (high byte first) and the level, as written by chapter 17:
+//
+//      0x07, 2000 >> 8, 2000 & 0xff, 1, 27830 >> 8, 27830 & 0xff, 0, ...
+//
+//  TIM1 counts microseconds and one entry is one update event.  The
+//  auto-reload, repetition and compare registers are preloaded, so the
+//  update interrupt at the start of an entry writes the entry after it
+//  and the timer moves from one to the next in hardware, each edge falls
+//  on its count whatever the interrupt latency.  The interrupt reads the
+//  three bytes of one entry in place, so the sequence can be longer than
+//  RAM and costs one short interrupt per entry:
+//
+//      PulseSequenceInitialise(3, 26, 9);      //  Channel 3, 38 kHz carrier.
+//      PulseSequencePlay((unsigned char *) EEPROM_DATA_START + 1, 7);
+//      while (PulseSequencePlaying())
+//      {
+//      }
+//
+//  A mark is a steady high level, or with a carrier carrierPeriod counts
+//  (1 us each) long and high for carrierHigh, a run of carrier cycles from
+//  the same channel.  The carrier period is loaded into the auto-reload
+//  register and the number of cycles in the mark into the repetition
+//  counter so a mark of up to 256 cycles is still one update event, the
+//  mark is rounded to a whole number of cycles.  A longer mark (a 9 ms
+//  leader is 346 cycles of a 26 us carrier) is played as runs of 256
+//  cycles and a last shorter run, one update event each, with no gap
+//  between them.  A 26 us carrier is 38.5 kHz.  The output is low at the
+//  end of the sequence and the counter stops.
+//
+//  Entries are 2 to 65535 us long and the update interrupt must finish
+//  within the shortest.  TIM1 must be clocked and is used for nothing
+//  else, its update interrupt is handled here.  f_master must be a whole
+//  number of MHz.
+//
+//  _pulseSequenceUpdates counts the update interrupts.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef PULSE_SEQUENCE_H
+#define PULSE_SEQUENCE_H
+
+#include <intrinsics.h>
+
+#if !defined(SYSTEM_CLOCK_H)
+    #error "SystemClock.h must be included before PulseSequence.h"
+#endif
+#if (F_MASTER % 1000000UL) != 0
+    #error "PulseSequence.h needs f_master to be a whole number of MHz to count microseconds on TIM1."
+#endif
+
+//
+//  Bytes in one entry and the CCMRx value for PWM mode 1 with preload.
+//
+#define PULSE_SEQUENCE_ENTRY            3
+#define PULSE_SEQUENCE_CCMR_MODE1_PRELOAD   0x68
+
+static unsigned char _pulseSequenceChannel;
+static unsigned char _pulseSequenceCarrierPeriod;
+static unsigned char _pulseSequenceCarrierHigh;
+static const unsigned char *_pulseSequenceNext;                 //  Entry to load next.
+static unsigned short _pulseSequenceRemaining;                  //  Entries still to load.
+static unsigned short _pulseSequenceCycles;                     //  Carrier cycles of the mark still to load.
+static unsigned char _pulseSequenceEnding;                      //  The idle level is loaded.
+static volatile unsigned char _pulseSequencePlaying;
+volatile unsigned long _pulseSequenceUpdates;
+
+#define PulseSequencePlaying()          (_pulseSequencePlaying)
+
+//--------------------------------------------------------------------------------
+//
+//  Write the compare preload register of the channel.
+//
+static void PulseSequenceCompare(unsigned short compare)
+{
+    unsigned char high = (unsigned char) (compare >> 8);
+    unsigned char low = (unsigned char) compare;
+    switch (_pulseSequenceChannel)
+    {
+        case 1:
+            TIM1_CCR1H = high;
+            TIM1_CCR1L = low;
+            break;
+        case 2:
+            TIM1_CCR2H = high;
+            TIM1_CCR2L = low;
+            break;
+        case 3:
+            TIM1_CCR3H = high;
+            TIM1_CCR3L = low;
+            break;
+        case 4:
+            TIM1_CCR4H = high;
+            TIM1_CCR4L = low;
+            break;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Take up to 256 of the carrier cycles still to be loaded, returning the
+//  repetition count for them.
+//
+static unsigned char PulseSequenceRun()
+{
+    unsigned short cycles = _pulseSequenceCycles;
+    if (cycles > 256)
+    {
+        cycles = 256;
+    }
+    _pulseSequenceCycles -= cycles;
+    return (unsigned char) (cycles - 1);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Load the next entry (or the next run of carrier cycles of a long mark)
+//  into the preload registers, or the idle level and a stop at the next
+//  update event when there are none left.
+//
+static void PulseSequenceLoad()
+{
+    if (_pulseSequenceCycles != 0)
+    {
+        TIM1_RCR = PulseSequenceRun();  //  Same carrier, more cycles.
+        return;
+    }
+    if (_pulseSequenceRemaining == 0)
+    {
+        PulseSequenceCompare(0);
+        TIM1_ARRH = 0xff;
+        TIM1_ARRL = 0xff;
+        TIM1_RCR = 0;
+        TIM1_CR1_OPM = 1;
+        _pulseSequenceEnding = 1;
+        return;
+    }
+    const unsigned char *entry = _pulseSequenceNext;
+    unsigned short length = (unsigned short) ((entry[0] << 8) | entry[1]);
+    unsigned short reload = (unsigned short) (length - 1);
+    unsigned short compare = 0;
+    unsigned char repeat = 0;
+    if (entry[2])
+    {
+        compare = 0xffff;
+        if (_pulseSequenceCarrierPeriod != 0)
+        {
+            unsigned short cycles = (unsigned short) ((length + (_pulseSequenceCarrierPeriod >> 1)) / _pulseSequenceCarrierPeriod);
+            if (cycles == 0)
+            {
+                cycles = 1;
+            }
+            _pulseSequenceCycles = cycles;
+            reload = (unsigned short) (_pulseSequenceCarrierPeriod - 1);
+            compare = _pulseSequenceCarrierHigh;
+            repeat = PulseSequenceRun();
+        }
+    }
+    TIM1_ARRH = (unsigned char) (reload >> 8);
+    TIM1_ARRL = (unsigned char) reload;
+    TIM1_RCR = repeat;
+    PulseSequenceCompare(compare);
+    _pulseSequenceNext = entry + PULSE_SEQUENCE_ENTRY;
+    _pulseSequenceRemaining--;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Set up TIM1 counting microseconds with channel (1 to 4) as the output,
+//  low until a sequence is played.  carrierPeriod is 0 for steady marks.
+//
+void PulseSequenceInitialise(unsigned char channel, unsigned char carrierPeriod, unsigned char carrierHigh)
+{
+    _pulseSequenceChannel = channel;
+    _pulseSequenceCarrierPeriod = carrierPeriod;
+    _pulseSequenceCarrierHigh = carrierHigh;
+    _pulseSequenceRemaining = 0;
+    _pulseSequenceCycles = 0;
+    _pulseSequenceEnding = 0;
+    _pulseSequencePlaying = 0;
+    _pulseSequenceUpdates = 0;
+    TIM1_CR1 = 0;                       //  Stopped, up counting, edge aligned.
+    TIM1_CR1_URS = 1;                   //  Only the counter raises UIF.
+    TIM1_PSCRH = (unsigned char) ((F_MASTER / 1000000UL - 1) >> 8);
+    TIM1_PSCRL = (unsigned char) (F_MASTER / 1000000UL - 1);
+    TIM1_ARRH = 0xff;
+    TIM1_ARRL = 0xff;
+    TIM1_RCR = 0;
+    TIM1_CCER1 = 0;
+    TIM1_CCER2 = 0;
+    switch (channel)
+    {
+        case 1:
+            TIM1_CCMR1 = PULSE_SEQUENCE_CCMR_MODE1_PRELOAD;
+            break;
+        case 2:
+            TIM1_CCMR2 = PULSE_SEQUENCE_CCMR_MODE1_PRELOAD;
+            break;
+        case 3:
+            TIM1_CCMR3 = PULSE_SEQUENCE_CCMR_MODE1_PRELOAD;
+            break;
+        case 4:
+            TIM1_CCMR4 = PULSE_SEQUENCE_CCMR_MODE1_PRELOAD;
+            break;
+    }
+    PulseSequenceCompare(0);
+    TIM1_EGR_UG = 1;
+    switch (channel)
+    {
+        case 1:
+            TIM1_CCER1_CC1E = 1;
+            break;
+        case 2:
+            TIM1_CCER1_CC2E = 1;
+            break;
+        case 3:
+            TIM1_CCER2_CC3E = 1;
+            break;
+        case 4:
+            TIM1_CCER2_CC4E = 1;
+            break;
+    }
+    TIM1_CR1_ARPE = 1;
+    TIM1_BKR_MOE = 1;                   //  Enable the main output.
+    TIM1_IER_UIE = 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Play count entries (1 or more) starting at entries, which must stay in
+//  place until the sequence ends.  Returns 0 if a sequence is playing.
+//
+unsigned char PulseSequencePlay(const unsigned char *entries, unsigned short count)
+{
+    if (_pulseSequencePlaying || (count == 0))
+    {
+        return 0;
+    }
+    TIM1_CR1_OPM = 0;
+    _pulseSequenceNext = entries;
+    _pulseSequenceRemaining = count;
+    _pulseSequenceCycles = 0;
+    _pulseSequenceEnding = 0;
+    _pulseSequencePlaying = 1;
+    PulseSequenceLoad();                //  First entry, loaded by UG.
+    //
+    //  The counter is started before UG so that the first entry is loaded
+    //  and counted from the same clock, the idle reload is too long to
+    //  overflow in between.
+    //
+    TIM1_CR1_CEN = 1;
+    TIM1_EGR_UG = 1;
+    PulseSequenceLoad();                //  Second entry, or the end.
+    return 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Update event, the entry loaded last time has started so load the one
+//  after it.  The update event after the idle level is loaded is the end
+//  of the sequence.
+//
+#pragma vector = TIM1_OVR_UIF_vector
+__interrupt void TIM1_UPD_OVF_IRQHandler(void)
+{
+    TIM1_SR1_UIF = 0;
+    _pulseSequenceUpdates++;
+    if (_pulseSequenceEnding)
+    {
+        _pulseSequenceEnding = 0;
+        _pulseSequencePlaying = 0;
+        return;
+    }
+    PulseSequenceLoad();
+}
+
+#endif
@@ -0,0 +1,243 @@
+//
+//  Trains of pulses from TIM1 in one pulse mode with no CPU time per pulse.
+//
+//  Chapter 07 part 1 makes its pulse by toggling a pin from the timer
+//  interrupt, so the edges move with the interrupt latency and each one
+//  costs an interrupt.  Here the pulses come straight from a TIM1 channel
+//  in PWM mode 2: the output is low for the first period - width counts of
+//  each period and high for the last width.  The repetition counter
+//  (TIM1_RCR) holds the update event back until count periods have passed
+//  and one pulse mode (TIM1_CR1_OPM) stops the counter at that update
+//  event, so the timer emits exactly count pulses and stops with the output
+//  low.  Every edge is placed by the counter, one clock apart at most:
+//
+//      PulseTrainInitialise(0, 4);                 //  16 MHz, channel 4.
+//      PulseTrainStart(8, 64, 160);                //  8 x 4 us every 10 us.
+//      while (PulseTrainBusy())
+//      {
+//      }
+//
+//  The first pulse starts period - width counts after the train starts.
+//  width must be less than period (a CCR of 0 would leave the output high)
+//  and count is 1 to 256.  TIM1_IER_UIE can be set for one interrupt at the
+//  end of each train, the update event is only raised by the counter so
+//  PulseTrainArm does not set UIF.
+//
+//  A train can be armed and then started by an edge on the TIM1 channel 1
+//  input (TI1), channel 1 cannot be the output of the train:
+//
+//      PulseTrainArmOnEdge(1, 480, 960, 1);        //  Falling edge.
+//
+//  On the target the timer starts itself in trigger mode (TIM1_SMCR SMS =
+//  110, TS = 101 for TI1FP1), the edge sets CEN after the input
+//  synchronisation so the first pulse follows it by period - width counts
+//  plus a cycle or two whatever the CPU is doing.  The trigger stays set:
+//  an edge while the train runs is ignored and an edge after it has ended
+//  starts the same train again, until PulseTrainArm, PulseTrainStart or
+//  PulseTrainDisarm clears it.
+//
+//  The host simulation does not model the slave mode controller.  There
+//  the train is started from the pin handler PulseTrainEdge attached to the
+//  pin carrying the edge with the dispatcher in PinInterrupts.h, which
+//  behaves the same way but starts the train a port interrupt latency
+//  after the edge.  That latency depends on the instruction being run and
+//  on any other interrupt being served so it is not fixed:
+//
+//      PinInterruptsAttach(&_portD, 3, PIN_FALLING_EDGE, PulseTrainEdge);
+//
+//  TIM1 must be clocked and is used for nothing else.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef PULSE_TRAIN_H
+#define PULSE_TRAIN_H
+
+#include <intrinsics.h>
+
+//
+//  CCMRx for an output in PWM mode 2 (OCxM = 111) with preload (OCxPE).
+//
+#define PULSE_TRAIN_CCMR_MODE2_PRELOAD  0x78
+//
+//  CCMR1 with channel 1 as an input on TI1 (CC1S = 01) and SMCR in trigger
+//  mode (SMS = 110) started by TI1FP1 (TS = 101).
+//
+#define PULSE_TRAIN_CCMR_INPUT_TI1      0x01
+#define PULSE_TRAIN_SMCR_TRIGGER_TI1    0x56
+
+static unsigned char _pulseTrainChannel;
+static volatile unsigned char _pulseTrainArmed;
+
+#define PulseTrainBusy()            (TIM1_CR1_CEN)
+
+//--------------------------------------------------------------------------------
+//
+//  Set up TIM1 counting up at f_master / (prescaler + 1) in one pulse mode
+//  with channel (1 to 4) as the output, low until a train is started.
+//
+void PulseTrainInitialise(unsigned short prescaler, unsigned char channel)
+{
+    _pulseTrainChannel = channel;
+    _pulseTrainArmed = 0;
+    TIM1_CR1 = 0;                       //  Stopped, up counting, edge aligned.
+    TIM1_CR1_URS = 1;                   //  Only the counter raises UIF.
+    TIM1_PSCRH = (unsigned char) (prescaler >> 8);
+    TIM1_PSCRL = (unsigned char) prescaler;
+    TIM1_ARRH = 0xff;
+    TIM1_ARRL = 0xff;
+    TIM1_CCER1 = 0;
+    TIM1_CCER2 = 0;
+    //
+    //  A compare value above the counter holds the output low until the
+    //  first train is armed.
+    //
+    switch (channel)
+    {
+        case 1:
+            TIM1_CCMR1 = PULSE_TRAIN_CCMR_MODE2_PRELOAD;
+            TIM1_CCR1H = 0xff;
+            TIM1_CCR1L = 0xff;
+            break;
+        case 2:
+            TIM1_CCMR2 = PULSE_TRAIN_CCMR_MODE2_PRELOAD;
+            TIM1_CCR2H = 0xff;
+            TIM1_CCR2L = 0xff;
+            break;
+        case 3:
+            TIM1_CCMR3 = PULSE_TRAIN_CCMR_MODE2_PRELOAD;
+            TIM1_CCR3H = 0xff;
+            TIM1_CCR3L = 0xff;
+            break;
+        case 4:
+            TIM1_CCMR4 = PULSE_TRAIN_CCMR_MODE2_PRELOAD;
+            TIM1_CCR4H = 0xff;
+            TIM1_CCR4L = 0xff;
+            break;
+    }
+    TIM1_EGR_UG = 1;
+    switch (channel)
+    {
+        case 1:
+            TIM1_CCER1_CC1E = 1;
+            break;
+        case 2:
+            TIM1_CCER1_CC2E = 1;
+            break;
+        case 3:
+            TIM1_CCER2_CC3E = 1;
+            break;
+        case 4:
+            TIM1_CCER2_CC4E = 1;
+            break;
+    }
+    TIM1_CR1_ARPE = 1;
+    TIM1_CR1_OPM = 1;                   //  Stop at the update event.
+    TIM1_BKR_MOE = 1;                   //  Enable the main output.
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Load a train of count pulses of width counts every period counts, it
+//  starts when PulseTrainFire is called.  Any train still running is
+//  stopped and any edge trigger cleared.
+//
+void PulseTrainArm(unsigned short count, unsigned short width, unsigned short period)
+{
+    unsigned short reload = (unsigned short) (period - 1);
+    unsigned short compare = (unsigned short) (period - width);
+    TIM1_CR1_CEN = 0;
+    TIM1_SMCR = 0;
+    _pulseTrainArmed = 0;
+    TIM1_ARRH = (unsigned char) (reload >> 8);
+    TIM1_ARRL = (unsigned char) reload;
+    TIM1_RCR = (unsigned char) (count - 1);
+    switch (_pulseTrainChannel)
+    {
+        case 1:
+            TIM1_CCR1H = (unsigned char) (compare >> 8);
+            TIM1_CCR1L = (unsigned char) compare;
+            break;
+        case 2:
+            TIM1_CCR2H = (unsigned char) (compare >> 8);
+            TIM1_CCR2L = (unsigned char) compare;
+            break;
+        case 3:
+            TIM1_CCR3H = (unsigned char) (compare >> 8);
+            TIM1_CCR3L = (unsigned char) compare;
+            break;
+        case 4:
+            TIM1_CCR4H = (unsigned char) (compare >> 8);
+            TIM1_CCR4L = (unsigned char) compare;
+            break;
+    }
+    TIM1_EGR_UG = 1;                    //  Load ARR, CCR and RCR and clear the counter.
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Start the armed train.
+//
+void PulseTrainFire()
+{
+    TIM1_CR1_CEN = 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Load a train which starts on the next falling (falling = 1) or rising
+//  edge on TI1, and again on each edge after it has ended.
+//
+void PulseTrainArmOnEdge(unsigned short count, unsigned short width, unsigned short period, unsigned char falling)
+{
+    PulseTrainArm(count, width, period);
+#if defined(STM8S_HOST_H)
+    (void) falling;
+    _pulseTrainArmed = 1;
+#else
+    TIM1_CCMR1 = PULSE_TRAIN_CCMR_INPUT_TI1;
+    TIM1_CCER1_CC1P = falling;
+    TIM1_SMCR = PULSE_TRAIN_SMCR_TRIGGER_TI1;
+#endif
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Stop edges starting the train.
+//
+void PulseTrainDisarm()
+{
+    TIM1_SMCR = 0;
+    _pulseTrainArmed = 0;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Load and start a train of count pulses.
+//
+void PulseTrainStart(unsigned short count, unsigned short width, unsigned short period)
+{
+    PulseTrainArm(count, width, period);
+    PulseTrainFire();
+}
+
+#if defined(STM8S_HOST_H)
+//--------------------------------------------------------------------------------
+//
+//  Pin handler (PinInterrupts.h) standing in for the trigger on the host,
+//  starts a train armed by PulseTrainArmOnEdge unless it is running.
+//
+void PulseTrainEdge(unsigned char pin, unsigned char level)
+{
+    (void) pin;
+    (void) level;
+    if (_pulseTrainArmed && !PulseTrainBusy())
+    {
+        PulseTrainFire();
+    }
+}
+#endif
+
+#endif
@@ -0,0 +1,259 @@
+//
+//  Multi-channel PWM on TIM1 (channels 1 to 4) and TIM2 (channels 1 to 3)
+//  with glitch free duty and period changes.
+//
+//  Writing a new duty straight into the compare register while the timer
+//  is running can cut a period short or stretch it: the output follows the
+//  new value part way through a period, and the two bytes of a 16 bit
+//  register are written one after the other.  Stopping the timer while
+//  writing (TIM1_CR1_CEN = 0 / 1) avoids this but stretches the period in
+//  which it happens.
+//
+//  Here every channel is in PWM mode 1 with its compare preload enabled
+//  (OCxPE) and the auto-reload is preloaded (ARPE), so writes go to the
+//  preload registers and reach the counter only at the update event at the
+//  end of a period.  A group of writes is bracketed by Begin and End which
+//  set update disable (UDIS) while the registers are written, an overflow
+//  in the middle of the group reloads the counter but keeps the old duty
+//  and period.  Every change in the group takes effect together at the
+//  first update event after End:
+//
+//      PwmTimer1Initialise(0, 1024, PWM_CHANNEL(1) | PWM_CHANNEL(4));
+//
+//      PwmTimer1Begin();
+//      PwmTimer1Duty(1, 100);
+//      PwmTimer1Duty(4, 900);
+//      PwmTimer1End();
+//
+//  period is the number of counts in a period (2 to 65536) and duty the
+//  number of counts the output is high from the start of the period, 0 is
+//  always low and period or more always high.  The timer must be clocked.
+//  While a group is being written no update interrupt is raised (UIF is
+//  not set) so keep groups short when the update interrupt is used.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef PWM_H
+#define PWM_H
+
+//
+//  Channel n as a bit mask for the channels parameter.
+//
+#define PWM_CHANNEL(n)              ((unsigned char) (1 << ((n) - 1)))
+
+//
+//  CCMRx for an output in PWM mode 1 (OCxM = 110) with preload (OCxPE).
+//
+#define PWM_CCMR_MODE1_PRELOAD      0x68
+
+//
+//  Capture / compare enable bits in CCERx for the odd and even channels.
+//
+#define PWM_CCER_ODD                0x01
+#define PWM_CCER_EVEN               0x10
+
+//--------------------------------------------------------------------------------
+//
+//  Start TIM1 counting up at f_master / (prescaler + 1) with a period of
+//  period counts and the channels (PWM_CHANNEL) output with a duty of 0.
+//
+void PwmTimer1Initialise(unsigned short prescaler, unsigned long period, unsigned char channels)
+{
+    unsigned short reload = (unsigned short) (period - 1);
+    TIM1_CR1 = 0;                       //  Stopped, up counting, edge aligned.
+    TIM1_PSCRH = (unsigned char) (prescaler >> 8);
+    TIM1_PSCRL = (unsigned char) prescaler;
+    TIM1_ARRH = (unsigned char) (reload >> 8);
+    TIM1_ARRL = (unsigned char) reload;
+    TIM1_RCR = 0;
+    TIM1_CCER1 = 0;
+    TIM1_CCER2 = 0;
+    if (channels & PWM_CHANNEL(1))
+    {
+        TIM1_CCMR1 = PWM_CCMR_MODE1_PRELOAD;
+        TIM1_CCR1H = 0;
+        TIM1_CCR1L = 0;
+        TIM1_CCER1 |= PWM_CCER_ODD;
+    }
+    if (channels & PWM_CHANNEL(2))
+    {
+        TIM1_CCMR2 = PWM_CCMR_MODE1_PRELOAD;
+        TIM1_CCR2H = 0;
+        TIM1_CCR2L = 0;
+        TIM1_CCER1 |= PWM_CCER_EVEN;
+    }
+    if (channels & PWM_CHANNEL(3))
+    {
+        TIM1_CCMR3 = PWM_CCMR_MODE1_PRELOAD;
+        TIM1_CCR3H = 0;
+        TIM1_CCR3L = 0;
+        TIM1_CCER2 |= PWM_CCER_ODD;
+    }
+    if (channels & PWM_CHANNEL(4))
+    {
+        TIM1_CCMR4 = PWM_CCMR_MODE1_PRELOAD;
+        TIM1_CCR4H = 0;
+        TIM1_CCR4L = 0;
+        TIM1_CCER2 |= PWM_CCER_EVEN;
+    }
+    TIM1_BKR_MOE = 1;                   //  Enable the main output.
+    TIM1_CR1_ARPE = 1;
+    TIM1_EGR_UG = 1;                    //  Load the shadow registers.
+    TIM1_CR1_CEN = 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Hold the TIM1 shadow registers while a group of changes is written.
+//
+void PwmTimer1Begin()
+{
+    TIM1_CR1_UDIS = 1;
+}
+
+//
+//  Release the group, it takes effect at the next update event.
+//
+void PwmTimer1End()
+{
+    TIM1_CR1_UDIS = 0;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Set the duty of a TIM1 channel (1 to 4) in counts.
+//
+void PwmTimer1Duty(unsigned char channel, unsigned short duty)
+{
+    unsigned char high = (unsigned char) (duty >> 8);
+    unsigned char low = (unsigned char) duty;
+    switch (channel)
+    {
+        case 1:
+            TIM1_CCR1H = high;
+            TIM1_CCR1L = low;
+            break;
+        case 2:
+            TIM1_CCR2H = high;
+            TIM1_CCR2L = low;
+            break;
+        case 3:
+            TIM1_CCR3H = high;
+            TIM1_CCR3L = low;
+            break;
+        case 4:
+            TIM1_CCR4H = high;
+            TIM1_CCR4L = low;
+            break;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Set the TIM1 period in counts.
+//
+void PwmTimer1Period(unsigned long period)
+{
+    unsigned short reload = (unsigned short) (period - 1);
+    TIM1_ARRH = (unsigned char) (reload >> 8);
+    TIM1_ARRL = (unsigned char) reload;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Start TIM2 counting at f_master / 2^prescaler (prescaler 0 to 15) with
+//  a period of period counts and the channels (PWM_CHANNEL) output with a
+//  duty of 0.
+//
+void PwmTimer2Initialise(unsigned char prescaler, unsigned long period, unsigned char channels)
+{
+    unsigned short reload = (unsigned short) (period - 1);
+    TIM2_CR1 = 0;
+    TIM2_PSCR = prescaler;
+    TIM2_ARRH = (unsigned char) (reload >> 8);
+    TIM2_ARRL = (unsigned char) reload;
+    TIM2_CCER1 = 0;
+    TIM2_CCER2 = 0;
+    if (channels & PWM_CHANNEL(1))
+    {
+        TIM2_CCMR1 = PWM_CCMR_MODE1_PRELOAD;
+        TIM2_CCR1H = 0;
+        TIM2_CCR1L = 0;
+        TIM2_CCER1 |= PWM_CCER_ODD;
+    }
+    if (channels & PWM_CHANNEL(2))
+    {
+        TIM2_CCMR2 = PWM_CCMR_MODE1_PRELOAD;
+        TIM2_CCR2H = 0;
+        TIM2_CCR2L = 0;
+        TIM2_CCER1 |= PWM_CCER_EVEN;
+    }
+    if (channels & PWM_CHANNEL(3))
+    {
+        TIM2_CCMR3 = PWM_CCMR_MODE1_PRELOAD;
+        TIM2_CCR3H = 0;
+        TIM2_CCR3L = 0;
+        TIM2_CCER2 |= PWM_CCER_ODD;
+    }
+    TIM2_CR1_ARPE = 1;
+    TIM2_EGR_UG = 1;                    //  Load the shadow registers.
+    TIM2_CR1_CEN = 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Hold the TIM2 shadow registers while a group of changes is written.
+//
+void PwmTimer2Begin()
+{
+    TIM2_CR1_UDIS = 1;
+}
+
+//
+//  Release the group, it takes effect at the next update event.
+//
+void PwmTimer2End()
+{
+    TIM2_CR1_UDIS = 0;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Set the duty of a TIM2 channel (1 to 3) in counts.
+//
+void PwmTimer2Duty(unsigned char channel, unsigned short duty)
+{
+    unsigned char high = (unsigned char) (duty >> 8);
+    unsigned char low = (unsigned char) duty;
+    switch (channel)
+    {
+        case 1:
+            TIM2_CCR1H = high;
+            TIM2_CCR1L = low;
+            break;
+        case 2:
+            TIM2_CCR2H = high;
+            TIM2_CCR2L = low;
+            break;
+        case 3:
+            TIM2_CCR3H = high;
+            TIM2_CCR3L = low;
+            break;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Set the TIM2 period in counts.
+//
+void PwmTimer2Period(unsigned long period)
+{
+    unsigned short reload = (unsigned short) (period - 1);
+    TIM2_ARRH = (unsigned char) (reload >> 8);
+    TIM2_ARRL = (unsigned char) reload;
+}
+
+#endif
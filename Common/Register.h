@@ -0,0 +1,243 @@
+//
+//  Register access through C++ templates with the address known at
+//  compile time.
+//
+//  The bit field macros in the device headers (TIM2_CCMR1_OC1M and so on)
+//  write one field at a time, each a separate read-modify-write of the
+//  register.  Here a register is a type, Register<address>, and a field a
+//  type within it, Field<register, shift, width>.  Nothing is stored and
+//  every function is a static inline, so a read or write of a field is
+//  the same single access as the macro.  Writes to several fields of one
+//  register are merged at compile time:
+//
+//      TIM2::CCMR1::Set<TIM2::CCMR1::OC1M::Is<6>, TIM2::CCMR1::OC1PE::Is<1> >();
+//
+//  becomes one read, one AND and OR with constants and one write.  Set
+//  picks the cheapest form for the merged mask and value:
+//
+//      All eight bits              A single store of the value.
+//      One or two one bit fields   BSET / BRES for each field in turn.
+//      Every field bit set         OR with the mask.
+//      Every field bit clear       AND with the inverted mask.
+//      Anything else               Read, AND, OR and write.
+//
+//  The forms are chosen to need no more accesses than the field by field
+//  macro writes; the code size has not been measured against them with
+//  the target compilers.  The fields change together in one store rather than one after another,
+//  fields which must change in a particular order need separate calls.
+//  Assign writes the merged value with every other bit cleared.  Fields of
+//  another register and fields which overlap are rejected at compile time.
+//
+//  RegisterPair writes the 16 bit timer registers high byte first as the
+//  timers require.  Register addresses for the peripherals used by the
+//  chapters are in RegisterMap.h.
+//
+//  This needs a C++11 compiler.  On the host the accesses go through the
+//  simulated registers (stm8s_host.h must be included first).
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef REGISTER_H
+#define REGISTER_H
+
+#if !defined(__cplusplus)
+    #error "Register.h is C++, compile the program as C++."
+#endif
+
+//
+//  The register at an address as an lvalue, the address need not be a
+//  constant.
+//
+#if defined(STM8S_HOST_H)
+    #define REGISTER_ACCESS(address)    STM8_REGISTER(address)
+#else
+    #define REGISTER_ACCESS(address)    (*(volatile unsigned char *) (address))
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  Combined mask and value of a list of field values (Field::Is), checked
+//  to be in the same register and not to overlap.  bitFields counts the
+//  values if they are all one bit wide and is 0 otherwise.
+//
+template<typename... Values>
+struct RegisterMerge;
+
+template<typename Value>
+struct RegisterMerge<Value>
+{
+    static const unsigned short address = Value::address;
+    static const unsigned char mask = Value::mask;
+    static const unsigned char value = Value::value;
+    static const unsigned char bitFields = (Value::width == 1) ? 1 : 0;
+};
+
+template<typename Value, typename... Rest>
+struct RegisterMerge<Value, Rest...>
+{
+    typedef RegisterMerge<Rest...> Tail;
+    static_assert(Value::address == Tail::address, "The fields are in different registers.");
+    static_assert((Value::mask & Tail::mask) == 0, "The fields overlap.");
+    static const unsigned short address = Value::address;
+    static const unsigned char mask = (unsigned char) (Value::mask | Tail::mask);
+    static const unsigned char value = (unsigned char) (Value::value | Tail::value);
+    static const unsigned char bitFields = ((Value::width == 1) && (Tail::bitFields != 0)) ? (unsigned char) (Tail::bitFields + 1) : 0;
+};
+
+//--------------------------------------------------------------------------------
+//
+//  Set or clear one bit field after another, the order they are listed.
+//
+template<typename... Values>
+struct RegisterEachBit
+{
+    static void Write()
+    {
+    }
+};
+
+template<typename Value, typename... Rest>
+struct RegisterEachBit<Value, Rest...>
+{
+    static void Write()
+    {
+        if (Value::value)
+        {
+            REGISTER_ACCESS(Value::address) |= Value::mask;
+        }
+        else
+        {
+            REGISTER_ACCESS(Value::address) &= (unsigned char) ~Value::mask;
+        }
+        RegisterEachBit<Rest...>::Write();
+    }
+};
+
+//--------------------------------------------------------------------------------
+//
+//  An 8 bit register.
+//
+template<unsigned short Address>
+struct Register
+{
+    static const unsigned short address = Address;
+
+    static unsigned char Read()
+    {
+        return REGISTER_ACCESS(Address);
+    }
+
+    static void Write(unsigned char value)
+    {
+        REGISTER_ACCESS(Address) = value;
+    }
+
+    //
+    //  Write the fields listed leaving the other bits unchanged.
+    //
+    template<typename... Values>
+    static void Set()
+    {
+        typedef RegisterMerge<Values...> Merged;
+        static_assert(Merged::address == Address, "The fields are not in this register.");
+        if (Merged::mask == 0xff)
+        {
+            Write(Merged::value);
+        }
+        else if ((Merged::bitFields != 0) && (Merged::bitFields <= 2))
+        {
+            RegisterEachBit<Values...>::Write();
+        }
+        else if (Merged::value == Merged::mask)
+        {
+            REGISTER_ACCESS(Address) |= Merged::mask;
+        }
+        else if (Merged::value == 0)
+        {
+            REGISTER_ACCESS(Address) &= (unsigned char) ~Merged::mask;
+        }
+        else
+        {
+            Write((unsigned char) ((Read() & (unsigned char) ~Merged::mask) | Merged::value));
+        }
+    }
+
+    //
+    //  Write the fields listed and clear every other bit.
+    //
+    template<typename... Values>
+    static void Assign()
+    {
+        typedef RegisterMerge<Values...> Merged;
+        static_assert(Merged::address == Address, "The fields are not in this register.");
+        Write(Merged::value);
+    }
+};
+
+//--------------------------------------------------------------------------------
+//
+//  A field of Width bits starting at bit Shift of the register Owner.
+//  Is<value> is the field holding a constant, for Register::Set.
+//
+template<typename Owner, unsigned char Shift, unsigned char Width = 1>
+struct Field
+{
+    static_assert((Width > 0) && (Shift + Width <= 8), "The field does not fit in the register.");
+    static const unsigned char mask = (unsigned char) (((1U << Width) - 1) << Shift);
+
+    static unsigned char Read()
+    {
+        return (unsigned char) ((Owner::Read() & mask) >> Shift);
+    }
+
+    static void Write(unsigned char value)
+    {
+        Owner::Write((unsigned char) ((Owner::Read() & (unsigned char) ~mask) | ((value << Shift) & mask)));
+    }
+
+    template<unsigned char Value>
+    struct Is
+    {
+        static_assert(Value < (1U << Width), "The value does not fit in the field.");
+        static const unsigned short address = Owner::address;
+        static const unsigned char width = Width;
+        static const unsigned char mask = Field::mask;
+        static const unsigned char value = (unsigned char) (Value << Shift);
+    };
+
+    template<unsigned char Value>
+    static void Set()
+    {
+        Owner::template Set<Is<Value> >();
+    }
+};
+
+//--------------------------------------------------------------------------------
+//
+//  A 16 bit timer register held as two bytes, high byte at HighAddress.
+//  The high byte is written first (it is buffered until the low byte is
+//  written) and read first (reading it latches the low byte).
+//
+template<unsigned short HighAddress>
+struct RegisterPair
+{
+    typedef Register<HighAddress> High;
+    typedef Register<HighAddress + 1> Low;
+
+    static unsigned short Read()
+    {
+        unsigned char high = High::Read();
+        return (unsigned short) ((high << 8) | Low::Read());
+    }
+
+    static void Write(unsigned short value)
+    {
+        High::Write((unsigned char) (value >> 8));
+        Low::Write((unsigned char) value);
+    }
+};
+
+#endif
@@ -0,0 +1,212 @@
+//
+//  Registers and fields of the STM8S peripherals used by chapters 5 to 9
+//  for the templates in Register.h.
+//
+//  Each peripheral is a namespace holding its registers, each register a
+//  type holding its fields, named as in the reference manual:
+//
+//      TIM2::CR1::CEN::Set<1>();                   //  TIM2_CR1_CEN = 1;
+//      PD::DDR::Pin<4>::Set<1>();                  //  PD_DDR_DDR4 = 1;
+//      TIM1::ARR::Write(960);                      //  TIM1_ARRH, TIM1_ARRL.
+//
+//  TIM2 is at different addresses in the low density (STM8S103) and the
+//  medium density (STM8S105, DISCOVERY) devices.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef REGISTER_MAP_H
+#define REGISTER_MAP_H
+
+#include "Register.h"
+
+//--------------------------------------------------------------------------------
+//
+//  GPIO ports, Pin<n> is bit n of the register.
+//
+template<unsigned short Base>
+struct Port
+{
+    struct ODR : Register<Base>
+    {
+        template<unsigned char N> struct Pin : Field<ODR, N> {};
+    };
+    struct IDR : Register<Base + 1>
+    {
+        template<unsigned char N> struct Pin : Field<IDR, N> {};
+    };
+    struct DDR : Register<Base + 2>
+    {
+        template<unsigned char N> struct Pin : Field<DDR, N> {};
+    };
+    struct CR1 : Register<Base + 3>
+    {
+        template<unsigned char N> struct Pin : Field<CR1, N> {};
+    };
+    struct CR2 : Register<Base + 4>
+    {
+        template<unsigned char N> struct Pin : Field<CR2, N> {};
+    };
+};
+
+typedef Port<0x5000> PA;
+typedef Port<0x5005> PB;
+typedef Port<0x500a> PC;
+typedef Port<0x500f> PD;
+
+//--------------------------------------------------------------------------------
+//
+//  Timer 1, the advanced control timer (channel 4 only).
+//
+namespace TIM1
+{
+    struct CR1 : Register<0x5250>
+    {
+        typedef Field<CR1, 0> CEN;
+        typedef Field<CR1, 1> UDIS;
+        typedef Field<CR1, 2> URS;
+        typedef Field<CR1, 3> OPM;
+        typedef Field<CR1, 4> DIR;
+        typedef Field<CR1, 5, 2> CMS;
+        typedef Field<CR1, 7> ARPE;
+    };
+    struct IER : Register<0x5254>
+    {
+        typedef Field<IER, 0> UIE;
+        typedef Field<IER, 4> CC4IE;
+    };
+    struct SR1 : Register<0x5255>
+    {
+        typedef Field<SR1, 0> UIF;
+        typedef Field<SR1, 4> CC4IF;
+    };
+    struct EGR : Register<0x5257>
+    {
+        typedef Field<EGR, 0> UG;
+        typedef Field<EGR, 4> CC4G;
+    };
+    struct CCMR4 : Register<0x525b>
+    {
+        typedef Field<CCMR4, 0, 2> CC4S;
+        typedef Field<CCMR4, 2> OC4FE;
+        typedef Field<CCMR4, 3> OC4PE;
+        typedef Field<CCMR4, 4, 3> OC4M;
+        typedef Field<CCMR4, 7> OC4CE;
+    };
+    struct CCER2 : Register<0x525d>
+    {
+        typedef Field<CCER2, 4> CC4E;
+        typedef Field<CCER2, 5> CC4P;
+    };
+    typedef RegisterPair<0x525e> CNTR;
+    typedef RegisterPair<0x5260> PSCR;
+    typedef RegisterPair<0x5262> ARR;
+    typedef Register<0x5264> RCR;
+    typedef RegisterPair<0x526b> CCR4;
+    struct BKR : Register<0x526d>
+    {
+        typedef Field<BKR, 0, 2> LOCK;
+        typedef Field<BKR, 2> OSSI;
+        typedef Field<BKR, 3> OSSR;
+        typedef Field<BKR, 4> BKE;
+        typedef Field<BKR, 5> BKP;
+        typedef Field<BKR, 6> AOE;
+        typedef Field<BKR, 7> MOE;
+    };
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Timer 2, general purpose timer (channel 1 only).
+//
+#if defined DISCOVERY
+    #define REGISTER_MAP_TIM2_OFFSET    0
+#else
+    #define REGISTER_MAP_TIM2_OFFSET    2           //  TIM2_CR2 and TIM2_SMCR on the STM8S103.
+#endif
+
+namespace TIM2
+{
+    struct CR1 : Register<0x5300>
+    {
+        typedef Field<CR1, 0> CEN;
+        typedef Field<CR1, 1> UDIS;
+        typedef Field<CR1, 2> URS;
+        typedef Field<CR1, 3> OPM;
+        typedef Field<CR1, 7> ARPE;
+    };
+    struct IER : Register<0x5301 + REGISTER_MAP_TIM2_OFFSET>
+    {
+        typedef Field<IER, 0> UIE;
+        typedef Field<IER, 1> CC1IE;
+    };
+    struct SR1 : Register<0x5302 + REGISTER_MAP_TIM2_OFFSET>
+    {
+        typedef Field<SR1, 0> UIF;
+        typedef Field<SR1, 1> CC1IF;
+    };
+    struct EGR : Register<0x5304 + REGISTER_MAP_TIM2_OFFSET>
+    {
+        typedef Field<EGR, 0> UG;
+        typedef Field<EGR, 1> CC1G;
+    };
+    struct CCMR1 : Register<0x5305 + REGISTER_MAP_TIM2_OFFSET>
+    {
+        typedef Field<CCMR1, 0, 2> CC1S;
+        typedef Field<CCMR1, 2> OC1FE;
+        typedef Field<CCMR1, 3> OC1PE;
+        typedef Field<CCMR1, 4, 3> OC1M;
+    };
+    struct CCER1 : Register<0x5308 + REGISTER_MAP_TIM2_OFFSET>
+    {
+        typedef Field<CCER1, 0> CC1E;
+        typedef Field<CCER1, 1> CC1P;
+        typedef Field<CCER1, 4> CC2E;
+        typedef Field<CCER1, 5> CC2P;
+    };
+    typedef RegisterPair<0x530a + REGISTER_MAP_TIM2_OFFSET> CNTR;
+    struct PSCR : Register<0x530c + REGISTER_MAP_TIM2_OFFSET>
+    {
+        typedef Field<PSCR, 0, 4> PSC;
+    };
+    typedef RegisterPair<0x530d + REGISTER_MAP_TIM2_OFFSET> ARR;
+    typedef RegisterPair<0x530f + REGISTER_MAP_TIM2_OFFSET> CCR1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Analogue to digital converter.
+//
+namespace ADC
+{
+    struct CSR : Register<0x5400>
+    {
+        typedef Field<CSR, 0, 4> CH;
+        typedef Field<CSR, 4> AWDIE;
+        typedef Field<CSR, 5> EOCIE;
+        typedef Field<CSR, 6> AWD;
+        typedef Field<CSR, 7> EOC;
+    };
+    struct CR1 : Register<0x5401>
+    {
+        typedef Field<CR1, 0> ADON;
+        typedef Field<CR1, 1> CONT;
+        typedef Field<CR1, 4, 3> SPSEL;
+    };
+    struct CR2 : Register<0x5402>
+    {
+        typedef Field<CR2, 1> SCAN;
+        typedef Field<CR2, 3> ALIGN;
+        typedef Field<CR2, 4, 2> EXTSEL;
+        typedef Field<CR2, 6> EXTTRIG;
+    };
+    struct CR3 : Register<0x5403>
+    {
+        typedef Field<CR3, 6> OVR;
+        typedef Field<CR3, 7> DBUF;
+    };
+}
+
+#endif
@@ -0,0 +1,247 @@
+//
+//  Cooperative run to completion task scheduler.
+//
+//  Interrupt service routines post small events (a byte) to tasks instead
+//  of setting a global status for the main loop to poll.  Each task has
+//  its own queue so events arriving between two wakeups are all kept and
+//  handled in the order they arrived.  The scheduler calls the handler of
+//  the highest priority task with an event waiting, one event per call,
+//  and only waits for an interrupt when every queue is empty:
+//
+//      Task _receiver;
+//
+//      void Receive(unsigned char event)
+//      {
+//          ...
+//      }
+//
+//      __interrupt void SPI_IRQHandler(void)
+//      {
+//          ...
+//          SchedulerPost(&_receiver, EVENT_RX_BUFFER_FULL);
+//      }
+//
+//      SchedulerAddTask(&_receiver, 0, Receive);
+//      while (1)
+//      {
+//          if (SchedulerDispatch() == 0)
+//          {
+//              SchedulerIdle();
+//          }
+//      }
+//
+//  Handlers run to completion with interrupts enabled, a long handler
+//  delays the lower priority tasks but not the interrupts which feed them.
+//  After each handler the scheduler looks again from the highest priority
+//  so an event posted to a higher priority task runs next.
+//
+//  The queues are lock free ring buffers.  head is only written by the
+//  producer and tail only by the scheduler, both are single bytes and
+//  the event is stored before head is moved, so posting needs no critical
+//  section.  This relies on there being one producer for each task at a
+//  time: producers which can interrupt one another (the main loop and an
+//  interrupt service routine, or interrupts at different software
+//  priorities) must not post to the same task.  A full queue drops the
+//  event and counts it in dropped.
+//
+//      SCHEDULER_TASKS         Maximum number of tasks (default 4).
+//      SCHEDULER_QUEUE_SIZE    Events per queue, a power of two up to 128
+//                              (default 8).
+//
+//  Each task counts the events it has handled (runs) and records the
+//  deepest its queue has been (deepest).  Define SCHEDULER_MEASURE and
+//  SCHEDULER_TIMESTAMP() (an unsigned short from a free running timer)
+//  before including this file to also record the time spent in each
+//  handler (runTime and longestRun) and waiting for interrupts
+//  (_schedulerIdleTime), all in timestamp units.  A single handler or
+//  wait must be shorter than 65536 units to be measured correctly.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <intrinsics.h>
+
+#if defined(SCHEDULER_MEASURE) && !defined(SCHEDULER_TIMESTAMP)
+    #error "SCHEDULER_TIMESTAMP must be defined when using SCHEDULER_MEASURE"
+#endif
+
+#if !defined(SCHEDULER_TASKS)
+    #define SCHEDULER_TASKS         4
+#endif
+#if !defined(SCHEDULER_QUEUE_SIZE)
+    #define SCHEDULER_QUEUE_SIZE    8
+#endif
+#if (SCHEDULER_QUEUE_SIZE > 128) || ((SCHEDULER_QUEUE_SIZE & (SCHEDULER_QUEUE_SIZE - 1)) != 0)
+    #error "SCHEDULER_QUEUE_SIZE must be a power of two no larger than 128."
+#endif
+#define SCHEDULER_QUEUE_MASK        (SCHEDULER_QUEUE_SIZE - 1)
+
+typedef void (*TaskHandler)(unsigned char event);
+
+//
+//  A task and its event queue.  head and tail count events in and out and
+//  are only reduced to an index into events when it is accessed.
+//
+typedef struct
+{
+    TaskHandler handler;
+    unsigned char priority;                 //  0 is the highest priority.
+    volatile unsigned char head;            //  Events posted, written by the producer.
+    volatile unsigned char tail;            //  Events taken, written by the scheduler.
+    volatile unsigned char events[SCHEDULER_QUEUE_SIZE];
+    unsigned char deepest;                  //  Most events waiting at one time.
+    unsigned short dropped;                 //  Events lost because the queue was full.
+    unsigned long runs;                     //  Events handled.
+#if defined(SCHEDULER_MEASURE)
+    unsigned long runTime;                  //  Total time in the handler.
+    unsigned short longestRun;              //  Longest single call of the handler.
+#endif
+} Task;
+
+//
+//  Tasks in order of priority and the number of times the scheduler has
+//  waited for an interrupt.
+//
+static Task *_schedulerTasks[SCHEDULER_TASKS];
+static unsigned char _schedulerTaskCount;
+static unsigned long _schedulerSleeps;
+#if defined(SCHEDULER_MEASURE)
+static unsigned long _schedulerIdleTime;
+#endif
+
+#define SchedulerQueueDepth(task)   ((unsigned char) ((task)->head - (task)->tail))
+
+//--------------------------------------------------------------------------------
+//
+//  Add a task, tasks with the same priority are served in the order they
+//  were added.  Returns 0 if there is no room for the task.  Tasks should
+//  be added before the interrupts which post to them are enabled.
+//
+unsigned char SchedulerAddTask(Task *task, unsigned char priority, TaskHandler handler)
+{
+    if (_schedulerTaskCount == SCHEDULER_TASKS)
+    {
+        return 0;
+    }
+    task->handler = handler;
+    task->priority = priority;
+    task->head = 0;
+    task->tail = 0;
+    task->deepest = 0;
+    task->dropped = 0;
+    task->runs = 0;
+#if defined(SCHEDULER_MEASURE)
+    task->runTime = 0;
+    task->longestRun = 0;
+#endif
+    unsigned char index = _schedulerTaskCount++;
+    while ((index > 0) && (_schedulerTasks[index - 1]->priority > priority))
+    {
+        _schedulerTasks[index] = _schedulerTasks[index - 1];
+        index--;
+    }
+    _schedulerTasks[index] = task;
+    return 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Post an event to a task, normally from an interrupt service routine.
+//  Returns 0 if the queue is full and the event has been dropped.
+//
+unsigned char SchedulerPost(Task *task, unsigned char event)
+{
+    unsigned char head = task->head;
+    unsigned char depth = (unsigned char) (head - task->tail + 1);
+    if (depth > SCHEDULER_QUEUE_SIZE)
+    {
+        task->dropped++;
+        return 0;
+    }
+    task->events[head & SCHEDULER_QUEUE_MASK] = event;
+    task->head = (unsigned char) (head + 1);
+    if (depth > task->deepest)
+    {
+        task->deepest = depth;
+    }
+    return 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Highest priority task with an event waiting, 0 if there is none.
+//
+static Task *SchedulerNextTask()
+{
+    for (unsigned char index = 0; index < _schedulerTaskCount; index++)
+    {
+        Task *task = _schedulerTasks[index];
+        if (task->head != task->tail)
+        {
+            return task;
+        }
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Handle one event for the highest priority task which has one.  The
+//  slot is freed before the handler is called so the queue can refill
+//  while it runs.  Returns 0 if every queue is empty.
+//
+unsigned char SchedulerDispatch()
+{
+    Task *task = SchedulerNextTask();
+    if (task == 0)
+    {
+        return 0;
+    }
+    unsigned char tail = task->tail;
+    unsigned char event = task->events[tail & SCHEDULER_QUEUE_MASK];
+    task->tail = (unsigned char) (tail + 1);
+#if defined(SCHEDULER_MEASURE)
+    unsigned short start = SCHEDULER_TIMESTAMP();
+    task->handler(event);
+    unsigned short duration = (unsigned short) (SCHEDULER_TIMESTAMP() - start);
+    task->runTime += duration;
+    if (duration > task->longestRun)
+    {
+        task->longestRun = duration;
+    }
+#else
+    task->handler(event);
+#endif
+    task->runs++;
+    return 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Wait for an interrupt if every queue is empty.  The queues are checked
+//  with interrupts disabled so an event posted after the check cannot be
+//  missed; WFI enables interrupts as it waits.
+//
+void SchedulerIdle()
+{
+    __disable_interrupt();
+    if (SchedulerNextTask() == 0)
+    {
+        _schedulerSleeps++;
+#if defined(SCHEDULER_MEASURE)
+        unsigned short start = SCHEDULER_TIMESTAMP();
+        __wait_for_interrupt();
+        _schedulerIdleTime += (unsigned short) (SCHEDULER_TIMESTAMP() - start);
+#else
+        __wait_for_interrupt();
+#endif
+    }
+    __enable_interrupt();
+}
+
+#endif
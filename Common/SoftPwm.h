@@ -0,0 +1,339 @@
+//
+//  Software PWM on any port pins driven by a sorted edge schedule.
+//
+//  The timers have seven PWM channels between them, not enough for a row
+//  of LEDs.  Here TIM2 counts out the period and every channel is a port
+//  pin: the update event at the start of the period turns on the pins
+//  with a duty above 0 and compare channel 1 (with no output pin) turns
+//  them off again.  The duties are sorted into a schedule of edge times
+//  with the pins which go low at each time collected into one mask per
+//  port, so an edge is one read-modify-write of each port rather than a
+//  loop over the pins.  On each compare the ISR writes the masks and moves
+//  CCR1 on to the next edge, channels sharing a duty share an edge and the
+//  interrupts per period grow with the number of different duties rather
+//  than the number of channels:
+//
+//      unsigned char red = SoftPwmChannel(SOFT_PWM_PORT_C, 3);
+//      unsigned char green = SoftPwmChannel(SOFT_PWM_PORT_C, 4);
+//
+//      SoftPwmInitialise(5, 256);                  //  500 kHz, 1.95 kHz period.
+//      SoftPwmDuty(red, 64);
+//      SoftPwmDuty(green, 200);
+//      SoftPwmCommit();
+//
+//  Duties are in counts of the period, 0 is always low and period or more
+//  always high.  The schedule is built by SoftPwmCommit in the main
+//  program while the ISRs play the previous one, the new schedule starts
+//  at the next update event so no period mixes the two.  The pins of a
+//  channel are written in whole by the update ISR (Px_ODR = (Px_ODR &
+//  ~channels) | on) and the main program must not write Px_ODR of a port
+//  with channels on it while the timer is running, other pins of the port
+//  included.
+//
+//  Each edge costs an interrupt, edges closer together than the interrupt
+//  takes are written by the same interrupt a little late rather than
+//  missed, so keep the count rate low enough for the duties used (a count
+//  of 2 us is 32 cycles at 16 MHz).  TIM2 is used, it must be clocked and
+//  the TIM2 update and capture / compare interrupts are handled here.
+//
+//      SOFT_PWM_CHANNELS       Maximum number of channels (default 24).
+//      SOFT_PWM_PORTS          Maximum number of ports the channels are
+//                              on (default 3).
+//
+//  _softPwmPeriods counts the update interrupts and _softPwmEdges the
+//  compare interrupts.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef SOFT_PWM_H
+#define SOFT_PWM_H
+
+#include <intrinsics.h>
+
+#if !defined(SOFT_PWM_CHANNELS)
+    #define SOFT_PWM_CHANNELS       24
+#endif
+#if !defined(SOFT_PWM_PORTS)
+    #define SOFT_PWM_PORTS          3
+#endif
+
+//
+//  Base address of each port (Px_ODR), the direction and control
+//  registers follow it.
+//
+#define SOFT_PWM_PORT_A             0x5000
+#define SOFT_PWM_PORT_B             0x5005
+#define SOFT_PWM_PORT_C             0x500a
+#define SOFT_PWM_PORT_D             0x500f
+#define SOFT_PWM_PORT_E             0x5014
+#define SOFT_PWM_DDR                2
+#define SOFT_PWM_CR1                3
+
+#if defined(STM8S_HOST_H)
+    #define SOFT_PWM_REGISTER(address)  STM8_REGISTER(address)
+#else
+    #define SOFT_PWM_REGISTER(address)  (*(volatile unsigned char *) (address))
+#endif
+
+//
+//  Pins turned off at one time, one mask for each port.
+//
+typedef struct
+{
+    unsigned short time;
+    unsigned char off[SOFT_PWM_PORTS];
+} SoftPwmEdge;
+
+//
+//  Everything the ISRs need for one period.
+//
+typedef struct
+{
+    unsigned char on[SOFT_PWM_PORTS];       //  Pins turned on at the update event.
+    unsigned char numberOfEdges;
+    SoftPwmEdge edges[SOFT_PWM_CHANNELS];   //  Sorted by time.
+} SoftPwmSchedule;
+
+//
+//  Channel configuration.
+//
+static unsigned short _softPwmPorts[SOFT_PWM_PORTS];
+static unsigned char _softPwmPortMasks[SOFT_PWM_PORTS];         //  Channel pins on each port.
+static unsigned char _softPwmNumberOfPorts;
+static unsigned char _softPwmChannelPort[SOFT_PWM_CHANNELS];
+static unsigned char _softPwmChannelMask[SOFT_PWM_CHANNELS];
+static unsigned short _softPwmDuty[SOFT_PWM_CHANNELS];
+static unsigned char _softPwmNumberOfChannels;
+static unsigned short _softPwmPeriod;
+
+//
+//  The schedule being played and the one being built, the ISR swaps them
+//  at the update event when _softPwmPending is set.
+//
+static SoftPwmSchedule _softPwmSchedules[2];
+static SoftPwmSchedule *_softPwmActive = &_softPwmSchedules[0];
+static SoftPwmSchedule *_softPwmNext = &_softPwmSchedules[1];
+static volatile unsigned char _softPwmPending;
+static unsigned char _softPwmEdge;                              //  Next edge in the period.
+volatile unsigned long _softPwmPeriods;
+volatile unsigned long _softPwmEdges;
+
+//--------------------------------------------------------------------------------
+//
+//  Add a channel on pin of port (SOFT_PWM_PORT_x) and make the pin a push
+//  pull output, low.  Returns the channel number or 0xff if there are
+//  already SOFT_PWM_CHANNELS channels or SOFT_PWM_PORTS ports.  Add the
+//  channels before SoftPwmInitialise.
+//
+unsigned char SoftPwmChannel(unsigned short port, unsigned char pin)
+{
+    if (_softPwmNumberOfChannels == SOFT_PWM_CHANNELS)
+    {
+        return 0xff;
+    }
+    unsigned char index = 0;
+    while ((index < _softPwmNumberOfPorts) && (_softPwmPorts[index] != port))
+    {
+        index++;
+    }
+    if (index == _softPwmNumberOfPorts)
+    {
+        if (_softPwmNumberOfPorts == SOFT_PWM_PORTS)
+        {
+            return 0xff;
+        }
+        _softPwmPorts[index] = port;
+        _softPwmPortMasks[index] = 0;
+        _softPwmNumberOfPorts++;
+    }
+    unsigned char mask = (unsigned char) (1 << pin);
+    _softPwmPortMasks[index] |= mask;
+    SOFT_PWM_REGISTER(port) &= (unsigned char) ~mask;
+    SOFT_PWM_REGISTER(port + SOFT_PWM_DDR) |= mask;
+    SOFT_PWM_REGISTER(port + SOFT_PWM_CR1) |= mask;
+    unsigned char channel = _softPwmNumberOfChannels++;
+    _softPwmChannelPort[channel] = index;
+    _softPwmChannelMask[channel] = mask;
+    _softPwmDuty[channel] = 0;
+    return channel;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Start TIM2 counting at f_master / 2^prescaler (prescaler 0 to 15) with a
+//  period of period counts (2 to 65535), every channel starts off.
+//
+void SoftPwmInitialise(unsigned char prescaler, unsigned short period)
+{
+    unsigned short reload = (unsigned short) (period - 1);
+    _softPwmPeriod = period;
+    _softPwmActive->numberOfEdges = 0;
+    for (unsigned char port = 0; port < SOFT_PWM_PORTS; port++)
+    {
+        _softPwmActive->on[port] = 0;
+    }
+    _softPwmPending = 0;
+    _softPwmEdge = 0;
+    _softPwmPeriods = 0;
+    _softPwmEdges = 0;
+    TIM2_CR1 = 0;
+    TIM2_PSCR = prescaler;
+    TIM2_ARRH = (unsigned char) (reload >> 8);
+    TIM2_ARRL = (unsigned char) reload;
+    TIM2_CCMR1 = 0;                     //  Frozen, compare only sets CC1IF.
+    TIM2_CCER1 = 0;
+    TIM2_CCR1H = 0xff;                  //  Beyond the period, no match.
+    TIM2_CCR1L = 0xff;
+    TIM2_CR1_ARPE = 1;
+    TIM2_EGR_UG = 1;
+    TIM2_SR1 = 0;
+    TIM2_IER_UIE = 1;
+    TIM2_IER_CC1IE = 1;
+    TIM2_CR1_CEN = 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Set the duty of a channel in counts, it takes effect when the schedule
+//  is next committed.
+//
+void SoftPwmDuty(unsigned char channel, unsigned short duty)
+{
+    _softPwmDuty[channel] = duty;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Build the schedule for the duties set and play it from the next period.
+//  The edges are kept sorted as each channel is added, a duty already in
+//  the schedule only adds the pin to that edge's mask.
+//
+void SoftPwmCommit()
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    _softPwmPending = 0;                //  Keep the ISR off the buffer being built.
+    __set_interrupt_state(state);
+
+    SoftPwmSchedule *schedule = _softPwmNext;
+    unsigned char numberOfEdges = 0;
+    for (unsigned char port = 0; port < SOFT_PWM_PORTS; port++)
+    {
+        schedule->on[port] = 0;
+    }
+    for (unsigned char channel = 0; channel < _softPwmNumberOfChannels; channel++)
+    {
+        unsigned short duty = _softPwmDuty[channel];
+        unsigned char port = _softPwmChannelPort[channel];
+        unsigned char mask = _softPwmChannelMask[channel];
+        if (duty == 0)
+        {
+            continue;
+        }
+        schedule->on[port] |= mask;
+        if (duty >= _softPwmPeriod)
+        {
+            continue;
+        }
+        unsigned char index = 0;
+        while ((index < numberOfEdges) && (schedule->edges[index].time < duty))
+        {
+            index++;
+        }
+        if ((index == numberOfEdges) || (schedule->edges[index].time != duty))
+        {
+            for (unsigned char move = numberOfEdges; move > index; move--)
+            {
+                schedule->edges[move] = schedule->edges[move - 1];
+            }
+            schedule->edges[index].time = duty;
+            for (unsigned char clear = 0; clear < SOFT_PWM_PORTS; clear++)
+            {
+                schedule->edges[index].off[clear] = 0;
+            }
+            numberOfEdges++;
+        }
+        schedule->edges[index].off[port] |= mask;
+    }
+    schedule->numberOfEdges = numberOfEdges;
+
+    __disable_interrupt();
+    _softPwmPending = 1;
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Write the edges which are due and set CCR1 to the next one.  CC1IF is
+//  cleared after CCR1 is written and the counter checked after that, an
+//  edge the counter has already passed is written now rather than waiting
+//  a whole period for the counter to come round again.
+//
+static void SoftPwmRunEdges()
+{
+    SoftPwmSchedule *schedule = _softPwmActive;
+    while (_softPwmEdge < schedule->numberOfEdges)
+    {
+        SoftPwmEdge *edge = &schedule->edges[_softPwmEdge];
+        TIM2_CCR1H = (unsigned char) (edge->time >> 8);
+        TIM2_CCR1L = (unsigned char) edge->time;
+        TIM2_SR1_CC1IF = 0;
+        unsigned char high = TIM2_CNTRH;
+        unsigned short counter = (unsigned short) ((high << 8) | TIM2_CNTRL);
+        if (counter < edge->time)
+        {
+            return;
+        }
+        for (unsigned char port = 0; port < _softPwmNumberOfPorts; port++)
+        {
+            if (edge->off[port] != 0)
+            {
+                SOFT_PWM_REGISTER(_softPwmPorts[port]) &= (unsigned char) ~edge->off[port];
+            }
+        }
+        _softPwmEdge++;
+    }
+    TIM2_CCR1H = 0xff;
+    TIM2_CCR1L = 0xff;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Start of a period, take up a new schedule and turn the channels on.
+//
+#pragma vector = TIM2_OVR_UIF_vector
+__interrupt void TIM2_UPD_OVF_IRQHandler(void)
+{
+    TIM2_SR1_UIF = 0;
+    _softPwmPeriods++;
+    if (_softPwmPending)
+    {
+        SoftPwmSchedule *schedule = _softPwmActive;
+        _softPwmActive = _softPwmNext;
+        _softPwmNext = schedule;
+        _softPwmPending = 0;
+    }
+    for (unsigned char port = 0; port < _softPwmNumberOfPorts; port++)
+    {
+        unsigned short address = _softPwmPorts[port];
+        SOFT_PWM_REGISTER(address) = (unsigned char) ((SOFT_PWM_REGISTER(address) & ~_softPwmPortMasks[port]) | _softPwmActive->on[port]);
+    }
+    _softPwmEdge = 0;
+    SoftPwmRunEdges();
+}
+
+//--------------------------------------------------------------------------------
+//
+//  An edge is due.
+//
+#pragma vector = TIM2_CAPCOM_CC1IF_vector
+__interrupt void TIM2_CAPCOM_IRQHandler(void)
+{
+    _softPwmEdges++;
+    SoftPwmRunEdges();
+}
+
+#endif
@@ -0,0 +1,190 @@
+//
+//  Compile time configuration of the STM8S clock tree.
+//
+//  The application describes the clock it wants before including this
+//  file and the register values are calculated by the compiler:
+//
+//      CLOCK_SOURCE        CLOCK_SOURCE_HSI (default), CLOCK_SOURCE_HSE or
+//                          CLOCK_SOURCE_LSI.
+//      HSE_FREQUENCY       Frequency of the crystal / external clock on the
+//                          board in Hz, required when using the HSE.
+//      HSI_DIVIDER         1 (default), 2, 4 or 8.
+//      CPU_DIVIDER         1 (default), 2, 4 ... 128, f_cpu = f_master / CPU_DIVIDER.
+//      CLOCK_PERIPHERALS   The peripherals to clock, for example
+//                          (CLOCK_UART1 | CLOCK_TIM2).  All peripheral clocks
+//                          are enabled if this is not defined.
+//      CLOCK_LSI_ENABLE    Define to keep the LSI running when it is not the
+//                          master clock.
+//      CLOCK_OUTPUT        Define to output a clock on the CCO pin, the value
+//                          is the CLK_CCOR CCOSEL selection.
+//
+//  The resulting frequencies are available to the rest of the application,
+//  for example to calculate UART, timer and I2C settings:
+//
+//      F_MASTER            Master clock (f_master) in Hz.
+//      F_CPU               CPU clock (f_cpu) in Hz.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef SYSTEM_CLOCK_H
+#define SYSTEM_CLOCK_H
+
+//
+//  Clock sources, the values are the CLK_SWR / CLK_CMSR codes.
+//
+#define CLOCK_SOURCE_HSI            0xe1
+#define CLOCK_SOURCE_LSI            0xd2
+#define CLOCK_SOURCE_HSE            0xb4
+
+//
+//  Oscillator frequencies and the fastest master clock which can be used
+//  without flash wait states.
+//
+#define HSI_FREQUENCY               16000000UL
+#define LSI_FREQUENCY               128000UL
+#define MAXIMUM_F_MASTER            16000000UL
+
+//
+//  Peripheral clock gates, bits 0-7 are CLK_PCKENR1 and bits 8-15 are
+//  CLK_PCKENR2.  The single UART on the STM8S103 (UART1) and STM8S105
+//  (UART2) both use PCKEN13.  The watchdogs and GPIO are always clocked.
+//
+#define CLOCK_I2C                   0x0001
+#define CLOCK_SPI                   0x0002
+#define CLOCK_UART1                 0x0008
+#define CLOCK_UART2                 0x0008
+#define CLOCK_TIM4                  0x0010
+#define CLOCK_TIM2                  0x0020
+#define CLOCK_TIM3                  0x0040
+#define CLOCK_TIM1                  0x0080
+#define CLOCK_AWU                   0x0400
+#define CLOCK_ADC                   0x0800
+#define CLOCK_CAN                   0x8000
+#define CLOCK_ALL                   0xffff
+
+//
+//  Defaults.
+//
+#if !defined(CLOCK_SOURCE)
+    #define CLOCK_SOURCE            CLOCK_SOURCE_HSI
+#endif
+#if !defined(HSI_DIVIDER)
+    #define HSI_DIVIDER             1
+#endif
+#if !defined(CPU_DIVIDER)
+    #define CPU_DIVIDER             1
+#endif
+#if !defined(CLOCK_PERIPHERALS)
+    #define CLOCK_PERIPHERALS       CLOCK_ALL
+#endif
+
+#if defined(F_MASTER) || defined(F_CPU)
+    #error "F_MASTER and F_CPU are calculated by SystemClock.h, set CLOCK_SOURCE and the dividers instead."
+#endif
+
+//
+//  Master clock frequency.
+//
+#if CLOCK_SOURCE == CLOCK_SOURCE_HSI
+    #define F_MASTER                (HSI_FREQUENCY / HSI_DIVIDER)
+#elif CLOCK_SOURCE == CLOCK_SOURCE_HSE
+    #if !defined(HSE_FREQUENCY)
+        #error "HSE_FREQUENCY must be set to the frequency of the external clock on the board."
+    #endif
+    #define F_MASTER                (HSE_FREQUENCY)
+#elif CLOCK_SOURCE == CLOCK_SOURCE_LSI
+    #define F_MASTER                LSI_FREQUENCY
+#else
+    #error "CLOCK_SOURCE must be CLOCK_SOURCE_HSI, CLOCK_SOURCE_HSE or CLOCK_SOURCE_LSI."
+#endif
+
+#define F_CPU                       (F_MASTER / CPU_DIVIDER)
+
+//
+//  Check the configuration.
+//
+#if (HSI_DIVIDER != 1) && (HSI_DIVIDER != 2) && (HSI_DIVIDER != 4) && (HSI_DIVIDER != 8)
+    #error "HSI_DIVIDER must be 1, 2, 4 or 8."
+#endif
+#if (CPU_DIVIDER < 1) || (CPU_DIVIDER > 128) || ((CPU_DIVIDER & (CPU_DIVIDER - 1)) != 0)
+    #error "CPU_DIVIDER must be a power of two between 1 and 128."
+#endif
+#if F_MASTER > MAXIMUM_F_MASTER
+    #error "The master clock must not be faster than 16 MHz."
+#endif
+#if (CLOCK_SOURCE == CLOCK_SOURCE_HSE) && (F_MASTER < 1000000UL)
+    #error "The HSE must be at least 1 MHz."
+#endif
+
+//
+//  Register values.
+//
+#define CLOCK_LOG2(n)               (((n) >= 128) ? 7 : ((n) >= 64) ? 6 : ((n) >= 32) ? 5 : ((n) >= 16) ? 4 : \
+                                     ((n) >= 8) ? 3 : ((n) >= 4) ? 2 : ((n) >= 2) ? 1 : 0)
+#define CLOCK_CKDIVR                ((unsigned char) ((CLOCK_LOG2(HSI_DIVIDER) << 3) | CLOCK_LOG2(CPU_DIVIDER)))
+#define CLOCK_PCKENR1               ((unsigned char) ((CLOCK_PERIPHERALS) & 0xff))
+#define CLOCK_PCKENR2               ((unsigned char) (((CLOCK_PERIPHERALS) >> 8) & 0xff))
+#if (CLOCK_SOURCE == CLOCK_SOURCE_LSI) || defined(CLOCK_LSI_ENABLE)
+    #define CLOCK_ICKR              0x09            //  HSIEN and LSIEN.
+#else
+    #define CLOCK_ICKR              0x01            //  HSIEN.
+#endif
+#if CLOCK_SOURCE == CLOCK_SOURCE_HSE
+    #define CLOCK_ECKR              0x01            //  HSEEN.
+#else
+    #define CLOCK_ECKR              0x00
+#endif
+#if defined(CLOCK_OUTPUT)
+    #define CLOCK_CCOR              ((unsigned char) (((CLOCK_OUTPUT) << 1) | 0x01))
+#else
+    #define CLOCK_CCOR              0x00
+#endif
+
+//
+//  Number of times the switch busy flag is checked before giving up on an
+//  oscillator which has not started.
+//
+#define CLOCK_SWITCH_TIMEOUT        0xffff
+
+//--------------------------------------------------------------------------------
+//
+//  Setup the clock tree.  The clock source is only switched when the master
+//  clock is not already running from CLOCK_SOURCE so starting from reset on
+//  the HSI does not wait at all.
+//
+//  Returns 1 if the master clock is running from CLOCK_SOURCE or 0 if the
+//  oscillator did not start, in which case the switch is abandoned and the
+//  master clock is left unchanged.
+//
+unsigned char InitialiseSystemClock()
+{
+    CLK_ICKR = CLOCK_ICKR;              //  Internal oscillators.
+    CLK_ECKR = CLOCK_ECKR;              //  External oscillator.
+    CLK_CKDIVR = CLOCK_CKDIVR;          //  HSI and CPU dividers.
+    CLK_PCKENR1 = CLOCK_PCKENR1;        //  Only clock the peripherals in use.
+    CLK_PCKENR2 = CLOCK_PCKENR2;
+    CLK_CCOR = CLOCK_CCOR;              //  Configurable clock output.
+    CLK_HSITRIMR = 0;                   //  Turn off any HSI trimming.
+    CLK_SWIMCCR = 0;                    //  Set SWIM to run at clock / 2.
+    if (CLK_CMSR == CLOCK_SOURCE)
+    {
+        return 1;
+    }
+    CLK_SWCR = 0;                       //  Reset the clock switch control register.
+    CLK_SWCR_SWEN = 1;                  //  Switch as soon as the source is ready.
+    CLK_SWR = CLOCK_SOURCE;
+    for (unsigned short timeout = CLOCK_SWITCH_TIMEOUT; CLK_SWCR_SWBSY != 0; timeout--)
+    {
+        if (timeout == 0)
+        {
+            CLK_SWCR_SWBSY = 0;         //  Abandon the switch.
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#endif
@@ -0,0 +1,414 @@
+//
+//  Tickless software timers on TIM2.
+//
+//  A periodic tick (as in SetupTimer2 in chapter 5) wakes the core from
+//  WFI on every period whether or not anything is due.  Here TIM2 is
+//  instead programmed to overflow when the earliest timer is due, so the
+//  core only wakes when there is work to do.
+//
+//  TIM2 counts ticks of 2^TICKLESS_PRESCALER master clock cycles (64 us
+//  at 16 MHz by default).  Each time the earliest deadline changes the
+//  auto-reload register is set so the counter overflows on the tick the
+//  deadline falls due.  ARPE is off so the new value applies at once and
+//  the counter is never reset, which keeps the time base exact.  A
+//  deadline more than 65536 ticks away is reached by chaining full length
+//  overflows; with nothing due the timer still overflows every 65536
+//  ticks (4.2 seconds by default) to keep the time.
+//
+//  When ClockScaling.h is included first the tick length is kept when
+//  f_master changes: the prescaler is reduced by ClockScalingShift and, as
+//  the new prescaler is only loaded by an update event which clears the
+//  counter, the count is written back afterwards.  Up to one tick is lost
+//  each time.  The tick must be longer than the time taken to reprogram
+//  the timer at the slowest CPU clock used.
+//
+//  TicklessNow returns the number of ticks since TicklessInitialise as a
+//  32 bit value (about 76 hours by default) which remains correct when the
+//  auto-reload is changed and while an overflow is waiting to be serviced.
+//
+//  Timers are kept in order of expiry so starting a timer takes time in
+//  proportion to the number of earlier timers.  The overflow interrupt
+//  moves the due timers to the expired list and the application runs the
+//  callbacks from its main loop:
+//
+//      #pragma vector = TIM2_OVR_UIF_vector
+//      __interrupt void TIM2_UPD_OVF_IRQHandler(void)
+//      {
+//          TicklessInterrupt();
+//      }
+//
+//      TicklessInitialise();
+//      TicklessStart(&_sensor, TICKLESS_MS(250), TICKLESS_MS(250), ReadSensor);
+//      while (1)
+//      {
+//          TicklessRun();
+//          TicklessIdle();
+//      }
+//
+//  TicklessIdle checks for expired timers with interrupts disabled and
+//  only then waits, WFI enables interrupts as it waits.  Testing the
+//  result of TicklessRun and then waiting would lose a wakeup: a timer
+//  which expires between the test and the WFI would not be run until the
+//  next overflow, up to 65536 ticks later.  The host simulator's WFI
+//  services an interrupt which is already pending, so the benchmark
+//  cannot show this on the host.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef TICKLESS_TIMER_H
+#define TICKLESS_TIMER_H
+
+#include <intrinsics.h>
+
+#if !defined(SYSTEM_CLOCK_H)
+    #error "SystemClock.h must be included before TicklessTimer.h"
+#endif
+
+//
+//  Tick length as a power of two of the master clock, 6 to 15.  The tick
+//  must be longer than the time taken to reprogram the timer.
+//
+#if !defined(TICKLESS_PRESCALER)
+    #define TICKLESS_PRESCALER      10
+#endif
+#if (TICKLESS_PRESCALER < 6) || (TICKLESS_PRESCALER > 15)
+    #error "TICKLESS_PRESCALER must be between 6 and 15."
+#endif
+
+//
+//  Tick frequency and conversions from time (rounded to the nearest tick).
+//
+#define TICKLESS_TICKS_PER_SECOND   (F_MASTER >> TICKLESS_PRESCALER)
+#define TICKLESS_MS(ms)             ((unsigned long) (((ms) * TICKLESS_TICKS_PER_SECOND + 500UL) / 1000UL))
+#define TICKLESS_US(us)             ((unsigned long) (((us) * (TICKLESS_TICKS_PER_SECOND / 100UL) + 5000UL) / 10000UL))
+
+//
+//  Longest time between overflows.
+//
+#define TICKLESS_LONGEST_PERIOD     0x10000UL
+
+struct TicklessTimer;
+typedef void (*TicklessCallback)(struct TicklessTimer *timer);
+
+//
+//  A timer, the members are managed by this module.
+//
+typedef struct TicklessTimer
+{
+    struct TicklessTimer *next;             //  Next timer in the list.
+    unsigned long expires;                  //  Tick on which the timer expires.
+    unsigned long period;                   //  Restart interval, 0 for a one shot timer.
+    TicklessCallback callback;
+    unsigned char state;                    //  TICKLESS_STOPPED, _WAITING or _EXPIRED.
+} TicklessTimer;
+
+#define TICKLESS_STOPPED            0
+#define TICKLESS_WAITING            1
+#define TICKLESS_EXPIRED            2
+
+//
+//  Timers waiting in order of expiry and the expired timers in the order
+//  they expired.
+//
+static TicklessTimer *_ticklessWaiting;
+static TicklessTimer *_ticklessExpired;
+static TicklessTimer **_ticklessExpiredTail = &_ticklessExpired;
+
+//
+//  Tick at which the current TIM2 period started (counter = 0) and the
+//  length of the period, ARR + 1.
+//
+static unsigned long _ticklessBase;
+static unsigned long _ticklessPeriod = TICKLESS_LONGEST_PERIOD;
+
+//
+//  Number of overflow interrupts.
+//
+static unsigned long _ticklessInterrupts;
+
+#define TicklessRunning(timer)      ((timer)->state != TICKLESS_STOPPED)
+
+//--------------------------------------------------------------------------------
+//
+//  Current TIM2 count, reading the high byte latches the low byte.
+//
+static unsigned short TicklessCounter()
+{
+    unsigned char high = TIM2_CNTRH;
+    return (unsigned short) ((high << 8) | TIM2_CNTRL);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Ticks since TicklessInitialise.  An overflow may have happened but not
+//  yet been serviced (interrupts disabled or a higher priority interrupt
+//  running), UIF is checked between two readings of the counter to tell
+//  which reading belongs with which period.
+//
+unsigned long TicklessNow()
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    unsigned short before = TicklessCounter();
+    unsigned char overflowed = TIM2_SR1_UIF;
+    unsigned short after = TicklessCounter();
+    unsigned long now = overflowed ? (_ticklessBase + _ticklessPeriod + after) : (_ticklessBase + before);
+    __set_interrupt_state(state);
+    return now;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Add a timer to the end of the expired list.
+//
+static void TicklessExpire(TicklessTimer *timer)
+{
+    timer->state = TICKLESS_EXPIRED;
+    timer->next = 0;
+    *_ticklessExpiredTail = timer;
+    _ticklessExpiredTail = &timer->next;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Add a timer to the waiting list in order of expiry, after any timers
+//  with the same expiry time.
+//
+static void TicklessInsert(TicklessTimer *timer)
+{
+    TicklessTimer **position = &_ticklessWaiting;
+    while (*position && ((long) ((*position)->expires - timer->expires) <= 0))
+    {
+        position = &(*position)->next;
+    }
+    timer->state = TICKLESS_WAITING;
+    timer->next = *position;
+    *position = timer;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Move the timers which are due at tick now to the expired list.
+//
+static void TicklessExpireDue(unsigned long now)
+{
+    while (_ticklessWaiting && ((long) (_ticklessWaiting->expires - now) <= 0))
+    {
+        TicklessTimer *timer = _ticklessWaiting;
+        _ticklessWaiting = timer->next;
+        TicklessExpire(timer);
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Remove a timer from the waiting or expired list.
+//
+static void TicklessRemove(TicklessTimer *timer)
+{
+    TicklessTimer **position = (timer->state == TICKLESS_WAITING) ? &_ticklessWaiting : &_ticklessExpired;
+    TicklessTimer *previous = 0;
+    while (*position != timer)
+    {
+        previous = *position;
+        position = &previous->next;
+    }
+    *position = timer->next;
+    if ((timer->state == TICKLESS_EXPIRED) && (timer->next == 0))
+    {
+        _ticklessExpiredTail = previous ? &previous->next : &_ticklessExpired;
+    }
+    timer->state = TICKLESS_STOPPED;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Set the auto-reload so that the current period ends on the earliest
+//  deadline, or after the longest period if that is sooner, expiring any
+//  timers which are already due.  Called with interrupts disabled.
+//
+//  The counter never passes the reload value unnoticed: the new reload is
+//  at least the count read before it was written and if the counter has
+//  moved past it by the time it is written the deadline has been reached
+//  and the calculation is repeated.  An overflow found pending is
+//  accounted for first, and the count is not used while it is about to
+//  overflow as the overflow could then happen before the new reload is
+//  written, ending the period at the old length.  Both rely on the tick
+//  being longer than the time taken to go round the loop.
+//
+//  A one tick period is never used as its counter is always about to
+//  overflow, so a deadline on the first tick of a period is one tick late.
+//
+static void TicklessProgram()
+{
+    while (1)
+    {
+        if (TIM2_SR1_UIF)
+        {
+            TIM2_SR1_UIF = 0;
+            _ticklessBase += _ticklessPeriod;
+        }
+        unsigned short counter = TicklessCounter();
+        if (TIM2_SR1_UIF || (counter == (unsigned short) (_ticklessPeriod - 1)))
+        {
+            continue;
+        }
+        TicklessExpireDue(_ticklessBase + counter);
+        unsigned long target = TICKLESS_LONGEST_PERIOD;
+        if (_ticklessWaiting && ((_ticklessWaiting->expires - _ticklessBase) < target))
+        {
+            target = _ticklessWaiting->expires - _ticklessBase;
+        }
+        if (target < 2)
+        {
+            target = 2;
+        }
+        unsigned short reload = (unsigned short) (target - 1);
+        TIM2_ARRH = (unsigned char) (reload >> 8);
+        TIM2_ARRL = (unsigned char) reload;
+        _ticklessPeriod = target;
+        if (TIM2_SR1_UIF || (TicklessCounter() <= reload))
+        {
+            return;
+        }
+    }
+}
+
+#if defined(CLOCK_SCALING_H)
+//--------------------------------------------------------------------------------
+//
+//  Keep the tick length when the master clock changes.  URS is set so the
+//  update event which loads the prescaler does not look like an overflow.
+//
+static void TicklessClockChanged(unsigned char phase, unsigned long fMaster)
+{
+    if (phase == CLOCK_SCALING_CHANGED)
+    {
+        unsigned short counter = TicklessCounter();
+        TIM2_PSCR = (unsigned char) (TICKLESS_PRESCALER - ClockScalingShift(fMaster));
+        TIM2_EGR_UG = 1;
+        TIM2_CNTRH = (unsigned char) (counter >> 8);
+        TIM2_CNTRL = (unsigned char) counter;
+    }
+}
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  Start TIM2 counting ticks with nothing due.  The update event only
+//  loads the prescaler (URS), just overflows interrupt.
+//
+void TicklessInitialise()
+{
+#if defined(CLOCK_SCALING_H)
+    TIM2_PSCR = (unsigned char) (TICKLESS_PRESCALER - ClockScalingShift(MasterClockFrequency()));
+    ClockScalingRegister(TicklessClockChanged);
+#else
+    TIM2_PSCR = TICKLESS_PRESCALER;
+#endif
+    TIM2_ARRH = 0xff;
+    TIM2_ARRL = 0xff;
+    TIM2_CR1_URS = 1;
+    TIM2_EGR_UG = 1;
+    TIM2_IER_UIE = 1;
+    TIM2_CR1_CEN = 1;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  TIM2 overflow, call this from TIM2_UPD_OVF_IRQHandler.
+//
+void TicklessInterrupt()
+{
+    _ticklessInterrupts++;
+    TicklessProgram();
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Start (or restart) a timer which expires after ticks ticks (at least
+//  1) and then every period ticks, or only once if period is 0.
+//
+void TicklessStart(TicklessTimer *timer, unsigned long ticks, unsigned long period, TicklessCallback callback)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    if (timer->state != TICKLESS_STOPPED)
+    {
+        TicklessRemove(timer);
+    }
+    timer->expires = TicklessNow() + (ticks ? ticks : 1);
+    timer->period = period;
+    timer->callback = callback;
+    TicklessInsert(timer);
+    TicklessProgram();
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Stop a timer, including one which has expired but whose callback has
+//  not been run.
+//
+void TicklessStop(TicklessTimer *timer)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    if (timer->state != TICKLESS_STOPPED)
+    {
+        TicklessRemove(timer);
+        TicklessProgram();
+    }
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Run the callbacks of the expired timers, call this from the main loop.
+//  Periodic timers are restarted from their previous expiry time before
+//  the callback is called.  Returns the number of callbacks run.
+//
+unsigned char TicklessRun()
+{
+    unsigned char count = 0;
+    while (1)
+    {
+        __disable_interrupt();
+        TicklessTimer *timer = _ticklessExpired;
+        if (timer == 0)
+        {
+            __enable_interrupt();
+            return count;
+        }
+        TicklessRemove(timer);
+        if (timer->period)
+        {
+            timer->expires += timer->period;
+            TicklessInsert(timer);
+            TicklessProgram();
+        }
+        __enable_interrupt();
+        timer->callback(timer);
+        count++;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Wait for an interrupt unless a timer has expired, call this from the
+//  main loop after TicklessRun.
+//
+void TicklessIdle()
+{
+    __disable_interrupt();
+    if (_ticklessExpired == 0)
+    {
+        __wait_for_interrupt();
+    }
+    __enable_interrupt();
+}
+
+#endif
@@ -0,0 +1,333 @@
+//
+//  Software timers multiplexed onto a single hardware timer.
+//
+//  Any number of one shot or periodic timers are driven from one periodic
+//  tick interrupt.  The timers are held in a hierarchical timing wheel of
+//  four levels of 16 slots:
+//
+//      Level 0     Timers due in the next 16 ticks, one slot per tick.
+//      Level 1     Due in under 256 ticks, one slot per 16 ticks.
+//      Level 2     Due in under 4096 ticks, one slot per 256 ticks.
+//      Level 3     Due in under 65536 ticks, one slot per 4096 ticks.
+//
+//  Starting or stopping a timer takes the same time however many timers
+//  are running as the timer is simply linked into, or unlinked from, the
+//  slot for its expiry time.  On each tick the interrupt service routine
+//  moves the timers in the current level 0 slot to the expired list.
+//  Every 16 ticks the next level 1 slot is redistributed into level 0
+//  (and so on up the levels), so each timer is moved at most once per
+//  level.  The tick therefore costs time in proportion to the number of
+//  timers expiring or moving down a level, not the number running.
+//
+//  Callbacks are not run by the interrupt service routine.  The
+//  application calls TimerWheelRun from its main loop which calls the
+//  callback of each expired timer with interrupts enabled:
+//
+//      SoftwareTimer _blink;
+//
+//      void Blink(SoftwareTimer *timer)
+//      {
+//          PD_ODR_ODR4 = !PD_ODR_ODR4;
+//      }
+//
+//      #pragma vector = TIM4_OVR_UIF_vector
+//      __interrupt void TIM4_UPD_OVF_IRQHandler()
+//      {
+//          TIM4_SR_UIF = 0;
+//          TimerWheelTick();
+//      }
+//
+//      TimerWheelStart(&_blink, 500, 500, Blink);
+//      while (1)
+//      {
+//          TimerWheelRun();
+//          TimerWheelIdle();
+//      }
+//
+//  TimerWheelIdle only waits for an interrupt if no timer has expired,
+//  making the check with interrupts disabled (WFI enables them as it
+//  waits).  Waiting because TimerWheelRun returned 0 would leave a timer
+//  which expired between the two calls until the next tick.
+//
+//  A periodic timer is restarted from its previous expiry time rather than
+//  from the time the callback ran so it does not drift when the main loop
+//  is late.
+//
+//  The wheel counts ticks and does not know their length.  The tick timer
+//  belongs to the application, so a program which changes f_master with
+//  ClockScaling.h must keep the tick length itself by registering a handler
+//  which reduces the tick timer's prescaler by ClockScalingShift(fMaster),
+//  as chapter 04 does for its timestamp.
+//
+//  Define TIMER_WHEEL_STATISTICS to count the timers handled by the tick:
+//  _timerWheelMoves is the total number of timers expired or moved down a
+//  level and _timerWheelMostMoves the largest number in a single tick.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <intrinsics.h>
+
+#define TIMER_WHEEL_LEVELS          4
+#define TIMER_WHEEL_SLOT_BITS       4
+#define TIMER_WHEEL_SLOTS           (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK       (TIMER_WHEEL_SLOTS - 1)
+
+struct SoftwareTimer;
+typedef void (*SoftwareTimerCallback)(struct SoftwareTimer *timer);
+
+//
+//  A software timer.  The members are managed by the wheel and should not
+//  be changed by the application.
+//
+typedef struct SoftwareTimer
+{
+    struct SoftwareTimer *next;             //  Next timer in the same list.
+    struct SoftwareTimer **previous;        //  Pointer to this timer in the list, 0 if stopped.
+    unsigned short expires;                 //  Tick on which the timer expires.
+    unsigned short period;                  //  Restart interval, 0 for a one shot timer.
+    SoftwareTimerCallback callback;
+} SoftwareTimer;
+
+//
+//  Wheel slots, the expired list and the current tick.  _timerWheelExpiredTail
+//  points at the next pointer of the last expired timer so that timers are
+//  run in the order they expired.
+//
+static SoftwareTimer *_timerWheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static SoftwareTimer *_timerWheelExpired;
+static SoftwareTimer **_timerWheelExpiredTail = &_timerWheelExpired;
+static volatile unsigned short _timerWheelNow;
+
+#if defined(TIMER_WHEEL_STATISTICS)
+static unsigned long _timerWheelMoves;
+static unsigned short _timerWheelMostMoves;
+#endif
+
+#define TimerWheelNow()             (_timerWheelNow)
+#define TimerWheelRunning(timer)    ((timer)->previous != 0)
+
+//--------------------------------------------------------------------------------
+//
+//  Push a timer on to the front of a list.
+//
+static void TimerWheelLink(SoftwareTimer **list, SoftwareTimer *timer)
+{
+    timer->next = *list;
+    if (timer->next)
+    {
+        timer->next->previous = &timer->next;
+    }
+    timer->previous = list;
+    *list = timer;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Remove a timer from whichever list it is in.
+//
+static void TimerWheelUnlink(SoftwareTimer *timer)
+{
+    *timer->previous = timer->next;
+    if (timer->next)
+    {
+        timer->next->previous = timer->previous;
+    }
+    else if (_timerWheelExpiredTail == &timer->next)
+    {
+        _timerWheelExpiredTail = timer->previous;
+    }
+    timer->previous = 0;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Add a timer to the end of the expired list.
+//
+static void TimerWheelExpire(SoftwareTimer *timer)
+{
+    timer->next = 0;
+    timer->previous = _timerWheelExpiredTail;
+    *_timerWheelExpiredTail = timer;
+    _timerWheelExpiredTail = &timer->next;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Put a timer in the slot for its expiry time.  The level is chosen from
+//  the number of ticks to go, the slot from the expiry time itself.  A
+//  timer which is already due goes in the slot for the current tick which
+//  is only correct while the tick is being processed (see TimerWheelTick).
+//
+static void TimerWheelInsert(SoftwareTimer *timer)
+{
+    unsigned short remaining = (unsigned short) (timer->expires - _timerWheelNow);
+    unsigned short expires = timer->expires;
+    unsigned char level = 0;
+    while (remaining >= TIMER_WHEEL_SLOTS)
+    {
+        remaining >>= TIMER_WHEEL_SLOT_BITS;
+        expires >>= TIMER_WHEEL_SLOT_BITS;
+        level++;
+    }
+    TimerWheelLink(&_timerWheel[level][expires & TIMER_WHEEL_SLOT_MASK], timer);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Start (or restart) a timer which will expire after ticks (1 to 65535)
+//  ticks and then every period ticks, or only once if period is 0.
+//
+void TimerWheelStart(SoftwareTimer *timer, unsigned short ticks, unsigned short period, SoftwareTimerCallback callback)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    if (timer->previous)
+    {
+        TimerWheelUnlink(timer);
+    }
+    timer->expires = (unsigned short) (_timerWheelNow + (ticks ? ticks : 1));
+    timer->period = period;
+    timer->callback = callback;
+    TimerWheelInsert(timer);
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Stop a timer.  A timer which has expired but whose callback has not
+//  been run yet is also cancelled.
+//
+void TimerWheelStop(SoftwareTimer *timer)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    if (timer->previous)
+    {
+        TimerWheelUnlink(timer);
+    }
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Advance the wheel by one tick, call this from the tick interrupt.
+//
+//  When the level 0 index wraps to 0 the next slot of level 1 is
+//  redistributed over level 0, and likewise up the levels.  This is done
+//  before the level 0 slot is expired so that timers due on this tick
+//  which have been cascaded down are expired straight away.
+//
+void TimerWheelTick()
+{
+    unsigned short now = (unsigned short) (_timerWheelNow + 1);
+    _timerWheelNow = now;
+#if defined(TIMER_WHEEL_STATISTICS)
+    unsigned short moves = 0;
+#endif
+    unsigned char level = 0;
+    unsigned short index = now;
+    while (((index & TIMER_WHEEL_SLOT_MASK) == 0) && (level < (TIMER_WHEEL_LEVELS - 1)))
+    {
+        index >>= TIMER_WHEEL_SLOT_BITS;
+        level++;
+    }
+    //
+    //  Cascade from the highest level which has wrapped down to level 1.
+    //
+    for (; level > 0; level--)
+    {
+        unsigned char slot = (unsigned char) ((now >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK);
+        SoftwareTimer *timer = _timerWheel[level][slot];
+        _timerWheel[level][slot] = 0;
+        while (timer)
+        {
+            SoftwareTimer *next = timer->next;
+            TimerWheelInsert(timer);
+            timer = next;
+#if defined(TIMER_WHEEL_STATISTICS)
+            moves++;
+#endif
+        }
+    }
+    SoftwareTimer **expiring = &_timerWheel[0][now & TIMER_WHEEL_SLOT_MASK];
+    SoftwareTimer *timer = *expiring;
+    *expiring = 0;
+    while (timer)
+    {
+        SoftwareTimer *next = timer->next;
+        TimerWheelExpire(timer);
+        timer = next;
+#if defined(TIMER_WHEEL_STATISTICS)
+        moves++;
+#endif
+    }
+#if defined(TIMER_WHEEL_STATISTICS)
+    _timerWheelMoves += moves;
+    if (moves > _timerWheelMostMoves)
+    {
+        _timerWheelMostMoves = moves;
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Run the callbacks of the expired timers, call this from the main loop.
+//  Periodic timers are restarted before their callback is called so the
+//  callback may stop or restart its own timer.  Returns the number of
+//  callbacks run.
+//
+unsigned char TimerWheelRun()
+{
+    unsigned char count = 0;
+    while (1)
+    {
+        __disable_interrupt();
+        SoftwareTimer *timer = _timerWheelExpired;
+        if (timer == 0)
+        {
+            __enable_interrupt();
+            return count;
+        }
+        TimerWheelUnlink(timer);
+        if (timer->period)
+        {
+            unsigned short late = (unsigned short) (_timerWheelNow - timer->expires);
+            timer->expires = (unsigned short) (timer->expires + timer->period);
+            if (late >= timer->period)
+            {
+                TimerWheelExpire(timer);        //  Already due again, the main loop is late.
+            }
+            else
+            {
+                TimerWheelInsert(timer);
+            }
+        }
+        __enable_interrupt();
+        timer->callback(timer);
+        count++;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Wait for an interrupt unless a timer has expired, call this from the
+//  main loop after TimerWheelRun.
+//
+void TimerWheelIdle()
+{
+    __disable_interrupt();
+    if (_timerWheelExpired == 0)
+    {
+        __wait_for_interrupt();
+    }
+    __enable_interrupt();
+}
+
+#endif
@@ -0,0 +1,96 @@
+//
+//  Compile time calculation of the UART baud rate registers.
+//
+//  The UART divides f_master by UART_DIV to generate the baud rate.  The
+//  16 bit divider is split across the two baud rate registers:
+//
+//      BRR1 = UART_DIV[11:4]
+//      BRR2 = UART_DIV[15:12] in the high nibble, UART_DIV[3:0] in the low nibble
+//
+//  BRR2 must be written before BRR1 as writing BRR1 updates the divider.
+//
+//  The divider is rounded to the nearest integer and UART_CHECK_BAUD_RATE
+//  stops the compilation if the baud rate cannot be generated from the
+//  clock to within UART_MAXIMUM_BAUD_ERROR parts per thousand.  The macros
+//  work for UART1 and UART2 as both use the same divider.
+//
+//  Usage:
+//
+//      #define F_MASTER    16000000UL
+//      #define BAUD_RATE   115200UL
+//      UART_CHECK_BAUD_RATE(F_MASTER, BAUD_RATE);
+//      ...
+//      UART1_BRR2 = UART_BRR2(F_MASTER, BAUD_RATE);
+//      UART1_BRR1 = UART_BRR1(F_MASTER, BAUD_RATE);
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef UART_BAUD_RATE_H
+#define UART_BAUD_RATE_H
+
+//
+//  Largest acceptable difference between the requested and generated baud
+//  rate in parts per thousand.  The receiver at the other end of the link
+//  must also be taken into account so keep this well inside the +/-3.75%
+//  the UART can tolerate.
+//
+#if !defined(UART_MAXIMUM_BAUD_ERROR)
+    #define UART_MAXIMUM_BAUD_ERROR     20
+#endif
+
+//
+//  Limits of the divider, the receiver samples each bit 16 times.
+//
+#define UART_MINIMUM_DIVIDER            16UL
+#define UART_MAXIMUM_DIVIDER            0xffffUL
+
+//
+//  Fastest baud rate which can be generated from f_master.
+//
+#define UART_MAXIMUM_BAUD_RATE(fMaster) ((unsigned long) (fMaster) / UART_MINIMUM_DIVIDER)
+
+//
+//  Divider rounded to the nearest integer.
+//
+#define UART_DIVIDER(fMaster, baud)     (((unsigned long) (fMaster) + ((unsigned long) (baud) / 2)) / (unsigned long) (baud))
+
+//
+//  Baud rate actually generated.
+//
+#define UART_ACTUAL_BAUD_RATE(fMaster, baud)    ((unsigned long) (fMaster) / UART_DIVIDER(fMaster, baud))
+
+//
+//  Error in the generated baud rate in parts per thousand.
+//
+#define UART_BAUD_ERROR(fMaster, baud)  (((UART_ACTUAL_BAUD_RATE(fMaster, baud) > (unsigned long) (baud)) ?         \
+                                          (UART_ACTUAL_BAUD_RATE(fMaster, baud) - (unsigned long) (baud)) :         \
+                                          ((unsigned long) (baud) - UART_ACTUAL_BAUD_RATE(fMaster, baud))) *        \
+                                         1000UL / (unsigned long) (baud))
+
+//
+//  Register values.
+//
+#define UART_BRR1(fMaster, baud)        ((unsigned char) ((UART_DIVIDER(fMaster, baud) >> 4) & 0xff))
+#define UART_BRR2(fMaster, baud)        ((unsigned char) (((UART_DIVIDER(fMaster, baud) >> 8) & 0xf0) | \
+                                                          (UART_DIVIDER(fMaster, baud) & 0x0f)))
+
+//
+//  True if the baud rate can be generated.
+//
+#define UART_BAUD_RATE_VALID(fMaster, baud)     ((UART_DIVIDER(fMaster, baud) >= UART_MINIMUM_DIVIDER) &&   \
+                                                 (UART_DIVIDER(fMaster, baud) <= UART_MAXIMUM_DIVIDER) &&   \
+                                                 (UART_BAUD_ERROR(fMaster, baud) <= UART_MAXIMUM_BAUD_ERROR))
+
+//
+//  Fail the compilation if the baud rate cannot be generated.  The array
+//  size is negative when the check fails, the type name tells you why.
+//
+#define UART_CHECK_JOIN(a, b)           a##b
+#define UART_CHECK_NAME(line)           UART_CHECK_JOIN(UARTBaudRateCannotBeGenerated_, line)
+#define UART_CHECK_BAUD_RATE(fMaster, baud)     \
+    typedef char UART_CHECK_NAME(__LINE__)[UART_BAUD_RATE_VALID(fMaster, baud) ? 1 : -1]
+
+#endif
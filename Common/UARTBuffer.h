@@ -0,0 +1,450 @@
+//
+//  Interrupt driven UART with a transmit ring buffer and a receive line
+//  buffer.
+//
+//  UARTPutChar places characters in the transmit buffer and the TXE
+//  interrupt feeds them to the UART one at a time, leaving the application
+//  free to carry on while a message is sent.  The RXNE interrupt assembles
+//  the incoming characters into lines in place so that the application can
+//  process a complete command straight from the buffer without copying it:
+//
+//      UARTInitialise();
+//      UARTPrintF("Hello\n\r");
+//      ...
+//      char *command = UARTGetLine();
+//      if (command)
+//      {
+//          ...
+//          UARTReleaseLine();
+//      }
+//
+//  The STM8S103 boards use UART1 and the Discovery board (STM8S105) UART2,
+//  as in UARTPrint.h.  Programs written only for the STM8S105 which do not
+//  define DISCOVERY define UART_BUFFER_UART2 instead.  SystemClock.h must be
+//  included first.  When ClockScaling.h is included first as well the baud
+//  rate is kept when f_master changes.
+//
+//      UART_BUFFER_BAUD_RATE   Baud rate (default 115200), n, 8, 1.
+//      UART_TX_BUFFER_SIZE     Characters in the transmit buffer, a power of
+//                              two no larger than 128 (default 64).
+//      UART_TX_OVERFLOW_POLICY What to do with a new character when the
+//                              transmit buffer is full (default
+//                              UART_TX_OVERFLOW_BLOCK, see below).
+//      UART_RX_LINES           Lines in the receive buffer, a power of two
+//                              no larger than 128 (default 4).
+//      UART_RX_LINE_LENGTH     Longest line plus one (default 32).
+//      UART_RX_ERROR(error, count)
+//                              Optional, called from the receive interrupt
+//                              with UART_RX_OVERRUN or UART_RX_FRAMING_ERROR
+//                              and the number of those errors so far.
+//
+//  A line ends with a carriage return or line feed, empty lines are
+//  ignored and characters beyond the end of a line are discarded.
+//
+//  The idle line interrupt records when the receive line has been quiet
+//  for a whole frame after the last character, UARTReceiverIdle.  A
+//  character being received while f_master changes is sampled at the wrong
+//  rate, so a program using ClockScaling.h changes the clock only when the
+//  receiver is idle (waiting for the idle line interrupt if need be).  This
+//  keeps characters sent back to back intact; only a character which
+//  starts in the few microseconds of the change itself can still be lost.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef UART_BUFFER_H
+#define UART_BUFFER_H
+
+#include <intrinsics.h>
+
+#if !defined(SYSTEM_CLOCK_H)
+    #error "SystemClock.h must be included before UARTBuffer.h"
+#endif
+
+#include "UARTBaudRate.h"
+
+#if !defined(UART_BUFFER_BAUD_RATE)
+    #define UART_BUFFER_BAUD_RATE   115200UL
+#endif
+
+UART_CHECK_BAUD_RATE(F_MASTER, UART_BUFFER_BAUD_RATE);
+
+#if defined(DISCOVERY) || defined(UART_BUFFER_UART2)
+    #define UART_BUFFER_UART2
+    #define UART_BUFFER_REGISTER(name)  UART2_##name
+#else
+    #define UART_BUFFER_REGISTER(name)  UART1_##name
+#endif
+
+//
+//  What to do with a new character when the transmit buffer is full:
+//
+//  UART_TX_OVERFLOW_DROP       Discard the new character.
+//  UART_TX_OVERFLOW_BLOCK      Wait for the UART to take the oldest
+//                              character.  Interrupts are disabled while
+//                              waiting (at most one character time) so this
+//                              also works when called from an interrupt
+//                              service routine.
+//  UART_TX_OVERFLOW_OVERWRITE  Discard the oldest character in the buffer.
+//
+#define UART_TX_OVERFLOW_DROP       0
+#define UART_TX_OVERFLOW_BLOCK      1
+#define UART_TX_OVERFLOW_OVERWRITE  2
+
+#if !defined(UART_TX_OVERFLOW_POLICY)
+    #define UART_TX_OVERFLOW_POLICY UART_TX_OVERFLOW_BLOCK
+#endif
+
+#if !defined(UART_TX_BUFFER_SIZE)
+    #define UART_TX_BUFFER_SIZE     64
+#endif
+#define UART_TX_BUFFER_MASK         (UART_TX_BUFFER_SIZE - 1)
+
+#if ((UART_TX_BUFFER_SIZE & UART_TX_BUFFER_MASK) != 0) || (UART_TX_BUFFER_SIZE > 128)
+    #error "UART_TX_BUFFER_SIZE must be a power of two no larger than 128."
+#endif
+
+#if !defined(UART_RX_LINES)
+    #define UART_RX_LINES           4
+#endif
+#if !defined(UART_RX_LINE_LENGTH)
+    #define UART_RX_LINE_LENGTH     32
+#endif
+#define UART_RX_LINES_MASK          (UART_RX_LINES - 1)
+
+#if ((UART_RX_LINES & UART_RX_LINES_MASK) != 0) || (UART_RX_LINES > 128)
+    #error "UART_RX_LINES must be a power of two no larger than 128."
+#endif
+
+//
+//  Receive errors passed to UART_RX_ERROR, the bits in the status register,
+//  and the other receive status bits.
+//
+#define UART_RX_FRAMING_ERROR       0x02
+#define UART_RX_OVERRUN             0x08
+#define UART_RX_IDLE_LINE           0x10
+#define UART_RX_NOT_EMPTY           0x20
+
+//--------------------------------------------------------------------------------
+//
+//  Transmit buffer variables.  _txHead is only changed by the application
+//  and _txTail by the interrupt service routine (except when overwriting
+//  the oldest character, which is done with interrupts disabled).
+//
+unsigned char _txBuffer[UART_TX_BUFFER_SIZE];   //  Characters waiting to be sent.
+volatile unsigned char _txHead;                 //  Where the next character is added.
+volatile unsigned char _txTail;                 //  Next character to send.
+unsigned char _txHighWaterMark;                 //  Most characters held in the buffer.
+unsigned short _txDropped;                      //  Characters lost when the buffer was full.
+
+//
+//  Receive buffer variables.  _rxHead is only changed by the interrupt
+//  service routine and _rxTail by the application.
+//
+char _rxLines[UART_RX_LINES][UART_RX_LINE_LENGTH];  //  Lines received.
+volatile unsigned char _rxHead;                 //  Line being assembled.
+volatile unsigned char _rxTail;                 //  Oldest complete line.
+unsigned char _rxLength;                        //  Characters in the line being assembled.
+unsigned short _rxOverruns;                     //  Characters lost because the interrupt was late.
+unsigned short _rxFramingErrors;                //  Characters discarded with a framing error.
+unsigned short _rxDropped;                      //  Characters lost because the line or buffer was full.
+volatile unsigned char _rxIdle = 1;             //  No character since the line was last idle.
+
+//
+//  Space in the transmit buffer, whether everything has been handed to the
+//  UART and the number of complete lines waiting.
+//
+#define UARTTransmitFree()          (UART_TX_BUFFER_SIZE - (unsigned char) (_txHead - _txTail))
+#define UARTTransmitEmpty()         (_txHead == _txTail)
+#define UARTLinesWaiting()          ((unsigned char) (_rxHead - _rxTail))
+#define UARTReceiverIdle()          (_rxIdle)
+
+//--------------------------------------------------------------------------------
+//
+//  Set the baud rate registers for the master clock frequency, BRR2 must be
+//  written before BRR1.
+//
+static void UARTSetBaudRate(unsigned long fMaster)
+{
+    UART_BUFFER_REGISTER(BRR2) = UART_BRR2(fMaster, UART_BUFFER_BAUD_RATE);
+    UART_BUFFER_REGISTER(BRR1) = UART_BRR1(fMaster, UART_BUFFER_BAUD_RATE);
+}
+
+#if defined(CLOCK_SCALING_H)
+//--------------------------------------------------------------------------------
+//
+//  Keep the baud rate when the master clock changes.  The character being
+//  sent is allowed to finish first.  The receiver is not waited for here as
+//  interrupts are disabled and characters arriving back to back would
+//  overrun, the application checks UARTReceiverIdle before the change.
+//
+static void UARTClockChanged(unsigned char phase, unsigned long fMaster)
+{
+    if (phase == CLOCK_SCALING_PREPARE)
+    {
+        if (UART_BUFFER_REGISTER(CR2_TEN))
+        {
+            while (UART_BUFFER_REGISTER(SR_TC) == 0);
+        }
+    }
+    else
+    {
+        UARTSetBaudRate(fMaster);
+    }
+}
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  Setup the UART, no parity, one stop bit, 8 data bits, with the receive
+//  interrupt enabled.
+//
+void UARTInitialise()
+{
+    //
+    //  Clear the Idle Line Detected bit in the status register by a read
+    //  of the SR register followed by a read of the DR register.
+    //
+    unsigned char tmp = UART_BUFFER_REGISTER(SR);
+    tmp = UART_BUFFER_REGISTER(DR);
+    (void) tmp;
+    //
+    //  Reset the UART registers to the reset values.
+    //
+    UART_BUFFER_REGISTER(CR1) = 0;
+    UART_BUFFER_REGISTER(CR2) = 0;
+    UART_BUFFER_REGISTER(CR4) = 0;
+    UART_BUFFER_REGISTER(CR3) = 0;
+#if !defined(UART_BUFFER_UART2)
+    UART_BUFFER_REGISTER(CR5) = 0;
+#endif
+    UART_BUFFER_REGISTER(GTR) = 0;
+    UART_BUFFER_REGISTER(PSCR) = 0;
+    //
+    //  Now setup the port to n,8,1.
+    //
+    UART_BUFFER_REGISTER(CR1_M) = 0;        //  8 Data bits.
+    UART_BUFFER_REGISTER(CR1_PCEN) = 0;     //  Disable parity.
+    UART_BUFFER_REGISTER(CR3_STOP) = 0;     //  1 stop bit.
+#if defined(CLOCK_SCALING_H)
+    UARTSetBaudRate(MasterClockFrequency());
+#else
+    UARTSetBaudRate(F_MASTER);
+#endif
+    //
+    //  Set the clock polarity, lock phase and last bit clock pulse.
+    //
+    UART_BUFFER_REGISTER(CR3_CPOL) = 1;
+    UART_BUFFER_REGISTER(CR3_CPHA) = 1;
+    UART_BUFFER_REGISTER(CR3_LBCL) = 1;
+    //
+    //  Turn on the UART transmit, receive and the UART clock.
+    //
+    UART_BUFFER_REGISTER(CR2_TEN) = 1;
+    UART_BUFFER_REGISTER(CR2_REN) = 1;
+    UART_BUFFER_REGISTER(CR3_CKEN) = 1;
+    //
+    //  Interrupt when a character is received and when the line goes idle.
+    //
+    UART_BUFFER_REGISTER(CR2_RIEN) = 1;
+    UART_BUFFER_REGISTER(CR2_ILIEN) = 1;
+#if defined(CLOCK_SCALING_H)
+    ClockScalingRegister(UARTClockChanged);
+#endif
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Add a character to the transmit buffer and make sure that the transmit
+//  interrupt is enabled to send it.  Safe to call from an interrupt service
+//  routine.
+//
+void UARTPutChar(unsigned char ch)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    if ((unsigned char) (_txHead - _txTail) == UART_TX_BUFFER_SIZE)
+    {
+#if UART_TX_OVERFLOW_POLICY == UART_TX_OVERFLOW_BLOCK
+        while (UART_BUFFER_REGISTER(SR_TXE) == 0);      //  Wait for the oldest character to be taken.
+        UART_BUFFER_REGISTER(DR) = _txBuffer[_txTail & UART_TX_BUFFER_MASK];
+        _txTail++;
+#else
+        _txDropped++;
+    #if UART_TX_OVERFLOW_POLICY == UART_TX_OVERFLOW_OVERWRITE
+        _txTail++;                          //  Lose the oldest character.
+    #else
+        __set_interrupt_state(state);
+        return;                             //  Lose the new character.
+    #endif
+#endif
+    }
+    _txBuffer[_txHead & UART_TX_BUFFER_MASK] = ch;
+    _txHead++;
+    unsigned char count = (unsigned char) (_txHead - _txTail);
+    if (count > _txHighWaterMark)
+    {
+        _txHighWaterMark = count;
+    }
+    UART_BUFFER_REGISTER(CR2_TIEN) = 1;
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Send a string.
+//
+void UARTPrintF(const char *message)
+{
+    const char *ch = message;
+    while (*ch)
+    {
+        UARTPutChar((unsigned char) *ch);
+        ch++;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Send an unsigned number in decimal.
+//
+void UARTPrintNumber(unsigned short number)
+{
+    char digits[6];
+    char *ch = digits + sizeof(digits) - 1;
+    *ch = 0;
+    do
+    {
+        *--ch = (char) ('0' + (number % 10));
+        number /= 10;
+    }
+    while (number != 0);
+    UARTPrintF(ch);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Wait until the transmit buffer is empty and the last character has
+//  left the UART.
+//
+void UARTFlush()
+{
+    while (_txHead != _txTail);
+    while (UART_BUFFER_REGISTER(SR_TC) == 0);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Transmit interrupt, move the next character from the buffer into the
+//  data register.  The interrupt is disabled when the buffer is empty.
+//
+#if defined(UART_BUFFER_UART2)
+#pragma vector = UART2_T_TXE_vector
+__interrupt void UART2_TX_IRQHandler(void)
+#else
+#pragma vector = UART1_T_TXE_vector
+__interrupt void UART1_TX_IRQHandler(void)
+#endif
+{
+    if (_txHead != _txTail)
+    {
+        UART_BUFFER_REGISTER(DR) = _txBuffer[_txTail & UART_TX_BUFFER_MASK];
+        _txTail++;
+    }
+    if (_txHead == _txTail)
+    {
+        UART_BUFFER_REGISTER(CR2_TIEN) = 0;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Receive interrupt, add the character to the line being assembled.
+//
+//  Reading SR followed by DR clears the error and idle line flags.  An
+//  overrun means that this routine was not called within one character
+//  time of the previous character arriving and at least one character has
+//  been lost.  The idle line flag is only set again after a character has
+//  been received.
+//
+#if defined(UART_BUFFER_UART2)
+#pragma vector = UART2_R_RXNE_vector
+__interrupt void UART2_RX_IRQHandler(void)
+#else
+#pragma vector = UART1_R_RXNE_vector
+__interrupt void UART1_RX_IRQHandler(void)
+#endif
+{
+    unsigned char status = UART_BUFFER_REGISTER(SR);
+    char ch = (char) UART_BUFFER_REGISTER(DR);
+    _rxIdle = (status & UART_RX_IDLE_LINE) != 0;
+    if ((status & UART_RX_NOT_EMPTY) == 0)
+    {
+        return;                             //  Only the line going idle.
+    }
+    if (status & UART_RX_OVERRUN)
+    {
+        _rxOverruns++;
+#if defined(UART_RX_ERROR)
+        UART_RX_ERROR(UART_RX_OVERRUN, _rxOverruns);
+#endif
+    }
+    if (status & UART_RX_FRAMING_ERROR)
+    {
+        _rxFramingErrors++;
+#if defined(UART_RX_ERROR)
+        UART_RX_ERROR(UART_RX_FRAMING_ERROR, _rxFramingErrors);
+#endif
+        return;
+    }
+    if ((unsigned char) (_rxHead - _rxTail) == UART_RX_LINES)
+    {
+        _rxDropped++;                       //  No room for another line.
+        return;
+    }
+    char *line = _rxLines[_rxHead & UART_RX_LINES_MASK];
+    if ((ch == '\r') || (ch == '\n'))
+    {
+        if (_rxLength != 0)
+        {
+            line[_rxLength] = 0;
+            _rxLength = 0;
+            _rxHead++;                      //  Hand the line to the application.
+        }
+    }
+    else if (_rxLength < (UART_RX_LINE_LENGTH - 1))
+    {
+        line[_rxLength++] = ch;
+    }
+    else
+    {
+        _rxDropped++;
+    }
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Oldest complete line received or 0 if there is none.  The line stays in
+//  the receive buffer until UARTReleaseLine is called.
+//
+char *UARTGetLine()
+{
+    if (_rxHead == _rxTail)
+    {
+        return 0;
+    }
+    return _rxLines[_rxTail & UART_RX_LINES_MASK];
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Return the line from UARTGetLine to the receive buffer.
+//
+void UARTReleaseLine()
+{
+    _rxTail++;
+}
+
+#endif
@@ -0,0 +1,115 @@
+//
+//  Simple polled UART output for reporting results.
+//
+//  This is shared by the programs in Benchmarks, which print their results
+//  as name=value pairs with UARTPrintValue, and by the report functions in
+//  EdgeLog.h and Jitter.h.
+//
+//  Each character is written straight to the data register once the
+//  previous one has been taken, so printing takes about 87 us per
+//  character at 115200 baud and should be kept out of anything which is
+//  being timed.  See "04 - UART" for interrupt driven transmission.
+//
+//  The STM8S103 boards use UART1 and the Discovery board (STM8S105) UART2,
+//  both at UART_PRINT_BAUD_RATE (default 115200) calculated from F_MASTER
+//  so SystemClock.h must be included first.  Programs written only for the
+//  STM8S105 which do not define DISCOVERY define UART_PRINT_UART2 instead.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef UART_PRINT_H
+#define UART_PRINT_H
+
+#if !defined(SYSTEM_CLOCK_H)
+    #error "SystemClock.h must be included before UARTPrint.h"
+#endif
+
+#include "UARTBaudRate.h"
+
+#if !defined(UART_PRINT_BAUD_RATE)
+    #define UART_PRINT_BAUD_RATE    115200UL
+#endif
+
+UART_CHECK_BAUD_RATE(F_MASTER, UART_PRINT_BAUD_RATE);
+
+#if defined(DISCOVERY) || defined(UART_PRINT_UART2)
+    #define UART_PRINT_REGISTER(name)   UART2_##name
+#else
+    #define UART_PRINT_REGISTER(name)   UART1_##name
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  Setup the UART for transmission only, n, 8, 1.
+//
+void UARTPrintInitialise()
+{
+    UART_PRINT_REGISTER(CR1) = 0;                   //  8 data bits, no parity.
+    UART_PRINT_REGISTER(CR3) = 0;                   //  1 stop bit.
+    UART_PRINT_REGISTER(BRR2) = UART_BRR2(F_MASTER, UART_PRINT_BAUD_RATE);
+    UART_PRINT_REGISTER(BRR1) = UART_BRR1(F_MASTER, UART_PRINT_BAUD_RATE);
+    UART_PRINT_REGISTER(CR2) = 0x08;                //  TEN, no interrupts.
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Send a character once the data register is free.
+//
+void UARTPrintChar(char ch)
+{
+    while (UART_PRINT_REGISTER(SR_TXE) == 0);
+    UART_PRINT_REGISTER(DR) = (unsigned char) ch;
+}
+
+//
+//  Send a string.
+//
+void UARTPrintString(const char *text)
+{
+    while (*text)
+    {
+        UARTPrintChar(*text++);
+    }
+}
+
+//
+//  Send an unsigned number in decimal.
+//
+void UARTPrintUnsigned(unsigned long number)
+{
+    char digits[11];
+    char *ch = digits + sizeof(digits) - 1;
+    *ch = 0;
+    do
+    {
+        *--ch = (char) ('0' + (number % 10));
+        number /= 10;
+    }
+    while (number != 0);
+    UARTPrintString(ch);
+}
+
+//
+//  Send "name=value" followed by a separator, the results are printed as
+//  lines of these pairs so that they can be read by a script.
+//
+void UARTPrintValue(const char *name, unsigned long value, char separator)
+{
+    UARTPrintString(name);
+    UARTPrintChar('=');
+    UARTPrintUnsigned(value);
+    UARTPrintChar(separator);
+}
+
+//
+//  Wait for the last character to leave the UART.
+//
+void UARTPrintFlush()
+{
+    while (UART_PRINT_REGISTER(SR_TC) == 0);
+}
+
+#endif
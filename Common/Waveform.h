@@ -0,0 +1,209 @@
+//
+//  Waveform playback from sample tables on the PWM update event.
+//
+//  A table of duties (in flash) is played into a PWM channel, one sample
+//  per period.  The timer update interrupt advances a 16 bit phase
+//  accumulator by step for each period and writes the sample the top bits
+//  of the phase point at:
+//
+//      f_out = f_update * step / 65536
+//
+//  so one table plays at any rate from f_update / 65536 upwards without
+//  changing the timer.  A table can be played once (a fade which holds its
+//  last value) or looped, and the next table can be queued while the
+//  current one plays; it takes over when the phase wraps so the waveform
+//  changes at the end of a cycle rather than part way through:
+//
+//      #define SINE(i)     WAVEFORM_SINE(i, 64, 128, 127)
+//      const unsigned short _sine[64] = { WAVEFORM_64(SINE) };
+//
+//      Waveform _tone;
+//
+//      #pragma vector = TIM2_OVR_UIF_vector
+//      __interrupt void TIM2_UPD_OVF_IRQHandler(void)
+//      {
+//          TIM2_SR1_UIF = 0;
+//          WaveformUpdate(&_tone);
+//      }
+//
+//      PwmTimer2Initialise(0, 256, PWM_CHANNEL(1));
+//      WaveformPlay(&_tone, PwmTimer2Duty, 1, _sine, 6, WAVEFORM_STEP(440, 62500), 1);
+//      TIM2_IER_UIE = 1;
+//
+//  The output function is one of the Pwm.h duty functions, the sample is
+//  written to the preload register just after an update event so it is
+//  loaded whole at the next one.  The update interrupt must finish within
+//  a period for this to hold.
+//
+//  Tables are built by the compiler from the sample macros below, nothing
+//  is calculated at run time.  WAVEFORM_64(F) expands to F(0), F(1) ...
+//  F(63) (WAVEFORM_16 and WAVEFORM_256 likewise) and the samples are:
+//
+//      WAVEFORM_SINE(i, n, offset, amplitude)
+//                              offset + amplitude * sin(2 pi i / n).
+//      WAVEFORM_GAMMA(i, n, maximum)
+//                              Ramp from 0 to maximum corrected for the
+//                              eye (gamma 2.2, within 1% of maximum) for
+//                              LED fades.
+//
+//  Tables hold a power of two number of samples, 2 to 256.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <intrinsics.h>
+
+//
+//  Phase step for a frequency (Hz) from an update rate (Hz).
+//
+#define WAVEFORM_STEP(frequency, updateRate)    ((unsigned short) (((frequency) * 65536.0 / (updateRate)) + 0.5))
+
+//
+//  sin(x) for 0 <= x <= pi / 2 (Taylor series, error below 4e-6) and for
+//  the sample i of n in a full cycle.
+//
+#define WAVEFORM_PI                 3.14159265358979
+#define WAVEFORM_SIN_QUADRANT(x)    ((x) * (1.0 - ((x) * (x) / 6.0) * (1.0 - ((x) * (x) / 20.0) * (1.0 - ((x) * (x) / 42.0) * (1.0 - ((x) * (x) / 72.0))))))
+#define WAVEFORM_ANGLE(i, n)        (2.0 * WAVEFORM_PI * (i) / (n))
+#define WAVEFORM_SIN(i, n)                                                                      \
+    ((4 * (i) <= (n)) ? WAVEFORM_SIN_QUADRANT(WAVEFORM_ANGLE(i, n)) :                           \
+     (2 * (i) <= (n)) ? WAVEFORM_SIN_QUADRANT(WAVEFORM_PI - WAVEFORM_ANGLE(i, n)) :             \
+     (4 * (i) <= 3 * (n)) ? -WAVEFORM_SIN_QUADRANT(WAVEFORM_ANGLE(i, n) - WAVEFORM_PI) :        \
+     -WAVEFORM_SIN_QUADRANT(2.0 * WAVEFORM_PI - WAVEFORM_ANGLE(i, n)))
+
+#define WAVEFORM_SINE(i, n, offset, amplitude)      ((unsigned short) ((offset) + ((amplitude) * WAVEFORM_SIN(i, n)) + 0.5))
+
+//
+//  x^2.2 approximated by x^2 (0.8 + 0.2 x) for 0 <= x <= 1.
+//
+#define WAVEFORM_GAMMA_X(i, n)      ((double) (i) / ((n) - 1))
+#define WAVEFORM_GAMMA(i, n, maximum)                                                           \
+    ((unsigned short) (((maximum) * WAVEFORM_GAMMA_X(i, n) * WAVEFORM_GAMMA_X(i, n) * (0.8 + 0.2 * WAVEFORM_GAMMA_X(i, n))) + 0.5))
+
+//
+//  Table initialisers, F(i) for each sample.
+//
+#define WAVEFORM_4(F, base)         F((base) + 0), F((base) + 1), F((base) + 2), F((base) + 3)
+#define WAVEFORM_16_FROM(F, base)   WAVEFORM_4(F, (base) + 0), WAVEFORM_4(F, (base) + 4), WAVEFORM_4(F, (base) + 8), WAVEFORM_4(F, (base) + 12)
+#define WAVEFORM_64_FROM(F, base)   WAVEFORM_16_FROM(F, (base) + 0), WAVEFORM_16_FROM(F, (base) + 16), WAVEFORM_16_FROM(F, (base) + 32), WAVEFORM_16_FROM(F, (base) + 48)
+#define WAVEFORM_16(F)              WAVEFORM_16_FROM(F, 0)
+#define WAVEFORM_64(F)              WAVEFORM_64_FROM(F, 0)
+#define WAVEFORM_256(F)             WAVEFORM_64_FROM(F, 0), WAVEFORM_64_FROM(F, 64), WAVEFORM_64_FROM(F, 128), WAVEFORM_64_FROM(F, 192)
+
+//
+//  Writes a sample to a channel (PwmTimer1Duty or PwmTimer2Duty).
+//
+typedef void (*WaveformOutput)(unsigned char channel, unsigned short value);
+
+//
+//  Playback state for one channel.
+//
+typedef struct
+{
+    const unsigned short *table;            //  Table being played, 0 when stopped.
+    const unsigned short *next;             //  Queued table, 0 if none.
+    WaveformOutput output;
+    unsigned char channel;
+    unsigned char shift;                    //  16 - log2(table length).
+    unsigned char loop;                     //  Non-zero to repeat the table.
+    unsigned short phase;
+    unsigned short step;
+    unsigned long cycles;                   //  Complete passes through a table.
+} Waveform;
+
+//--------------------------------------------------------------------------------
+//
+//  Start playing a table of 2^bits samples (bits 1 to 8) into channel,
+//  once or looped, from the next update.
+//
+void WaveformPlay(Waveform *waveform, WaveformOutput output, unsigned char channel, const unsigned short *table,
+                  unsigned char bits, unsigned short step, unsigned char loop)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    waveform->output = output;
+    waveform->channel = channel;
+    waveform->shift = (unsigned char) (16 - bits);
+    waveform->loop = loop;
+    waveform->phase = 0;
+    waveform->step = step;
+    waveform->next = 0;
+    waveform->cycles = 0;
+    waveform->table = table;
+    __set_interrupt_state(state);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Queue a table of the same length to play when the current pass ends,
+//  it is played once or looped as the current table was.  Returns 0 if a
+//  table is already queued.
+//
+unsigned char WaveformQueue(Waveform *waveform, const unsigned short *table)
+{
+    unsigned char queued = 0;
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    if (waveform->next == 0)
+    {
+        waveform->next = table;
+        queued = 1;
+    }
+    __set_interrupt_state(state);
+    return queued;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Change the playback rate, the phase carries on from where it is.
+//
+void WaveformRate(Waveform *waveform, unsigned short step)
+{
+    __istate_t state = __get_interrupt_state();
+    __disable_interrupt();
+    waveform->step = step;
+    __set_interrupt_state(state);
+}
+
+#define WaveformPlaying(waveform)   ((waveform)->table != 0)
+
+//--------------------------------------------------------------------------------
+//
+//  Output the next sample, call this from the timer update interrupt.  At
+//  the end of a pass the queued table takes over, a table played once
+//  holds its last sample and stops.
+//
+void WaveformUpdate(Waveform *waveform)
+{
+    const unsigned short *table = waveform->table;
+    if (table == 0)
+    {
+        return;
+    }
+    unsigned short phase = waveform->phase;
+    unsigned short next = (unsigned short) (phase + waveform->step);
+    waveform->output(waveform->channel, table[phase >> waveform->shift]);
+    if (next < phase)
+    {
+        waveform->cycles++;
+        if (waveform->next != 0)
+        {
+            waveform->table = waveform->next;
+            waveform->next = 0;
+        }
+        else if (!waveform->loop)
+        {
+            waveform->output(waveform->channel, table[0xffff >> waveform->shift]);
+            waveform->table = 0;
+            return;
+        }
+    }
+    waveform->phase = next;
+}
+
+#endif
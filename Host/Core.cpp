@@ -0,0 +1,1434 @@
+//
+//  STM8 instruction set simulator.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#include <cstdio>
+
+#include "Core.h"
+
+namespace STM8
+{
+    //
+    //  Condition code register flags.
+    //
+    const unsigned char FLAG_V = 0x80;
+    const unsigned char FLAG_I1 = 0x20;
+    const unsigned char FLAG_H = 0x10;
+    const unsigned char FLAG_I0 = 0x08;
+    const unsigned char FLAG_N = 0x04;
+    const unsigned char FLAG_Z = 0x02;
+    const unsigned char FLAG_C = 0x01;
+
+    //
+    //  Instruction prefixes.
+    //
+    const unsigned char PREFIX_NONE = 0x00;
+    const unsigned char PREFIX_72 = 0x72;
+    const unsigned char PREFIX_90 = 0x90;
+    const unsigned char PREFIX_91 = 0x91;
+    const unsigned char PREFIX_92 = 0x92;
+
+    //
+    //  Extra cycles for the indirect (pointer) addressing modes.
+    //
+    const unsigned long IndirectCycles = 3;
+
+    //
+    //  Worst case for DIV and DIVW.
+    //
+    const unsigned long DivideCycles = 17;
+
+    //
+    //  First interrupt controller software priority register.
+    //
+    const unsigned short ITC_SPR1_ADDRESS = 0x7f70;
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Constructor.
+    //
+    Core::Core(Simulator &simulator) : _simulator(simulator), _profiling(false)
+    {
+        Reset();
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Reset values of the registers, the stack starts at the top of RAM.
+    //
+    void Core::Reset()
+    {
+        _a = 0;
+        _x = 0;
+        _y = 0;
+        _sp = _simulator.MediumDensity() ? 0x07ff : 0x03ff;
+        _cc = FLAG_I1 | FLAG_I0;
+        _pc = VectorAddress(0);
+        _instructionAddress = _pc;
+        _state = State::Running;
+        _instructions = 0;
+        _profile.clear();
+        _active.clear();
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Run until the simulator throws SimulationComplete.
+    //
+    void Core::Run()
+    {
+        while (true)
+        {
+            Step();
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Service an interrupt, let time pass while waiting for one or execute
+    //  the next instruction.
+    //
+    void Core::Step()
+    {
+        if (TakeInterrupt())
+        {
+            return;
+        }
+        if (_state == State::WaitingForEvent)
+        {
+            if (_simulator.PendingInterrupts() != 0)
+            {
+                _state = State::Running;
+            }
+            else
+            {
+                _simulator.Idle(false);
+            }
+            return;
+        }
+        if (_state != State::Running)
+        {
+            _simulator.Idle(_state == State::Halted);
+            return;
+        }
+        uint32_t address = _pc;
+        unsigned long cycles = Execute();
+        _instructions++;
+        if (_profiling)
+        {
+            ProfileCount &count = _profile[address];
+            count.instructions++;
+            count.cycles += cycles;
+        }
+        _simulator.Execute(cycles);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Vector table entry.
+    //
+    uint32_t Core::VectorAddress(int vector) const
+    {
+        unsigned short entry = (unsigned short) (VectorTableAddress + (vector * 4));
+        return ((uint32_t) _simulator.Memory(entry + 1) << 16) |
+               ((uint32_t) _simulator.Memory(entry + 2) << 8) |
+               _simulator.Memory(entry + 3);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Instruction stream.
+    //
+    unsigned char Core::Fetch()
+    {
+        unsigned char value = _simulator.Memory((unsigned short) _pc);
+        _pc = (_pc + 1) & 0xffffff;
+        return value;
+    }
+
+    unsigned short Core::FetchWord()
+    {
+        unsigned short high = Fetch();
+        return (unsigned short) ((high << 8) | Fetch());
+    }
+
+    uint32_t Core::FetchExtended()
+    {
+        uint32_t extended = Fetch();
+        return (extended << 16) | FetchWord();
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Data memory.  Only the first 64K of the address space is present on
+    //  these devices.  The program memory is write protected.
+    //
+    unsigned char Core::Read(uint32_t address)
+    {
+        return _simulator.BusRead((unsigned short) address);
+    }
+
+    unsigned short Core::ReadWord(uint32_t address)
+    {
+        unsigned short high = Read(address);
+        return (unsigned short) ((high << 8) | Read(address + 1));
+    }
+
+    uint32_t Core::ReadExtended(uint32_t address)
+    {
+        uint32_t extended = Read(address);
+        return (extended << 16) | ReadWord(address + 1);
+    }
+
+    void Core::Write(uint32_t address, unsigned char value)
+    {
+        if ((address & 0xffff) < VectorTableAddress)
+        {
+            _simulator.BusWrite((unsigned short) address, value);
+        }
+    }
+
+    void Core::WriteWord(uint32_t address, unsigned short value)
+    {
+        Write(address, (unsigned char) (value >> 8));
+        Write(address + 1, (unsigned char) value);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  The stack grows down, SP points to the next free location.
+    //
+    void Core::Push(unsigned char value)
+    {
+        Write(_sp, value);
+        _sp--;
+    }
+
+    void Core::PushWord(unsigned short value)
+    {
+        Push((unsigned char) value);
+        Push((unsigned char) (value >> 8));
+    }
+
+    unsigned char Core::Pop()
+    {
+        _sp++;
+        return Read(_sp);
+    }
+
+    unsigned short Core::PopWord()
+    {
+        unsigned short high = Pop();
+        return (unsigned short) ((high << 8) | Pop());
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Interrupt levels are encoded in I1:I0 (and ITC_SPRx) as
+    //  10 = level 0 (main), 01 = level 1, 00 = level 2 and 11 = level 3.
+    //
+    static int DecodeLevel(unsigned int bits)
+    {
+        static const int levels[4] = { 2, 1, 0, 3 };
+        return levels[bits & 0x03];
+    }
+
+    int Core::Level() const
+    {
+        return DecodeLevel((Flag(FLAG_I1) ? 2 : 0) | (Flag(FLAG_I0) ? 1 : 0));
+    }
+
+    void Core::SetLevel(int level)
+    {
+        static const unsigned char bits[4] = { FLAG_I1, FLAG_I0, 0, FLAG_I1 | FLAG_I0 };
+        _cc = (unsigned char) ((_cc & ~(FLAG_I1 | FLAG_I0)) | bits[level]);
+    }
+
+    int Core::VectorPriority(int vector) const
+    {
+        int irq = vector - 2;
+        unsigned char spr = _simulator.Memory((unsigned short) (ITC_SPR1_ADDRESS + (irq / 4)));
+        return DecodeLevel(spr >> ((irq % 4) * 2));
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Take the highest priority pending interrupt if it is above the
+    //  current level.
+    //
+    bool Core::TakeInterrupt()
+    {
+        uint32_t pending = _simulator.PendingInterrupts();
+        if (pending == 0)
+        {
+            return false;
+        }
+        int selected = -1;
+        int priority = Level();
+        for (int vector = 2; vector < NumberOfVectors; vector++)
+        {
+            if ((pending & (1UL << vector)) && (VectorPriority(vector) > priority))
+            {
+                selected = vector;
+                priority = VectorPriority(vector);
+            }
+        }
+        if (selected < 0)
+        {
+            return false;
+        }
+        _simulator.AcknowledgeInterrupt(selected);
+        _state = State::Running;
+        EnterInterrupt(selected, priority);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Save the context and jump to the handler.
+    //
+    void Core::EnterInterrupt(int vector, int level)
+    {
+        _active.push_back(std::make_pair(vector, _simulator.CpuCycles()));
+        Push((unsigned char) _pc);
+        Push((unsigned char) (_pc >> 8));
+        Push((unsigned char) (_pc >> 16));
+        PushWord(_y);
+        PushWord(_x);
+        Push(_a);
+        Push(_cc);
+        SetLevel(level);
+        _pc = VectorAddress(vector);
+        _simulator.Execute(InterruptEntryCycles);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Stop the simulation at an opcode the core does not recognise.  The
+    //  microcontroller would reset.
+    //
+    void Core::IllegalOpcode(unsigned char prefix, unsigned char opcode)
+    {
+        char message[80];
+        if (prefix == PREFIX_NONE)
+        {
+            snprintf(message, sizeof(message), "illegal opcode %02x at 0x%06x", opcode, (unsigned) _instructionAddress);
+        }
+        else
+        {
+            snprintf(message, sizeof(message), "illegal opcode %02x %02x at 0x%06x", prefix, opcode, (unsigned) _instructionAddress);
+        }
+        _simulator.Stop(message);
+        _simulator.Execute(1);
+        throw SimulationComplete(message);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Decode and execute one instruction returning the number of cycles.
+    //
+    unsigned long Core::Execute()
+    {
+        _instructionAddress = _pc;
+        unsigned char prefix = PREFIX_NONE;
+        unsigned char opcode = Fetch();
+        if ((opcode == PREFIX_72) || (opcode == PREFIX_90) || (opcode == PREFIX_91) || (opcode == PREFIX_92))
+        {
+            prefix = opcode;
+            opcode = Fetch();
+        }
+        unsigned char high = opcode >> 4;
+        if (((prefix == PREFIX_72) && (high <= 1)) || ((prefix == PREFIX_90) && (high == 1)))
+        {
+            return ExecuteBitOperation(prefix, opcode);
+        }
+        if (high == 2)
+        {
+            return ExecuteRelativeJump(prefix, opcode);
+        }
+        if ((high == 8) || (high == 9))
+        {
+            return ExecuteSpecial(prefix, opcode);
+        }
+        if ((high == 1) || (high >= 0x0a))
+        {
+            return ExecuteAccumulator(prefix, opcode);
+        }
+        return ExecuteReadModifyWrite(prefix, opcode);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Flags.
+    //
+    void Core::SetFlag(unsigned char flag, bool value)
+    {
+        if (value)
+        {
+            _cc |= flag;
+        }
+        else
+        {
+            _cc &= (unsigned char) ~flag;
+        }
+    }
+
+    void Core::SetNZ(unsigned char value)
+    {
+        SetFlag(FLAG_N, (value & 0x80) != 0);
+        SetFlag(FLAG_Z, value == 0);
+    }
+
+    void Core::SetNZWord(unsigned short value)
+    {
+        SetFlag(FLAG_N, (value & 0x8000) != 0);
+        SetFlag(FLAG_Z, value == 0);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Arithmetic.
+    //
+    unsigned char Core::Add(unsigned char a, unsigned char b, bool carry)
+    {
+        unsigned int c = carry ? 1 : 0;
+        unsigned int sum = a + b + c;
+        unsigned char result = (unsigned char) sum;
+        SetFlag(FLAG_V, ((a ^ result) & (b ^ result) & 0x80) != 0);
+        SetFlag(FLAG_H, ((a & 0x0f) + (b & 0x0f) + c) > 0x0f);
+        SetFlag(FLAG_C, sum > 0xff);
+        SetNZ(result);
+        return result;
+    }
+
+    unsigned char Core::Subtract(unsigned char a, unsigned char b, bool borrow)
+    {
+        unsigned int c = borrow ? 1 : 0;
+        unsigned char result = (unsigned char) (a - b - c);
+        SetFlag(FLAG_V, ((a ^ b) & (a ^ result) & 0x80) != 0);
+        SetFlag(FLAG_C, (unsigned int) a < (b + c));
+        SetNZ(result);
+        return result;
+    }
+
+    unsigned short Core::AddWord(unsigned short a, unsigned short b)
+    {
+        unsigned long sum = (unsigned long) a + b;
+        unsigned short result = (unsigned short) sum;
+        SetFlag(FLAG_V, ((a ^ result) & (b ^ result) & 0x8000) != 0);
+        SetFlag(FLAG_H, ((a & 0xff) + (b & 0xff)) > 0xff);
+        SetFlag(FLAG_C, sum > 0xffff);
+        SetNZWord(result);
+        return result;
+    }
+
+    unsigned short Core::SubtractWord(unsigned short a, unsigned short b, bool halfCarry)
+    {
+        unsigned short result = (unsigned short) (a - b);
+        SetFlag(FLAG_V, ((a ^ b) & (a ^ result) & 0x8000) != 0);
+        if (halfCarry)
+        {
+            SetFlag(FLAG_H, (a & 0xff) < (b & 0xff));
+        }
+        SetFlag(FLAG_C, a < b);
+        SetNZWord(result);
+        return result;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Single operand byte operations selected by the low nibble of the
+    //  opcode (NEG, CPL, SRL, RRC, SRA, SLL, RLC, DEC, INC, TNZ, SWAP, CLR).
+    //
+    unsigned char Core::ReadModifyWrite(unsigned char operation, unsigned char value)
+    {
+        unsigned char result = value;
+        switch (operation)
+        {
+            case 0x0:
+                result = (unsigned char) -value;
+                SetFlag(FLAG_V, result == 0x80);
+                SetFlag(FLAG_C, result != 0);
+                break;
+            case 0x3:
+                result = (unsigned char) ~value;
+                SetFlag(FLAG_C, true);
+                break;
+            case 0x4:
+                result = value >> 1;
+                SetFlag(FLAG_C, value & 0x01);
+                break;
+            case 0x6:
+                result = (unsigned char) ((value >> 1) | (Flag(FLAG_C) ? 0x80 : 0));
+                SetFlag(FLAG_C, value & 0x01);
+                break;
+            case 0x7:
+                result = (unsigned char) ((value >> 1) | (value & 0x80));
+                SetFlag(FLAG_C, value & 0x01);
+                break;
+            case 0x8:
+                result = (unsigned char) (value << 1);
+                SetFlag(FLAG_C, value & 0x80);
+                break;
+            case 0x9:
+                result = (unsigned char) ((value << 1) | (Flag(FLAG_C) ? 1 : 0));
+                SetFlag(FLAG_C, value & 0x80);
+                break;
+            case 0xa:
+                result = (unsigned char) (value - 1);
+                SetFlag(FLAG_V, value == 0x80);
+                break;
+            case 0xc:
+                result = (unsigned char) (value + 1);
+                SetFlag(FLAG_V, value == 0x7f);
+                break;
+            case 0xd:
+                break;
+            case 0xe:
+                result = (unsigned char) ((value << 4) | (value >> 4));
+                break;
+            case 0xf:
+                result = 0;
+                break;
+        }
+        SetNZ(result);
+        return result;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Index register selected by the prefix, Y for 0x90 and 0x91.
+    //
+    unsigned short &Core::IndexRegister(unsigned char prefix)
+    {
+        return ((prefix == PREFIX_90) || (prefix == PREFIX_91)) ? _y : _x;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Operand address for the accumulator group (high nibble 1 and A to F).
+    //
+    //      1   (shortoff,SP)
+    //      B   shortmem
+    //      C   longmem, [shortptr.w] (92, 91), [longptr.w] (72)
+    //      D   (longoff,X), (longoff,Y) (90), ([shortptr.w],X) (92),
+    //          ([shortptr.w],Y) (91), ([longptr.w],X) (72)
+    //      E   (shortoff,X), (shortoff,Y) (90)
+    //      F   (X), (Y) (90)
+    //
+    bool Core::DecodeAccumulatorOperand(unsigned char prefix, unsigned char mode, Operand &operand)
+    {
+        operand.cycles = 0;
+        switch (mode)
+        {
+            case 0x1:
+                if (prefix != PREFIX_NONE)
+                {
+                    return false;
+                }
+                operand.address = (unsigned short) (_sp + Fetch());
+                return true;
+            case 0xb:
+                if ((prefix != PREFIX_NONE) && (prefix != PREFIX_90))
+                {
+                    return false;
+                }
+                operand.address = Fetch();
+                return true;
+            case 0xc:
+                if ((prefix == PREFIX_NONE) || (prefix == PREFIX_90))
+                {
+                    operand.address = FetchWord();
+                }
+                else if (prefix == PREFIX_72)
+                {
+                    operand.address = ReadWord(FetchWord());
+                    operand.cycles = IndirectCycles;
+                }
+                else
+                {
+                    operand.address = ReadWord(Fetch());
+                    operand.cycles = IndirectCycles;
+                }
+                return true;
+            case 0xd:
+                if ((prefix == PREFIX_NONE) || (prefix == PREFIX_90))
+                {
+                    operand.address = (unsigned short) (FetchWord() + IndexRegister(prefix));
+                }
+                else if (prefix == PREFIX_72)
+                {
+                    operand.address = (unsigned short) (ReadWord(FetchWord()) + _x);
+                    operand.cycles = IndirectCycles;
+                }
+                else
+                {
+                    operand.address = (unsigned short) (ReadWord(Fetch()) + IndexRegister(prefix));
+                    operand.cycles = IndirectCycles;
+                }
+                return true;
+            case 0xe:
+                if ((prefix != PREFIX_NONE) && (prefix != PREFIX_90))
+                {
+                    return false;
+                }
+                operand.address = (unsigned short) (Fetch() + IndexRegister(prefix));
+                return true;
+            case 0xf:
+                if ((prefix != PREFIX_NONE) && (prefix != PREFIX_90))
+                {
+                    return false;
+                }
+                operand.address = IndexRegister(prefix);
+                return true;
+        }
+        return false;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Accumulator and word load/compare group.  The low nibble selects
+    //  SUB, CP, SBC, CPW, AND, BCP, LD A,mem, LD mem,A, XOR, ADC, OR, ADD,
+    //  JP, CALL, LDW reg,mem and LDW mem,reg.  The high nibble selects the
+    //  addressing mode with A being immediate.
+    //
+    unsigned long Core::ExecuteAccumulator(unsigned char prefix, unsigned char opcode)
+    {
+        unsigned char mode = opcode >> 4;
+        unsigned char operation = opcode & 0x0f;
+        //
+        //  Word arithmetic and far addressing which share the opcode space.
+        //
+        if (prefix == PREFIX_72)
+        {
+            switch (opcode)
+            {
+                case 0xa2:
+                    _y = SubtractWord(_y, FetchWord(), true);
+                    return 2;
+                case 0xa9:
+                    _y = AddWord(_y, FetchWord());
+                    return 2;
+                case 0xb0:
+                    _x = SubtractWord(_x, ReadWord(FetchWord()), true);
+                    return 2;
+                case 0xb2:
+                    _y = SubtractWord(_y, ReadWord(FetchWord()), true);
+                    return 2;
+                case 0xb9:
+                    _y = AddWord(_y, ReadWord(FetchWord()));
+                    return 2;
+                case 0xbb:
+                    _x = AddWord(_x, ReadWord(FetchWord()));
+                    return 2;
+                case 0xf0:
+                    _x = SubtractWord(_x, ReadWord((unsigned short) (_sp + Fetch())), true);
+                    return 2;
+                case 0xf2:
+                    _y = SubtractWord(_y, ReadWord((unsigned short) (_sp + Fetch())), true);
+                    return 2;
+                case 0xf9:
+                    _y = AddWord(_y, ReadWord((unsigned short) (_sp + Fetch())));
+                    return 2;
+                case 0xfb:
+                    _x = AddWord(_x, ReadWord((unsigned short) (_sp + Fetch())));
+                    return 2;
+            }
+            if ((mode != 0x0c) && (mode != 0x0d))
+            {
+                IllegalOpcode(prefix, opcode);
+            }
+        }
+        if (prefix == PREFIX_NONE)
+        {
+            switch (opcode)
+            {
+                case 0x16:
+                    _y = ReadWord((unsigned short) (_sp + Fetch()));
+                    SetNZWord(_y);
+                    return 2;
+                case 0x17:
+                    WriteWord((unsigned short) (_sp + Fetch()), _y);
+                    SetNZWord(_y);
+                    return 2;
+                case 0x1c:
+                    _x = AddWord(_x, FetchWord());
+                    return 2;
+                case 0x1d:
+                    _x = SubtractWord(_x, FetchWord(), true);
+                    return 2;
+                case 0xac:
+                    _pc = FetchExtended();
+                    return 2;
+                case 0xad:
+                {
+                    signed char offset = (signed char) Fetch();
+                    PushWord((unsigned short) _pc);
+                    _pc = (_pc + offset) & 0xffffff;
+                    return 4;
+                }
+                case 0xbc:
+                    _a = Read(FetchExtended());
+                    SetNZ(_a);
+                    return 1;
+                case 0xbd:
+                    Write(FetchExtended(), _a);
+                    SetNZ(_a);
+                    return 1;
+            }
+        }
+        if (prefix == PREFIX_92)
+        {
+            switch (opcode)
+            {
+                case 0xac:
+                    _pc = ReadExtended(FetchWord());
+                    return 6;
+                case 0xbc:
+                    _a = Read(ReadExtended(FetchWord()));
+                    SetNZ(_a);
+                    return 5;
+                case 0xbd:
+                    Write(ReadExtended(FetchWord()), _a);
+                    SetNZ(_a);
+                    return 5;
+            }
+        }
+        //
+        //  LDF with extended indexed addressing.
+        //
+        if ((opcode == 0xa7) || (opcode == 0xaf))
+        {
+            uint32_t address;
+            unsigned long cycles = 1;
+            if ((prefix == PREFIX_NONE) || (prefix == PREFIX_90))
+            {
+                address = FetchExtended() + IndexRegister(prefix);
+            }
+            else
+            {
+                address = ReadExtended(FetchWord()) + IndexRegister(prefix);
+                cycles = 5;
+            }
+            if (opcode == 0xa7)
+            {
+                Write(address, _a);
+            }
+            else
+            {
+                _a = Read(address);
+            }
+            SetNZ(_a);
+            return cycles;
+        }
+        //
+        //  Immediate operands.
+        //
+        bool word = (operation == 0x3) || (operation == 0xe) || (operation == 0xf);
+        bool yOperation = (prefix == PREFIX_90) || (prefix == PREFIX_91);
+        if (((prefix == PREFIX_90) && (mode >= 0x0a) && (mode <= 0x0c) && !word) ||
+            ((prefix == PREFIX_91) && (mode == 0x0c) && !word) ||
+            ((prefix == PREFIX_91) && (mode != 0x0c) && (mode != 0x0d)) ||
+            ((prefix == PREFIX_92) && (mode != 0x0c) && (mode != 0x0d)))
+        {
+            IllegalOpcode(prefix, opcode);
+        }
+        unsigned short immediate = 0;
+        Operand operand = { 0, 0 };
+        if (mode == 0x0a)
+        {
+            if ((operation == 0x7) || (operation == 0xc) || (operation == 0xd) || (operation == 0xf) ||
+                ((prefix == PREFIX_90) && (operation != 0x3) && (operation != 0xe)))
+            {
+                IllegalOpcode(prefix, opcode);
+            }
+            immediate = word ? FetchWord() : Fetch();
+        }
+        else if (!DecodeAccumulatorOperand(prefix, mode, operand))
+        {
+            IllegalOpcode(prefix, opcode);
+        }
+        //
+        //  Word operations use X or Y.  With the indexed modes LDW loads the
+        //  index register while CPW and the LDW store use the other one.
+        //
+        bool indexed = mode >= 0x0d;
+        unsigned short &index = IndexRegister(prefix);
+        unsigned short &other = (&index == &_x) ? _y : _x;
+        unsigned short &wordRegister = indexed ? ((operation == 0xe) ? index : other) : (yOperation ? _y : _x);
+        unsigned char value = 0;
+        if (!word && (operation != 0x7) && (operation != 0xc) && (operation != 0xd))
+        {
+            value = (mode == 0x0a) ? (unsigned char) immediate : Read(operand.address);
+        }
+        switch (operation)
+        {
+            case 0x0:
+                _a = Subtract(_a, value, false);
+                break;
+            case 0x1:
+                Subtract(_a, value, false);
+                break;
+            case 0x2:
+                _a = Subtract(_a, value, Flag(FLAG_C));
+                break;
+            case 0x3:
+                SubtractWord(wordRegister, (mode == 0x0a) ? immediate : ReadWord(operand.address), false);
+                return 2 + operand.cycles;
+            case 0x4:
+                _a &= value;
+                SetNZ(_a);
+                break;
+            case 0x5:
+                SetNZ(_a & value);
+                break;
+            case 0x6:
+                _a = value;
+                SetNZ(_a);
+                break;
+            case 0x7:
+                Write(operand.address, _a);
+                SetNZ(_a);
+                break;
+            case 0x8:
+                _a ^= value;
+                SetNZ(_a);
+                break;
+            case 0x9:
+                _a = Add(_a, value, Flag(FLAG_C));
+                break;
+            case 0xa:
+                _a |= value;
+                SetNZ(_a);
+                break;
+            case 0xb:
+                _a = Add(_a, value, false);
+                break;
+            case 0xc:
+                _pc = (_pc & 0xff0000) | (operand.address & 0xffff);
+                return operand.cycles ? 5 : 1;
+            case 0xd:
+                PushWord((unsigned short) _pc);
+                _pc = (_pc & 0xff0000) | (operand.address & 0xffff);
+                return 4 + (operand.cycles ? 2 : 0);
+            case 0xe:
+                wordRegister = (mode == 0x0a) ? immediate : ReadWord(operand.address);
+                SetNZWord(wordRegister);
+                return 2 + operand.cycles;
+            case 0xf:
+                WriteWord(operand.address, wordRegister);
+                SetNZWord(wordRegister);
+                return 2 + operand.cycles;
+        }
+        return 1 + operand.cycles;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Operand address for the read-modify-write group.
+    //
+    //      0   (shortoff,SP)
+    //      3   shortmem, [longptr.w] (72), [shortptr.w] (92)
+    //      4   (longoff,X) (72), (longoff,Y) (90)
+    //      5   longmem (72)
+    //      6   (shortoff,X), (shortoff,Y) (90), ([longptr.w],X) (72),
+    //          ([shortptr.w],X) (92), ([shortptr.w],Y) (91)
+    //      7   (X), (Y) (90)
+    //
+    bool Core::DecodeReadModifyWriteOperand(unsigned char prefix, unsigned char mode, Operand &operand)
+    {
+        operand.cycles = 0;
+        switch (prefix)
+        {
+            case PREFIX_NONE:
+                switch (mode)
+                {
+                    case 0x0:
+                        operand.address = (unsigned short) (_sp + Fetch());
+                        return true;
+                    case 0x3:
+                        operand.address = Fetch();
+                        return true;
+                    case 0x6:
+                        operand.address = (unsigned short) (_x + Fetch());
+                        return true;
+                    case 0x7:
+                        operand.address = _x;
+                        return true;
+                }
+                break;
+            case PREFIX_90:
+                switch (mode)
+                {
+                    case 0x4:
+                        operand.address = (unsigned short) (_y + FetchWord());
+                        return true;
+                    case 0x6:
+                        operand.address = (unsigned short) (_y + Fetch());
+                        return true;
+                    case 0x7:
+                        operand.address = _y;
+                        return true;
+                }
+                break;
+            case PREFIX_72:
+                switch (mode)
+                {
+                    case 0x3:
+                        operand.address = ReadWord(FetchWord());
+                        operand.cycles = IndirectCycles;
+                        return true;
+                    case 0x4:
+                        operand.address = (unsigned short) (_x + FetchWord());
+                        return true;
+                    case 0x5:
+                        operand.address = FetchWord();
+                        return true;
+                    case 0x6:
+                        operand.address = (unsigned short) (ReadWord(FetchWord()) + _x);
+                        operand.cycles = IndirectCycles;
+                        return true;
+                }
+                break;
+            case PREFIX_92:
+                switch (mode)
+                {
+                    case 0x3:
+                        operand.address = ReadWord(Fetch());
+                        operand.cycles = IndirectCycles;
+                        return true;
+                    case 0x6:
+                        operand.address = (unsigned short) (ReadWord(Fetch()) + _x);
+                        operand.cycles = IndirectCycles;
+                        return true;
+                }
+                break;
+            case PREFIX_91:
+                if (mode == 0x6)
+                {
+                    operand.address = (unsigned short) (ReadWord(Fetch()) + _y);
+                    operand.cycles = IndirectCycles;
+                    return true;
+                }
+                break;
+        }
+        return false;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Read-modify-write group (high nibble 0 and 3 to 7) together with the
+    //  instructions which occupy the unused operation slots.
+    //
+    unsigned long Core::ExecuteReadModifyWrite(unsigned char prefix, unsigned char opcode)
+    {
+        unsigned char mode = opcode >> 4;
+        unsigned char operation = opcode & 0x0f;
+        if ((prefix == PREFIX_NONE) || (prefix == PREFIX_90))
+        {
+            unsigned short &index = IndexRegister(prefix);
+            switch (opcode)
+            {
+                case 0x01:
+                {
+                    unsigned char a = _a;
+                    _a = (unsigned char) index;
+                    index = (unsigned short) ((a << 8) | (index >> 8));
+                    SetNZWord(index);
+                    return 1;
+                }
+                case 0x02:
+                {
+                    unsigned char a = _a;
+                    _a = (unsigned char) (index >> 8);
+                    index = (unsigned short) ((index << 8) | a);
+                    SetNZWord(index);
+                    return 1;
+                }
+                case 0x42:
+                    index = (unsigned short) ((index & 0xff) * _a);
+                    SetFlag(FLAG_H, false);
+                    SetFlag(FLAG_C, false);
+                    return 4;
+                case 0x62:
+                    if (_a == 0)
+                    {
+                        SetFlag(FLAG_C, true);
+                    }
+                    else
+                    {
+                        unsigned short quotient = (unsigned short) (index / _a);
+                        _a = (unsigned char) (index % _a);
+                        index = quotient;
+                        _cc &= (unsigned char) ~(FLAG_V | FLAG_H | FLAG_N | FLAG_C);
+                        SetFlag(FLAG_Z, quotient == 0);
+                    }
+                    return DivideCycles;
+            }
+            if ((mode == 0x5) && ((prefix == PREFIX_NONE) || ((opcode != 0x51) && (opcode != 0x52) && (opcode != 0x55) && (opcode != 0x5b))))
+            {
+                return ExecuteWordRegister(opcode, index);
+            }
+        }
+        if (prefix == PREFIX_NONE)
+        {
+            switch (opcode)
+            {
+                case 0x31:
+                {
+                    unsigned short address = FetchWord();
+                    unsigned char value = Read(address);
+                    Write(address, _a);
+                    _a = value;
+                    return 3;
+                }
+                case 0x32:
+                    Write(FetchWord(), Pop());
+                    return 1;
+                case 0x35:
+                {
+                    unsigned char value = Fetch();
+                    Write(FetchWord(), value);
+                    return 1;
+                }
+                case 0x3b:
+                    Push(Read(FetchWord()));
+                    return 1;
+                case 0x41:
+                {
+                    unsigned char a = _a;
+                    _a = (unsigned char) _x;
+                    _x = (unsigned short) ((_x & 0xff00) | a);
+                    return 1;
+                }
+                case 0x45:
+                {
+                    unsigned char source = Fetch();
+                    Write(Fetch(), Read(source));
+                    return 1;
+                }
+                case 0x4b:
+                    Push(Fetch());
+                    return 1;
+                case 0x61:
+                {
+                    unsigned char a = _a;
+                    _a = (unsigned char) _y;
+                    _y = (unsigned short) ((_y & 0xff00) | a);
+                    return 1;
+                }
+                case 0x65:
+                    if (_y == 0)
+                    {
+                        SetFlag(FLAG_C, true);
+                    }
+                    else
+                    {
+                        unsigned short quotient = (unsigned short) (_x / _y);
+                        _y = (unsigned short) (_x % _y);
+                        _x = quotient;
+                        _cc &= (unsigned char) ~(FLAG_V | FLAG_H | FLAG_N | FLAG_C);
+                        SetFlag(FLAG_Z, quotient == 0);
+                    }
+                    return DivideCycles;
+                case 0x6b:
+                    Write((unsigned short) (_sp + Fetch()), _a);
+                    SetNZ(_a);
+                    return 1;
+                case 0x7b:
+                    _a = Read((unsigned short) (_sp + Fetch()));
+                    SetNZ(_a);
+                    return 1;
+            }
+            if (mode == 0x4)
+            {
+                if ((operation == 0x1) || (operation == 0x2) || (operation == 0x5) || (operation == 0xb))
+                {
+                    IllegalOpcode(prefix, opcode);
+                }
+                _a = ReadModifyWrite(operation, _a);
+                return 1;
+            }
+        }
+        Operand operand;
+        if ((operation == 0x1) || (operation == 0x2) || (operation == 0x5) || (operation == 0xb) ||
+            !DecodeReadModifyWriteOperand(prefix, mode, operand))
+        {
+            IllegalOpcode(prefix, opcode);
+        }
+        unsigned char result = ReadModifyWrite(operation, Read(operand.address));
+        if (operation != 0xd)
+        {
+            Write(operand.address, result);
+        }
+        return 1 + operand.cycles;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Word operations on X (or Y with the 0x90 prefix), high nibble 5.
+    //
+    unsigned long Core::ExecuteWordRegister(unsigned char opcode, unsigned short &reg)
+    {
+        unsigned short value = reg;
+        switch (opcode)
+        {
+            case 0x50:
+                reg = (unsigned short) -value;
+                SetFlag(FLAG_V, reg == 0x8000);
+                SetFlag(FLAG_C, reg != 0);
+                SetNZWord(reg);
+                return 2;
+            case 0x51:
+            {
+                unsigned short x = _x;
+                _x = _y;
+                _y = x;
+                return 1;
+            }
+            case 0x52:
+                _sp = (unsigned short) (_sp - Fetch());
+                return 1;
+            case 0x53:
+                reg = (unsigned short) ~value;
+                SetFlag(FLAG_C, true);
+                SetNZWord(reg);
+                return 2;
+            case 0x54:
+                reg = value >> 1;
+                SetFlag(FLAG_C, value & 0x0001);
+                SetNZWord(reg);
+                return 2;
+            case 0x55:
+            {
+                unsigned short source = FetchWord();
+                Write(FetchWord(), Read(source));
+                return 1;
+            }
+            case 0x56:
+                reg = (unsigned short) ((value >> 1) | (Flag(FLAG_C) ? 0x8000 : 0));
+                SetFlag(FLAG_C, value & 0x0001);
+                SetNZWord(reg);
+                return 2;
+            case 0x57:
+                reg = (unsigned short) ((value >> 1) | (value & 0x8000));
+                SetFlag(FLAG_C, value & 0x0001);
+                SetNZWord(reg);
+                return 2;
+            case 0x58:
+                reg = (unsigned short) (value << 1);
+                SetFlag(FLAG_C, value & 0x8000);
+                SetNZWord(reg);
+                return 2;
+            case 0x59:
+                reg = (unsigned short) ((value << 1) | (Flag(FLAG_C) ? 1 : 0));
+                SetFlag(FLAG_C, value & 0x8000);
+                SetNZWord(reg);
+                return 2;
+            case 0x5a:
+                reg = (unsigned short) (value - 1);
+                SetFlag(FLAG_V, value == 0x8000);
+                SetNZWord(reg);
+                return 1;
+            case 0x5b:
+                _sp = (unsigned short) (_sp + Fetch());
+                return 2;
+            case 0x5c:
+                reg = (unsigned short) (value + 1);
+                SetFlag(FLAG_V, value == 0x7fff);
+                SetNZWord(reg);
+                return 1;
+            case 0x5d:
+                SetNZWord(value);
+                return 2;
+            case 0x5e:
+                reg = (unsigned short) ((value << 8) | (value >> 8));
+                SetNZWord(reg);
+                return 1;
+            case 0x5f:
+                reg = 0;
+                SetNZWord(reg);
+                return 1;
+        }
+        IllegalOpcode(&reg == &_y ? PREFIX_90 : PREFIX_NONE, opcode);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Bit operations on a long memory address.
+    //
+    //      72 0x   BTJT (even) / BTJF (odd) longmem,#bit,rel
+    //      72 1x   BSET (even) / BRES (odd) longmem,#bit
+    //      90 1x   BCPL (even) / BCCM (odd) longmem,#bit
+    //
+    unsigned long Core::ExecuteBitOperation(unsigned char prefix, unsigned char opcode)
+    {
+        unsigned char mask = (unsigned char) (1 << ((opcode >> 1) & 0x07));
+        bool odd = (opcode & 0x01) != 0;
+        unsigned short address = FetchWord();
+        unsigned char value = Read(address);
+        if ((prefix == PREFIX_72) && (opcode < 0x10))
+        {
+            signed char offset = (signed char) Fetch();
+            bool set = (value & mask) != 0;
+            SetFlag(FLAG_C, set);
+            if (set != odd)
+            {
+                _pc = (_pc + offset) & 0xffffff;
+                return 3;
+            }
+            return 2;
+        }
+        if (prefix == PREFIX_72)
+        {
+            value = odd ? (unsigned char) (value & ~mask) : (unsigned char) (value | mask);
+        }
+        else if (odd)
+        {
+            value = Flag(FLAG_C) ? (unsigned char) (value | mask) : (unsigned char) (value & ~mask);
+        }
+        else
+        {
+            value ^= mask;
+        }
+        Write(address, value);
+        return 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Conditional relative jumps, 1 cycle if not taken and 2 if taken.
+    //
+    unsigned long Core::ExecuteRelativeJump(unsigned char prefix, unsigned char opcode)
+    {
+        bool v = Flag(FLAG_V);
+        bool n = Flag(FLAG_N);
+        bool z = Flag(FLAG_Z);
+        bool c = Flag(FLAG_C);
+        bool taken = false;
+        if (prefix == PREFIX_90)
+        {
+            switch (opcode)
+            {
+                case 0x28:
+                    taken = !Flag(FLAG_H);
+                    break;
+                case 0x29:
+                    taken = Flag(FLAG_H);
+                    break;
+                case 0x2c:
+                    taken = Level() != 3;
+                    break;
+                case 0x2d:
+                    taken = Level() == 3;
+                    break;
+                case 0x2e:
+                    taken = false;
+                    break;
+                case 0x2f:
+                    taken = true;
+                    break;
+                default:
+                    IllegalOpcode(prefix, opcode);
+            }
+        }
+        else if (prefix == PREFIX_NONE)
+        {
+            switch (opcode)
+            {
+                case 0x20: taken = true; break;
+                case 0x21: taken = false; break;
+                case 0x22: taken = !c && !z; break;
+                case 0x23: taken = c || z; break;
+                case 0x24: taken = !c; break;
+                case 0x25: taken = c; break;
+                case 0x26: taken = !z; break;
+                case 0x27: taken = z; break;
+                case 0x28: taken = !v; break;
+                case 0x29: taken = v; break;
+                case 0x2a: taken = !n; break;
+                case 0x2b: taken = n; break;
+                case 0x2c: taken = !z && (n == v); break;
+                case 0x2d: taken = z || (n != v); break;
+                case 0x2e: taken = n == v; break;
+                case 0x2f: taken = n != v; break;
+            }
+        }
+        else
+        {
+            IllegalOpcode(prefix, opcode);
+        }
+        signed char offset = (signed char) Fetch();
+        if (taken)
+        {
+            _pc = (_pc + offset) & 0xffffff;
+            return 2;
+        }
+        return 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Control, stack and register transfer instructions (high nibble 8 and 9).
+    //
+    unsigned long Core::ExecuteSpecial(unsigned char prefix, unsigned char opcode)
+    {
+        if (prefix == PREFIX_72)
+        {
+            if (opcode == 0x8f)
+            {
+                _state = State::WaitingForEvent;
+                return 1;
+            }
+            IllegalOpcode(prefix, opcode);
+        }
+        if (prefix == PREFIX_92)
+        {
+            if (opcode == 0x8d)
+            {
+                uint32_t address = ReadExtended(FetchWord());
+                Push((unsigned char) _pc);
+                Push((unsigned char) (_pc >> 8));
+                Push((unsigned char) (_pc >> 16));
+                _pc = address;
+                return 8;
+            }
+            IllegalOpcode(prefix, opcode);
+        }
+        if (prefix == PREFIX_91)
+        {
+            IllegalOpcode(prefix, opcode);
+        }
+        if (prefix == PREFIX_90)
+        {
+            switch (opcode)
+            {
+                case 0x85: case 0x89: case 0x93: case 0x94: case 0x95:
+                case 0x96: case 0x97: case 0x9e: case 0x9f:
+                    break;
+                default:
+                    IllegalOpcode(prefix, opcode);
+            }
+        }
+        unsigned short &index = IndexRegister(prefix);
+        switch (opcode)
+        {
+            case 0x80:
+            {
+                _cc = Pop();
+                _a = Pop();
+                _x = PopWord();
+                _y = PopWord();
+                uint32_t pc = Pop();
+                pc = (pc << 16) | PopWord();
+                _pc = pc;
+                if (!_active.empty())
+                {
+                    std::pair<int, uint64_t> entry = _active.back();
+                    _active.pop_back();
+                    _simulator.RecordInterrupt(entry.first, _simulator.CpuCycles() + InterruptReturnCycles - entry.second);
+                }
+                return InterruptReturnCycles;
+            }
+            case 0x81:
+                _pc = (_pc & 0xff0000) | PopWord();
+                return 4;
+            case 0x82:
+                _pc = FetchExtended();
+                return 2;
+            case 0x83:
+                EnterInterrupt(1, 3);
+                return 0;
+            case 0x84:
+                _a = Pop();
+                return 1;
+            case 0x85:
+                index = PopWord();
+                return 2;
+            case 0x86:
+                _cc = Pop();
+                return 1;
+            case 0x87:
+            {
+                uint32_t pc = Pop();
+                _pc = (pc << 16) | PopWord();
+                return 5;
+            }
+            case 0x88:
+                Push(_a);
+                return 1;
+            case 0x89:
+                PushWord(index);
+                return 2;
+            case 0x8a:
+                Push(_cc);
+                return 1;
+            case 0x8b:
+                _simulator.Stop("BREAK instruction");
+                return 1;
+            case 0x8c:
+                _cc ^= FLAG_C;
+                return 1;
+            case 0x8d:
+            {
+                uint32_t address = FetchExtended();
+                Push((unsigned char) _pc);
+                Push((unsigned char) (_pc >> 8));
+                Push((unsigned char) (_pc >> 16));
+                _pc = address;
+                return 5;
+            }
+            case 0x8e:
+                SetLevel(0);
+                _state = State::Halted;
+                return 10;
+            case 0x8f:
+                SetLevel(0);
+                _state = State::Waiting;
+                return 10;
+            case 0x93:
+                index = (&index == &_x) ? _y : _x;
+                return 1;
+            case 0x94:
+                _sp = index;
+                return 1;
+            case 0x95:
+                index = (unsigned short) ((index & 0x00ff) | (_a << 8));
+                return 1;
+            case 0x96:
+                index = _sp;
+                return 1;
+            case 0x97:
+                index = (unsigned short) ((index & 0xff00) | _a);
+                return 1;
+            case 0x98:
+                SetFlag(FLAG_C, false);
+                return 1;
+            case 0x99:
+                SetFlag(FLAG_C, true);
+                return 1;
+            case 0x9a:
+                SetLevel(0);
+                return 1;
+            case 0x9b:
+                SetLevel(3);
+                return 1;
+            case 0x9c:
+                SetFlag(FLAG_V, false);
+                return 1;
+            case 0x9d:
+                return 1;
+            case 0x9e:
+                _a = (unsigned char) (index >> 8);
+                return 1;
+            case 0x9f:
+                _a = (unsigned char) index;
+                return 1;
+        }
+        IllegalOpcode(prefix, opcode);
+    }
+}
@@ -0,0 +1,173 @@
+//
+//  STM8 instruction set simulator.
+//
+//  Executes an STM8 program image from the simulator memory using the same
+//  peripheral models as the host builds of the chapters.  Each instruction
+//  is charged the number of cycles given in the STM8 programming manual
+//  (PM0044); pipeline stalls caused by instruction fetches are not modelled.
+//  DIV and DIVW are charged their worst case of 17 cycles.
+//
+//  Interrupts follow the STM8 interrupt controller: a pending vector is
+//  taken when its software priority (ITC_SPRx) is higher than the current
+//  level held in CC.I1:I0, the lowest numbered vector winning a tie.  The
+//  nine byte context is pushed on the stack and the handler address read
+//  from the vector table at 0x8000.  The number of cycles from interrupt
+//  entry to the end of the IRET is recorded against the vector.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef CORE_H
+#define CORE_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "Simulator.h"
+
+namespace STM8
+{
+    //
+    //  Address of the interrupt vector table, each entry is the INT opcode
+    //  (0x82) followed by a 24 bit address.
+    //
+    const unsigned short VectorTableAddress = 0x8000;
+
+    class Core
+    {
+    public:
+        explicit Core(Simulator &simulator);
+
+        //
+        //  Load the registers with their reset values and fetch the reset
+        //  vector.
+        //
+        void Reset();
+
+        //
+        //  Execute until the simulator ends the run by throwing
+        //  SimulationComplete.
+        //
+        void Run();
+
+        //
+        //  Take a pending interrupt or execute a single instruction.
+        //
+        void Step();
+
+        uint32_t PC() const { return _pc; }
+        unsigned short SP() const { return _sp; }
+        unsigned short X() const { return _x; }
+        unsigned short Y() const { return _y; }
+        unsigned char A() const { return _a; }
+        unsigned char CC() const { return _cc; }
+        uint64_t Instructions() const { return _instructions; }
+
+        //
+        //  Instruction profile, the number of times the instruction at each
+        //  address has been executed and the cycles it took.  Only recorded
+        //  once EnableProfile has been called.
+        //
+        struct ProfileCount
+        {
+            uint64_t instructions;
+            uint64_t cycles;
+        };
+        void EnableProfile() { _profiling = true; }
+        const std::map<uint32_t, ProfileCount> &Profile() const { return _profile; }
+
+        //
+        //  Handler address held in the vector table.
+        //
+        uint32_t VectorAddress(int vector) const;
+
+    private:
+        enum class State { Running, Waiting, WaitingForEvent, Halted };
+
+        //
+        //  Operand location decoded from the addressing mode.
+        //
+        struct Operand
+        {
+            uint32_t address;
+            unsigned long cycles;
+        };
+
+        //
+        //  Memory access.
+        //
+        unsigned char Fetch();
+        unsigned short FetchWord();
+        uint32_t FetchExtended();
+        unsigned char Read(uint32_t address);
+        unsigned short ReadWord(uint32_t address);
+        uint32_t ReadExtended(uint32_t address);
+        void Write(uint32_t address, unsigned char value);
+        void WriteWord(uint32_t address, unsigned short value);
+        void Push(unsigned char value);
+        void PushWord(unsigned short value);
+        unsigned char Pop();
+        unsigned short PopWord();
+
+        //
+        //  Interrupt controller.
+        //
+        int Level() const;
+        int VectorPriority(int vector) const;
+        void SetLevel(int level);
+        bool TakeInterrupt();
+        void EnterInterrupt(int vector, int level);
+
+        //
+        //  Instruction groups.
+        //
+        unsigned long Execute();
+        unsigned long ExecuteAccumulator(unsigned char prefix, unsigned char opcode);
+        unsigned long ExecuteReadModifyWrite(unsigned char prefix, unsigned char opcode);
+        unsigned long ExecuteWordRegister(unsigned char opcode, unsigned short &reg);
+        unsigned long ExecuteBitOperation(unsigned char prefix, unsigned char opcode);
+        unsigned long ExecuteRelativeJump(unsigned char prefix, unsigned char opcode);
+        unsigned long ExecuteSpecial(unsigned char prefix, unsigned char opcode);
+        bool DecodeAccumulatorOperand(unsigned char prefix, unsigned char mode, Operand &operand);
+        bool DecodeReadModifyWriteOperand(unsigned char prefix, unsigned char mode, Operand &operand);
+        [[noreturn]] void IllegalOpcode(unsigned char prefix, unsigned char opcode);
+
+        //
+        //  Arithmetic and flags.
+        //
+        void SetFlag(unsigned char flag, bool value);
+        bool Flag(unsigned char flag) const { return (_cc & flag) != 0; }
+        void SetNZ(unsigned char value);
+        void SetNZWord(unsigned short value);
+        unsigned char Add(unsigned char a, unsigned char b, bool carry);
+        unsigned char Subtract(unsigned char a, unsigned char b, bool borrow);
+        unsigned short AddWord(unsigned short a, unsigned short b);
+        unsigned short SubtractWord(unsigned short a, unsigned short b, bool halfCarry);
+        unsigned char ReadModifyWrite(unsigned char operation, unsigned char value);
+        unsigned short &IndexRegister(unsigned char prefix);
+
+        Simulator &_simulator;
+        uint32_t _pc;
+        uint32_t _instructionAddress;
+        unsigned short _sp;
+        unsigned short _x;
+        unsigned short _y;
+        unsigned char _a;
+        unsigned char _cc;
+        State _state;
+        uint64_t _instructions;
+        bool _profiling;
+        std::map<uint32_t, ProfileCount> _profile;
+
+        //
+        //  Vector and entry cycle count of each interrupt being serviced,
+        //  innermost last.
+        //
+        std::vector<std::pair<int, uint64_t>> _active;
+    };
+}
+
+#endif
@@ -0,0 +1,367 @@
+//
+//  Command line stimulus and reporting shared by the chapter runners and the
+//  instruction set simulator.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+
+#include "Harness.h"
+#include "Peripherals.h"
+
+namespace STM8
+{
+    //
+    //  Vector serviced for each byte received by the SPI slave.
+    //
+    const int SpiVector = 12;
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Split "value@time" into its parts, time defaults to 0.
+    //
+    static double SplitTime(std::string &text)
+    {
+        double time = 0;
+        size_t at = text.rfind('@');
+        if (at != std::string::npos)
+        {
+            time = atof(text.c_str() + at + 1);
+            text.erase(at);
+        }
+        return time;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Convert a string of hex digits into bytes.
+    //
+    static std::vector<unsigned char> ParseHex(const std::string &text)
+    {
+        std::vector<unsigned char> bytes;
+        for (size_t index = 0; index + 1 < text.size(); index += 2)
+        {
+            bytes.push_back((unsigned char) strtoul(text.substr(index, 2).c_str(), nullptr, 16));
+        }
+        return bytes;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Constructor.
+    //
+    Harness::Harness(Simulator &simulator, const char *program, const char *arguments, const char *options) :
+        _simulator(simulator), _program(program), _arguments(arguments), _options(options), _seconds(1.0)
+    {
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Print the usage message and exit.
+    //
+    void Harness::Usage() const
+    {
+        fprintf(stderr, "Usage: %s [--time s] [--hse Hz] [--input PD4=0@t] [--connect PA1=PC3] [--watch PD4] [--timer-updates 1]\n", _program);
+        fprintf(stderr, "       [--adc ch=value] [--uart text@t] [--uart-capture file] [--spi hex@t:sck] [--spi-response hex]\n");
+        fprintf(stderr, "       [--i2c-write addr:hex@t] [--i2c-read addr:count@t] [--i2c-device addr:hex]\n");
+        if (_options != nullptr)
+        {
+            fprintf(stderr, "       %s\n", _options);
+        }
+        if (*_arguments != 0)
+        {
+            fprintf(stderr, "       %s\n", _arguments);
+        }
+        exit(1);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Parse a pin name and exit if it is not valid.
+    //
+    void Harness::ParsePin(const std::string &name, int &port, int &pin) const
+    {
+        if (!GpioModel::ParsePinName(name, port, pin))
+        {
+            fprintf(stderr, "Invalid pin name: %s\n", name.c_str());
+            Usage();
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Apply one of the common options.
+    //
+    bool Harness::Option(const std::string &option, std::string value)
+    {
+        Simulator &simulator = _simulator;
+        if (option == "--time")
+        {
+            _seconds = atof(value.c_str());
+        }
+        else if (option == "--hse")
+        {
+            simulator.Clock().SetExternalCrystal(strtoul(value.c_str(), nullptr, 0));
+        }
+        else if (option == "--input")
+        {
+            int port, pin;
+            double time = SplitTime(value);
+            size_t equals = value.find('=');
+            if (equals == std::string::npos)
+            {
+                Usage();
+            }
+            ParsePin(value.substr(0, equals), port, pin);
+            bool level = atoi(value.c_str() + equals + 1) != 0;
+            simulator.Schedule(time, [&simulator, port, pin, level]() { simulator.Gpio().SetInput(port, pin, level); });
+        }
+        else if (option == "--connect")
+        {
+            int fromPort, fromPin, toPort, toPin;
+            size_t equals = value.find('=');
+            if (equals == std::string::npos)
+            {
+                Usage();
+            }
+            ParsePin(value.substr(0, equals), fromPort, fromPin);
+            ParsePin(value.substr(equals + 1), toPort, toPin);
+            simulator.Gpio().Connect(fromPort, fromPin, toPort, toPin);
+        }
+        else if (option == "--watch")
+        {
+            int port, pin;
+            ParsePin(value, port, pin);
+            simulator.Gpio().Watch(port, pin);
+            _watched.push_back(std::make_pair(port, pin));
+        }
+        else if (option == "--timer-updates")
+        {
+            int number = atoi(value.c_str());
+            if (!simulator.HasTimer(number))
+            {
+                fprintf(stderr, "Invalid timer: %s\n", value.c_str());
+                Usage();
+            }
+            simulator.Timer(number).RecordUpdates(true);
+            _updateTimers.push_back(number);
+        }
+        else if (option == "--adc")
+        {
+            size_t equals = value.find('=');
+            if (equals == std::string::npos)
+            {
+                Usage();
+            }
+            simulator.Adc().SetChannel(atoi(value.c_str()), (unsigned short) strtoul(value.c_str() + equals + 1, nullptr, 0));
+        }
+        else if (option == "--uart")
+        {
+            double time = SplitTime(value);
+            simulator.Schedule(time, [&simulator, value]() { simulator.Uart().Receive(value); });
+        }
+        else if (option == "--uart-capture")
+        {
+            _uartCapture = value;
+        }
+        else if (option == "--spi")
+        {
+            double sck = 1000000;
+            size_t colon = value.rfind(':');
+            if (colon != std::string::npos)
+            {
+                sck = atof(value.c_str() + colon + 1);
+                value.erase(colon);
+            }
+            double time = SplitTime(value);
+            std::vector<unsigned char> bytes = ParseHex(value);
+            simulator.Schedule(time, [&simulator, bytes, sck]() { simulator.Spi().MasterTransfer(bytes, sck); });
+        }
+        else if (option == "--spi-response")
+        {
+            simulator.Spi().SlaveResponse(ParseHex(value));
+        }
+        else if ((option == "--i2c-write") || (option == "--i2c-read") || (option == "--i2c-device"))
+        {
+            double time = SplitTime(value);
+            size_t colon = value.find(':');
+            if (colon == std::string::npos)
+            {
+                Usage();
+            }
+            unsigned char address = (unsigned char) strtoul(value.c_str(), nullptr, 0);
+            std::string data = value.substr(colon + 1);
+            if (option == "--i2c-write")
+            {
+                std::vector<unsigned char> bytes = ParseHex(data);
+                simulator.Schedule(time, [&simulator, address, bytes]() { simulator.I2C().MasterWrite(address, bytes); });
+            }
+            else if (option == "--i2c-read")
+            {
+                size_t count = strtoul(data.c_str(), nullptr, 0);
+                simulator.Schedule(time, [&simulator, address, count]() { simulator.I2C().MasterRead(address, count); });
+            }
+            else
+            {
+                simulator.I2C().AttachDevice(address, ParseHex(data));
+            }
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Print the results of the run.
+    //
+    //  For an SPI slave the interrupt service routine must keep up with the
+    //  master or the next byte overwrites the last (OVR).  The fastest SCK
+    //  which can be sustained allows eight clocks for the longer of the
+    //  slowest service routine and the average service time per byte.
+    //
+    void Harness::Report(const std::string &reason) const
+    {
+        Simulator &simulator = _simulator;
+        printf("Device: %s\n", simulator.DeviceName());
+        printf("Stopped: %s\n", reason.c_str());
+        printf("Simulated time: %.6f s (%llu master clock ticks, %llu CPU cycles, %.1f%% idle)\n",
+               simulator.Seconds(), (unsigned long long) simulator.Ticks(), (unsigned long long) simulator.CpuCycles(),
+               simulator.Ticks() ? (100.0 * simulator.IdleTicks() / simulator.Ticks()) : 0.0);
+        printf("Wakeups from WFI / HALT: %lu (%.1f per second)\n", simulator.Wakeups(),
+               (simulator.Seconds() > 0.0) ? (simulator.Wakeups() / simulator.Seconds()) : 0.0);
+        printf("Master clock: %lu Hz, CPU clock: %lu Hz\n", simulator.Clock().MasterFrequency(), simulator.Clock().CpuFrequency());
+        printf("Interrupts:\n");
+        for (int vector = 0; vector < NumberOfVectors; vector++)
+        {
+            const InterruptStatistics &statistics = simulator.Statistics(vector);
+            if (statistics.count > 0)
+            {
+                printf("    %2d %-28s count %8lu  cycles min %llu avg %.1f max %llu\n", vector, simulator.HandlerName(vector),
+                       statistics.count, (unsigned long long) statistics.minimumCycles,
+                       (double) statistics.totalCycles / statistics.count, (unsigned long long) statistics.maximumCycles);
+            }
+            if (simulator.UnhandledInterrupts(vector) > 0)
+            {
+                printf("    %2d %-28s unhandled %lu\n", vector, "(no handler)", simulator.UnhandledInterrupts(vector));
+            }
+        }
+        //
+        //  Gates which were only on from reset until the clock was set up
+        //  are not reported.
+        //
+        printf("Peripheral clock gates:\n");
+        for (int bit = 0; bit < 16; bit++)
+        {
+            const char *name = ClockModel::GateName(bit);
+            uint64_t on = simulator.Clock().GatePicoseconds(bit);
+            if ((name != nullptr) && (simulator.Clock().PeripheralClockEnabled(bit) || (simulator.Clock().GateEnables(bit) > 1)))
+            {
+                printf("    %-8s on %12.6f ms (%5.1f%%), enabled %lu times\n", name, on / 1e9,
+                       simulator.Picoseconds() ? (100.0 * on / simulator.Picoseconds()) : 0.0, simulator.Clock().GateEnables(bit));
+            }
+        }
+        printf("Pin transitions:\n");
+        for (int port = 0; port < simulator.Gpio().Ports(); port++)
+        {
+            for (int pin = 0; pin < 8; pin++)
+            {
+                if (simulator.Gpio().Transitions(port, pin) > 0)
+                {
+                    printf("    %s %lu\n", GpioModel::PinName(port, pin).c_str(), simulator.Gpio().Transitions(port, pin));
+                }
+            }
+        }
+        for (auto &pin : _watched)
+        {
+            printf("Changes on %s:\n", GpioModel::PinName(pin.first, pin.second).c_str());
+            for (auto &change : simulator.Gpio().Changes(pin.first, pin.second))
+            {
+                printf("    %12.6f ms %d\n", change.picoseconds / 1e9, change.level ? 1 : 0);
+            }
+        }
+        //
+        //  A period which mixes old and new values shows up as a set of
+        //  shadow registers the program never meant to write.
+        //
+        for (int number : _updateTimers)
+        {
+            TimerModel &timer = simulator.Timer(number);
+            std::map<std::vector<unsigned short>, unsigned long> periods;
+            for (auto &update : timer.Updates())
+            {
+                std::vector<unsigned short> registers(1, update.autoReload);
+                registers.insert(registers.end(), update.compare, update.compare + timer.Channels());
+                periods[registers]++;
+            }
+            printf("TIM%d update events: %zu, distinct shadow registers: %zu\n", number, timer.Updates().size(), periods.size());
+            for (auto &entry : periods)
+            {
+                printf("    ARR %5u CCR", entry.first[0]);
+                for (size_t channel = 1; channel < entry.first.size(); channel++)
+                {
+                    printf(" %5u", entry.first[channel]);
+                }
+                printf("  periods %lu\n", entry.second);
+            }
+        }
+        const std::string &transmitted = simulator.Uart().Transmitted();
+        if (!transmitted.empty())
+        {
+            printf("UART TX (%lu baud):\n", simulator.Uart().BaudRate());
+            fwrite(transmitted.data(), 1, transmitted.size(), stdout);
+            printf("\n");
+        }
+        if (!_uartCapture.empty())
+        {
+            FILE *file = fopen(_uartCapture.c_str(), "wb");
+            if ((file == nullptr) || (fwrite(transmitted.data(), 1, transmitted.size(), file) != transmitted.size()))
+            {
+                fprintf(stderr, "Cannot write %s\n", _uartCapture.c_str());
+            }
+            if (file != nullptr)
+            {
+                fclose(file);
+            }
+        }
+        if (!simulator.Spi().Miso().empty() || !simulator.Spi().Mosi().empty())
+        {
+            printf("SPI MOSI:");
+            for (unsigned char byte : simulator.Spi().Mosi())
+            {
+                printf(" %02x", byte);
+            }
+            printf("\nSPI MISO:");
+            for (unsigned char byte : simulator.Spi().Miso())
+            {
+                printf(" %02x", byte);
+            }
+            printf("\nSPI overruns: %lu\n", simulator.Spi().Overruns());
+            const InterruptStatistics &spi = simulator.Statistics(SpiVector);
+            if (!simulator.Spi().MasterMode() && (spi.count > 0) && !simulator.Spi().Mosi().empty())
+            {
+                double perByte = (double) spi.totalCycles / simulator.Spi().Mosi().size();
+                double cycles = std::max(perByte, (double) spi.maximumCycles);
+                printf("SPI slave: %.1f interrupt cycles per byte, maximum sustainable SCK %.0f Hz\n",
+                       perByte, 8.0 * simulator.Clock().CpuFrequency() / cycles);
+            }
+        }
+        if (!simulator.I2C().SlaveTransmitted().empty())
+        {
+            printf("I2C slave transmitted:");
+            for (unsigned char byte : simulator.I2C().SlaveTransmitted())
+            {
+                printf(" %02x", byte);
+            }
+            printf("\n");
+        }
+    }
+}
@@ -0,0 +1,74 @@
+//
+//  Command line stimulus and reporting shared by the chapter runners and the
+//  instruction set simulator.
+//
+//  Options understood by every runner:
+//
+//      --time <seconds>                Simulated run time (default 1 second).
+//      --hse <frequency>               External crystal frequency in Hz.
+//      --input <pin>=<0|1>[@<time>]    Drive an input pin, e.g. PD4=0@0.01.
+//      --connect <output>=<input>      Wire one pin to another, e.g. PA1=PC3.
+//      --watch <pin>                   Report the time of every change on a pin.
+//      --timer-updates <timer>         Report each distinct set of shadow
+//                                      registers loaded by the update events.
+//      --adc <channel>=<value>         10-bit value for an ADC channel.
+//      --uart <text>[@<time>]          Characters arriving on the UART RX pin.
+//      --uart-capture <file>           Save the bytes transmitted by the UART.
+//      --spi <hex>[@<time>][:<sck>]    Bytes clocked in by an external SPI master.
+//      --spi-response <hex>            Bytes returned by an external SPI slave.
+//      --i2c-write <addr>:<hex>[@<time>]   External I2C master writes to the device.
+//      --i2c-read <addr>:<count>[@<time>]  External I2C master reads from the device.
+//      --i2c-device <addr>:<hex>       External I2C slave and the bytes it returns.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Simulator.h"
+
+namespace STM8
+{
+    class Harness
+    {
+    public:
+        //
+        //  arguments and options describe anything the runner accepts in
+        //  addition to the common options and are shown in the usage message.
+        //
+        Harness(Simulator &simulator, const char *program, const char *arguments = "", const char *options = nullptr);
+
+        //
+        //  Apply one of the common options.  Returns false if the option is
+        //  not recognised and exits with the usage message if the value is
+        //  not valid.
+        //
+        bool Option(const std::string &option, std::string value);
+
+        [[noreturn]] void Usage() const;
+
+        double Seconds() const { return _seconds; }
+        void Report(const std::string &reason) const;
+
+    private:
+        void ParsePin(const std::string &name, int &port, int &pin) const;
+
+        Simulator &_simulator;
+        const char *_program;
+        const char *_arguments;
+        const char *_options;
+        double _seconds;
+        std::string _uartCapture;
+        std::vector<std::pair<int, int>> _watched;
+        std::vector<int> _updateTimers;
+    };
+}
+
+#endif
@@ -0,0 +1,126 @@
+//
+//  Command line runner for a chapter built against the host simulator.
+//
+//  The chapter main is renamed ChapterMain when it is compiled for the host
+//  and the interrupt service routines are found through weak references to
+//  the handler names used in the chapters.  #pragma vector has no meaning
+//  on the host and so the vector is taken from the handler name.
+//
+//  Usage: <chapter> [options], see Harness.h for the options.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#include <string>
+
+#include "Simulator.h"
+#include "Harness.h"
+
+//
+//  Renamed chapter entry point (see CMakeLists.txt).
+//
+void ChapterMain();
+
+//
+//  Interrupt service routines which may be defined by the chapter.
+//
+#define WEAK __attribute__((weak))
+WEAK void AWU_IRQHandler();
+WEAK void CLK_IRQHandler();
+WEAK void EXTI_PORTA_IRQHandler();
+WEAK void EXTI_PORTB_IRQHandler();
+WEAK void EXTI_PORTC_IRQHandler();
+WEAK void EXTI_PORTD_IRQHandler();
+WEAK void EXTI_PORTE_IRQHandler();
+WEAK void EXTI_SPI_CS_PORT_IRQHandler();
+WEAK void SPI_IRQHandler();
+WEAK void TIM1_UPD_OVF_IRQHandler();
+WEAK void TIM1_CAPCOM_IRQHandler();
+WEAK void TIM2_UPD_OVF_IRQHandler();
+WEAK void TIM2_CAPCOM_IRQHandler();
+WEAK void TIM3_UPD_OVF_IRQHandler();
+WEAK void TIM3_CAPCOM_IRQHandler();
+WEAK void UART1_TX_IRQHandler();
+WEAK void UART1_RX_IRQHandler();
+WEAK void I2C_IRQHandler();
+WEAK void UART2_TX_IRQHandler();
+WEAK void UART2_RX_IRQHandler();
+WEAK void ADC1_EOC_IRQHandler();
+WEAK void TIM4_UPD_OVF_IRQHandler();
+WEAK void FLASH_IRQHandler();
+
+//
+//  Vector numbers for the handler names.
+//
+struct VectorEntry
+{
+    int vector;
+    STM8::InterruptHandler handler;
+    const char *name;
+};
+
+#define VECTOR(number, handler)     { number, handler, #handler }
+
+static const VectorEntry _vectors[] =
+{
+    VECTOR(3, AWU_IRQHandler),
+    VECTOR(4, CLK_IRQHandler),
+    VECTOR(5, EXTI_PORTA_IRQHandler),
+    VECTOR(6, EXTI_PORTB_IRQHandler),
+    VECTOR(7, EXTI_PORTC_IRQHandler),
+    VECTOR(8, EXTI_PORTD_IRQHandler),
+    VECTOR(9, EXTI_PORTE_IRQHandler),
+#if defined(DISCOVERY)
+    VECTOR(6, EXTI_SPI_CS_PORT_IRQHandler),
+#else
+    VECTOR(5, EXTI_SPI_CS_PORT_IRQHandler),
+#endif
+    VECTOR(12, SPI_IRQHandler),
+    VECTOR(13, TIM1_UPD_OVF_IRQHandler),
+    VECTOR(14, TIM1_CAPCOM_IRQHandler),
+    VECTOR(15, TIM2_UPD_OVF_IRQHandler),
+    VECTOR(16, TIM2_CAPCOM_IRQHandler),
+    VECTOR(17, TIM3_UPD_OVF_IRQHandler),
+    VECTOR(18, TIM3_CAPCOM_IRQHandler),
+    VECTOR(19, UART1_TX_IRQHandler),
+    VECTOR(20, UART1_RX_IRQHandler),
+    VECTOR(21, I2C_IRQHandler),
+    VECTOR(22, UART2_TX_IRQHandler),
+    VECTOR(23, UART2_RX_IRQHandler),
+    VECTOR(24, ADC1_EOC_IRQHandler),
+    VECTOR(25, TIM4_UPD_OVF_IRQHandler),
+    VECTOR(26, FLASH_IRQHandler)
+};
+
+//--------------------------------------------------------------------------------
+//
+//  Configure the simulation from the command line and run the chapter.
+//
+int main(int argc, char *argv[])
+{
+    STM8::Simulator &simulator = STM8::Simulator::Instance();
+    STM8::Harness harness(simulator, argv[0]);
+
+    for (const VectorEntry &entry : _vectors)
+    {
+        if (entry.handler != nullptr)
+        {
+            simulator.AttachInterrupt(entry.vector, entry.handler, entry.name);
+        }
+    }
+    for (int index = 1; index < argc; index++)
+    {
+        std::string option = argv[index];
+        if ((index + 1 >= argc) || !harness.Option(option, argv[index + 1]))
+        {
+            harness.Usage();
+        }
+        index++;
+    }
+
+    std::string reason = simulator.Run(ChapterMain, harness.Seconds());
+    harness.Report(reason);
+    return 0;
+}
@@ -0,0 +1,218 @@
+//
+//  Command line runner for the STM8 instruction set simulator.
+//
+//  Loads a program built by IAR (ELF .out) or SDCC (.ihx or ELF) and runs it
+//  against the peripheral models, reporting the minimum, average and
+//  maximum number of cycles spent in each interrupt service routine.  For an
+//  SPI slave the fastest SCK the service routine can keep up with is also
+//  reported.
+//
+//  Usage: stm8iss [options] [--device <name>] <program>
+//
+//      --device <name>     STM8S103F3 (default), STM8S103K3 or STM8S105C6.
+//      --profile <file>    Write the instructions and cycles executed in
+//                          each function and its size in bytes to file
+//                          (- for the standard output) as comma separated
+//                          values.
+//
+//  See Harness.h for the stimulus options, for example:
+//
+//      stm8iss --time 0.01 --input PB0=0@0.001 --spi 0102030405@0.002:2000000 spi.out
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Simulator.h"
+#include "Harness.h"
+#include "Core.h"
+#include "Program.h"
+
+//
+//  Vector names used when the image has no symbols.
+//
+static const char *_vectorNames[STM8::NumberOfVectors] =
+{
+    "RESET", "TRAP", "TLI", "AWU", "CLK", "EXTI_PORTA", "EXTI_PORTB", "EXTI_PORTC",
+    "EXTI_PORTD", "EXTI_PORTE", "CAN_RX", "CAN_TX", "SPI", "TIM1_UPD_OVF", "TIM1_CAPCOM", "TIM2_UPD_OVF",
+    "TIM2_CAPCOM", "TIM3_UPD_OVF", "TIM3_CAPCOM", "UART1_TX", "UART1_RX", "I2C", "UART2_TX", "UART2_RX",
+    "ADC1", "TIM4_UPD_OVF", "FLASH", "vector 27", "vector 28", "vector 29", "vector 30", "vector 31"
+};
+
+//--------------------------------------------------------------------------------
+//
+//  Write the profile grouped by function, busiest first.  Instructions
+//  outside any known function are grouped under their own address.  The
+//  size of a function is the distance to the next symbol, empty for the
+//  last symbol and for unknown functions.
+//
+static bool WriteProfile(const std::string &path, const STM8::Core &core, const STM8::Program &program)
+{
+    struct Function
+    {
+        std::string name;
+        uint32_t address;
+        uint32_t size;
+        STM8::Core::ProfileCount count;
+    };
+    std::map<uint32_t, Function> functions;
+    for (auto &entry : core.Profile())
+    {
+        uint32_t start = entry.first;
+        const char *name = program.FunctionContaining(entry.first, start);
+        Function &function = functions[start];
+        if (function.name.empty())
+        {
+            char address[16];
+            snprintf(address, sizeof(address), "0x%06x", (unsigned) start);
+            function.name = (name != nullptr) ? name : address;
+            function.address = start;
+            uint32_t next = (name != nullptr) ? program.NextSymbol(start) : 0;
+            function.size = (next != 0) ? next - start : 0;
+        }
+        function.count.instructions += entry.second.instructions;
+        function.count.cycles += entry.second.cycles;
+    }
+    std::vector<Function> sorted;
+    for (auto &function : functions)
+    {
+        sorted.push_back(function.second);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Function &a, const Function &b) { return a.count.cycles > b.count.cycles; });
+
+    FILE *file = (path == "-") ? stdout : fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    fprintf(file, "function,address,instructions,cycles,bytes\n");
+    for (auto &function : sorted)
+    {
+        char size[16] = "";
+        if (function.size != 0)
+        {
+            snprintf(size, sizeof(size), "%u", (unsigned) function.size);
+        }
+        fprintf(file, "%s,0x%06x,%llu,%llu,%s\n", function.name.c_str(), (unsigned) function.address,
+                (unsigned long long) function.count.instructions, (unsigned long long) function.count.cycles, size);
+    }
+    if (file != stdout)
+    {
+        fclose(file);
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Load the program and run it.
+//
+int main(int argc, char *argv[])
+{
+    STM8::Simulator &simulator = STM8::Simulator::Instance();
+    STM8::Harness harness(simulator, argv[0], "<program.out | program.elf | program.hex | program.ihx>",
+                          "[--device STM8S103F3 | STM8S103K3 | STM8S105C6] [--profile file]");
+    STM8::Device device = STM8::Device::STM8S103F3;
+    std::string path;
+    std::string profile;
+    std::vector<std::pair<std::string, std::string>> options;
+
+    //
+    //  The device must be selected before the stimulus is attached to the
+    //  peripherals so collect the options first.
+    //
+    for (int index = 1; index < argc; index++)
+    {
+        std::string option = argv[index];
+        if ((option.size() < 2) || (option.compare(0, 2, "--") != 0))
+        {
+            if (!path.empty())
+            {
+                harness.Usage();
+            }
+            path = option;
+            continue;
+        }
+        if (index + 1 >= argc)
+        {
+            harness.Usage();
+        }
+        std::string value = argv[++index];
+        if (option == "--device")
+        {
+            if (value == "STM8S103F3")
+            {
+                device = STM8::Device::STM8S103F3;
+            }
+            else if (value == "STM8S103K3")
+            {
+                device = STM8::Device::STM8S103K3;
+            }
+            else if (value == "STM8S105C6")
+            {
+                device = STM8::Device::STM8S105C6;
+            }
+            else
+            {
+                harness.Usage();
+            }
+        }
+        else if (option == "--profile")
+        {
+            profile = value;
+        }
+        else
+        {
+            options.push_back(std::make_pair(option, value));
+        }
+    }
+    if (path.empty())
+    {
+        harness.Usage();
+    }
+    simulator.Reset(device);
+    STM8::Program program;
+    std::string error;
+    if (!program.Load(path, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    program.Install(simulator);
+    for (auto &option : options)
+    {
+        if (!harness.Option(option.first, option.second))
+        {
+            harness.Usage();
+        }
+    }
+
+    STM8::Core core(simulator);
+    if (!profile.empty())
+    {
+        core.EnableProfile();
+    }
+    for (int vector = 0; vector < STM8::NumberOfVectors; vector++)
+    {
+        const char *name = program.SymbolName(core.VectorAddress(vector));
+        simulator.AttachInterrupt(vector, nullptr, (name != nullptr) ? name : _vectorNames[vector]);
+    }
+
+    std::string reason = simulator.Run([&core]() { core.Run(); }, harness.Seconds());
+    printf("Program: %s (%s, %zu bytes)\n", path.c_str(), program.Format(), program.Size());
+    harness.Report(reason);
+    printf("Instructions executed: %llu\n", (unsigned long long) core.Instructions());
+    if (!profile.empty() && !WriteProfile(profile, core, program))
+    {
+        fprintf(stderr, "Cannot write the profile to %s\n", profile.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,336 @@
+//
+//  Decoder for the binary log records written by Common/BinaryLog.h.
+//
+//  The message table is read from the source file which defines
+//  LOG_MESSAGES, message n being the nth LOG_MESSAGE(id, "format") entry.
+//  The captured UART output (a file or standard input) is then turned back
+//  into text, one line per record with the timestamp extended to cover the
+//  wrap of the 16 bit counter.  Bytes which are not part of a record are
+//  copied to the output unchanged.
+//
+//  Usage: stm8log [--tick <seconds>] <source file> [capture file]
+//
+//      --tick <seconds>    Length of one timestamp count, the timestamp is
+//                          shown in counts when this is not given.
+//
+//      ./build/chapter04 --uart "hello"$'\r'@0.01 --uart-capture capture.bin
+//      ./build/stm8log --tick 0.001024 "04 - UART/main.c" capture.bin
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <regex>
+#include <string>
+#include <vector>
+
+//
+//  First byte of every record, see BinaryLog.h.
+//
+const unsigned char LogSync = 0xa5;
+
+//
+//  Message table entry.
+//
+struct Message
+{
+    std::string id;
+    std::string format;
+};
+
+//--------------------------------------------------------------------------------
+//
+//  Print the usage message and exit.
+//
+[[noreturn]] static void Usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--tick seconds] <source file> [capture file]\n", program);
+    exit(1);
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Read a whole file, returns false if the file cannot be opened.
+//
+static bool ReadFile(const char *path, std::string &contents)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Replace the escape sequences in a C string literal.
+//
+static std::string Unescape(const std::string &text)
+{
+    std::string result;
+    for (size_t index = 0; index < text.size(); index++)
+    {
+        char ch = text[index];
+        if ((ch == '\\') && (index + 1 < text.size()))
+        {
+            ch = text[++index];
+            switch (ch)
+            {
+                case 'n':
+                    ch = '\n';
+                    break;
+                case 'r':
+                    ch = '\r';
+                    break;
+                case 't':
+                    ch = '\t';
+                    break;
+                default:
+                    break;
+            }
+        }
+        result += ch;
+    }
+    return result;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Find the LOG_MESSAGE entries in the source file.
+//
+static std::vector<Message> ReadMessages(const std::string &source)
+{
+    static const std::regex entry(R"(LOG_MESSAGE\s*\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)\"\s*\))");
+    std::vector<Message> messages;
+    for (std::sregex_iterator match(source.begin(), source.end(), entry); match != std::sregex_iterator(); ++match)
+    {
+        messages.push_back(Message { (*match)[1].str(), Unescape((*match)[2].str()) });
+    }
+    return messages;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Number of 16 bit arguments used by a format string.
+//
+static size_t CountArguments(const std::string &format)
+{
+    size_t count = 0;
+    for (size_t index = 0; index < format.size(); index++)
+    {
+        if (format[index] == '%')
+        {
+            if ((index + 1 < format.size()) && (format[index + 1] == '%'))
+            {
+                index++;
+            }
+            else
+            {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Format the arguments of a record.  Each conversion may have flags and a
+//  width, e.g. %04x, and takes one 16 bit argument.
+//
+static std::string Format(const std::string &format, const std::vector<unsigned short> &arguments)
+{
+    std::string text;
+    size_t argument = 0;
+    for (size_t index = 0; index < format.size(); index++)
+    {
+        if (format[index] != '%')
+        {
+            text += format[index];
+            continue;
+        }
+        size_t start = index++;
+        while ((index < format.size()) && (strchr("-+ #0123456789", format[index]) != nullptr))
+        {
+            index++;
+        }
+        if (index >= format.size())
+        {
+            break;
+        }
+        char conversion = format[index];
+        if (conversion == '%')
+        {
+            text += '%';
+            continue;
+        }
+        unsigned short value = (argument < arguments.size()) ? arguments[argument++] : 0;
+        std::string specification = format.substr(start, index - start);
+        char buffer[64];
+        switch (conversion)
+        {
+            case 'd':
+            case 'i':
+                specification += 'd';
+                snprintf(buffer, sizeof(buffer), specification.c_str(), (int) (short) value);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                specification += conversion;
+                snprintf(buffer, sizeof(buffer), specification.c_str(), (unsigned int) value);
+                break;
+            case 'c':
+                specification += 'c';
+                snprintf(buffer, sizeof(buffer), specification.c_str(), (int) (value & 0xff));
+                break;
+            default:
+                snprintf(buffer, sizeof(buffer), "<%%%c?>", conversion);
+                break;
+        }
+        text += buffer;
+    }
+    return text;
+}
+
+//--------------------------------------------------------------------------------
+//
+//  Decode the capture.
+//
+int main(int argc, char *argv[])
+{
+    double tick = 0;
+    std::vector<const char *> paths;
+    for (int index = 1; index < argc; index++)
+    {
+        std::string option = argv[index];
+        if (option == "--tick")
+        {
+            if (index + 1 >= argc)
+            {
+                Usage(argv[0]);
+            }
+            tick = atof(argv[++index]);
+        }
+        else if ((option.size() > 1) && (option[0] == '-'))
+        {
+            Usage(argv[0]);
+        }
+        else
+        {
+            paths.push_back(argv[index]);
+        }
+    }
+    if ((paths.size() < 1) || (paths.size() > 2))
+    {
+        Usage(argv[0]);
+    }
+
+    std::string source;
+    if (!ReadFile(paths[0], source))
+    {
+        fprintf(stderr, "Cannot read %s\n", paths[0]);
+        return 1;
+    }
+    std::vector<Message> messages = ReadMessages(source);
+    if (messages.empty())
+    {
+        fprintf(stderr, "No LOG_MESSAGE entries found in %s\n", paths[0]);
+        return 1;
+    }
+
+    std::string capture;
+    if (paths.size() == 2)
+    {
+        if (!ReadFile(paths[1], capture))
+        {
+            fprintf(stderr, "Cannot read %s\n", paths[1]);
+            return 1;
+        }
+    }
+    else
+    {
+        capture.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
+
+    //
+    //  Bytes in the capture.
+    //
+    const unsigned char *data = (const unsigned char *) capture.data();
+    size_t size = capture.size();
+    auto ReadShort = [data](size_t offset) { return (unsigned short) ((data[offset] << 8) | data[offset + 1]); };
+
+    unsigned long long time = 0;
+    unsigned short lastTimestamp = 0;
+    bool first = true;
+    size_t records = 0;
+    size_t recordBytes = 0;
+    size_t expandedBytes = 0;
+    size_t index = 0;
+    while (index < size)
+    {
+        if (data[index] != LogSync)
+        {
+            fputc(data[index++], stdout);
+            continue;
+        }
+        if (index + 4 > size)
+        {
+            printf("<incomplete record>\n");
+            break;
+        }
+        unsigned char id = data[index + 1];
+        if ((id == 0) || (id > messages.size()))
+        {
+            printf("<unknown message %u>\n", id);
+            index += 2;
+            continue;
+        }
+        const Message &message = messages[id - 1];
+        size_t count = CountArguments(message.format);
+        size_t length = 4 + (2 * count);
+        if (index + length > size)
+        {
+            printf("<incomplete record %s>\n", message.id.c_str());
+            break;
+        }
+        unsigned short timestamp = ReadShort(index + 2);
+        time = first ? timestamp : time + (unsigned short) (timestamp - lastTimestamp);
+        lastTimestamp = timestamp;
+        first = false;
+        std::vector<unsigned short> arguments;
+        for (size_t argument = 0; argument < count; argument++)
+        {
+            arguments.push_back(ReadShort(index + 4 + (2 * argument)));
+        }
+        std::string text = Format(message.format, arguments);
+        if (tick > 0)
+        {
+            printf("[%12.6f] %s\n", time * tick, text.c_str());
+        }
+        else
+        {
+            printf("[%10llu] %s\n", time, text.c_str());
+        }
+        records++;
+        recordBytes += length;
+        expandedBytes += text.size();
+        index += length;
+    }
+
+    //
+    //  Compare the size of the records with the text they represent.
+    //
+    fprintf(stderr, "%zu records in %zu bytes, %zu bytes as text\n", records, recordBytes, expandedBytes);
+    return 0;
+}
@@ -0,0 +1,2507 @@
+//
+//  Peripheral models for the host simulation of the STM8S.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#include <algorithm>
+#include <cctype>
+
+#include "Peripherals.h"
+
+namespace STM8
+{
+    //--------------------------------------------------------------------------------
+    //
+    //  Oscillator frequencies.
+    //
+    const unsigned long HsiFrequency = 16000000;
+    const unsigned long LsiFrequency = 128000;
+
+    //
+    //  Register addresses used by more than one model.
+    //
+    const unsigned short CLK_ICKR_ADDRESS = 0x50c0;
+    const unsigned short CLK_ECKR_ADDRESS = 0x50c1;
+    const unsigned short CLK_CMSR_ADDRESS = 0x50c3;
+    const unsigned short CLK_SWR_ADDRESS = 0x50c4;
+    const unsigned short CLK_SWCR_ADDRESS = 0x50c5;
+    const unsigned short CLK_CKDIVR_ADDRESS = 0x50c6;
+    const unsigned short CLK_PCKENR1_ADDRESS = 0x50c7;
+    const unsigned short CLK_CCOR_ADDRESS = 0x50c9;
+    const unsigned short CLK_PCKENR2_ADDRESS = 0x50ca;
+    const unsigned short EXTI_CR1_ADDRESS = 0x50a0;
+    const unsigned short EXTI_CR2_ADDRESS = 0x50a1;
+    const unsigned short RST_SR_ADDRESS = 0x50b3;
+
+    //********************************************************************************
+    //
+    //  Clock controller.
+    //
+    //********************************************************************************
+
+    ClockModel::ClockModel(Simulator &simulator) : Peripheral(simulator), _hseFrequency(16000000), _switches(0)
+    {
+        _simulator.Map(0x50c0, 0x50cd, this);
+        Register(CLK_ICKR_ADDRESS) = 0x01;
+        Register(CLK_CMSR_ADDRESS) = 0xe1;
+        Register(CLK_SWR_ADDRESS) = 0xe1;
+        Register(CLK_CKDIVR_ADDRESS) = 0x18;
+        Register(CLK_PCKENR1_ADDRESS) = 0xff;
+        Register(CLK_PCKENR2_ADDRESS) = 0xff;
+        for (int bit = 0; bit < NumberOfGates; bit++)
+        {
+            _gatePicoseconds[bit] = 0;
+            _gateEnabledAt[bit] = 0;
+            _gateEnables[bit] = 1;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  The oscillators become ready as soon as they are enabled.
+    //
+    unsigned char ClockModel::Read(unsigned short address, unsigned char value)
+    {
+        switch (address)
+        {
+            case CLK_ICKR_ADDRESS:
+                value &= 0x2d;
+                if (value & 0x01)
+                {
+                    value |= 0x02;          //  HSIRDY
+                }
+                if (value & 0x08)
+                {
+                    value |= 0x10;          //  LSIRDY
+                }
+                break;
+            case CLK_ECKR_ADDRESS:
+                value = (value & 0x01) ? 0x03 : 0x00;
+                break;
+            case CLK_CCOR_ADDRESS:
+                value = (value & 0x01) ? (value | 0x20) : (value & ~0x20);
+                break;
+        }
+        return value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Register writes.
+    //
+    void ClockModel::Write(unsigned short address, unsigned char value)
+    {
+        switch (address)
+        {
+            case CLK_ICKR_ADDRESS:
+                //
+                //  The oscillator providing the master clock cannot be stopped.
+                //
+                if (Register(CLK_CMSR_ADDRESS) == 0xe1)
+                {
+                    value |= 0x01;
+                }
+                if (Register(CLK_CMSR_ADDRESS) == 0xd2)
+                {
+                    value |= 0x08;
+                }
+                Register(address) = value & 0x2d;
+                break;
+            case CLK_ECKR_ADDRESS:
+                if (Register(CLK_CMSR_ADDRESS) == 0xb4)
+                {
+                    value |= 0x01;
+                }
+                Register(address) = value & 0x01;
+                break;
+            case CLK_CMSR_ADDRESS:
+                break;
+            case CLK_SWR_ADDRESS:
+                Register(address) = value;
+                Register(CLK_SWCR_ADDRESS) |= 0x01;         //  SWBSY
+                if (Register(CLK_SWCR_ADDRESS) & 0x02)
+                {
+                    CompleteSwitch();
+                }
+                break;
+            case CLK_SWCR_ADDRESS:
+                {
+                    unsigned char current = Register(address);
+                    //
+                    //  SWIF is cleared by writing 0, SWBSY may be cleared by
+                    //  software to abandon the switch.
+                    //
+                    unsigned char result = (unsigned char) ((value & 0x06) | (current & value & 0x09));
+                    Register(address) = result;
+                    if ((result & 0x03) == 0x03)
+                    {
+                        CompleteSwitch();
+                    }
+                }
+                break;
+            case CLK_CKDIVR_ADDRESS:
+                Register(address) = value & 0x1f;
+                break;
+            case CLK_PCKENR1_ADDRESS:
+            case CLK_PCKENR2_ADDRESS:
+                {
+                    unsigned short previous = Gates();
+                    Register(address) = value;
+                    GatesChanged(previous);
+                }
+                break;
+            default:
+                Register(address) = value;
+                break;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Switch the master clock to the source in CLK_SWR.
+    //
+    void ClockModel::CompleteSwitch()
+    {
+        unsigned char target = Register(CLK_SWR_ADDRESS);
+        if ((target == 0xe1) || (target == 0xd2) || (target == 0xb4))
+        {
+            if (target == 0xe1)
+            {
+                Register(CLK_ICKR_ADDRESS) |= 0x01;
+            }
+            if (target == 0xd2)
+            {
+                Register(CLK_ICKR_ADDRESS) |= 0x08;
+            }
+            if (target == 0xb4)
+            {
+                Register(CLK_ECKR_ADDRESS) |= 0x01;
+            }
+            if (Register(CLK_CMSR_ADDRESS) != target)
+            {
+                _switches++;
+            }
+            Register(CLK_CMSR_ADDRESS) = target;
+        }
+        Register(CLK_SWCR_ADDRESS) &= (unsigned char) ~0x01;
+        if (Register(CLK_SWCR_ADDRESS) & 0x04)
+        {
+            Register(CLK_SWCR_ADDRESS) |= 0x08;             //  SWIF
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Clock switch interrupt.
+    //
+    uint32_t ClockModel::PendingInterrupts() const
+    {
+        unsigned char swcr = _simulator.Memory(CLK_SWCR_ADDRESS);
+        return ((swcr & 0x0c) == 0x0c) ? (1UL << 4) : 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Master clock frequency from the current source and the HSI divider.
+    //
+    unsigned long ClockModel::MasterFrequency() const
+    {
+        switch (_simulator.Memory(CLK_CMSR_ADDRESS))
+        {
+            case 0xd2:
+                return LsiFrequency;
+            case 0xb4:
+                return _hseFrequency;
+            default:
+                return HsiFrequency >> ((_simulator.Memory(CLK_CKDIVR_ADDRESS) >> 3) & 0x03);
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  CPU clock divider as a power of two.
+    //
+    int ClockModel::CpuDivider() const
+    {
+        return _simulator.Memory(CLK_CKDIVR_ADDRESS) & 0x07;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Peripheral clock gates, bits 0-7 are CLK_PCKENR1 and 8-15 CLK_PCKENR2.
+    //
+    unsigned short ClockModel::Gates() const
+    {
+        return (unsigned short) (_simulator.Memory(CLK_PCKENR1_ADDRESS) | (_simulator.Memory(CLK_PCKENR2_ADDRESS) << 8));
+    }
+
+    bool ClockModel::PeripheralClockEnabled(int bit) const
+    {
+        return (Gates() & (1 << bit)) != 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Account for the time spent with each gate enabled.
+    //
+    void ClockModel::GatesChanged(unsigned short previous)
+    {
+        unsigned short changed = (unsigned short) (previous ^ Gates());
+        for (int bit = 0; bit < NumberOfGates; bit++)
+        {
+            if ((changed & (1 << bit)) == 0)
+            {
+                continue;
+            }
+            if (previous & (1 << bit))
+            {
+                _gatePicoseconds[bit] += _simulator.Picoseconds() - _gateEnabledAt[bit];
+            }
+            else
+            {
+                _gateEnabledAt[bit] = _simulator.Picoseconds();
+                _gateEnables[bit]++;
+            }
+        }
+    }
+
+    uint64_t ClockModel::GatePicoseconds(int bit) const
+    {
+        uint64_t picoseconds = _gatePicoseconds[bit];
+        if (PeripheralClockEnabled(bit))
+        {
+            picoseconds += _simulator.Picoseconds() - _gateEnabledAt[bit];
+        }
+        return picoseconds;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Name of the peripheral(s) behind each gate, nullptr for reserved bits.
+    //
+    const char *ClockModel::GateName(int bit)
+    {
+        static const char *names[NumberOfGates] =
+        {
+            "I2C", "SPI", nullptr, "UART", "TIM4", "TIM2", "TIM3", "TIM1",
+            nullptr, nullptr, "AWU/BEEP", "ADC", nullptr, nullptr, nullptr, "CAN"
+        };
+        return names[bit];
+    }
+
+    //********************************************************************************
+    //
+    //  GPIO ports and external interrupts.
+    //
+    //********************************************************************************
+
+    GpioModel::GpioModel(Simulator &simulator) : Peripheral(simulator), _pending(0), _deferring(false), _dirty(0)
+    {
+        _ports = simulator.MediumDensity() ? 9 : 6;
+        _simulator.Map(0x5000, (unsigned short) (0x5000 + (_ports * 5) - 1), this);
+        _simulator.Map(EXTI_CR1_ADDRESS, EXTI_CR2_ADDRESS, this);
+        for (int port = 0; port < MaximumPorts; port++)
+        {
+            _external[port] = 0;
+            _driven[port] = 0;
+            _alternateMask[port] = 0;
+            _alternateLevel[port] = 0;
+            _levels[port] = 0;
+            _watched[port] = 0;
+            for (int pin = 0; pin < 8; pin++)
+            {
+                _transitions[port][pin] = 0;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Reading IDR returns the pin levels.
+    //
+    unsigned char GpioModel::Read(unsigned short address, unsigned char value)
+    {
+        if ((address < 0x5000 + (_ports * 5)) && (((address - 0x5000) % 5) == 1))
+        {
+            return _levels[(address - 0x5000) / 5];
+        }
+        return value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Writes to the port registers can change the pin levels.
+    //
+    void GpioModel::Write(unsigned short address, unsigned char value)
+    {
+        if (address >= 0x5000 + (_ports * 5))
+        {
+            Register(address) = value;
+            return;
+        }
+        int port = (address - 0x5000) / 5;
+        if (((address - 0x5000) % 5) != 1)
+        {
+            Register(address) = value;
+            UpdateLevels(port);
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  EXTI vectors 5 (port A) to 9 (port E).
+    //
+    uint32_t GpioModel::PendingInterrupts() const
+    {
+        return _pending;
+    }
+
+    void GpioModel::AcknowledgeInterrupt(int vector)
+    {
+        _pending &= ~(1UL << vector);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Current level of a pin.
+    //
+    bool GpioModel::Level(int port, int pin) const
+    {
+        return (_levels[port] & (1 << pin)) != 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Drive an input pin from outside the microcontroller.
+    //
+    void GpioModel::SetInput(int port, int pin, bool level)
+    {
+        if ((port < 0) || (port >= _ports))
+        {
+            return;
+        }
+        _driven[port] |= (unsigned char) (1 << pin);
+        if (level)
+        {
+            _external[port] |= (unsigned char) (1 << pin);
+        }
+        else
+        {
+            _external[port] &= (unsigned char) ~(1 << pin);
+        }
+        UpdateLevels(port);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Drive a pin from an alternate function (timer output).
+    //
+    void GpioModel::SetAlternate(int port, int pin, bool enabled, bool level)
+    {
+        if ((port < 0) || (port >= _ports))
+        {
+            return;
+        }
+        unsigned char bit = (unsigned char) (1 << pin);
+        _alternateMask[port] = enabled ? (_alternateMask[port] | bit) : (_alternateMask[port] & ~bit);
+        _alternateLevel[port] = level ? (_alternateLevel[port] | bit) : (_alternateLevel[port] & ~bit);
+        UpdateLevels(port);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Wire the output of one pin to the input of another.
+    //
+    void GpioModel::Connect(int fromPort, int fromPin, int toPort, int toPin)
+    {
+        _connections[fromPort][fromPin].push_back(std::make_pair(toPort, toPin));
+        SetInput(toPort, toPin, Level(fromPort, fromPin));
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Start or stop holding back pin changes.
+    //
+    void GpioModel::Defer(bool defer)
+    {
+        _deferring = defer;
+        if (!defer)
+        {
+            while (_dirty != 0)
+            {
+                int port = 0;
+                while ((_dirty & (1 << port)) == 0)
+                {
+                    port++;
+                }
+                _dirty &= (unsigned short) ~(1 << port);
+                UpdateLevels(port);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Recalculate the levels on a port and act on any changes.
+    //
+    //  Inputs without an external signal read as 1 when the pull-up is
+    //  enabled and 0 otherwise.
+    //
+    void GpioModel::UpdateLevels(int port)
+    {
+        if (_deferring)
+        {
+            _dirty |= (unsigned short) (1 << port);
+            return;
+        }
+        unsigned short base = (unsigned short) (0x5000 + (port * 5));
+        unsigned char odr = Register(base);
+        unsigned char ddr = Register(base + 2);
+        unsigned char cr1 = Register(base + 3);
+        unsigned char levels = (unsigned char) ((_alternateMask[port] & _alternateLevel[port]) |
+                                                (~_alternateMask[port] & ddr & odr) |
+                                                (~_alternateMask[port] & ~ddr & (_external[port] | (~_driven[port] & cr1))));
+        unsigned char changed = levels ^ _levels[port];
+        _levels[port] = levels;
+        for (int pin = 0; pin < 8; pin++)
+        {
+            if (changed & (1 << pin))
+            {
+                EdgeDetected(port, pin, (levels & (1 << pin)) != 0);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  A pin has changed level.
+    //
+    //  EXTI sensitivity 00 (falling edge and low level) is treated as a
+    //  falling edge.
+    //
+    void GpioModel::EdgeDetected(int port, int pin, bool level)
+    {
+        _transitions[port][pin]++;
+        if (_watched[port] & (1 << pin))
+        {
+            _changes[port][pin].push_back({ _simulator.Picoseconds(), level });
+        }
+        if (port <= PortE)
+        {
+            unsigned short base = (unsigned short) (0x5000 + (port * 5));
+            unsigned char bit = (unsigned char) (1 << pin);
+            if (((Register(base + 2) & bit) == 0) && (Register(base + 4) & bit))
+            {
+                int sensitivity;
+                if (port == PortE)
+                {
+                    sensitivity = Register(EXTI_CR2_ADDRESS) & 0x03;
+                }
+                else
+                {
+                    sensitivity = (Register(EXTI_CR1_ADDRESS) >> (port * 2)) & 0x03;
+                }
+                bool trigger = (sensitivity == 3) || ((sensitivity == 1) && level) || ((sensitivity != 1) && !level);
+                if (trigger)
+                {
+                    _pending |= 1UL << (5 + port);
+                }
+            }
+        }
+        for (auto &connection : _connections[port][pin])
+        {
+            SetInput(connection.first, connection.second, level);
+        }
+        for (auto &listener : _listeners)
+        {
+            listener(port, pin, level);
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Convert between pin numbers and names such as PD4.
+    //
+    std::string GpioModel::PinName(int port, int pin)
+    {
+        std::string name = "P";
+        name += (char) ('A' + port);
+        name += (char) ('0' + pin);
+        return name;
+    }
+
+    bool GpioModel::ParsePinName(const std::string &name, int &port, int &pin)
+    {
+        if ((name.size() != 3) || (toupper(name[0]) != 'P'))
+        {
+            return false;
+        }
+        port = toupper(name[1]) - 'A';
+        pin = name[2] - '0';
+        return (port >= 0) && (port < MaximumPorts) && (pin >= 0) && (pin <= 7);
+    }
+
+    //********************************************************************************
+    //
+    //  Timers.
+    //
+    //********************************************************************************
+
+    //
+    //  Peripheral clock enable bits for TIM1 to TIM4.
+    //
+    static const int _timerClockBits[5] = { 0, 7, 5, 6, 4 };
+
+    TimerModel::TimerModel(Simulator &simulator, const Layout &layout) :
+        Peripheral(simulator), _layout(layout), _counter(0), _downwards(false), _divider(1), _prescalerPhase(0),
+        _repetition(0), _latchedLow(0), _lowLatched(false), _updateEvents(0), _recordUpdates(false)
+    {
+        //
+        //  The registers of each timer are contiguous, CR1 is the first and
+        //  the last is either BKR (TIM1), a compare register or ARR.
+        //
+        unsigned short last = _layout.arrl;
+        for (int channel = 0; channel < _layout.channels; channel++)
+        {
+            last = std::max(last, _layout.ccrl[channel]);
+        }
+        last = std::max(last, _layout.bkr);
+        _simulator.Map(_layout.cr1, last, this);
+        _autoReload = (_layout.arrh != 0) ? 0xffff : 0xff;
+        if (_layout.arrh != 0)
+        {
+            Register(_layout.arrh) = 0xff;
+        }
+        Register(_layout.arrl) = 0xff;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            _compare[channel] = 0;
+            _reference[channel] = false;
+            _driving[channel] = false;
+            _captureEdges[channel] = 0;
+        }
+        if (_layout.channels > 0)
+        {
+            _simulator.Gpio().AddListener([this](int port, int pin, bool level) { InputChanged(port, pin, level); });
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Reading the high byte of the counter latches the low byte.
+    //
+    unsigned char TimerModel::Read(unsigned short address, unsigned char value)
+    {
+        if ((address == _layout.cntrh) && (_layout.cntrh != 0))
+        {
+            _latchedLow = (unsigned char) (_counter & 0xff);
+            _lowLatched = true;
+            return (unsigned char) (_counter >> 8);
+        }
+        if (address == _layout.cntrl)
+        {
+            if (_lowLatched)
+            {
+                _lowLatched = false;
+                return _latchedLow;
+            }
+            return (unsigned char) (_counter & 0xff);
+        }
+        if (address == _layout.egr)
+        {
+            return 0;
+        }
+        return value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Register writes.
+    //
+    void TimerModel::Write(unsigned short address, unsigned char value)
+    {
+        if ((address == _layout.sr1) || ((address == _layout.sr2) && (_layout.sr2 != 0)))
+        {
+            Register(address) &= value;
+            return;
+        }
+        if (address == _layout.egr)
+        {
+            if (value & 0x01)
+            {
+                UpdateEvent(true);
+                _counter = CountingDown() && !CentreAligned() ? _autoReload : 0;
+                _prescalerPhase = 0;
+                UpdateOutputs();
+            }
+            for (int channel = 0; channel < _layout.channels; channel++)
+            {
+                if (value & (1 << (channel + 1)))
+                {
+                    if (ChannelIsInput(channel))
+                    {
+                        Capture(channel);
+                    }
+                    else
+                    {
+                        Register(_layout.sr1) |= (unsigned char) (1 << (channel + 1));
+                    }
+                }
+            }
+            return;
+        }
+        Register(address) = value;
+        if (address == _layout.cntrl)
+        {
+            _counter = (unsigned short) (((_layout.cntrh != 0) ? (Register(_layout.cntrh) << 8) : 0) | value);
+            UpdateOutputs();
+            return;
+        }
+        if (address == _layout.arrl)
+        {
+            if ((Register(_layout.cr1) & 0x80) == 0)
+            {
+                _autoReload = (unsigned short) (((_layout.arrh != 0) ? (Register(_layout.arrh) << 8) : 0) | value);
+                UpdateOutputs();
+            }
+            return;
+        }
+        for (int channel = 0; channel < _layout.channels; channel++)
+        {
+            if (address == _layout.ccrl[channel])
+            {
+                if (!ChannelIsInput(channel) && !PreloadEnabled(channel))
+                {
+                    _compare[channel] = (unsigned short) ((Register(_layout.ccrh[channel]) << 8) | value);
+                    UpdateOutputs();
+                }
+                return;
+            }
+        }
+        if ((address == _layout.cr1) || (address == _layout.ccer1) || (address == _layout.ccer2) ||
+            (address == _layout.bkr) || (address == _layout.ccmr[0]) || (address == _layout.ccmr[1]) ||
+            (address == _layout.ccmr[2]) || (address == _layout.ccmr[3]))
+        {
+            if (address == _layout.cr1)
+            {
+                _downwards = CountingDown();
+            }
+            UpdateOutputs();
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Run the counter for a number of master clock ticks.
+    //
+    void TimerModel::Advance(uint64_t ticks)
+    {
+        while ((ticks > 0) && Running())
+        {
+            uint64_t ticksToCount = _divider - _prescalerPhase;
+            uint64_t counts = CountsToNextEvent();
+            uint64_t ticksToEvent = ticksToCount + ((counts - 1) * _divider);
+            if (ticks < ticksToEvent)
+            {
+                uint64_t total = _prescalerPhase + ticks;
+                uint64_t steps = total / _divider;
+                _prescalerPhase = (unsigned long) (total % _divider);
+                if (CentreAligned() ? _downwards : CountingDown())
+                {
+                    _counter = (unsigned short) (_counter - steps);
+                }
+                else
+                {
+                    _counter = (unsigned short) (_counter + steps);
+                }
+                ticks = 0;
+            }
+            else
+            {
+                ticks -= ticksToEvent;
+                _prescalerPhase = 0;
+                if (CentreAligned() ? _downwards : CountingDown())
+                {
+                    _counter = (unsigned short) (_counter - (counts - 1));
+                }
+                else
+                {
+                    _counter = (unsigned short) (_counter + (counts - 1));
+                }
+                Count();
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Ticks until the counter next reaches a compare value or overflows.
+    //
+    uint64_t TimerModel::TicksToNextEvent() const
+    {
+        if (!Running())
+        {
+            return NoEvent;
+        }
+        return (_divider - _prescalerPhase) + ((CountsToNextEvent() - 1) * _divider);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Update and capture / compare interrupts.
+    //
+    uint32_t TimerModel::PendingInterrupts() const
+    {
+        unsigned char status = _simulator.Memory(_layout.sr1) & _simulator.Memory(_layout.ier);
+        uint32_t pending = 0;
+        if (status & 0xc1)
+        {
+            pending |= 1UL << _layout.updateVector;
+        }
+        if ((status & 0x3e) && (_layout.captureVector != 0))
+        {
+            pending |= 1UL << _layout.captureVector;
+        }
+        return pending;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  The counter runs when enabled and the peripheral clock is on.
+    //
+    bool TimerModel::Running() const
+    {
+        return (_simulator.Memory(_layout.cr1) & 0x01) && _simulator.Clock().PeripheralClockEnabled(_timerClockBits[_layout.number]);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Counting mode (TIM1 only supports down and centre aligned counting).
+    //
+    bool TimerModel::CentreAligned() const
+    {
+        return (_layout.number == 1) && ((_simulator.Memory(_layout.cr1) & 0x60) != 0);
+    }
+
+    bool TimerModel::CountingDown() const
+    {
+        return (_layout.number == 1) && ((_simulator.Memory(_layout.cr1) & 0x10) != 0);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Channel configuration.
+    //
+    int TimerModel::ChannelMode(int channel) const
+    {
+        return (_simulator.Memory(_layout.ccmr[channel]) >> 4) & 0x07;
+    }
+
+    bool TimerModel::ChannelIsOutput(int channel) const
+    {
+        return (_simulator.Memory(_layout.ccmr[channel]) & 0x03) == 0;
+    }
+
+    bool TimerModel::ChannelIsInput(int channel) const
+    {
+        return !ChannelIsOutput(channel);
+    }
+
+    bool TimerModel::ChannelEnabled(int channel) const
+    {
+        unsigned short ccer = (channel < 2) ? _layout.ccer1 : _layout.ccer2;
+        return (_simulator.Memory(ccer) & (1 << ((channel & 1) * 4))) != 0;
+    }
+
+    bool TimerModel::ChannelPolarity(int channel) const
+    {
+        unsigned short ccer = (channel < 2) ? _layout.ccer1 : _layout.ccer2;
+        return (_simulator.Memory(ccer) & (2 << ((channel & 1) * 4))) != 0;
+    }
+
+    bool TimerModel::PreloadEnabled(int channel) const
+    {
+        return (_simulator.Memory(_layout.ccmr[channel]) & 0x08) != 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Counts until the next overflow, underflow or compare match.
+    //
+    unsigned long TimerModel::CountsToNextEvent() const
+    {
+        unsigned long counts;
+        bool down = CentreAligned() ? _downwards : CountingDown();
+        if (CentreAligned())
+        {
+            counts = down ? _counter : (unsigned long) (_autoReload - _counter);
+            if (counts == 0)
+            {
+                counts = 1;
+            }
+        }
+        else if (down)
+        {
+            counts = (unsigned long) _counter + 1;
+        }
+        else if (_counter <= _autoReload)
+        {
+            counts = (unsigned long) (_autoReload - _counter) + 1;
+        }
+        else
+        {
+            counts = (((_layout.cntrh != 0) ? 0x10000UL : 0x100UL) - _counter);
+        }
+        for (int channel = 0; channel < _layout.channels; channel++)
+        {
+            if (ChannelIsOutput(channel))
+            {
+                if (!down && (_compare[channel] > _counter) && (_compare[channel] <= _autoReload))
+                {
+                    counts = std::min(counts, (unsigned long) (_compare[channel] - _counter));
+                }
+                if (down && (_compare[channel] < _counter))
+                {
+                    counts = std::min(counts, (unsigned long) (_counter - _compare[channel]));
+                }
+            }
+        }
+        return counts;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Single count of the counter including any events it causes.
+    //
+    void TimerModel::Count()
+    {
+        bool overflow = false;
+        if (CentreAligned())
+        {
+            if (_downwards)
+            {
+                if (_counter > 0)
+                {
+                    _counter--;
+                }
+                if (_counter == 0)
+                {
+                    _downwards = false;
+                    overflow = true;
+                }
+            }
+            else
+            {
+                if (_counter < _autoReload)
+                {
+                    _counter++;
+                }
+                if (_counter >= _autoReload)
+                {
+                    _downwards = true;
+                    overflow = true;
+                }
+            }
+        }
+        else if (CountingDown())
+        {
+            if (_counter == 0)
+            {
+                overflow = true;
+            }
+            else
+            {
+                _counter--;
+            }
+        }
+        else
+        {
+            unsigned short maximum = (_layout.cntrh != 0) ? 0xffff : 0xff;
+            if ((_counter == _autoReload) || (_counter == maximum))
+            {
+                _counter = 0;
+                overflow = true;
+            }
+            else
+            {
+                _counter++;
+            }
+        }
+        if (overflow)
+        {
+            //
+            //  With a repetition counter the update event only happens when
+            //  the repetition counter reaches zero.
+            //
+            if ((_layout.rcr != 0) && (_repetition != 0))
+            {
+                _repetition--;
+            }
+            else
+            {
+                UpdateEvent(false);
+            }
+            if (!CentreAligned() && CountingDown())
+            {
+                _counter = _autoReload;
+            }
+        }
+        for (int channel = 0; channel < _layout.channels; channel++)
+        {
+            if (ChannelIsOutput(channel) && (_counter == _compare[channel]))
+            {
+                CompareMatch(channel);
+            }
+        }
+        UpdateOutputs();
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Update event: load the shadow registers from the preload registers.
+    //
+    void TimerModel::UpdateEvent(bool fromSoftware)
+    {
+        unsigned char cr1 = Register(_layout.cr1);
+        if ((cr1 & 0x02) && !fromSoftware)
+        {
+            return;
+        }
+        if (_layout.prescaler == Prescaler::Linear)
+        {
+            _divider = ((Register(_layout.pscrh) << 8) | Register(_layout.pscrl)) + 1UL;
+        }
+        else
+        {
+            _divider = 1UL << (Register(_layout.pscrl) & ((1 << _layout.prescalerBits) - 1));
+        }
+        if (cr1 & 0x80)
+        {
+            _autoReload = (unsigned short) (((_layout.arrh != 0) ? (Register(_layout.arrh) << 8) : 0) | Register(_layout.arrl));
+        }
+        for (int channel = 0; channel < _layout.channels; channel++)
+        {
+            if (ChannelIsOutput(channel) && PreloadEnabled(channel))
+            {
+                _compare[channel] = (unsigned short) ((Register(_layout.ccrh[channel]) << 8) | Register(_layout.ccrl[channel]));
+            }
+        }
+        if (_layout.rcr != 0)
+        {
+            _repetition = Register(_layout.rcr);
+        }
+        if (!fromSoftware || ((cr1 & 0x04) == 0))
+        {
+            Register(_layout.sr1) |= 0x01;
+        }
+        _updateEvents++;
+        if (_recordUpdates)
+        {
+            UpdateRecord record = { _simulator.Picoseconds(), _autoReload, { _compare[0], _compare[1], _compare[2], _compare[3] } };
+            _updates.push_back(record);
+        }
+        //
+        //  One pulse mode stops the counter at the update event.
+        //
+        if ((cr1 & 0x08) && !fromSoftware)
+        {
+            Register(_layout.cr1) &= (unsigned char) ~0x01;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Output compare match.
+    //
+    void TimerModel::CompareMatch(int channel)
+    {
+        Register(_layout.sr1) |= (unsigned char) (1 << (channel + 1));
+        switch (ChannelMode(channel))
+        {
+            case 1:
+                _reference[channel] = true;
+                break;
+            case 2:
+                _reference[channel] = false;
+                break;
+            case 3:
+                _reference[channel] = !_reference[channel];
+                break;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Recalculate the output reference signals and drive the pins.
+    //
+    //  PWM mode 1 is active while the counter is below the compare value
+    //  when counting up and at or below it when counting down.
+    //
+    void TimerModel::UpdateOutputs()
+    {
+        bool down = CentreAligned() ? _downwards : CountingDown();
+        for (int channel = 0; channel < _layout.channels; channel++)
+        {
+            if (!ChannelIsOutput(channel))
+            {
+                if (_driving[channel])
+                {
+                    _driving[channel] = false;
+                    _simulator.Gpio().SetAlternate(_layout.pinPort[channel], _layout.pinNumber[channel], false, false);
+                }
+                continue;
+            }
+            int mode = ChannelMode(channel);
+            bool active = down ? (_counter <= _compare[channel]) : (_counter < _compare[channel]);
+            switch (mode)
+            {
+                case 4:
+                    _reference[channel] = false;
+                    break;
+                case 5:
+                    _reference[channel] = true;
+                    break;
+                case 6:
+                    _reference[channel] = active;
+                    break;
+                case 7:
+                    _reference[channel] = !active;
+                    break;
+            }
+            bool enabled = ChannelEnabled(channel);
+            if ((_layout.number == 1) && ((Register(_layout.bkr) & 0x80) == 0))
+            {
+                enabled = false;
+            }
+            if (enabled)
+            {
+                _driving[channel] = true;
+                _simulator.Gpio().SetAlternate(_layout.pinPort[channel], _layout.pinNumber[channel], true, _reference[channel] != ChannelPolarity(channel));
+            }
+            else if (_driving[channel])
+            {
+                _driving[channel] = false;
+                _simulator.Gpio().SetAlternate(_layout.pinPort[channel], _layout.pinNumber[channel], false, false);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Capture the counter into a capture / compare register.
+    //
+    void TimerModel::Capture(int channel)
+    {
+        _compare[channel] = _counter;
+        Register(_layout.ccrh[channel]) = (unsigned char) (_counter >> 8);
+        Register(_layout.ccrl[channel]) = (unsigned char) (_counter & 0xff);
+        unsigned char bit = (unsigned char) (1 << (channel + 1));
+        if ((Register(_layout.sr1) & bit) && (_layout.sr2 != 0))
+        {
+            Register(_layout.sr2) |= bit;
+        }
+        Register(_layout.sr1) |= bit;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Input capture on the channel pins.  CCxS = 01 maps a channel onto its
+    //  own input and CCxS = 10 onto the input of the neighbouring channel.
+    //
+    void TimerModel::InputChanged(int port, int pin, bool level)
+    {
+        for (int channel = 0; channel < _layout.channels; channel++)
+        {
+            if (!ChannelIsInput(channel) || !ChannelEnabled(channel))
+            {
+                continue;
+            }
+            int selection = _simulator.Memory(_layout.ccmr[channel]) & 0x03;
+            int source = (selection == 2) ? (channel ^ 1) : channel;
+            if ((source >= _layout.channels) || (_layout.pinPort[source] != port) || (_layout.pinNumber[source] != pin))
+            {
+                continue;
+            }
+            if (level == ChannelPolarity(channel))
+            {
+                continue;
+            }
+            int prescaler = (_simulator.Memory(_layout.ccmr[channel]) >> 2) & 0x03;
+            if (++_captureEdges[channel] >= (1 << prescaler))
+            {
+                _captureEdges[channel] = 0;
+                Capture(channel);
+            }
+        }
+    }
+
+    //********************************************************************************
+    //
+    //  UART.
+    //
+    //********************************************************************************
+
+    UartModel::UartModel(Simulator &simulator, unsigned short base, int transmitVector, int receiveVector) :
+        Peripheral(simulator), _base(base), _transmitVector(transmitVector), _receiveVector(receiveVector), _statusRead(false),
+        _shifting(false), _transmitRemaining(0), _transmitFull(false), _transmitData(0), _shiftData(0), _receiveRemaining(0), _idleRemaining(NoEvent)
+    {
+        _simulator.Map(base, (unsigned short) (base + 0x0a), this);
+        Register(base) = 0xc0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Reading SR followed by DR clears the error flags.
+    //
+    unsigned char UartModel::Read(unsigned short address, unsigned char value)
+    {
+        if (address == _base)
+        {
+            _statusRead = true;
+        }
+        else if (address == _base + 1)
+        {
+            Register(_base) &= (unsigned char) ~0x20;
+            if (_statusRead)
+            {
+                Register(_base) &= (unsigned char) ~0x1f;
+                _statusRead = false;
+            }
+        }
+        return value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Register writes.
+    //
+    void UartModel::Write(unsigned short address, unsigned char value)
+    {
+        unsigned char &sr = Register(_base);
+        if (address == _base)
+        {
+            //
+            //  Only RXNE and TC can be cleared by software.
+            //
+            sr &= (unsigned char) (value | ~0x60);
+        }
+        else if (address == _base + 1)
+        {
+            if (_statusRead)
+            {
+                _statusRead = false;
+            }
+            sr &= (unsigned char) ~0x40;
+            bool enabled = (Register(_base + 5) & 0x08) != 0;
+            if (enabled && !_shifting)
+            {
+                _shifting = true;
+                _shiftData = value;
+                _transmitRemaining = FrameTicks();
+                sr |= 0x80;
+            }
+            else
+            {
+                _transmitFull = true;
+                _transmitData = value;
+                sr &= (unsigned char) ~0x80;
+            }
+        }
+        else
+        {
+            Register(address) = value;
+            if ((address == _base + 5) && (value & 0x08) && _transmitFull && !_shifting)
+            {
+                _transmitFull = false;
+                _shifting = true;
+                _shiftData = _transmitData;
+                _transmitRemaining = FrameTicks();
+                sr |= 0x80;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Shift characters in and out.
+    //
+    void UartModel::Advance(uint64_t ticks)
+    {
+        unsigned char &sr = Register(_base);
+        if (_shifting)
+        {
+            if (ticks >= _transmitRemaining)
+            {
+                _transmitted += (char) _shiftData;
+                if (_transmitFull)
+                {
+                    _transmitFull = false;
+                    _shiftData = _transmitData;
+                    _transmitRemaining = FrameTicks();
+                    sr |= 0x80;
+                }
+                else
+                {
+                    _shifting = false;
+                    sr |= 0x40;
+                }
+            }
+            else
+            {
+                _transmitRemaining -= ticks;
+            }
+        }
+        if (!_receiveQueue.empty())
+        {
+            if (ticks >= _receiveRemaining)
+            {
+                std::pair<unsigned char, bool> character = _receiveQueue.front();
+                _receiveQueue.pop_front();
+                bool enabled = ((Register(_base + 5) & 0x04) != 0) && ((Register(_base + 4) & 0x20) == 0);
+                if (enabled)
+                {
+                    if (sr & 0x20)
+                    {
+                        sr |= 0x08;
+                    }
+                    else
+                    {
+                        Register(_base + 1) = character.first;
+                        sr |= 0x20;
+                        if (character.second)
+                        {
+                            sr |= 0x02;
+                        }
+                    }
+                }
+                _receiveRemaining = FrameTicks();
+                if (_receiveQueue.empty())
+                {
+                    _idleRemaining = FrameTicks();
+                }
+            }
+            else
+            {
+                _receiveRemaining -= ticks;
+            }
+        }
+        else if (_idleRemaining != NoEvent)
+        {
+            //
+            //  IDLE is set once the line has been idle for a whole frame
+            //  after the last character.
+            //
+            if (ticks >= _idleRemaining)
+            {
+                _idleRemaining = NoEvent;
+                if ((Register(_base + 5) & 0x04) != 0)
+                {
+                    sr |= 0x10;
+                }
+            }
+            else
+            {
+                _idleRemaining -= ticks;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Next character boundary.
+    //
+    uint64_t UartModel::TicksToNextEvent() const
+    {
+        uint64_t next = NoEvent;
+        if (_shifting)
+        {
+            next = _transmitRemaining;
+        }
+        if (!_receiveQueue.empty())
+        {
+            next = std::min(next, _receiveRemaining);
+        }
+        else
+        {
+            next = std::min(next, _idleRemaining);
+        }
+        return std::max(next, (uint64_t) 1);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Transmit and receive interrupts.
+    //
+    uint32_t UartModel::PendingInterrupts() const
+    {
+        unsigned char sr = _simulator.Memory(_base);
+        unsigned char cr2 = _simulator.Memory((unsigned short) (_base + 5));
+        uint32_t pending = 0;
+        if (((cr2 & 0x80) && (sr & 0x80)) || ((cr2 & 0x40) && (sr & 0x40)))
+        {
+            pending |= 1UL << _transmitVector;
+        }
+        if (((cr2 & 0x20) && (sr & 0x28)) || ((cr2 & 0x10) && (sr & 0x10)))
+        {
+            pending |= 1UL << _receiveVector;
+        }
+        return pending;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Queue characters on the RX line.
+    //
+    void UartModel::Receive(const std::string &data)
+    {
+        for (char character : data)
+        {
+            Receive((unsigned char) character);
+        }
+    }
+
+    void UartModel::Receive(unsigned char data, bool framingError)
+    {
+        if (_receiveQueue.empty())
+        {
+            _receiveRemaining = FrameTicks();
+            _idleRemaining = NoEvent;
+        }
+        _receiveQueue.push_back(std::make_pair(data, framingError));
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Baud rate from the divider in BRR1 / BRR2.
+    //
+    unsigned long UartModel::BaudRate() const
+    {
+        unsigned char brr1 = _simulator.Memory((unsigned short) (_base + 2));
+        unsigned char brr2 = _simulator.Memory((unsigned short) (_base + 3));
+        unsigned long divider = ((brr2 & 0xf0UL) << 8) | (brr1 << 4) | (brr2 & 0x0fUL);
+        if (divider < 16)
+        {
+            return 0;
+        }
+        return _simulator.Clock().MasterFrequency() / divider;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Length of a character frame: start bit, 8 or 9 data bits and the stop bits.
+    //
+    uint64_t UartModel::FrameTicks() const
+    {
+        unsigned char brr1 = _simulator.Memory((unsigned short) (_base + 2));
+        unsigned char brr2 = _simulator.Memory((unsigned short) (_base + 3));
+        uint64_t divider = ((brr2 & 0xf0UL) << 8) | (brr1 << 4) | (brr2 & 0x0fUL);
+        if (divider < 16)
+        {
+            divider = 16;
+        }
+        unsigned int bits = (_simulator.Memory((unsigned short) (_base + 4)) & 0x10) ? 11 : 10;
+        if ((_simulator.Memory((unsigned short) (_base + 6)) & 0x30) == 0x20)
+        {
+            bits++;
+        }
+        return divider * bits;
+    }
+
+    //********************************************************************************
+    //
+    //  SPI.
+    //
+    //********************************************************************************
+
+    const unsigned short SPI_CR1_ADDRESS = 0x5200;
+    const unsigned short SPI_ICR_ADDRESS = 0x5202;
+    const unsigned short SPI_SR_ADDRESS = 0x5203;
+    const unsigned short SPI_DR_ADDRESS = 0x5204;
+
+    SpiModel::SpiModel(Simulator &simulator) :
+        Peripheral(simulator), _phase(Phase::Idle), _remaining(0), _shiftIn(0), _transmitFull(false), _transmitData(0),
+        _receiveData(0), _dataRead(false), _overruns(0)
+    {
+        _simulator.Map(0x5200, 0x5207, this);
+        Register(SPI_SR_ADDRESS) = 0x02;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Reading DR followed by SR clears an overrun.
+    //
+    unsigned char SpiModel::Read(unsigned short address, unsigned char value)
+    {
+        if (address == SPI_DR_ADDRESS)
+        {
+            Register(SPI_SR_ADDRESS) &= (unsigned char) ~0x01;
+            _dataRead = true;
+            return _receiveData;
+        }
+        if (address == SPI_SR_ADDRESS)
+        {
+            if (_dataRead)
+            {
+                Register(SPI_SR_ADDRESS) &= (unsigned char) ~0x40;
+                _dataRead = false;
+            }
+            return value;
+        }
+        return value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Register writes.
+    //
+    void SpiModel::Write(unsigned short address, unsigned char value)
+    {
+        unsigned char &sr = Register(SPI_SR_ADDRESS);
+        if (address == SPI_SR_ADDRESS)
+        {
+            sr &= (unsigned char) (value | ~0x10);
+            return;
+        }
+        if (address == SPI_DR_ADDRESS)
+        {
+            _dataRead = false;
+            if (MasterMode() && Enabled() && (_phase == Phase::Idle))
+            {
+                _transmitData = value;
+                StartByte();
+            }
+            else
+            {
+                _transmitFull = true;
+                _transmitData = value;
+                sr &= (unsigned char) ~0x02;
+            }
+            return;
+        }
+        Register(address) = value;
+        if ((address == SPI_CR1_ADDRESS) && MasterMode() && Enabled() && _transmitFull && (_phase == Phase::Idle))
+        {
+            StartByte();
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Move the transfer in progress on.
+    //
+    void SpiModel::Advance(uint64_t ticks)
+    {
+        if (_phase == Phase::Idle)
+        {
+            return;
+        }
+        if (ticks < _remaining)
+        {
+            _remaining -= ticks;
+            return;
+        }
+        if (_phase == Phase::WaitingForStart)
+        {
+            StartByte();
+        }
+        else
+        {
+            EndByte();
+        }
+    }
+
+    uint64_t SpiModel::TicksToNextEvent() const
+    {
+        return (_phase == Phase::Idle) ? NoEvent : std::max(_remaining, (uint64_t) 1);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  SPI interrupt sources.
+    //
+    uint32_t SpiModel::PendingInterrupts() const
+    {
+        unsigned char icr = _simulator.Memory(SPI_ICR_ADDRESS);
+        unsigned char sr = _simulator.Memory(SPI_SR_ADDRESS);
+        bool pending = ((icr & 0x80) && (sr & 0x02)) || ((icr & 0x40) && (sr & 0x01)) ||
+                       ((icr & 0x20) && (sr & 0x70)) || ((icr & 0x10) && (sr & 0x08));
+        return pending ? (1UL << 12) : 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  External master clocks bytes into the slave.
+    //
+    void SpiModel::MasterTransfer(const std::vector<unsigned char> &data, double sckFrequency)
+    {
+        uint64_t ticks = std::max(_simulator.SecondsToTicks(8.0 / sckFrequency), (uint64_t) 1);
+        for (unsigned char byte : data)
+        {
+            _incoming.push_back(std::make_pair(byte, ticks));
+        }
+        if (_phase == Phase::Idle)
+        {
+            _phase = Phase::WaitingForStart;
+            _remaining = 1;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Bytes returned by an external slave in master mode.
+    //
+    void SpiModel::SlaveResponse(const std::vector<unsigned char> &data)
+    {
+        _response.insert(_response.end(), data.begin(), data.end());
+    }
+
+    bool SpiModel::MasterMode() const
+    {
+        return (_simulator.Memory(SPI_CR1_ADDRESS) & 0x04) != 0;
+    }
+
+    bool SpiModel::Enabled() const
+    {
+        return (_simulator.Memory(SPI_CR1_ADDRESS) & 0x40) != 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Start shifting a byte.  The transmit buffer moves to the shift
+    //  register and TXE is set.
+    //
+    void SpiModel::StartByte()
+    {
+        unsigned char &sr = Register(SPI_SR_ADDRESS);
+        if (MasterMode())
+        {
+            _transmitFull = false;
+            _mosi.push_back(_transmitData);
+            _remaining = 8UL * (2UL << ((_simulator.Memory(SPI_CR1_ADDRESS) >> 3) & 0x07));
+            _shiftIn = 0xff;
+            if (!_response.empty())
+            {
+                _shiftIn = _response.front();
+                _response.pop_front();
+            }
+        }
+        else
+        {
+            if (_incoming.empty())
+            {
+                _phase = Phase::Idle;
+                return;
+            }
+            _remaining = _incoming.front().second;
+            _shiftIn = _incoming.front().first;
+            _incoming.pop_front();
+            if (Enabled())
+            {
+                _mosi.push_back(_shiftIn);
+                _miso.push_back(_transmitData);
+            }
+            _transmitFull = false;
+        }
+        sr |= 0x82;
+        _phase = Phase::Shifting;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  A byte has been shifted in.  If the previous byte has not been read the
+    //  new byte is lost and OVR is set.
+    //
+    void SpiModel::EndByte()
+    {
+        unsigned char &sr = Register(SPI_SR_ADDRESS);
+        if (Enabled())
+        {
+            if (sr & 0x01)
+            {
+                sr |= 0x40;
+                _overruns++;
+            }
+            else
+            {
+                _receiveData = _shiftIn;
+                sr |= 0x01;
+            }
+        }
+        _phase = Phase::Idle;
+        sr &= (unsigned char) ~0x80;
+        if (MasterMode())
+        {
+            if (_transmitFull && Enabled())
+            {
+                StartByte();
+            }
+        }
+        else if (!_incoming.empty())
+        {
+            StartByte();
+        }
+    }
+
+    //********************************************************************************
+    //
+    //  I2C.
+    //
+    //********************************************************************************
+
+    const unsigned short I2C_CR1_ADDRESS = 0x5210;
+    const unsigned short I2C_CR2_ADDRESS = 0x5211;
+    const unsigned short I2C_OARL_ADDRESS = 0x5213;
+    const unsigned short I2C_DR_ADDRESS = 0x5216;
+    const unsigned short I2C_SR1_ADDRESS = 0x5217;
+    const unsigned short I2C_SR2_ADDRESS = 0x5218;
+    const unsigned short I2C_SR3_ADDRESS = 0x5219;
+    const unsigned short I2C_ITR_ADDRESS = 0x521a;
+
+    //
+    //  Status register bits.
+    //
+    const unsigned char SR1_SB = 0x01;
+    const unsigned char SR1_ADDR = 0x02;
+    const unsigned char SR1_BTF = 0x04;
+    const unsigned char SR1_STOPF = 0x10;
+    const unsigned char SR1_RXNE = 0x40;
+    const unsigned char SR1_TXE = 0x80;
+    const unsigned char SR2_AF = 0x04;
+    const unsigned char SR3_MSL = 0x01;
+    const unsigned char SR3_BUSY = 0x02;
+    const unsigned char SR3_TRA = 0x04;
+
+    I2CModel::I2CModel(Simulator &simulator) :
+        Peripheral(simulator), _state(State::Idle), _remaining(NoEvent), _sr1Read(false), _position(0), _masterAddress(0), _masterRead(false)
+    {
+        _simulator.Map(0x5210, 0x521e, this);
+        Register(0x521d) = 0x02;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Status register clearing sequences.
+    //
+    unsigned char I2CModel::Read(unsigned short address, unsigned char value)
+    {
+        unsigned char &sr1 = Register(I2C_SR1_ADDRESS);
+        if (address == I2C_SR1_ADDRESS)
+        {
+            _sr1Read = true;
+        }
+        else if (address == I2C_SR3_ADDRESS)
+        {
+            if (_sr1Read && (sr1 & SR1_ADDR))
+            {
+                sr1 &= (unsigned char) ~SR1_ADDR;
+                if (_state == State::SlaveWaitAddressClear)
+                {
+                    if (_current.read)
+                    {
+                        _state = State::SlaveTransmit;
+                        sr1 |= SR1_TXE;
+                        _remaining = NoEvent;
+                    }
+                    else
+                    {
+                        _state = State::SlaveReceive;
+                        _remaining = ByteTicks();
+                    }
+                }
+                else if (_state == State::MasterWaitAddressClear)
+                {
+                    if (_masterRead)
+                    {
+                        _state = State::MasterReceive;
+                        _remaining = ByteTicks();
+                    }
+                    else
+                    {
+                        _state = State::MasterTransmit;
+                        sr1 |= SR1_TXE;
+                        _remaining = NoEvent;
+                    }
+                }
+            }
+            _sr1Read = false;
+        }
+        else if (address == I2C_DR_ADDRESS)
+        {
+            sr1 &= (unsigned char) ~(SR1_RXNE | SR1_BTF);
+            if (((_state == State::SlaveReceive) || (_state == State::MasterReceive)) && (_remaining == NoEvent))
+            {
+                _remaining = 1;
+            }
+        }
+        return value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Register writes.
+    //
+    void I2CModel::Write(unsigned short address, unsigned char value)
+    {
+        unsigned char &sr1 = Register(I2C_SR1_ADDRESS);
+        if (address == I2C_SR1_ADDRESS)
+        {
+            return;
+        }
+        if (address == I2C_SR2_ADDRESS)
+        {
+            Register(address) &= value;
+            return;
+        }
+        if (address == I2C_SR3_ADDRESS)
+        {
+            return;
+        }
+        Register(address) = value;
+        if (address == I2C_CR1_ADDRESS)
+        {
+            if ((value & 0x01) && (_state == State::Idle))
+            {
+                NextSlaveTransaction();
+            }
+            return;
+        }
+        if (address == I2C_CR2_ADDRESS)
+        {
+            if (_sr1Read && (sr1 & SR1_STOPF))
+            {
+                sr1 &= (unsigned char) ~SR1_STOPF;
+            }
+            _sr1Read = false;
+            if ((value & 0x01) && (Register(I2C_CR1_ADDRESS) & 0x01) && (_state == State::Idle))
+            {
+                _state = State::MasterStart;
+                _remaining = std::max(ByteTicks() / 9, (uint64_t) 1);
+            }
+            if ((value & 0x02) && (_state == State::MasterTransmit) && (sr1 & SR1_TXE))
+            {
+                _state = State::MasterStop;
+                _remaining = std::max(ByteTicks() / 9, (uint64_t) 1);
+            }
+            return;
+        }
+        if (address == I2C_DR_ADDRESS)
+        {
+            switch (_state)
+            {
+                case State::MasterAddress:
+                    if (sr1 & SR1_SB)
+                    {
+                        sr1 &= (unsigned char) ~SR1_SB;
+                        _masterAddress = (unsigned char) (value >> 1);
+                        _masterRead = (value & 0x01) != 0;
+                        _remaining = ByteTicks();
+                    }
+                    break;
+                case State::MasterTransmit:
+                case State::SlaveTransmit:
+                    sr1 &= (unsigned char) ~(SR1_TXE | SR1_BTF);
+                    _remaining = ByteTicks();
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Move the bus on.
+    //
+    void I2CModel::Advance(uint64_t ticks)
+    {
+        if (_remaining == NoEvent)
+        {
+            return;
+        }
+        if (ticks < _remaining)
+        {
+            _remaining -= ticks;
+            return;
+        }
+        _remaining = NoEvent;
+        Step();
+    }
+
+    uint64_t I2CModel::TicksToNextEvent() const
+    {
+        return (_remaining == NoEvent) ? NoEvent : std::max(_remaining, (uint64_t) 1);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Event, buffer and error interrupts.
+    //
+    uint32_t I2CModel::PendingInterrupts() const
+    {
+        unsigned char itr = _simulator.Memory(I2C_ITR_ADDRESS);
+        unsigned char sr1 = _simulator.Memory(I2C_SR1_ADDRESS);
+        unsigned char sr2 = _simulator.Memory(I2C_SR2_ADDRESS);
+        bool pending = ((itr & 0x02) && (sr1 & 0x1f)) ||
+                       ((itr & 0x06) == 0x06 && (sr1 & (SR1_RXNE | SR1_TXE))) ||
+                       ((itr & 0x01) && (sr2 & 0x2f));
+        return pending ? (1UL << 21) : 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Harness as the bus master.
+    //
+    void I2CModel::MasterWrite(unsigned char address, const std::vector<unsigned char> &data)
+    {
+        _transactions.push_back({ address, false, data, data.size() });
+        if (_state == State::Idle)
+        {
+            NextSlaveTransaction();
+        }
+    }
+
+    void I2CModel::MasterRead(unsigned char address, size_t count)
+    {
+        _transactions.push_back({ address, true, std::vector<unsigned char>(), count });
+        if (_state == State::Idle)
+        {
+            NextSlaveTransaction();
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Attach a slave device for the STM8S to talk to as master.
+    //
+    void I2CModel::AttachDevice(unsigned char address, const std::vector<unsigned char> &response)
+    {
+        _devices[address] = { response, 0, std::vector<unsigned char>() };
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Nine bit periods at 100 kHz.
+    //
+    uint64_t I2CModel::ByteTicks() const
+    {
+        return std::max(_simulator.SecondsToTicks(9.0 / 100000.0), (uint64_t) 1);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Start the next transaction from the harness master.
+    //
+    void I2CModel::NextSlaveTransaction()
+    {
+        if (_transactions.empty() || ((Register(I2C_CR1_ADDRESS) & 0x01) == 0))
+        {
+            _state = State::Idle;
+            return;
+        }
+        _current = _transactions.front();
+        _transactions.pop_front();
+        _position = 0;
+        _state = State::SlaveAddress;
+        _remaining = ByteTicks();
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  The bus has finished the current step.
+    //
+    void I2CModel::Step()
+    {
+        unsigned char &sr1 = Register(I2C_SR1_ADDRESS);
+        unsigned char &sr3 = Register(I2C_SR3_ADDRESS);
+        switch (_state)
+        {
+            case State::SlaveAddress:
+                if (((Register(I2C_OARL_ADDRESS) >> 1) == _current.address) && (Register(I2C_CR2_ADDRESS) & 0x04))
+                {
+                    sr1 |= SR1_ADDR;
+                    sr3 |= SR3_BUSY;
+                    sr3 = _current.read ? (sr3 | SR3_TRA) : (sr3 & ~SR3_TRA);
+                    _state = State::SlaveWaitAddressClear;
+                }
+                else
+                {
+                    NextSlaveTransaction();
+                }
+                break;
+            case State::SlaveReceive:
+                if (sr1 & SR1_RXNE)
+                {
+                    break;
+                }
+                Register(I2C_DR_ADDRESS) = _current.data[_position++];
+                sr1 |= SR1_RXNE;
+                if (_position < _current.data.size())
+                {
+                    _remaining = ByteTicks();
+                }
+                else
+                {
+                    _state = State::SlaveStop;
+                    _remaining = std::max(ByteTicks() / 9, (uint64_t) 1);
+                }
+                break;
+            case State::SlaveTransmit:
+                _slaveTransmitted.push_back(Register(I2C_DR_ADDRESS));
+                if (++_position < _current.count)
+                {
+                    sr1 |= SR1_TXE;
+                }
+                else
+                {
+                    //
+                    //  Master does not acknowledge the final byte.
+                    //
+                    Register(I2C_SR2_ADDRESS) |= SR2_AF;
+                    sr3 &= (unsigned char) ~(SR3_BUSY | SR3_TRA);
+                    NextSlaveTransaction();
+                }
+                break;
+            case State::SlaveStop:
+                sr1 |= SR1_STOPF;
+                sr3 &= (unsigned char) ~(SR3_BUSY | SR3_TRA);
+                NextSlaveTransaction();
+                break;
+            case State::MasterStart:
+                Register(I2C_CR2_ADDRESS) &= (unsigned char) ~0x01;
+                sr1 |= SR1_SB;
+                sr3 |= SR3_MSL | SR3_BUSY;
+                _state = State::MasterAddress;
+                break;
+            case State::MasterAddress:
+                if (_devices.find(_masterAddress) != _devices.end())
+                {
+                    sr1 |= SR1_ADDR;
+                    sr3 = _masterRead ? (sr3 & ~SR3_TRA) : (sr3 | SR3_TRA);
+                    _state = State::MasterWaitAddressClear;
+                }
+                else
+                {
+                    Register(I2C_SR2_ADDRESS) |= SR2_AF;
+                    sr3 &= (unsigned char) ~(SR3_MSL | SR3_BUSY | SR3_TRA);
+                    _state = State::Idle;
+                }
+                break;
+            case State::MasterReceive:
+                {
+                    if (sr1 & SR1_RXNE)
+                    {
+                        break;
+                    }
+                    Device &device = _devices[_masterAddress];
+                    unsigned char data = 0xff;
+                    if (device.position < device.response.size())
+                    {
+                        data = device.response[device.position++];
+                    }
+                    Register(I2C_DR_ADDRESS) = data;
+                    sr1 |= SR1_RXNE;
+                    if (Register(I2C_CR2_ADDRESS) & 0x02)
+                    {
+                        Register(I2C_CR2_ADDRESS) &= (unsigned char) ~0x02;
+                        sr3 &= (unsigned char) ~(SR3_MSL | SR3_BUSY);
+                        _state = State::Idle;
+                        NextSlaveTransaction();
+                    }
+                    else
+                    {
+                        _remaining = ByteTicks();
+                    }
+                }
+                break;
+            case State::MasterTransmit:
+                _devices[_masterAddress].received.push_back(Register(I2C_DR_ADDRESS));
+                sr1 |= SR1_TXE | SR1_BTF;
+                if (Register(I2C_CR2_ADDRESS) & 0x02)
+                {
+                    _state = State::MasterStop;
+                    _remaining = std::max(ByteTicks() / 9, (uint64_t) 1);
+                }
+                break;
+            case State::MasterStop:
+                Register(I2C_CR2_ADDRESS) &= (unsigned char) ~0x02;
+                sr1 &= (unsigned char) ~(SR1_TXE | SR1_BTF);
+                sr3 &= (unsigned char) ~(SR3_MSL | SR3_BUSY | SR3_TRA);
+                _state = State::Idle;
+                NextSlaveTransaction();
+                break;
+            default:
+                break;
+        }
+    }
+
+    //********************************************************************************
+    //
+    //  ADC.
+    //
+    //********************************************************************************
+
+    const unsigned short ADC_CSR_ADDRESS = 0x5400;
+    const unsigned short ADC_CR1_ADDRESS = 0x5401;
+    const unsigned short ADC_CR2_ADDRESS = 0x5402;
+    const unsigned short ADC_DRH_ADDRESS = 0x5404;
+    const unsigned short ADC_DRL_ADDRESS = 0x5405;
+
+    //
+    //  The ADC ignores register writes and stops converting when its clock
+    //  gate (PCKEN23) is off.
+    //
+    const int AdcClockGate = 11;
+
+    AdcModel::AdcModel(Simulator &simulator) : Peripheral(simulator), _remaining(0), _converting(false), _conversions(0)
+    {
+        _simulator.Map(0x5400, 0x540f, this);
+        for (int channel = 0; channel < 16; channel++)
+        {
+            _channels[channel] = 0;
+        }
+    }
+
+    unsigned char AdcModel::Read(unsigned short address, unsigned char value)
+    {
+        (void) address;
+        return value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  The first write of ADON wakes the ADC, the second starts a conversion.
+    //
+    void AdcModel::Write(unsigned short address, unsigned char value)
+    {
+        if (!_simulator.Clock().PeripheralClockEnabled(AdcClockGate))
+        {
+            return;
+        }
+        if (address == ADC_CR1_ADDRESS)
+        {
+            bool on = (Register(address) & 0x01) != 0;
+            Register(address) = value;
+            if (on && (value & 0x01))
+            {
+                StartConversion();
+            }
+            if ((value & 0x01) == 0)
+            {
+                _converting = false;
+            }
+            return;
+        }
+        Register(address) = value;
+    }
+
+    void AdcModel::Advance(uint64_t ticks)
+    {
+        if (!_converting || !_simulator.Clock().PeripheralClockEnabled(AdcClockGate))
+        {
+            return;
+        }
+        if (ticks < _remaining)
+        {
+            _remaining -= ticks;
+            return;
+        }
+        _converting = false;
+        _conversions++;
+        unsigned short value = _channels[Register(ADC_CSR_ADDRESS) & 0x0f];
+        if (Register(ADC_CR2_ADDRESS) & 0x08)
+        {
+            Register(ADC_DRH_ADDRESS) = (unsigned char) (value >> 8);
+            Register(ADC_DRL_ADDRESS) = (unsigned char) (value & 0xff);
+        }
+        else
+        {
+            Register(ADC_DRH_ADDRESS) = (unsigned char) (value >> 2);
+            Register(ADC_DRL_ADDRESS) = (unsigned char) ((value & 0x03) << 6);
+        }
+        Register(ADC_CSR_ADDRESS) |= 0x80;
+        if (Register(ADC_CR1_ADDRESS) & 0x02)
+        {
+            StartConversion();
+        }
+    }
+
+    uint64_t AdcModel::TicksToNextEvent() const
+    {
+        if (!_converting || !_simulator.Clock().PeripheralClockEnabled(AdcClockGate))
+        {
+            return NoEvent;
+        }
+        return std::max(_remaining, (uint64_t) 1);
+    }
+
+    uint32_t AdcModel::PendingInterrupts() const
+    {
+        unsigned char csr = _simulator.Memory(ADC_CSR_ADDRESS);
+        bool pending = ((csr & 0xa0) == 0xa0) || ((csr & 0x50) == 0x50);
+        return pending ? (1UL << 24) : 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  A conversion takes 14 ADC clock cycles, the ADC clock being f_master
+    //  divided by the prescaler in CR1.
+    //
+    void AdcModel::StartConversion()
+    {
+        static const unsigned int dividers[8] = { 2, 3, 4, 6, 8, 10, 12, 18 };
+        _remaining = 14UL * dividers[(Register(ADC_CR1_ADDRESS) >> 4) & 0x07];
+        _converting = true;
+    }
+
+    //********************************************************************************
+    //
+    //  Auto-wakeup.
+    //
+    //********************************************************************************
+
+    const unsigned short AWU_CSR1_ADDRESS = 0x50f0;
+    const unsigned short AWU_APR_ADDRESS = 0x50f1;
+    const unsigned short AWU_TBR_ADDRESS = 0x50f2;
+
+    AwuModel::AwuModel(Simulator &simulator) : Peripheral(simulator), _remaining(0), _running(false)
+    {
+        _simulator.Map(AWU_CSR1_ADDRESS, AWU_TBR_ADDRESS, this);
+        Register(AWU_APR_ADDRESS) = 0x3f;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  AWUF is cleared by reading CSR1.
+    //
+    unsigned char AwuModel::Read(unsigned short address, unsigned char value)
+    {
+        if (address == AWU_CSR1_ADDRESS)
+        {
+            Register(address) &= (unsigned char) ~0x20;
+        }
+        return value;
+    }
+
+    void AwuModel::Write(unsigned short address, unsigned char value)
+    {
+        if (address == AWU_CSR1_ADDRESS)
+        {
+            value = (unsigned char) ((value & 0x13) | (Register(address) & 0x20));
+        }
+        Register(address) = value;
+        Restart();
+    }
+
+    void AwuModel::Advance(uint64_t ticks)
+    {
+        if (!_running)
+        {
+            return;
+        }
+        if (ticks < _remaining)
+        {
+            _remaining -= ticks;
+            return;
+        }
+        Register(AWU_CSR1_ADDRESS) |= 0x20;
+        Restart();
+    }
+
+    uint64_t AwuModel::TicksToNextEvent() const
+    {
+        return _running ? std::max(_remaining, (uint64_t) 1) : NoEvent;
+    }
+
+    uint32_t AwuModel::PendingInterrupts() const
+    {
+        return ((_simulator.Memory(AWU_CSR1_ADDRESS) & 0x30) == 0x30) ? (1UL << 3) : 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Wakeup period from the asynchronous prescaler and the time base.
+    //
+    double AwuModel::Period() const
+    {
+        int timebase = _simulator.Memory(AWU_TBR_ADDRESS) & 0x0f;
+        double divider = _simulator.Memory(AWU_APR_ADDRESS) & 0x3f;
+        double scale;
+        if (timebase == 0)
+        {
+            return 0;
+        }
+        if (timebase <= 12)
+        {
+            scale = (double) (1UL << (timebase - 1));
+        }
+        else if (timebase == 13)
+        {
+            scale = 5.0 * 2048;
+        }
+        else
+        {
+            scale = 30.0 * 2048;
+        }
+        return divider * scale / LsiFrequency;
+    }
+
+    void AwuModel::Restart()
+    {
+        double period = Period();
+        _running = ((_simulator.Memory(AWU_CSR1_ADDRESS) & 0x10) != 0) && (period > 0);
+        if (_running)
+        {
+            _remaining = std::max(_simulator.SecondsToTicks(period), (uint64_t) 1);
+        }
+    }
+
+    //********************************************************************************
+    //
+    //  Independent watchdog.
+    //
+    //********************************************************************************
+
+    const unsigned short IWDG_KR_ADDRESS = 0x50e0;
+    const unsigned short IWDG_PR_ADDRESS = 0x50e1;
+    const unsigned short IWDG_RLR_ADDRESS = 0x50e2;
+
+    IwdgModel::IwdgModel(Simulator &simulator) : Peripheral(simulator), _enabled(false), _unlocked(false), _counter(0xff), _phase(0)
+    {
+        _simulator.Map(IWDG_KR_ADDRESS, IWDG_RLR_ADDRESS, this);
+        Register(IWDG_RLR_ADDRESS) = 0xff;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Key register: 0xcc starts the watchdog, 0x55 unlocks PR and RLR and
+    //  0xaa reloads the counter.
+    //
+    void IwdgModel::Write(unsigned short address, unsigned char value)
+    {
+        if (address == IWDG_KR_ADDRESS)
+        {
+            switch (value)
+            {
+                case 0xcc:
+                    if (!_enabled)
+                    {
+                        _enabled = true;
+                        _counter = 0xff;
+                        _phase = 0;
+                    }
+                    break;
+                case 0x55:
+                    _unlocked = true;
+                    break;
+                case 0xaa:
+                    _counter = Register(IWDG_RLR_ADDRESS);
+                    _unlocked = false;
+                    break;
+            }
+            return;
+        }
+        if (_unlocked)
+        {
+            Register(address) = (address == IWDG_PR_ADDRESS) ? (value & 0x07) : value;
+        }
+    }
+
+    void IwdgModel::Advance(uint64_t ticks)
+    {
+        if (!_enabled)
+        {
+            return;
+        }
+        _phase += ticks;
+        uint64_t period = CountTicks();
+        while (_phase >= period)
+        {
+            _phase -= period;
+            if (_counter == 0)
+            {
+                _simulator.Memory(RST_SR_ADDRESS) |= 0x02;
+                _simulator.Stop("independent watchdog reset");
+                _enabled = false;
+                return;
+            }
+            _counter--;
+        }
+    }
+
+    uint64_t IwdgModel::TicksToNextEvent() const
+    {
+        if (!_enabled)
+        {
+            return NoEvent;
+        }
+        return std::max(((uint64_t) _counter + 1) * CountTicks() - _phase, (uint64_t) 1);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  The counter is clocked from LSI / 2 through the prescaler.
+    //
+    uint64_t IwdgModel::CountTicks() const
+    {
+        double period = (4 << (_simulator.Memory(IWDG_PR_ADDRESS) & 0x07)) / (LsiFrequency / 2.0);
+        return std::max(_simulator.SecondsToTicks(period), (uint64_t) 1);
+    }
+
+    //********************************************************************************
+    //
+    //  Window watchdog.
+    //
+    //********************************************************************************
+
+    const unsigned short WWDG_CR_ADDRESS = 0x50d1;
+    const unsigned short WWDG_WR_ADDRESS = 0x50d2;
+
+    WwdgModel::WwdgModel(Simulator &simulator) : Peripheral(simulator), _phase(0)
+    {
+        _simulator.Map(WWDG_CR_ADDRESS, WWDG_WR_ADDRESS, this);
+        Register(WWDG_CR_ADDRESS) = 0x7f;
+        Register(WWDG_WR_ADDRESS) = 0x7f;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Refreshing the counter while it is above the window, or clearing T6,
+    //  resets the device.  WDGA cannot be cleared once set.
+    //
+    void WwdgModel::Write(unsigned short address, unsigned char value)
+    {
+        unsigned char &cr = Register(WWDG_CR_ADDRESS);
+        if (address == WWDG_WR_ADDRESS)
+        {
+            Register(address) = (unsigned char) (0x80 | (value & 0x7f));
+            return;
+        }
+        if (cr & 0x80)
+        {
+            if ((cr & 0x7f) > (Register(WWDG_WR_ADDRESS) & 0x7f))
+            {
+                _simulator.Memory(RST_SR_ADDRESS) |= 0x01;
+                _simulator.Stop("window watchdog reset (refreshed outside the window)");
+                return;
+            }
+        }
+        cr = (unsigned char) ((cr & 0x80) | value);
+        if ((cr & 0xc0) == 0x80)
+        {
+            _simulator.Memory(RST_SR_ADDRESS) |= 0x01;
+            _simulator.Stop("window watchdog reset (T6 cleared)");
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  The counter decrements every 12288 CPU cycles.
+    //
+    void WwdgModel::Advance(uint64_t ticks)
+    {
+        unsigned char &cr = Register(WWDG_CR_ADDRESS);
+        uint64_t period = CountTicks();
+        _phase += ticks;
+        uint64_t counts = _phase / period;
+        _phase %= period;
+        if (counts == 0)
+        {
+            return;
+        }
+        unsigned char counter = cr & 0x7f;
+        if ((cr & 0x80) && (counts > (uint64_t) (counter - 0x3f)))
+        {
+            counts = (uint64_t) (counter - 0x3f);
+        }
+        cr = (unsigned char) ((cr & 0x80) | ((counter - counts) & 0x7f));
+        if ((cr & 0xc0) == 0x80)
+        {
+            _simulator.Memory(RST_SR_ADDRESS) |= 0x01;
+            _simulator.Stop("window watchdog reset (counter expired)");
+        }
+    }
+
+    uint64_t WwdgModel::TicksToNextEvent() const
+    {
+        unsigned char cr = _simulator.Memory(WWDG_CR_ADDRESS);
+        if ((cr & 0x80) == 0)
+        {
+            return NoEvent;
+        }
+        uint64_t counts = (uint64_t) ((cr & 0x7f) - 0x3f);
+        return std::max(counts * CountTicks() - _phase, (uint64_t) 1);
+    }
+
+    uint64_t WwdgModel::CountTicks() const
+    {
+        return 12288ULL << _simulator.Clock().CpuDivider();
+    }
+
+    //********************************************************************************
+    //
+    //  Flash and data EEPROM control.
+    //
+    //********************************************************************************
+
+    const unsigned short FLASH_IAPSR_ADDRESS = 0x505f;
+    const unsigned short FLASH_PUKR_ADDRESS = 0x5062;
+    const unsigned short FLASH_DUKR_ADDRESS = 0x5064;
+
+    FlashModel::FlashModel(Simulator &simulator) : Peripheral(simulator), _dataKeys(0), _programKeys(0)
+    {
+        _simulator.Map(0x505a, FLASH_DUKR_ADDRESS, this);
+        Register(FLASH_IAPSR_ADDRESS) = 0x40;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  The MASS keys unlock the data EEPROM (0xae, 0x56) and the program
+    //  memory (0x56, 0xae).  DUL and PUL are cleared by writing 0.
+    //
+    void FlashModel::Write(unsigned short address, unsigned char value)
+    {
+        unsigned char &iapsr = Register(FLASH_IAPSR_ADDRESS);
+        switch (address)
+        {
+            case FLASH_DUKR_ADDRESS:
+                if ((_dataKeys == 0) && (value == 0xae))
+                {
+                    _dataKeys = 1;
+                }
+                else if ((_dataKeys == 1) && (value == 0x56))
+                {
+                    iapsr |= 0x08;
+                    _dataKeys = 0;
+                }
+                else
+                {
+                    _dataKeys = 0;
+                }
+                break;
+            case FLASH_PUKR_ADDRESS:
+                if ((_programKeys == 0) && (value == 0x56))
+                {
+                    _programKeys = 1;
+                }
+                else if ((_programKeys == 1) && (value == 0xae))
+                {
+                    iapsr |= 0x02;
+                    _programKeys = 0;
+                }
+                else
+                {
+                    _programKeys = 0;
+                }
+                break;
+            case FLASH_IAPSR_ADDRESS:
+                iapsr = (unsigned char) (iapsr & (value | ~0x0a));
+                break;
+            default:
+                Register(address) = value;
+                break;
+        }
+    }
+}
@@ -0,0 +1,540 @@
+//
+//  Peripheral models for the host simulation of the STM8S.
+//
+//  Each model implements enough of the reference manual (RM0016) for the
+//  register level code in the chapters to behave as it does on the
+//  microcontroller.  The harness functions (SetInput, Receive, MasterTransfer
+//  etc.) allow a test program to act as the outside world.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef PERIPHERALS_H
+#define PERIPHERALS_H
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Simulator.h"
+
+namespace STM8
+{
+    //--------------------------------------------------------------------------------
+    //
+    //  Clock controller.
+    //
+    class ClockModel : public Peripheral
+    {
+    public:
+        explicit ClockModel(Simulator &simulator);
+
+        unsigned char Read(unsigned short address, unsigned char value) override;
+        void Write(unsigned short address, unsigned char value) override;
+        uint32_t PendingInterrupts() const override;
+
+        //
+        //  Frequency of the external crystal (HSE), default 16 MHz.
+        //
+        void SetExternalCrystal(unsigned long frequency) { _hseFrequency = frequency; }
+
+        unsigned long MasterFrequency() const;
+        unsigned long CpuFrequency() const { return MasterFrequency() >> CpuDivider(); }
+        int CpuDivider() const;
+        bool PeripheralClockEnabled(int bit) const;
+
+        //
+        //  Time each peripheral clock gate has been enabled and the number
+        //  of times it has been turned on, the gates being numbered as for
+        //  PeripheralClockEnabled.
+        //
+        uint64_t GatePicoseconds(int bit) const;
+        unsigned long GateEnables(int bit) const { return _gateEnables[bit]; }
+        static const char *GateName(int bit);
+
+        //
+        //  Number of master clock source switches performed.
+        //
+        unsigned long Switches() const { return _switches; }
+
+    private:
+        static const int NumberOfGates = 16;
+
+        void CompleteSwitch();
+        unsigned short Gates() const;
+        void GatesChanged(unsigned short previous);
+
+        unsigned long _hseFrequency;
+        unsigned long _switches;
+        uint64_t _gatePicoseconds[NumberOfGates];
+        uint64_t _gateEnabledAt[NumberOfGates];
+        unsigned long _gateEnables[NumberOfGates];
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  GPIO ports and the external interrupt controller.
+    //
+    //  Each pin is driven by (in order of precedence) an alternate function
+    //  (timer output), the output data register when configured as an output,
+    //  or the level applied by the harness.
+    //
+    class GpioModel : public Peripheral
+    {
+    public:
+        //
+        //  Pin identifiers used by the harness, port A = 0.
+        //
+        enum Port { PortA, PortB, PortC, PortD, PortE, PortF, PortG, PortH, PortI };
+
+        struct PinChange
+        {
+            uint64_t picoseconds;
+            bool level;
+        };
+
+        typedef std::function<void(int port, int pin, bool level)> Listener;
+
+        explicit GpioModel(Simulator &simulator);
+
+        unsigned char Read(unsigned short address, unsigned char value) override;
+        void Write(unsigned short address, unsigned char value) override;
+        uint32_t PendingInterrupts() const override;
+        void AcknowledgeInterrupt(int vector) override;
+        bool RunsWhenHalted() const override { return true; }
+
+        int Ports() const { return _ports; }
+        bool Level(int port, int pin) const;
+        void SetInput(int port, int pin, bool level);
+        void SetAlternate(int port, int pin, bool enabled, bool level);
+        void Connect(int fromPort, int fromPin, int toPort, int toPin);
+        void AddListener(Listener listener) { _listeners.push_back(listener); }
+
+        //
+        //  Hold back pin changes made while the simulator advances the
+        //  peripherals so that listeners see every peripheral at the same
+        //  point in time.
+        //
+        void Defer(bool defer);
+
+        //
+        //  Record the time of every change on a pin.
+        //
+        void Watch(int port, int pin) { _watched[port] |= (unsigned char) (1 << pin); }
+        const std::vector<PinChange> &Changes(int port, int pin) const { return _changes[port][pin]; }
+        unsigned long Transitions(int port, int pin) const { return _transitions[port][pin]; }
+
+        static std::string PinName(int port, int pin);
+        static bool ParsePinName(const std::string &name, int &port, int &pin);
+
+    private:
+        static const int MaximumPorts = 9;
+
+        void UpdateLevels(int port);
+        void EdgeDetected(int port, int pin, bool level);
+
+        int _ports;
+        unsigned char _external[MaximumPorts];
+        unsigned char _driven[MaximumPorts];
+        unsigned char _alternateMask[MaximumPorts];
+        unsigned char _alternateLevel[MaximumPorts];
+        unsigned char _levels[MaximumPorts];
+        unsigned char _watched[MaximumPorts];
+        unsigned long _transitions[MaximumPorts][8];
+        std::vector<PinChange> _changes[MaximumPorts][8];
+        std::vector<std::pair<int, int>> _connections[MaximumPorts][8];
+        std::vector<Listener> _listeners;
+        uint32_t _pending;
+        bool _deferring;
+        unsigned short _dirty;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  16-bit general purpose and advanced control timers and the 8-bit basic
+    //  timer.  One class covers TIM1 to TIM4; the differences are described by
+    //  the layout passed to the constructor.
+    //
+    class TimerModel : public Peripheral
+    {
+    public:
+        enum class Prescaler { Linear, PowerOfTwo };
+
+        struct Layout
+        {
+            int number;
+            unsigned short cr1, ier, sr1, sr2, egr;
+            unsigned short ccmr[4];
+            unsigned short ccer1, ccer2;
+            unsigned short cntrh, cntrl;
+            unsigned short pscrh, pscrl;
+            unsigned short arrh, arrl;
+            unsigned short rcr;
+            unsigned short ccrh[4], ccrl[4];
+            unsigned short bkr;
+            int channels;
+            Prescaler prescaler;
+            int prescalerBits;
+            int updateVector, captureVector;
+            int pinPort[4], pinNumber[4];
+        };
+
+        //
+        //  Snapshot of the shadow (active) registers taken at each update event.
+        //
+        struct UpdateRecord
+        {
+            uint64_t picoseconds;
+            unsigned short autoReload;
+            unsigned short compare[4];
+        };
+
+        TimerModel(Simulator &simulator, const Layout &layout);
+
+        unsigned char Read(unsigned short address, unsigned char value) override;
+        void Write(unsigned short address, unsigned char value) override;
+        void Advance(uint64_t ticks) override;
+        uint64_t TicksToNextEvent() const override;
+        uint32_t PendingInterrupts() const override;
+
+        int Number() const { return _layout.number; }
+        int Channels() const { return _layout.channels; }
+        bool Running() const;
+        unsigned short Counter() const { return _counter; }
+        unsigned short AutoReload() const { return _autoReload; }
+        unsigned short Compare(int channel) const { return _compare[channel]; }
+        unsigned long Divider() const { return _divider; }
+        unsigned long UpdateEvents() const { return _updateEvents; }
+        bool OutputReference(int channel) const { return _reference[channel]; }
+
+        //
+        //  Keep a log of the shadow registers at every update event.
+        //
+        void RecordUpdates(bool record) { _recordUpdates = record; }
+        const std::vector<UpdateRecord> &Updates() const { return _updates; }
+
+    private:
+        bool CentreAligned() const;
+        bool CountingDown() const;
+        int ChannelMode(int channel) const;
+        bool ChannelIsOutput(int channel) const;
+        bool ChannelIsInput(int channel) const;
+        bool ChannelEnabled(int channel) const;
+        bool ChannelPolarity(int channel) const;
+        bool PreloadEnabled(int channel) const;
+        unsigned long CountsToNextEvent() const;
+        void Count();
+        void UpdateEvent(bool fromSoftware);
+        void CompareMatch(int channel);
+        void UpdateOutputs();
+        void Capture(int channel);
+        void InputChanged(int port, int pin, bool level);
+        void StoreCounter();
+
+        Layout _layout;
+        unsigned short _counter;
+        bool _downwards;
+        unsigned long _divider;
+        unsigned long _prescalerPhase;
+        unsigned short _autoReload;
+        unsigned short _compare[4];
+        unsigned char _repetition;
+        bool _reference[4];
+        bool _driving[4];
+        unsigned char _captureEdges[4];
+        unsigned char _latchedLow;
+        bool _lowLatched;
+        unsigned long _updateEvents;
+        bool _recordUpdates;
+        std::vector<UpdateRecord> _updates;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  UART1 (low density) or UART2 (medium density).
+    //
+    class UartModel : public Peripheral
+    {
+    public:
+        UartModel(Simulator &simulator, unsigned short base, int transmitVector, int receiveVector);
+
+        unsigned char Read(unsigned short address, unsigned char value) override;
+        void Write(unsigned short address, unsigned char value) override;
+        void Advance(uint64_t ticks) override;
+        uint64_t TicksToNextEvent() const override;
+        uint32_t PendingInterrupts() const override;
+
+        //
+        //  Queue bytes to arrive on the RX pin.  A framing error can be
+        //  simulated for an individual byte.
+        //
+        void Receive(const std::string &data);
+        void Receive(unsigned char data, bool framingError = false);
+
+        const std::string &Transmitted() const { return _transmitted; }
+        void ClearTransmitted() { _transmitted.clear(); }
+        unsigned long BaudRate() const;
+        unsigned short Base() const { return _base; }
+
+    private:
+        uint64_t FrameTicks() const;
+
+        unsigned short _base;
+        int _transmitVector;
+        int _receiveVector;
+        bool _statusRead;
+        bool _shifting;
+        uint64_t _transmitRemaining;
+        bool _transmitFull;
+        unsigned char _transmitData;
+        unsigned char _shiftData;
+        std::deque<std::pair<unsigned char, bool>> _receiveQueue;
+        uint64_t _receiveRemaining;
+        uint64_t _idleRemaining;
+        std::string _transmitted;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  SPI.  In slave mode the harness plays the part of the master clocking
+    //  bytes in and out; in master mode bytes written are logged and the
+    //  harness supplies the bytes returned by the slave.
+    //
+    class SpiModel : public Peripheral
+    {
+    public:
+        explicit SpiModel(Simulator &simulator);
+
+        unsigned char Read(unsigned short address, unsigned char value) override;
+        void Write(unsigned short address, unsigned char value) override;
+        void Advance(uint64_t ticks) override;
+        uint64_t TicksToNextEvent() const override;
+        uint32_t PendingInterrupts() const override;
+
+        //
+        //  Slave mode: clock the bytes in from an external master at the given
+        //  SCK frequency.  The bytes follow back to back.
+        //
+        void MasterTransfer(const std::vector<unsigned char> &data, double sckFrequency);
+
+        //
+        //  Master mode: bytes the external slave will return.
+        //
+        void SlaveResponse(const std::vector<unsigned char> &data);
+
+        const std::vector<unsigned char> &Mosi() const { return _mosi; }
+        const std::vector<unsigned char> &Miso() const { return _miso; }
+        unsigned long Overruns() const { return _overruns; }
+        bool TransferInProgress() const { return _phase != Phase::Idle; }
+        bool MasterMode() const;
+
+    private:
+        enum class Phase { Idle, WaitingForStart, Shifting };
+
+        bool Enabled() const;
+        void StartByte();
+        void EndByte();
+
+        std::deque<std::pair<unsigned char, uint64_t>> _incoming;
+        std::deque<unsigned char> _response;
+        Phase _phase;
+        uint64_t _remaining;
+        unsigned char _shiftIn;
+        bool _transmitFull;
+        unsigned char _transmitData;
+        unsigned char _receiveData;
+        bool _dataRead;
+        unsigned long _overruns;
+        std::vector<unsigned char> _mosi;
+        std::vector<unsigned char> _miso;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  I2C.  The harness can act as a master addressing the STM8S as a slave
+    //  or attach remote slave devices for the STM8S to talk to as a master.
+    //  Bytes take nine clock periods at the standard mode bus speed.
+    //
+    class I2CModel : public Peripheral
+    {
+    public:
+        explicit I2CModel(Simulator &simulator);
+
+        unsigned char Read(unsigned short address, unsigned char value) override;
+        void Write(unsigned short address, unsigned char value) override;
+        void Advance(uint64_t ticks) override;
+        uint64_t TicksToNextEvent() const override;
+        uint32_t PendingInterrupts() const override;
+
+        //
+        //  Harness as master.
+        //
+        void MasterWrite(unsigned char address, const std::vector<unsigned char> &data);
+        void MasterRead(unsigned char address, size_t count);
+        const std::vector<unsigned char> &SlaveTransmitted() const { return _slaveTransmitted; }
+
+        //
+        //  Remote slave devices for the STM8S as master.
+        //
+        void AttachDevice(unsigned char address, const std::vector<unsigned char> &response);
+        const std::vector<unsigned char> &DeviceReceived(unsigned char address) { return _devices[address].received; }
+
+    private:
+        enum class State
+        {
+            Idle,
+            SlaveAddress, SlaveWaitAddressClear, SlaveReceive, SlaveTransmit, SlaveStop,
+            MasterStart, MasterAddress, MasterWaitAddressClear, MasterTransmit, MasterReceive, MasterStop
+        };
+
+        struct Transaction
+        {
+            unsigned char address;
+            bool read;
+            std::vector<unsigned char> data;
+            size_t count;
+        };
+
+        struct Device
+        {
+            std::vector<unsigned char> response;
+            size_t position;
+            std::vector<unsigned char> received;
+        };
+
+        uint64_t ByteTicks() const;
+        void NextSlaveTransaction();
+        void Step();
+
+        State _state;
+        uint64_t _remaining;
+        bool _sr1Read;
+        std::deque<Transaction> _transactions;
+        Transaction _current;
+        size_t _position;
+        std::vector<unsigned char> _slaveTransmitted;
+        std::map<unsigned char, Device> _devices;
+        unsigned char _masterAddress;
+        bool _masterRead;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  ADC1 / ADC2.  Single conversions on the selected channel using the
+    //  analog values set by the harness.
+    //
+    class AdcModel : public Peripheral
+    {
+    public:
+        explicit AdcModel(Simulator &simulator);
+
+        unsigned char Read(unsigned short address, unsigned char value) override;
+        void Write(unsigned short address, unsigned char value) override;
+        void Advance(uint64_t ticks) override;
+        uint64_t TicksToNextEvent() const override;
+        uint32_t PendingInterrupts() const override;
+
+        //
+        //  Set the 10-bit value returned by conversions on a channel.
+        //
+        void SetChannel(int channel, unsigned short value) { _channels[channel & 0x0f] = (unsigned short) (value & 0x3ff); }
+        unsigned long Conversions() const { return _conversions; }
+
+    private:
+        void StartConversion();
+
+        unsigned short _channels[16];
+        uint64_t _remaining;
+        bool _converting;
+        unsigned long _conversions;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Auto-wakeup unit.  Runs from the LSI and so keeps going in HALT.
+    //
+    class AwuModel : public Peripheral
+    {
+    public:
+        explicit AwuModel(Simulator &simulator);
+
+        unsigned char Read(unsigned short address, unsigned char value) override;
+        void Write(unsigned short address, unsigned char value) override;
+        void Advance(uint64_t ticks) override;
+        uint64_t TicksToNextEvent() const override;
+        uint32_t PendingInterrupts() const override;
+        bool RunsWhenHalted() const override { return true; }
+
+        double Period() const;
+
+    private:
+        void Restart();
+
+        uint64_t _remaining;
+        bool _running;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Independent watchdog.  A timeout ends the simulation.
+    //
+    class IwdgModel : public Peripheral
+    {
+    public:
+        explicit IwdgModel(Simulator &simulator);
+
+        void Write(unsigned short address, unsigned char value) override;
+        void Advance(uint64_t ticks) override;
+        uint64_t TicksToNextEvent() const override;
+        bool RunsWhenHalted() const override { return true; }
+
+    private:
+        uint64_t CountTicks() const;
+
+        bool _enabled;
+        bool _unlocked;
+        unsigned char _counter;
+        uint64_t _phase;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Window watchdog.  A timeout or refresh outside the window ends the
+    //  simulation.
+    //
+    class WwdgModel : public Peripheral
+    {
+    public:
+        explicit WwdgModel(Simulator &simulator);
+
+        void Write(unsigned short address, unsigned char value) override;
+        void Advance(uint64_t ticks) override;
+        uint64_t TicksToNextEvent() const override;
+
+    private:
+        uint64_t CountTicks() const;
+
+        uint64_t _phase;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Flash and data EEPROM control registers.
+    //
+    class FlashModel : public Peripheral
+    {
+    public:
+        explicit FlashModel(Simulator &simulator);
+
+        void Write(unsigned short address, unsigned char value) override;
+
+    private:
+        unsigned char _dataKeys;
+        unsigned char _programKeys;
+    };
+}
+
+#endif
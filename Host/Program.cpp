@@ -0,0 +1,319 @@
+//
+//  STM8 program image loader.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Program.h"
+
+namespace STM8
+{
+    //
+    //  ELF constants used by the loader.
+    //
+    const unsigned char ELFCLASS32 = 1;
+    const unsigned char ELFDATA2LSB = 1;
+    const uint32_t PT_LOAD = 1;
+    const uint32_t SHT_PROGBITS = 1;
+    const uint32_t SHT_SYMTAB = 2;
+    const uint32_t SHF_ALLOC = 2;
+    const unsigned char STT_NOTYPE = 0;
+    const unsigned char STT_FUNC = 2;
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Read a file into memory.
+    //
+    static bool ReadFile(const std::string &path, std::vector<unsigned char> &contents)
+    {
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        unsigned char buffer[4096];
+        size_t length;
+        while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            contents.insert(contents.end(), buffer, buffer + length);
+        }
+        fclose(file);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Load an image.
+    //
+    bool Program::Load(const std::string &path, std::string &error)
+    {
+        std::vector<unsigned char> file;
+        if (!ReadFile(path, file))
+        {
+            error = "cannot read " + path;
+            return false;
+        }
+        _segments.clear();
+        _symbols.clear();
+        if ((file.size() >= 4) && (memcmp(file.data(), "\x7f" "ELF", 4) == 0))
+        {
+            _format = "ELF";
+            return LoadElf(file, error);
+        }
+        if (!file.empty() && (file[0] == ':'))
+        {
+            _format = "Intel hex";
+            return LoadHex(file, error);
+        }
+        error = path + " is not an ELF or Intel hex file";
+        return false;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Copy the image into memory.  The STM8S devices only decode the first
+    //  64K of the address space.
+    //
+    void Program::Install(Simulator &simulator) const
+    {
+        for (const Segment &segment : _segments)
+        {
+            for (size_t index = 0; index < segment.data.size(); index++)
+            {
+                uint32_t address = segment.address + (uint32_t) index;
+                if (address <= 0xffff)
+                {
+                    simulator.Memory((unsigned short) address) = segment.data[index];
+                }
+            }
+        }
+    }
+
+    size_t Program::Size() const
+    {
+        size_t size = 0;
+        for (const Segment &segment : _segments)
+        {
+            size += segment.data.size();
+        }
+        return size;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Symbol lookup.
+    //
+    const char *Program::SymbolName(uint32_t address) const
+    {
+        auto symbol = _symbols.find(address);
+        return (symbol == _symbols.end()) ? nullptr : symbol->second.c_str();
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Function containing an address.
+    //
+    const char *Program::FunctionContaining(uint32_t address, uint32_t &start) const
+    {
+        auto symbol = _symbols.upper_bound(address);
+        if (symbol == _symbols.begin())
+        {
+            return nullptr;
+        }
+        --symbol;
+        start = symbol->first;
+        return symbol->second.c_str();
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  First symbol above an address.
+    //
+    uint32_t Program::NextSymbol(uint32_t address) const
+    {
+        auto symbol = _symbols.upper_bound(address);
+        return (symbol == _symbols.end()) ? 0 : symbol->first;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  ELF32 of either byte order.  The loadable segments are placed at their
+    //  physical (load) address so that initialised data is found where the
+    //  startup code expects to copy it from.  Images without program headers
+    //  are loaded from their allocated sections.
+    //
+    bool Program::LoadElf(const std::vector<unsigned char> &file, std::string &error)
+    {
+        if ((file.size() < 52) || (file[4] != ELFCLASS32))
+        {
+            error = "only 32 bit ELF files are supported";
+            return false;
+        }
+        bool little = file[5] == ELFDATA2LSB;
+        auto field = [&file, little](size_t offset, int size) -> uint32_t
+        {
+            uint32_t value = 0;
+            for (int index = 0; index < size; index++)
+            {
+                if (offset + index >= file.size())
+                {
+                    return 0;
+                }
+                int shift = little ? (index * 8) : ((size - 1 - index) * 8);
+                value |= (uint32_t) file[offset + index] << shift;
+            }
+            return value;
+        };
+        auto copy = [this, &file](uint32_t address, uint32_t offset, uint32_t size) -> bool
+        {
+            if (((uint64_t) offset + size) > file.size())
+            {
+                return false;
+            }
+            _segments.push_back({ address, std::vector<unsigned char>(file.begin() + offset, file.begin() + offset + size) });
+            return true;
+        };
+        uint32_t programHeaders = field(28, 4);
+        uint32_t sectionHeaders = field(32, 4);
+        uint32_t programHeaderSize = field(42, 2);
+        uint32_t programHeaderCount = field(44, 2);
+        uint32_t sectionHeaderSize = field(46, 2);
+        uint32_t sectionHeaderCount = field(48, 2);
+        for (uint32_t index = 0; index < programHeaderCount; index++)
+        {
+            size_t header = programHeaders + (index * programHeaderSize);
+            if ((field(header, 4) == PT_LOAD) && (field(header + 16, 4) > 0))
+            {
+                if (!copy(field(header + 12, 4), field(header + 4, 4), field(header + 16, 4)))
+                {
+                    error = "truncated ELF segment";
+                    return false;
+                }
+            }
+        }
+        for (uint32_t index = 0; index < sectionHeaderCount; index++)
+        {
+            size_t header = sectionHeaders + (index * sectionHeaderSize);
+            uint32_t type = field(header + 4, 4);
+            if ((programHeaderCount == 0) && (type == SHT_PROGBITS) && (field(header + 8, 4) & SHF_ALLOC))
+            {
+                if (!copy(field(header + 12, 4), field(header + 16, 4), field(header + 20, 4)))
+                {
+                    error = "truncated ELF section";
+                    return false;
+                }
+            }
+            if (type == SHT_SYMTAB)
+            {
+                size_t strings = sectionHeaders + (field(header + 24, 4) * sectionHeaderSize);
+                uint32_t stringTable = field(strings + 16, 4);
+                uint32_t stringTableSize = field(strings + 20, 4);
+                uint32_t entrySize = field(header + 36, 4) ? field(header + 36, 4) : 16;
+                uint32_t count = field(header + 20, 4) / entrySize;
+                if (((uint64_t) stringTable + stringTableSize) > file.size())
+                {
+                    continue;
+                }
+                for (uint32_t entry = 0; entry < count; entry++)
+                {
+                    size_t symbol = field(header + 16, 4) + (entry * entrySize);
+                    if ((symbol + 16) > file.size())
+                    {
+                        break;
+                    }
+                    uint32_t name = field(symbol, 4);
+                    unsigned char kind = file[symbol + 12] & 0x0f;
+                    if ((name == 0) || (name >= stringTableSize) || (field(symbol + 14, 2) == 0) ||
+                        ((kind != STT_FUNC) && (kind != STT_NOTYPE)))
+                    {
+                        continue;
+                    }
+                    const char *text = (const char *) file.data() + stringTable + name;
+                    size_t length = strnlen(text, stringTableSize - name);
+                    uint32_t address = field(symbol + 4, 4);
+                    if ((kind == STT_FUNC) || (_symbols.find(address) == _symbols.end()))
+                    {
+                        _symbols[address] = std::string(text, length);
+                    }
+                }
+            }
+        }
+        if (_segments.empty())
+        {
+            error = "no loadable data in ELF file";
+            return false;
+        }
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Intel hex with extended segment and extended linear addresses.
+    //
+    bool Program::LoadHex(const std::vector<unsigned char> &file, std::string &error)
+    {
+        std::string text(file.begin(), file.end());
+        uint32_t base = 0;
+        size_t position = 0;
+        int line = 0;
+        while (position < text.size())
+        {
+            size_t end = text.find('\n', position);
+            if (end == std::string::npos)
+            {
+                end = text.size();
+            }
+            std::string record = text.substr(position, end - position);
+            position = end + 1;
+            line++;
+            while (!record.empty() && ((record.back() == '\r') || (record.back() == ' ')))
+            {
+                record.pop_back();
+            }
+            if (record.empty())
+            {
+                continue;
+            }
+            if ((record[0] != ':') || (record.size() < 11) || ((record.size() % 2) == 0))
+            {
+                error = "invalid hex record on line " + std::to_string(line);
+                return false;
+            }
+            std::vector<unsigned char> bytes;
+            unsigned char checksum = 0;
+            for (size_t index = 1; index < record.size(); index += 2)
+            {
+                unsigned char byte = (unsigned char) strtoul(record.substr(index, 2).c_str(), nullptr, 16);
+                bytes.push_back(byte);
+                checksum = (unsigned char) (checksum + byte);
+            }
+            if ((checksum != 0) || (bytes.size() != (size_t) bytes[0] + 5))
+            {
+                error = "hex checksum or length error on line " + std::to_string(line);
+                return false;
+            }
+            uint32_t address = ((uint32_t) bytes[1] << 8) | bytes[2];
+            switch (bytes[3])
+            {
+                case 0x00:
+                    _segments.push_back({ base + address, std::vector<unsigned char>(bytes.begin() + 4, bytes.end() - 1) });
+                    break;
+                case 0x01:
+                    return true;
+                case 0x02:
+                    base = (((uint32_t) bytes[4] << 8) | bytes[5]) << 4;
+                    break;
+                case 0x04:
+                    base = (((uint32_t) bytes[4] << 8) | bytes[5]) << 16;
+                    break;
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,77 @@
+//
+//  STM8 program image loader.
+//
+//  Reads the output of the IAR and SDCC toolchains for the instruction set
+//  simulator: ELF executables (IAR .out, SDCC --out-fmt-elf) and Intel hex
+//  files (.hex, .ihx).  Symbols are taken from the ELF symbol table so that
+//  the interrupt service routines can be reported by name.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Simulator.h"
+
+namespace STM8
+{
+    class Program
+    {
+    public:
+        //
+        //  Load an image, the format is taken from the file contents.
+        //  Returns false and sets error if the file cannot be loaded.
+        //
+        bool Load(const std::string &path, std::string &error);
+
+        //
+        //  Copy the image into the simulator memory.
+        //
+        void Install(Simulator &simulator) const;
+
+        //
+        //  Name of the function at an address or nullptr if it is not known.
+        //
+        const char *SymbolName(uint32_t address) const;
+
+        //
+        //  Start address and name of the function containing an address,
+        //  taken to be the nearest symbol at or below it.  Returns nullptr if
+        //  there is no such symbol.
+        //
+        const char *FunctionContaining(uint32_t address, uint32_t &start) const;
+
+        //
+        //  Address of the first symbol above an address, 0 if there is none.
+        //  Taken as the end of the function at the address.
+        //
+        uint32_t NextSymbol(uint32_t address) const;
+
+        const char *Format() const { return _format; }
+        size_t Size() const;
+
+    private:
+        struct Segment
+        {
+            uint32_t address;
+            std::vector<unsigned char> data;
+        };
+
+        bool LoadElf(const std::vector<unsigned char> &file, std::string &error);
+        bool LoadHex(const std::vector<unsigned char> &file, std::string &error);
+
+        const char *_format = "";
+        std::vector<Segment> _segments;
+        std::map<uint32_t, std::string> _symbols;
+    };
+}
+
+#endif
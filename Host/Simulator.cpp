@@ -0,0 +1,713 @@
+//
+//  Host simulation of the STM8S core.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#include <algorithm>
+
+#include "Simulator.h"
+#include "Peripherals.h"
+#include "include/intrinsics.h"
+
+namespace STM8
+{
+    //--------------------------------------------------------------------------------
+    //
+    //  Default register write stores the value.
+    //
+    void Peripheral::Write(unsigned short address, unsigned char value)
+    {
+        Register(address) = value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Access the memory backing a register.
+    //
+    unsigned char &Peripheral::Register(unsigned short address)
+    {
+        return _simulator.Memory(address);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Single simulator instance.  The device is selected by the static
+    //  initialiser in stm8s_host.h, defaulting to the STM8S103F3.
+    //
+    Simulator &Simulator::Instance()
+    {
+        static Simulator simulator;
+        return simulator;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Constructor.
+    //
+    Simulator::Simulator() : _memory(0x10000, 0), _owners(0x10000, nullptr)
+    {
+        for (int vector = 0; vector < NumberOfVectors; vector++)
+        {
+            _handlers[vector] = nullptr;
+            _handlerNames[vector] = nullptr;
+        }
+        Reset(Device::STM8S103F3);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Put the device into the reset state.  Interrupt handlers remain attached.
+    //
+    void Simulator::Reset(Device device)
+    {
+        _device = device;
+        std::fill(_memory.begin(), _memory.end(), 0);
+        std::fill(_owners.begin(), _owners.end(), nullptr);
+        _peripherals.clear();
+        _scheduled.clear();
+        _ticks = 0;
+        _picoseconds = 0;
+        _cpuCycles = 0;
+        _idleTicks = 0;
+        _limitPicoseconds = UINT64_MAX;
+        _stopReason.clear();
+        _interruptsEnabled = false;
+        _inInterrupt = false;
+        _currentVector = -1;
+        ClearStatistics();
+        //
+        //  Interrupt controller, all vectors at software priority 3.
+        //
+        for (unsigned short address = 0x7f70; address <= 0x7f77; address++)
+        {
+            _memory[address] = 0xff;
+        }
+        //
+        //  Create the peripherals.  Each model maps its own registers.
+        //
+        _clock = new ClockModel(*this);
+        _peripherals.emplace_back(_clock);
+        _gpio = new GpioModel(*this);
+        _peripherals.emplace_back(_gpio);
+        _flash = new FlashModel(*this);
+        _peripherals.emplace_back(_flash);
+        _awu = new AwuModel(*this);
+        _peripherals.emplace_back(_awu);
+        _peripherals.emplace_back(new IwdgModel(*this));
+        _peripherals.emplace_back(new WwdgModel(*this));
+        _spi = new SpiModel(*this);
+        _peripherals.emplace_back(_spi);
+        _i2c = new I2CModel(*this);
+        _peripherals.emplace_back(_i2c);
+        _adc = new AdcModel(*this);
+        _peripherals.emplace_back(_adc);
+        if (MediumDensity())
+        {
+            _uart = new UartModel(*this, 0x5240, 22, 23);
+        }
+        else
+        {
+            _uart = new UartModel(*this, 0x5230, 19, 20);
+        }
+        _peripherals.emplace_back(_uart);
+        //
+        //  Timers.  TIM2 and TIM4 on the low density devices have
+        //  reserved registers after CR1 which moves the remaining registers.
+        //
+        TimerModel::Layout tim1 =
+        {
+            1, 0x5250, 0x5254, 0x5255, 0x5256, 0x5257,
+            { 0x5258, 0x5259, 0x525a, 0x525b }, 0x525c, 0x525d,
+            0x525e, 0x525f, 0x5260, 0x5261, 0x5262, 0x5263, 0x5264,
+            { 0x5265, 0x5267, 0x5269, 0x526b }, { 0x5266, 0x5268, 0x526a, 0x526c }, 0x526d,
+            4, TimerModel::Prescaler::Linear, 16, 13, 14,
+            { GpioModel::PortC, GpioModel::PortC, GpioModel::PortC, GpioModel::PortC }, { 1, 2, 3, 4 }
+        };
+        _timers[1] = new TimerModel(*this, tim1);
+        unsigned short offset = MediumDensity() ? 0 : 2;
+        TimerModel::Layout tim2 =
+        {
+            2, 0x5300, (unsigned short) (0x5301 + offset), (unsigned short) (0x5302 + offset), (unsigned short) (0x5303 + offset), (unsigned short) (0x5304 + offset),
+            { (unsigned short) (0x5305 + offset), (unsigned short) (0x5306 + offset), (unsigned short) (0x5307 + offset), 0 },
+            (unsigned short) (0x5308 + offset), (unsigned short) (0x5309 + offset),
+            (unsigned short) (0x530a + offset), (unsigned short) (0x530b + offset), 0, (unsigned short) (0x530c + offset),
+            (unsigned short) (0x530d + offset), (unsigned short) (0x530e + offset), 0,
+            { (unsigned short) (0x530f + offset), (unsigned short) (0x5311 + offset), (unsigned short) (0x5313 + offset), 0 },
+            { (unsigned short) (0x5310 + offset), (unsigned short) (0x5312 + offset), (unsigned short) (0x5314 + offset), 0 }, 0,
+            3, TimerModel::Prescaler::PowerOfTwo, 4, 15, 16,
+            { GpioModel::PortD, GpioModel::PortD, GpioModel::PortA, 0 }, { 4, 3, 3, 0 }
+        };
+        _timers[2] = new TimerModel(*this, tim2);
+        _timers[3] = nullptr;
+        if (MediumDensity())
+        {
+            TimerModel::Layout tim3 =
+            {
+                3, 0x5320, 0x5321, 0x5322, 0x5323, 0x5324,
+                { 0x5325, 0x5326, 0, 0 }, 0x5327, 0,
+                0x5328, 0x5329, 0, 0x532a, 0x532b, 0x532c, 0,
+                { 0x532d, 0x532f, 0, 0 }, { 0x532e, 0x5330, 0, 0 }, 0,
+                2, TimerModel::Prescaler::PowerOfTwo, 4, 17, 18,
+                { GpioModel::PortD, GpioModel::PortD, 0, 0 }, { 2, 0, 0, 0 }
+            };
+            _timers[3] = new TimerModel(*this, tim3);
+        }
+        TimerModel::Layout tim4 =
+        {
+            4, 0x5340, (unsigned short) (0x5341 + offset), (unsigned short) (0x5342 + offset), 0, (unsigned short) (0x5343 + offset),
+            { 0, 0, 0, 0 }, 0, 0,
+            0, (unsigned short) (0x5344 + offset), 0, (unsigned short) (0x5345 + offset), 0, (unsigned short) (0x5346 + offset), 0,
+            { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, 0,
+            0, TimerModel::Prescaler::PowerOfTwo, 3, 25, 0,
+            { 0, 0, 0, 0 }, { 0, 0, 0, 0 }
+        };
+        _timers[4] = new TimerModel(*this, tim4);
+        for (int index = 1; index <= 4; index++)
+        {
+            if (_timers[index] != nullptr)
+            {
+                _peripherals.emplace_back(_timers[index]);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Name of the simulated device.
+    //
+    const char *Simulator::DeviceName() const
+    {
+        switch (_device)
+        {
+            case Device::STM8S103K3:
+                return "STM8S103K3";
+            case Device::STM8S105C6:
+                return "STM8S105C6";
+            default:
+                return "STM8S103F3";
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Give a peripheral ownership of a range of register addresses.
+    //
+    void Simulator::Map(unsigned short first, unsigned short last, Peripheral *peripheral)
+    {
+        for (unsigned int address = first; address <= last; address++)
+        {
+            _owners[address] = peripheral;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Read a register (or memory location) and charge the CPU for the access.
+    //
+    unsigned char Simulator::Read(unsigned short address, bool mayThrow)
+    {
+        unsigned char value = BusRead(address);
+        Execute(1, mayThrow);
+        return value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Write a register (or memory location) and charge the CPU for the access.
+    //
+    void Simulator::Write(unsigned short address, unsigned char value)
+    {
+        BusWrite(address, value);
+        Execute(1);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Read a register (or memory location) without letting time pass.
+    //
+    unsigned char Simulator::BusRead(unsigned short address)
+    {
+        unsigned char value = _memory[address];
+        if (_owners[address] != nullptr)
+        {
+            value = _owners[address]->Read(address, value);
+        }
+        return value;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Write a register (or memory location) without letting time pass.
+    //
+    void Simulator::BusWrite(unsigned short address, unsigned char value)
+    {
+        if (_owners[address] != nullptr)
+        {
+            _owners[address]->Write(address, value);
+        }
+        else
+        {
+            _memory[address] = value;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Let time pass while the CPU executes the given number of cycles and
+    //  then service any pending interrupts.
+    //
+    void Simulator::Execute(unsigned long cycles, bool mayThrow)
+    {
+        AdvanceTicks((uint64_t) cycles << _clock->CpuDivider(), false);
+        _cpuCycles += cycles;
+        if (mayThrow)
+        {
+            CheckForEnd();
+            DispatchInterrupts();
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Interrupt mask control.
+    //
+    void Simulator::EnableInterrupts()
+    {
+        _interruptsEnabled = true;
+        Execute(1);
+    }
+
+    void Simulator::DisableInterrupts()
+    {
+        _interruptsEnabled = false;
+        Execute(1);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  WFI enables interrupts and stops the CPU until an interrupt arrives.
+    //  An interrupt which is already pending ends the wait at once, the time
+    //  for the instruction is charged without servicing interrupts so that
+    //  it is counted as the wakeup.
+    //
+    void Simulator::WaitForInterrupt()
+    {
+        _interruptsEnabled = true;
+        Execute(10, false);
+        CheckForEnd();
+        while (!DispatchInterrupts())
+        {
+            Idle(false);
+        }
+        _wakeups++;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  HALT stops the master clock.  Only the peripherals running from the
+    //  LSI and external events can wake the core.
+    //
+    void Simulator::Halt()
+    {
+        _interruptsEnabled = true;
+        Execute(10, false);
+        CheckForEnd();
+        while (!DispatchInterrupts())
+        {
+            Idle(true);
+        }
+        _wakeups++;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Let time pass with the core stopped until the next peripheral or
+    //  harness event.  The simulation ends if nothing can ever happen.
+    //
+    void Simulator::Idle(bool halted)
+    {
+        uint64_t ticks = TicksToNextEvent(halted);
+        if (ticks == NoEvent)
+        {
+            Stop(halted ? "halted with no wakeup source" : "waiting for an interrupt which can never occur");
+            CheckForEnd();
+        }
+        uint64_t before = _ticks;
+        AdvanceTicks(std::min(ticks, TicksToLimit()), halted);
+        _idleTicks += _ticks - before;
+        CheckForEnd();
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Attach an interrupt service routine to a vector.
+    //
+    void Simulator::AttachInterrupt(int vector, InterruptHandler handler, const char *name)
+    {
+        if ((vector >= 0) && (vector < NumberOfVectors))
+        {
+            _handlers[vector] = handler;
+            _handlerNames[vector] = name;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Reset the interrupt statistics.
+    //
+    void Simulator::ClearStatistics()
+    {
+        for (int vector = 0; vector < NumberOfVectors; vector++)
+        {
+            _statistics[vector] = { 0, 0, UINT64_MAX, 0 };
+            _unhandled[vector] = 0;
+        }
+        _unhandledMask = 0;
+        _wakeups = 0;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Convert a period of time into master clock ticks at the current
+    //  clock frequency, rounding up.
+    //
+    uint64_t Simulator::SecondsToTicks(double seconds) const
+    {
+        double ticks = seconds * _clock->MasterFrequency();
+        uint64_t result = (uint64_t) ticks;
+        if (result < ticks)
+        {
+            result++;
+        }
+        return result;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Schedule a harness action.
+    //
+    void Simulator::Schedule(double delaySeconds, std::function<void()> action)
+    {
+        uint64_t when = _picoseconds + (uint64_t) (delaySeconds * 1e12 + 0.5);
+        _scheduled.emplace(when, action);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Run the program.
+    //
+    std::string Simulator::Run(std::function<void()> entry, double seconds)
+    {
+        _limitPicoseconds = _picoseconds + (uint64_t) (seconds * 1e12);
+        _stopReason.clear();
+        std::string reason;
+        try
+        {
+            RunScheduledActions();
+            entry();
+            reason = "program returned";
+        }
+        catch (const SimulationComplete &e)
+        {
+            reason = e.what();
+        }
+        _inInterrupt = false;
+        _currentVector = -1;
+        _limitPicoseconds = UINT64_MAX;
+        return reason;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Request the end of the simulation at the next safe point.
+    //
+    void Simulator::Stop(const std::string &reason)
+    {
+        if (_stopReason.empty())
+        {
+            _stopReason = reason;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Timer number 1 to 4.
+    //
+    TimerModel &Simulator::Timer(int number)
+    {
+        if (!HasTimer(number))
+        {
+            throw std::out_of_range("Timer not present on this device.");
+        }
+        return *_timers[number];
+    }
+
+    bool Simulator::HasTimer(int number) const
+    {
+        return (number >= 1) && (number <= 4) && (_timers[number] != nullptr);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Move time forward stopping at every peripheral and harness event.
+    //
+    void Simulator::AdvanceTicks(uint64_t ticks, bool halted)
+    {
+        while (ticks > 0)
+        {
+            uint64_t step = std::min(ticks, TicksToNextEvent(halted));
+            _gpio->Defer(true);
+            for (auto &peripheral : _peripherals)
+            {
+                if (!halted || peripheral->RunsWhenHalted())
+                {
+                    peripheral->Advance(step);
+                }
+            }
+            _ticks += step;
+            _picoseconds += step * TickPicoseconds();
+            _gpio->Defer(false);
+            ticks -= step;
+            RunScheduledActions();
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Ticks until the next peripheral or harness event.
+    //
+    uint64_t Simulator::TicksToNextEvent(bool halted) const
+    {
+        uint64_t next = NoEvent;
+        for (auto &peripheral : _peripherals)
+        {
+            if (!halted || peripheral->RunsWhenHalted())
+            {
+                next = std::min(next, peripheral->TicksToNextEvent());
+            }
+        }
+        if (!_scheduled.empty())
+        {
+            uint64_t period = TickPicoseconds();
+            uint64_t when = _scheduled.begin()->first;
+            uint64_t ticks = (when > _picoseconds) ? ((when - _picoseconds + period - 1) / period) : 1;
+            next = std::min(next, std::max(ticks, (uint64_t) 1));
+        }
+        return next;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Ticks until the end of the run, at least one.
+    //
+    uint64_t Simulator::TicksToLimit() const
+    {
+        if (_limitPicoseconds <= _picoseconds)
+        {
+            return 1;
+        }
+        uint64_t period = TickPicoseconds();
+        return std::max((_limitPicoseconds - _picoseconds + period - 1) / period, (uint64_t) 1);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Length of a master clock tick.
+    //
+    uint64_t Simulator::TickPicoseconds() const
+    {
+        return 1000000000000ULL / _clock->MasterFrequency();
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Run the harness actions which are now due.
+    //
+    void Simulator::RunScheduledActions()
+    {
+        while (!_scheduled.empty() && (_scheduled.begin()->first <= _picoseconds))
+        {
+            std::function<void()> action = _scheduled.begin()->second;
+            _scheduled.erase(_scheduled.begin());
+            action();
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Vectors requested by the peripherals.
+    //
+    uint32_t Simulator::PendingInterrupts() const
+    {
+        uint32_t pending = 0;
+        for (auto &peripheral : _peripherals)
+        {
+            pending |= peripheral->PendingInterrupts();
+        }
+        return pending;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Clear the request for a vector which is about to be serviced.
+    //
+    void Simulator::AcknowledgeInterrupt(int vector)
+    {
+        for (auto &peripheral : _peripherals)
+        {
+            peripheral->AcknowledgeInterrupt(vector);
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Add the length of a completed interrupt service routine to the
+    //  statistics for its vector.
+    //
+    void Simulator::RecordInterrupt(int vector, uint64_t cycles)
+    {
+        InterruptStatistics &statistics = _statistics[vector];
+        statistics.count++;
+        statistics.totalCycles += cycles;
+        statistics.minimumCycles = std::min(statistics.minimumCycles, cycles);
+        statistics.maximumCycles = std::max(statistics.maximumCycles, cycles);
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Service the pending interrupts.  Returns true if a handler was run.
+    //
+    //  A vector with no handler attached is counted once each time it
+    //  becomes pending and is otherwise ignored.
+    //
+    bool Simulator::DispatchInterrupts()
+    {
+        if (!_interruptsEnabled || _inInterrupt)
+        {
+            return false;
+        }
+        bool dispatched = false;
+        while (true)
+        {
+            uint32_t pending = PendingInterrupts();
+            _unhandledMask &= pending;
+            pending &= ~_unhandledMask;
+            if (pending == 0)
+            {
+                break;
+            }
+            int vector = 0;
+            while ((pending & (1UL << vector)) == 0)
+            {
+                vector++;
+            }
+            if (_handlers[vector] == nullptr)
+            {
+                _unhandledMask |= 1UL << vector;
+                _unhandled[vector]++;
+                continue;
+            }
+            AcknowledgeInterrupt(vector);
+            uint64_t start = _cpuCycles;
+            _inInterrupt = true;
+            _currentVector = vector;
+            Execute(InterruptEntryCycles);
+            _handlers[vector]();
+            Execute(InterruptReturnCycles);
+            _inInterrupt = false;
+            _currentVector = -1;
+            RecordInterrupt(vector, _cpuCycles - start);
+            dispatched = true;
+        }
+        return dispatched;
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Throw to unwind the program if the simulation should end.
+    //
+    void Simulator::CheckForEnd()
+    {
+        if (_stopReason.empty() && (_picoseconds >= _limitPicoseconds))
+        {
+            _stopReason = "time limit reached";
+        }
+        if (!_stopReason.empty())
+        {
+            throw SimulationComplete(_stopReason);
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Functions called by the register proxies and intrinsics.
+    //
+    unsigned char ReadRegister(unsigned short address, bool mayThrow)
+    {
+        return Simulator::Instance().Read(address, mayThrow);
+    }
+
+    void WriteRegister(unsigned short address, unsigned char value)
+    {
+        Simulator::Instance().Write(address, value);
+    }
+
+    unsigned char *Memory(unsigned short address)
+    {
+        return &Simulator::Instance().Memory(address);
+    }
+
+    bool SelectDevice(Device device)
+    {
+        if (Simulator::Instance().GetDevice() != device)
+        {
+            Simulator::Instance().Reset(device);
+        }
+        return true;
+    }
+
+    void EnableInterrupts()
+    {
+        Simulator::Instance().EnableInterrupts();
+    }
+
+    void DisableInterrupts()
+    {
+        Simulator::Instance().DisableInterrupts();
+    }
+
+    __istate_t GetInterruptState()
+    {
+        return Simulator::Instance().InterruptsEnabled() ? 0x20 : 0x28;
+    }
+
+    void SetInterruptState(__istate_t state)
+    {
+        if ((state & 0x28) == 0x28)
+        {
+            Simulator::Instance().DisableInterrupts();
+        }
+        else
+        {
+            Simulator::Instance().EnableInterrupts();
+        }
+    }
+
+    void WaitForInterrupt()
+    {
+        Simulator::Instance().WaitForInterrupt();
+    }
+
+    void Halt()
+    {
+        Simulator::Instance().Halt();
+    }
+
+    void Execute(unsigned long cycles)
+    {
+        Simulator::Instance().Execute(cycles);
+    }
+}
@@ -0,0 +1,307 @@
+//
+//  Host simulation of the STM8S core and its peripherals.
+//
+//  The simulator owns a 64K address space, the peripheral models and the
+//  simulated time base.  Chapter code accesses the peripherals through the
+//  register proxies in include/stm8s_host.h and the intrinsic functions in
+//  include/intrinsics.h, both of which end up here.
+//
+//  Time is kept as a count of master clock (f_master) ticks together with the
+//  elapsed time in picoseconds so that the clock may be switched or divided
+//  while the program is running.  When running chapter code compiled for the
+//  host every register access costs one CPU cycle and __no_operation costs
+//  one CPU cycle; this is not an instruction level simulation but it is
+//  enough for busy-wait loops, timeouts and interrupt driven code to behave
+//  as they do on the microcontroller.  The instruction set simulator in
+//  Core.h uses the bus access methods, which do not charge for the access,
+//  and charges the documented cycle count for each instruction instead.
+//
+//  Interrupts are dispatched when they are enabled and the core is not
+//  already servicing an interrupt.  The lowest numbered pending vector is
+//  serviced first and interrupts do not nest.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "include/stm8s_host.h"
+
+namespace STM8
+{
+    //
+    //  Number of interrupt vectors (including reset and TRAP) in the
+    //  STM8S vector table.
+    //
+    const int NumberOfVectors = 32;
+
+    //
+    //  Value returned by a peripheral when it has nothing scheduled.
+    //
+    const uint64_t NoEvent = UINT64_MAX;
+
+    //
+    //  Approximate cost of entering and leaving an interrupt service routine.
+    //
+    const unsigned long InterruptEntryCycles = 9;
+    const unsigned long InterruptReturnCycles = 11;
+
+    typedef void (*InterruptHandler)();
+
+    //
+    //  Thrown to unwind the chapter code when the simulation has finished.
+    //
+    class SimulationComplete : public std::runtime_error
+    {
+    public:
+        explicit SimulationComplete(const std::string &reason) : std::runtime_error(reason)
+        {
+        }
+    };
+
+    //
+    //  Execution statistics for an interrupt vector.
+    //
+    struct InterruptStatistics
+    {
+        unsigned long count;
+        uint64_t totalCycles;
+        uint64_t minimumCycles;
+        uint64_t maximumCycles;
+    };
+
+    class Simulator;
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Base class for the peripheral models.
+    //
+    //  The register contents are held in the simulator memory; Read is given
+    //  the stored value and may return something else (IDR registers for
+    //  instance) or act on the read (status register clearing sequences).
+    //
+    class Peripheral
+    {
+    public:
+        explicit Peripheral(Simulator &simulator) : _simulator(simulator)
+        {
+        }
+
+        virtual ~Peripheral()
+        {
+        }
+
+        virtual unsigned char Read(unsigned short address, unsigned char value)
+        {
+            (void) address;
+            return value;
+        }
+
+        virtual void Write(unsigned short address, unsigned char value);
+
+        //
+        //  Move the peripheral forward by the given number of master clock
+        //  ticks.  The simulator never advances past the point returned by
+        //  TicksToNextEvent.
+        //
+        virtual void Advance(uint64_t ticks)
+        {
+            (void) ticks;
+        }
+
+        virtual uint64_t TicksToNextEvent() const
+        {
+            return NoEvent;
+        }
+
+        //
+        //  Bit mask of the interrupt vectors currently requested.
+        //
+        virtual uint32_t PendingInterrupts() const
+        {
+            return 0;
+        }
+
+        virtual void AcknowledgeInterrupt(int vector)
+        {
+            (void) vector;
+        }
+
+        //
+        //  True if the peripheral keeps running when the core executes HALT.
+        //
+        virtual bool RunsWhenHalted() const
+        {
+            return false;
+        }
+
+    protected:
+        unsigned char &Register(unsigned short address);
+        Simulator &_simulator;
+    };
+
+    class ClockModel;
+    class GpioModel;
+    class TimerModel;
+    class UartModel;
+    class SpiModel;
+    class I2CModel;
+    class AdcModel;
+    class AwuModel;
+    class IwdgModel;
+    class WwdgModel;
+    class FlashModel;
+
+    //--------------------------------------------------------------------------------
+    //
+    //  The simulated microcontroller.
+    //
+    class Simulator
+    {
+    public:
+        static Simulator &Instance();
+
+        void Reset(Device device);
+        Device GetDevice() const { return _device; }
+        const char *DeviceName() const;
+        bool MediumDensity() const { return _device == Device::STM8S105C6; }
+
+        //
+        //  Register and memory access.
+        //
+        unsigned char Read(unsigned short address, bool mayThrow = true);
+        void Write(unsigned short address, unsigned char value);
+        unsigned char BusRead(unsigned short address);
+        void BusWrite(unsigned short address, unsigned char value);
+        unsigned char &Memory(unsigned short address) { return _memory[address]; }
+        void Map(unsigned short first, unsigned short last, Peripheral *peripheral);
+
+        //
+        //  Core.
+        //
+        void Execute(unsigned long cycles, bool mayThrow = true);
+        void EnableInterrupts();
+        void DisableInterrupts();
+        bool InterruptsEnabled() const { return _interruptsEnabled; }
+        bool InInterrupt() const { return _inInterrupt; }
+        int CurrentVector() const { return _currentVector; }
+        void WaitForInterrupt();
+        void Halt();
+        void Idle(bool halted);
+
+        //
+        //  Interrupt handlers and statistics.
+        //
+        void AttachInterrupt(int vector, InterruptHandler handler, const char *name = nullptr);
+        InterruptHandler Handler(int vector) const { return _handlers[vector]; }
+        const char *HandlerName(int vector) const { return _handlerNames[vector]; }
+        const InterruptStatistics &Statistics(int vector) const { return _statistics[vector]; }
+        unsigned long UnhandledInterrupts(int vector) const { return _unhandled[vector]; }
+        unsigned long Wakeups() const { return _wakeups; }
+        void ClearStatistics();
+
+        //
+        //  Interrupt controller access for the instruction set simulator.
+        //
+        uint32_t PendingInterrupts() const;
+        void AcknowledgeInterrupt(int vector);
+        void RecordInterrupt(int vector, uint64_t cycles);
+
+        //
+        //  Time.
+        //
+        uint64_t Ticks() const { return _ticks; }
+        uint64_t CpuCycles() const { return _cpuCycles; }
+        uint64_t IdleTicks() const { return _idleTicks; }
+        uint64_t Picoseconds() const { return _picoseconds; }
+        double Seconds() const { return _picoseconds / 1e12; }
+        uint64_t SecondsToTicks(double seconds) const;
+
+        //
+        //  Run a harness action at a point in simulated time.
+        //
+        void Schedule(double delaySeconds, std::function<void()> action);
+
+        //
+        //  Run the program until it returns, the time limit is reached, the
+        //  core waits for an interrupt which can never arrive or a watchdog
+        //  resets the device.  Returns the reason the simulation stopped.
+        //
+        std::string Run(std::function<void()> entry, double seconds);
+        void Stop(const std::string &reason);
+
+        //
+        //  Peripherals.
+        //
+        ClockModel &Clock() { return *_clock; }
+        GpioModel &Gpio() { return *_gpio; }
+        TimerModel &Timer(int number);
+        bool HasTimer(int number) const;
+        UartModel &Uart() { return *_uart; }
+        SpiModel &Spi() { return *_spi; }
+        I2CModel &I2C() { return *_i2c; }
+        AdcModel &Adc() { return *_adc; }
+        AwuModel &Awu() { return *_awu; }
+        FlashModel &Flash() { return *_flash; }
+
+    private:
+        Simulator();
+        Simulator(const Simulator &) = delete;
+        Simulator &operator=(const Simulator &) = delete;
+
+        void AdvanceTicks(uint64_t ticks, bool halted);
+        uint64_t TicksToNextEvent(bool halted) const;
+        uint64_t TickPicoseconds() const;
+        uint64_t TicksToLimit() const;
+        void RunScheduledActions();
+        bool DispatchInterrupts();
+        void CheckForEnd();
+
+        Device _device;
+        std::vector<unsigned char> _memory;
+        std::vector<Peripheral *> _owners;
+        std::vector<std::unique_ptr<Peripheral>> _peripherals;
+
+        ClockModel *_clock;
+        GpioModel *_gpio;
+        TimerModel *_timers[5];
+        UartModel *_uart;
+        SpiModel *_spi;
+        I2CModel *_i2c;
+        AdcModel *_adc;
+        AwuModel *_awu;
+        FlashModel *_flash;
+
+        uint64_t _ticks;
+        uint64_t _picoseconds;
+        uint64_t _cpuCycles;
+        uint64_t _idleTicks;
+        uint64_t _limitPicoseconds;
+        std::string _stopReason;
+
+        bool _interruptsEnabled;
+        bool _inInterrupt;
+        int _currentVector;
+        unsigned long _wakeups;
+        InterruptHandler _handlers[NumberOfVectors];
+        const char *_handlerNames[NumberOfVectors];
+        InterruptStatistics _statistics[NumberOfVectors];
+        unsigned long _unhandled[NumberOfVectors];
+        uint32_t _unhandledMask;
+
+        std::multimap<uint64_t, std::function<void()>> _scheduled;
+    };
+}
+
+#endif
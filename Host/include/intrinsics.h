@@ -0,0 +1,41 @@
+//
+//  Host simulation replacement for the IAR intrinsics.h header.
+//
+//  The intrinsic functions are forwarded to the simulated core so that
+//  interrupts are only dispatched when enabled and so that waiting for an
+//  interrupt advances simulated time to the next peripheral event.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef INTRINSICS_H
+#define INTRINSICS_H
+
+#if !defined(__cplusplus)
+    #error "The host simulation headers require the sources to be compiled as C++."
+#endif
+
+typedef unsigned char __istate_t;
+
+namespace STM8
+{
+    void EnableInterrupts();
+    void DisableInterrupts();
+    __istate_t GetInterruptState();
+    void SetInterruptState(__istate_t state);
+    void WaitForInterrupt();
+    void Halt();
+    void Execute(unsigned long cycles);
+}
+
+inline void __enable_interrupt()                    { STM8::EnableInterrupts(); }
+inline void __disable_interrupt()                   { STM8::DisableInterrupts(); }
+inline __istate_t __get_interrupt_state()           { return STM8::GetInterruptState(); }
+inline void __set_interrupt_state(__istate_t state) { STM8::SetInterruptState(state); }
+inline void __wait_for_interrupt()                  { STM8::WaitForInterrupt(); }
+inline void __halt()                                { STM8::Halt(); }
+inline void __no_operation()                        { STM8::Execute(1); }
+
+#endif
@@ -0,0 +1,20 @@
+//
+//  Host simulation replacement for the IAR iostm8S105c6.h header.
+//
+//  The STM8S105C6 is a medium density STM8S device.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef IOSTM8S105C6_H
+#define IOSTM8S105C6_H
+
+#define STM8_HOST_DEVICE            STM8::Device::STM8S105C6
+#define STM8_HOST_MEDIUM_DENSITY
+
+#include "stm8s_host.h"
+#include "stm8s_registers.h"
+
+#endif
@@ -0,0 +1,19 @@
+//
+//  Host simulation replacement for the IAR iostm8s103f3.h header.
+//
+//  The STM8S103F3 is a low density STM8S device.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef IOSTM8S103F3_H
+#define IOSTM8S103F3_H
+
+#define STM8_HOST_DEVICE            STM8::Device::STM8S103F3
+
+#include "stm8s_host.h"
+#include "stm8s_registers.h"
+
+#endif
@@ -0,0 +1,184 @@
+//
+//  Register access proxies for the host simulation of the STM8S.
+//
+//  On the target the IAR headers map each register onto a volatile byte at a
+//  fixed address.  On the host each register name expands to a short lived
+//  proxy object instead.  Reading the proxy (by converting it to a value) or
+//  writing it (by assigning to it) is forwarded to the simulated peripheral
+//  model so that status bits, read-to-clear flags and the passage of time
+//  behave as they do on the microcontroller.
+//
+//  A proxy which is created but neither read nor written, as in the idiom
+//  (void) SPI_DR, performs a read when it is destroyed.
+//
+//  This software is provided under the CC BY-SA 3.0 licence.  A
+//  copy of this licence can be found at:
+//
+//  http://creativecommons.org/licenses/by-sa/3.0/legalcode
+//
+#ifndef STM8S_HOST_H
+#define STM8S_HOST_H
+
+#if !defined(__cplusplus)
+    #error "The host simulation headers require the sources to be compiled as C++."
+#endif
+
+#include <exception>
+
+namespace STM8
+{
+    //
+    //  Devices supported by the simulation.
+    //
+    enum class Device
+    {
+        STM8S103F3,
+        STM8S103K3,
+        STM8S105C6
+    };
+
+    //
+    //  Entry points into the simulator used by the proxies.  The final
+    //  parameter is false when the access is made from a destructor and
+    //  so must not end the simulation by throwing.
+    //
+    unsigned char ReadRegister(unsigned short address, bool mayThrow = true);
+    void WriteRegister(unsigned short address, unsigned char value);
+    unsigned char *Memory(unsigned short address);
+    bool SelectDevice(Device device);
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Proxy for a whole 8-bit register.
+    //
+    class Register8
+    {
+    public:
+        explicit Register8(unsigned short address) : _address(address), _accessed(false)
+        {
+        }
+
+        ~Register8() noexcept(false)
+        {
+            if (!_accessed && (std::uncaught_exceptions() == 0))
+            {
+                ReadRegister(_address, false);
+            }
+        }
+
+        operator unsigned char() const
+        {
+            _accessed = true;
+            return ReadRegister(_address);
+        }
+
+        Register8 &operator=(unsigned char value)
+        {
+            _accessed = true;
+            WriteRegister(_address, value);
+            return *this;
+        }
+
+        Register8 &operator=(const Register8 &other)
+        {
+            return *this = (unsigned char) other;
+        }
+
+        Register8 &operator|=(unsigned char value) { return *this = (unsigned char) (*this | value); }
+        Register8 &operator&=(unsigned char value) { return *this = (unsigned char) (*this & value); }
+        Register8 &operator^=(unsigned char value) { return *this = (unsigned char) (*this ^ value); }
+        Register8 &operator+=(unsigned char value) { return *this = (unsigned char) (*this + value); }
+        Register8 &operator-=(unsigned char value) { return *this = (unsigned char) (*this - value); }
+        Register8 &operator<<=(int shift) { return *this = (unsigned char) (*this << shift); }
+        Register8 &operator>>=(int shift) { return *this = (unsigned char) (*this >> shift); }
+        Register8 &operator++() { return *this += 1; }
+        Register8 &operator--() { return *this -= 1; }
+
+    private:
+        unsigned short _address;
+        mutable bool _accessed;
+    };
+
+    //--------------------------------------------------------------------------------
+    //
+    //  Proxy for a bit field within an 8-bit register.  Writes are performed
+    //  as a read-modify-write of the whole register in the same way as the
+    //  code generated by the compiler for the target.
+    //
+    class Field8
+    {
+    public:
+        Field8(unsigned short address, int shift, int width) :
+            _address(address), _shift(shift), _mask((unsigned char) (((1 << width) - 1) << shift)), _accessed(false)
+        {
+        }
+
+        ~Field8() noexcept(false)
+        {
+            if (!_accessed && (std::uncaught_exceptions() == 0))
+            {
+                ReadRegister(_address, false);
+            }
+        }
+
+        operator unsigned char() const
+        {
+            _accessed = true;
+            return (unsigned char) ((ReadRegister(_address) & _mask) >> _shift);
+        }
+
+        Field8 &operator=(unsigned char value)
+        {
+            _accessed = true;
+            unsigned char current = ReadRegister(_address);
+            WriteRegister(_address, (unsigned char) ((current & ~_mask) | ((value << _shift) & _mask)));
+            return *this;
+        }
+
+        Field8 &operator=(const Field8 &other)
+        {
+            return *this = (unsigned char) other;
+        }
+
+        Field8 &operator|=(unsigned char value) { return *this = (unsigned char) (*this | value); }
+        Field8 &operator&=(unsigned char value) { return *this = (unsigned char) (*this & value); }
+        Field8 &operator^=(unsigned char value) { return *this = (unsigned char) (*this ^ value); }
+        Field8 &operator+=(unsigned char value) { return *this = (unsigned char) (*this + value); }
+        Field8 &operator-=(unsigned char value) { return *this = (unsigned char) (*this - value); }
+
+    private:
+        unsigned short _address;
+        int _shift;
+        unsigned char _mask;
+        mutable bool _accessed;
+    };
+}
+
+#define STM8_REGISTER(address)              (STM8::Register8(address))
+#define STM8_FIELD(address, shift, width)   (STM8::Field8(address, shift, width))
+
+//
+//  IAR extended keywords have no meaning on the host.
+//
+#define __interrupt
+#define __no_init
+#define __near
+#define __far
+#define __huge
+#define __tiny
+#define __eeprom
+
+//
+//  Start of the data EEPROM in the simulated address space.  The chapter
+//  code uses this in place of the absolute address 0x4000.
+//
+#define EEPROM_BASE_ADDRESS     ((unsigned long) STM8::Memory(0x4000))
+
+//
+//  Tell the simulator which device the source file was written for.
+//
+#if defined(STM8_HOST_DEVICE)
+    static const bool _stm8HostDeviceSelected = STM8::SelectDevice(STM8_HOST_DEVICE);
+#endif
+
+#endif
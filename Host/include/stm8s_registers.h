@@ -0,0 +1,1603 @@
+//
+//  Register definitions for the host simulation of the STM8S.
+//
+//  The names follow the IAR iostm8s*.h headers so that the chapter
+//  source files compile unchanged.  Each register expands to a proxy
+//  object which forwards the access to the peripheral model in the
+//  simulator (see stm8s_host.h).
+//
+//  This file is included by the device headers and should not be
+//  included directly.
+//
+#ifndef STM8S_REGISTERS_H
+#define STM8S_REGISTERS_H
+
+//--------------------------------------------------------------------------------
+#if defined(STM8_HOST_MEDIUM_DENSITY)
+
+//
+//  GPIO ports A to I.
+//
+#define PA_ODR                      STM8_REGISTER(0x5000)
+#define PA_ODR_ODR0                 STM8_FIELD(0x5000, 0, 1)
+#define PA_ODR_ODR1                 STM8_FIELD(0x5000, 1, 1)
+#define PA_ODR_ODR2                 STM8_FIELD(0x5000, 2, 1)
+#define PA_ODR_ODR3                 STM8_FIELD(0x5000, 3, 1)
+#define PA_ODR_ODR4                 STM8_FIELD(0x5000, 4, 1)
+#define PA_ODR_ODR5                 STM8_FIELD(0x5000, 5, 1)
+#define PA_ODR_ODR6                 STM8_FIELD(0x5000, 6, 1)
+#define PA_ODR_ODR7                 STM8_FIELD(0x5000, 7, 1)
+#define PA_IDR                      STM8_REGISTER(0x5001)
+#define PA_IDR_IDR0                 STM8_FIELD(0x5001, 0, 1)
+#define PA_IDR_IDR1                 STM8_FIELD(0x5001, 1, 1)
+#define PA_IDR_IDR2                 STM8_FIELD(0x5001, 2, 1)
+#define PA_IDR_IDR3                 STM8_FIELD(0x5001, 3, 1)
+#define PA_IDR_IDR4                 STM8_FIELD(0x5001, 4, 1)
+#define PA_IDR_IDR5                 STM8_FIELD(0x5001, 5, 1)
+#define PA_IDR_IDR6                 STM8_FIELD(0x5001, 6, 1)
+#define PA_IDR_IDR7                 STM8_FIELD(0x5001, 7, 1)
+#define PA_DDR                      STM8_REGISTER(0x5002)
+#define PA_DDR_DDR0                 STM8_FIELD(0x5002, 0, 1)
+#define PA_DDR_DDR1                 STM8_FIELD(0x5002, 1, 1)
+#define PA_DDR_DDR2                 STM8_FIELD(0x5002, 2, 1)
+#define PA_DDR_DDR3                 STM8_FIELD(0x5002, 3, 1)
+#define PA_DDR_DDR4                 STM8_FIELD(0x5002, 4, 1)
+#define PA_DDR_DDR5                 STM8_FIELD(0x5002, 5, 1)
+#define PA_DDR_DDR6                 STM8_FIELD(0x5002, 6, 1)
+#define PA_DDR_DDR7                 STM8_FIELD(0x5002, 7, 1)
+#define PA_CR1                      STM8_REGISTER(0x5003)
+#define PA_CR1_C10                  STM8_FIELD(0x5003, 0, 1)
+#define PA_CR1_C11                  STM8_FIELD(0x5003, 1, 1)
+#define PA_CR1_C12                  STM8_FIELD(0x5003, 2, 1)
+#define PA_CR1_C13                  STM8_FIELD(0x5003, 3, 1)
+#define PA_CR1_C14                  STM8_FIELD(0x5003, 4, 1)
+#define PA_CR1_C15                  STM8_FIELD(0x5003, 5, 1)
+#define PA_CR1_C16                  STM8_FIELD(0x5003, 6, 1)
+#define PA_CR1_C17                  STM8_FIELD(0x5003, 7, 1)
+#define PA_CR2                      STM8_REGISTER(0x5004)
+#define PA_CR2_C20                  STM8_FIELD(0x5004, 0, 1)
+#define PA_CR2_C21                  STM8_FIELD(0x5004, 1, 1)
+#define PA_CR2_C22                  STM8_FIELD(0x5004, 2, 1)
+#define PA_CR2_C23                  STM8_FIELD(0x5004, 3, 1)
+#define PA_CR2_C24                  STM8_FIELD(0x5004, 4, 1)
+#define PA_CR2_C25                  STM8_FIELD(0x5004, 5, 1)
+#define PA_CR2_C26                  STM8_FIELD(0x5004, 6, 1)
+#define PA_CR2_C27                  STM8_FIELD(0x5004, 7, 1)
+#define PB_ODR                      STM8_REGISTER(0x5005)
+#define PB_ODR_ODR0                 STM8_FIELD(0x5005, 0, 1)
+#define PB_ODR_ODR1                 STM8_FIELD(0x5005, 1, 1)
+#define PB_ODR_ODR2                 STM8_FIELD(0x5005, 2, 1)
+#define PB_ODR_ODR3                 STM8_FIELD(0x5005, 3, 1)
+#define PB_ODR_ODR4                 STM8_FIELD(0x5005, 4, 1)
+#define PB_ODR_ODR5                 STM8_FIELD(0x5005, 5, 1)
+#define PB_ODR_ODR6                 STM8_FIELD(0x5005, 6, 1)
+#define PB_ODR_ODR7                 STM8_FIELD(0x5005, 7, 1)
+#define PB_IDR                      STM8_REGISTER(0x5006)
+#define PB_IDR_IDR0                 STM8_FIELD(0x5006, 0, 1)
+#define PB_IDR_IDR1                 STM8_FIELD(0x5006, 1, 1)
+#define PB_IDR_IDR2                 STM8_FIELD(0x5006, 2, 1)
+#define PB_IDR_IDR3                 STM8_FIELD(0x5006, 3, 1)
+#define PB_IDR_IDR4                 STM8_FIELD(0x5006, 4, 1)
+#define PB_IDR_IDR5                 STM8_FIELD(0x5006, 5, 1)
+#define PB_IDR_IDR6                 STM8_FIELD(0x5006, 6, 1)
+#define PB_IDR_IDR7                 STM8_FIELD(0x5006, 7, 1)
+#define PB_DDR                      STM8_REGISTER(0x5007)
+#define PB_DDR_DDR0                 STM8_FIELD(0x5007, 0, 1)
+#define PB_DDR_DDR1                 STM8_FIELD(0x5007, 1, 1)
+#define PB_DDR_DDR2                 STM8_FIELD(0x5007, 2, 1)
+#define PB_DDR_DDR3                 STM8_FIELD(0x5007, 3, 1)
+#define PB_DDR_DDR4                 STM8_FIELD(0x5007, 4, 1)
+#define PB_DDR_DDR5                 STM8_FIELD(0x5007, 5, 1)
+#define PB_DDR_DDR6                 STM8_FIELD(0x5007, 6, 1)
+#define PB_DDR_DDR7                 STM8_FIELD(0x5007, 7, 1)
+#define PB_CR1                      STM8_REGISTER(0x5008)
+#define PB_CR1_C10                  STM8_FIELD(0x5008, 0, 1)
+#define PB_CR1_C11                  STM8_FIELD(0x5008, 1, 1)
+#define PB_CR1_C12                  STM8_FIELD(0x5008, 2, 1)
+#define PB_CR1_C13                  STM8_FIELD(0x5008, 3, 1)
+#define PB_CR1_C14                  STM8_FIELD(0x5008, 4, 1)
+#define PB_CR1_C15                  STM8_FIELD(0x5008, 5, 1)
+#define PB_CR1_C16                  STM8_FIELD(0x5008, 6, 1)
+#define PB_CR1_C17                  STM8_FIELD(0x5008, 7, 1)
+#define PB_CR2                      STM8_REGISTER(0x5009)
+#define PB_CR2_C20                  STM8_FIELD(0x5009, 0, 1)
+#define PB_CR2_C21                  STM8_FIELD(0x5009, 1, 1)
+#define PB_CR2_C22                  STM8_FIELD(0x5009, 2, 1)
+#define PB_CR2_C23                  STM8_FIELD(0x5009, 3, 1)
+#define PB_CR2_C24                  STM8_FIELD(0x5009, 4, 1)
+#define PB_CR2_C25                  STM8_FIELD(0x5009, 5, 1)
+#define PB_CR2_C26                  STM8_FIELD(0x5009, 6, 1)
+#define PB_CR2_C27                  STM8_FIELD(0x5009, 7, 1)
+#define PC_ODR                      STM8_REGISTER(0x500a)
+#define PC_ODR_ODR0                 STM8_FIELD(0x500a, 0, 1)
+#define PC_ODR_ODR1                 STM8_FIELD(0x500a, 1, 1)
+#define PC_ODR_ODR2                 STM8_FIELD(0x500a, 2, 1)
+#define PC_ODR_ODR3                 STM8_FIELD(0x500a, 3, 1)
+#define PC_ODR_ODR4                 STM8_FIELD(0x500a, 4, 1)
+#define PC_ODR_ODR5                 STM8_FIELD(0x500a, 5, 1)
+#define PC_ODR_ODR6                 STM8_FIELD(0x500a, 6, 1)
+#define PC_ODR_ODR7                 STM8_FIELD(0x500a, 7, 1)
+#define PC_IDR                      STM8_REGISTER(0x500b)
+#define PC_IDR_IDR0                 STM8_FIELD(0x500b, 0, 1)
+#define PC_IDR_IDR1                 STM8_FIELD(0x500b, 1, 1)
+#define PC_IDR_IDR2                 STM8_FIELD(0x500b, 2, 1)
+#define PC_IDR_IDR3                 STM8_FIELD(0x500b, 3, 1)
+#define PC_IDR_IDR4                 STM8_FIELD(0x500b, 4, 1)
+#define PC_IDR_IDR5                 STM8_FIELD(0x500b, 5, 1)
+#define PC_IDR_IDR6                 STM8_FIELD(0x500b, 6, 1)
+#define PC_IDR_IDR7                 STM8_FIELD(0x500b, 7, 1)
+#define PC_DDR                      STM8_REGISTER(0x500c)
+#define PC_DDR_DDR0                 STM8_FIELD(0x500c, 0, 1)
+#define PC_DDR_DDR1                 STM8_FIELD(0x500c, 1, 1)
+#define PC_DDR_DDR2                 STM8_FIELD(0x500c, 2, 1)
+#define PC_DDR_DDR3                 STM8_FIELD(0x500c, 3, 1)
+#define PC_DDR_DDR4                 STM8_FIELD(0x500c, 4, 1)
+#define PC_DDR_DDR5                 STM8_FIELD(0x500c, 5, 1)
+#define PC_DDR_DDR6                 STM8_FIELD(0x500c, 6, 1)
+#define PC_DDR_DDR7                 STM8_FIELD(0x500c, 7, 1)
+#define PC_CR1                      STM8_REGISTER(0x500d)
+#define PC_CR1_C10                  STM8_FIELD(0x500d, 0, 1)
+#define PC_CR1_C11                  STM8_FIELD(0x500d, 1, 1)
+#define PC_CR1_C12                  STM8_FIELD(0x500d, 2, 1)
+#define PC_CR1_C13                  STM8_FIELD(0x500d, 3, 1)
+#define PC_CR1_C14                  STM8_FIELD(0x500d, 4, 1)
+#define PC_CR1_C15                  STM8_FIELD(0x500d, 5, 1)
+#define PC_CR1_C16                  STM8_FIELD(0x500d, 6, 1)
+#define PC_CR1_C17                  STM8_FIELD(0x500d, 7, 1)
+#define PC_CR2                      STM8_REGISTER(0x500e)
+#define PC_CR2_C20                  STM8_FIELD(0x500e, 0, 1)
+#define PC_CR2_C21                  STM8_FIELD(0x500e, 1, 1)
+#define PC_CR2_C22                  STM8_FIELD(0x500e, 2, 1)
+#define PC_CR2_C23                  STM8_FIELD(0x500e, 3, 1)
+#define PC_CR2_C24                  STM8_FIELD(0x500e, 4, 1)
+#define PC_CR2_C25                  STM8_FIELD(0x500e, 5, 1)
+#define PC_CR2_C26                  STM8_FIELD(0x500e, 6, 1)
+#define PC_CR2_C27                  STM8_FIELD(0x500e, 7, 1)
+#define PD_ODR                      STM8_REGISTER(0x500f)
+#define PD_ODR_ODR0                 STM8_FIELD(0x500f, 0, 1)
+#define PD_ODR_ODR1                 STM8_FIELD(0x500f, 1, 1)
+#define PD_ODR_ODR2                 STM8_FIELD(0x500f, 2, 1)
+#define PD_ODR_ODR3                 STM8_FIELD(0x500f, 3, 1)
+#define PD_ODR_ODR4                 STM8_FIELD(0x500f, 4, 1)
+#define PD_ODR_ODR5                 STM8_FIELD(0x500f, 5, 1)
+#define PD_ODR_ODR6                 STM8_FIELD(0x500f, 6, 1)
+#define PD_ODR_ODR7                 STM8_FIELD(0x500f, 7, 1)
+#define PD_IDR                      STM8_REGISTER(0x5010)
+#define PD_IDR_IDR0                 STM8_FIELD(0x5010, 0, 1)
+#define PD_IDR_IDR1                 STM8_FIELD(0x5010, 1, 1)
+#define PD_IDR_IDR2                 STM8_FIELD(0x5010, 2, 1)
+#define PD_IDR_IDR3                 STM8_FIELD(0x5010, 3, 1)
+#define PD_IDR_IDR4                 STM8_FIELD(0x5010, 4, 1)
+#define PD_IDR_IDR5                 STM8_FIELD(0x5010, 5, 1)
+#define PD_IDR_IDR6                 STM8_FIELD(0x5010, 6, 1)
+#define PD_IDR_IDR7                 STM8_FIELD(0x5010, 7, 1)
+#define PD_DDR                      STM8_REGISTER(0x5011)
+#define PD_DDR_DDR0                 STM8_FIELD(0x5011, 0, 1)
+#define PD_DDR_DDR1                 STM8_FIELD(0x5011, 1, 1)
+#define PD_DDR_DDR2                 STM8_FIELD(0x5011, 2, 1)
+#define PD_DDR_DDR3                 STM8_FIELD(0x5011, 3, 1)
+#define PD_DDR_DDR4                 STM8_FIELD(0x5011, 4, 1)
+#define PD_DDR_DDR5                 STM8_FIELD(0x5011, 5, 1)
+#define PD_DDR_DDR6                 STM8_FIELD(0x5011, 6, 1)
+#define PD_DDR_DDR7                 STM8_FIELD(0x5011, 7, 1)
+#define PD_CR1                      STM8_REGISTER(0x5012)
+#define PD_CR1_C10                  STM8_FIELD(0x5012, 0, 1)
+#define PD_CR1_C11                  STM8_FIELD(0x5012, 1, 1)
+#define PD_CR1_C12                  STM8_FIELD(0x5012, 2, 1)
+#define PD_CR1_C13                  STM8_FIELD(0x5012, 3, 1)
+#define PD_CR1_C14                  STM8_FIELD(0x5012, 4, 1)
+#define PD_CR1_C15                  STM8_FIELD(0x5012, 5, 1)
+#define PD_CR1_C16                  STM8_FIELD(0x5012, 6, 1)
+#define PD_CR1_C17                  STM8_FIELD(0x5012, 7, 1)
+#define PD_CR2                      STM8_REGISTER(0x5013)
+#define PD_CR2_C20                  STM8_FIELD(0x5013, 0, 1)
+#define PD_CR2_C21                  STM8_FIELD(0x5013, 1, 1)
+#define PD_CR2_C22                  STM8_FIELD(0x5013, 2, 1)
+#define PD_CR2_C23                  STM8_FIELD(0x5013, 3, 1)
+#define PD_CR2_C24                  STM8_FIELD(0x5013, 4, 1)
+#define PD_CR2_C25                  STM8_FIELD(0x5013, 5, 1)
+#define PD_CR2_C26                  STM8_FIELD(0x5013, 6, 1)
+#define PD_CR2_C27                  STM8_FIELD(0x5013, 7, 1)
+#define PE_ODR                      STM8_REGISTER(0x5014)
+#define PE_ODR_ODR0                 STM8_FIELD(0x5014, 0, 1)
+#define PE_ODR_ODR1                 STM8_FIELD(0x5014, 1, 1)
+#define PE_ODR_ODR2                 STM8_FIELD(0x5014, 2, 1)
+#define PE_ODR_ODR3                 STM8_FIELD(0x5014, 3, 1)
+#define PE_ODR_ODR4                 STM8_FIELD(0x5014, 4, 1)
+#define PE_ODR_ODR5                 STM8_FIELD(0x5014, 5, 1)
+#define PE_ODR_ODR6                 STM8_FIELD(0x5014, 6, 1)
+#define PE_ODR_ODR7                 STM8_FIELD(0x5014, 7, 1)
+#define PE_IDR                      STM8_REGISTER(0x5015)
+#define PE_IDR_IDR0                 STM8_FIELD(0x5015, 0, 1)
+#define PE_IDR_IDR1                 STM8_FIELD(0x5015, 1, 1)
+#define PE_IDR_IDR2                 STM8_FIELD(0x5015, 2, 1)
+#define PE_IDR_IDR3                 STM8_FIELD(0x5015, 3, 1)
+#define PE_IDR_IDR4                 STM8_FIELD(0x5015, 4, 1)
+#define PE_IDR_IDR5                 STM8_FIELD(0x5015, 5, 1)
+#define PE_IDR_IDR6                 STM8_FIELD(0x5015, 6, 1)
+#define PE_IDR_IDR7                 STM8_FIELD(0x5015, 7, 1)
+#define PE_DDR                      STM8_REGISTER(0x5016)
+#define PE_DDR_DDR0                 STM8_FIELD(0x5016, 0, 1)
+#define PE_DDR_DDR1                 STM8_FIELD(0x5016, 1, 1)
+#define PE_DDR_DDR2                 STM8_FIELD(0x5016, 2, 1)
+#define PE_DDR_DDR3                 STM8_FIELD(0x5016, 3, 1)
+#define PE_DDR_DDR4                 STM8_FIELD(0x5016, 4, 1)
+#define PE_DDR_DDR5                 STM8_FIELD(0x5016, 5, 1)
+#define PE_DDR_DDR6                 STM8_FIELD(0x5016, 6, 1)
+#define PE_DDR_DDR7                 STM8_FIELD(0x5016, 7, 1)
+#define PE_CR1                      STM8_REGISTER(0x5017)
+#define PE_CR1_C10                  STM8_FIELD(0x5017, 0, 1)
+#define PE_CR1_C11                  STM8_FIELD(0x5017, 1, 1)
+#define PE_CR1_C12                  STM8_FIELD(0x5017, 2, 1)
+#define PE_CR1_C13                  STM8_FIELD(0x5017, 3, 1)
+#define PE_CR1_C14                  STM8_FIELD(0x5017, 4, 1)
+#define PE_CR1_C15                  STM8_FIELD(0x5017, 5, 1)
+#define PE_CR1_C16                  STM8_FIELD(0x5017, 6, 1)
+#define PE_CR1_C17                  STM8_FIELD(0x5017, 7, 1)
+#define PE_CR2                      STM8_REGISTER(0x5018)
+#define PE_CR2_C20                  STM8_FIELD(0x5018, 0, 1)
+#define PE_CR2_C21                  STM8_FIELD(0x5018, 1, 1)
+#define PE_CR2_C22                  STM8_FIELD(0x5018, 2, 1)
+#define PE_CR2_C23                  STM8_FIELD(0x5018, 3, 1)
+#define PE_CR2_C24                  STM8_FIELD(0x5018, 4, 1)
+#define PE_CR2_C25                  STM8_FIELD(0x5018, 5, 1)
+#define PE_CR2_C26                  STM8_FIELD(0x5018, 6, 1)
+#define PE_CR2_C27                  STM8_FIELD(0x5018, 7, 1)
+#define PF_ODR                      STM8_REGISTER(0x5019)
+#define PF_ODR_ODR0                 STM8_FIELD(0x5019, 0, 1)
+#define PF_ODR_ODR1                 STM8_FIELD(0x5019, 1, 1)
+#define PF_ODR_ODR2                 STM8_FIELD(0x5019, 2, 1)
+#define PF_ODR_ODR3                 STM8_FIELD(0x5019, 3, 1)
+#define PF_ODR_ODR4                 STM8_FIELD(0x5019, 4, 1)
+#define PF_ODR_ODR5                 STM8_FIELD(0x5019, 5, 1)
+#define PF_ODR_ODR6                 STM8_FIELD(0x5019, 6, 1)
+#define PF_ODR_ODR7                 STM8_FIELD(0x5019, 7, 1)
+#define PF_IDR                      STM8_REGISTER(0x501a)
+#define PF_IDR_IDR0                 STM8_FIELD(0x501a, 0, 1)
+#define PF_IDR_IDR1                 STM8_FIELD(0x501a, 1, 1)
+#define PF_IDR_IDR2                 STM8_FIELD(0x501a, 2, 1)
+#define PF_IDR_IDR3                 STM8_FIELD(0x501a, 3, 1)
+#define PF_IDR_IDR4                 STM8_FIELD(0x501a, 4, 1)
+#define PF_IDR_IDR5                 STM8_FIELD(0x501a, 5, 1)
+#define PF_IDR_IDR6                 STM8_FIELD(0x501a, 6, 1)
+#define PF_IDR_IDR7                 STM8_FIELD(0x501a, 7, 1)
+#define PF_DDR                      STM8_REGISTER(0x501b)
+#define PF_DDR_DDR0                 STM8_FIELD(0x501b, 0, 1)
+#define PF_DDR_DDR1                 STM8_FIELD(0x501b, 1, 1)
+#define PF_DDR_DDR2                 STM8_FIELD(0x501b, 2, 1)
+#define PF_DDR_DDR3                 STM8_FIELD(0x501b, 3, 1)
+#define PF_DDR_DDR4                 STM8_FIELD(0x501b, 4, 1)
+#define PF_DDR_DDR5                 STM8_FIELD(0x501b, 5, 1)
+#define PF_DDR_DDR6                 STM8_FIELD(0x501b, 6, 1)
+#define PF_DDR_DDR7                 STM8_FIELD(0x501b, 7, 1)
+#define PF_CR1                      STM8_REGISTER(0x501c)
+#define PF_CR1_C10                  STM8_FIELD(0x501c, 0, 1)
+#define PF_CR1_C11                  STM8_FIELD(0x501c, 1, 1)
+#define PF_CR1_C12                  STM8_FIELD(0x501c, 2, 1)
+#define PF_CR1_C13                  STM8_FIELD(0x501c, 3, 1)
+#define PF_CR1_C14                  STM8_FIELD(0x501c, 4, 1)
+#define PF_CR1_C15                  STM8_FIELD(0x501c, 5, 1)
+#define PF_CR1_C16                  STM8_FIELD(0x501c, 6, 1)
+#define PF_CR1_C17                  STM8_FIELD(0x501c, 7, 1)
+#define PF_CR2                      STM8_REGISTER(0x501d)
+#define PF_CR2_C20                  STM8_FIELD(0x501d, 0, 1)
+#define PF_CR2_C21                  STM8_FIELD(0x501d, 1, 1)
+#define PF_CR2_C22                  STM8_FIELD(0x501d, 2, 1)
+#define PF_CR2_C23                  STM8_FIELD(0x501d, 3, 1)
+#define PF_CR2_C24                  STM8_FIELD(0x501d, 4, 1)
+#define PF_CR2_C25                  STM8_FIELD(0x501d, 5, 1)
+#define PF_CR2_C26                  STM8_FIELD(0x501d, 6, 1)
+#define PF_CR2_C27                  STM8_FIELD(0x501d, 7, 1)
+#define PG_ODR                      STM8_REGISTER(0x501e)
+#define PG_ODR_ODR0                 STM8_FIELD(0x501e, 0, 1)
+#define PG_ODR_ODR1                 STM8_FIELD(0x501e, 1, 1)
+#define PG_ODR_ODR2                 STM8_FIELD(0x501e, 2, 1)
+#define PG_ODR_ODR3                 STM8_FIELD(0x501e, 3, 1)
+#define PG_ODR_ODR4                 STM8_FIELD(0x501e, 4, 1)
+#define PG_ODR_ODR5                 STM8_FIELD(0x501e, 5, 1)
+#define PG_ODR_ODR6                 STM8_FIELD(0x501e, 6, 1)
+#define PG_ODR_ODR7                 STM8_FIELD(0x501e, 7, 1)
+#define PG_IDR                      STM8_REGISTER(0x501f)
+#define PG_IDR_IDR0                 STM8_FIELD(0x501f, 0, 1)
+#define PG_IDR_IDR1                 STM8_FIELD(0x501f, 1, 1)
+#define PG_IDR_IDR2                 STM8_FIELD(0x501f, 2, 1)
+#define PG_IDR_IDR3                 STM8_FIELD(0x501f, 3, 1)
+#define PG_IDR_IDR4                 STM8_FIELD(0x501f, 4, 1)
+#define PG_IDR_IDR5                 STM8_FIELD(0x501f, 5, 1)
+#define PG_IDR_IDR6                 STM8_FIELD(0x501f, 6, 1)
+#define PG_IDR_IDR7                 STM8_FIELD(0x501f, 7, 1)
+#define PG_DDR                      STM8_REGISTER(0x5020)
+#define PG_DDR_DDR0                 STM8_FIELD(0x5020, 0, 1)
+#define PG_DDR_DDR1                 STM8_FIELD(0x5020, 1, 1)
+#define PG_DDR_DDR2                 STM8_FIELD(0x5020, 2, 1)
+#define PG_DDR_DDR3                 STM8_FIELD(0x5020, 3, 1)
+#define PG_DDR_DDR4                 STM8_FIELD(0x5020, 4, 1)
+#define PG_DDR_DDR5                 STM8_FIELD(0x5020, 5, 1)
+#define PG_DDR_DDR6                 STM8_FIELD(0x5020, 6, 1)
+#define PG_DDR_DDR7                 STM8_FIELD(0x5020, 7, 1)
+#define PG_CR1                      STM8_REGISTER(0x5021)
+#define PG_CR1_C10                  STM8_FIELD(0x5021, 0, 1)
+#define PG_CR1_C11                  STM8_FIELD(0x5021, 1, 1)
+#define PG_CR1_C12                  STM8_FIELD(0x5021, 2, 1)
+#define PG_CR1_C13                  STM8_FIELD(0x5021, 3, 1)
+#define PG_CR1_C14                  STM8_FIELD(0x5021, 4, 1)
+#define PG_CR1_C15                  STM8_FIELD(0x5021, 5, 1)
+#define PG_CR1_C16                  STM8_FIELD(0x5021, 6, 1)
+#define PG_CR1_C17                  STM8_FIELD(0x5021, 7, 1)
+#define PG_CR2                      STM8_REGISTER(0x5022)
+#define PG_CR2_C20                  STM8_FIELD(0x5022, 0, 1)
+#define PG_CR2_C21                  STM8_FIELD(0x5022, 1, 1)
+#define PG_CR2_C22                  STM8_FIELD(0x5022, 2, 1)
+#define PG_CR2_C23                  STM8_FIELD(0x5022, 3, 1)
+#define PG_CR2_C24                  STM8_FIELD(0x5022, 4, 1)
+#define PG_CR2_C25                  STM8_FIELD(0x5022, 5, 1)
+#define PG_CR2_C26                  STM8_FIELD(0x5022, 6, 1)
+#define PG_CR2_C27                  STM8_FIELD(0x5022, 7, 1)
+#define PH_ODR                      STM8_REGISTER(0x5023)
+#define PH_ODR_ODR0                 STM8_FIELD(0x5023, 0, 1)
+#define PH_ODR_ODR1                 STM8_FIELD(0x5023, 1, 1)
+#define PH_ODR_ODR2                 STM8_FIELD(0x5023, 2, 1)
+#define PH_ODR_ODR3                 STM8_FIELD(0x5023, 3, 1)
+#define PH_ODR_ODR4                 STM8_FIELD(0x5023, 4, 1)
+#define PH_ODR_ODR5                 STM8_FIELD(0x5023, 5, 1)
+#define PH_ODR_ODR6                 STM8_FIELD(0x5023, 6, 1)
+#define PH_ODR_ODR7                 STM8_FIELD(0x5023, 7, 1)
+#define PH_IDR                      STM8_REGISTER(0x5024)
+#define PH_IDR_IDR0                 STM8_FIELD(0x5024, 0, 1)
+#define PH_IDR_IDR1                 STM8_FIELD(0x5024, 1, 1)
+#define PH_IDR_IDR2                 STM8_FIELD(0x5024, 2, 1)
+#define PH_IDR_IDR3                 STM8_FIELD(0x5024, 3, 1)
+#define PH_IDR_IDR4                 STM8_FIELD(0x5024, 4, 1)
+#define PH_IDR_IDR5                 STM8_FIELD(0x5024, 5, 1)
+#define PH_IDR_IDR6                 STM8_FIELD(0x5024, 6, 1)
+#define PH_IDR_IDR7                 STM8_FIELD(0x5024, 7, 1)
+#define PH_DDR                      STM8_REGISTER(0x5025)
+#define PH_DDR_DDR0                 STM8_FIELD(0x5025, 0, 1)
+#define PH_DDR_DDR1                 STM8_FIELD(0x5025, 1, 1)
+#define PH_DDR_DDR2                 STM8_FIELD(0x5025, 2, 1)
+#define PH_DDR_DDR3                 STM8_FIELD(0x5025, 3, 1)
+#define PH_DDR_DDR4                 STM8_FIELD(0x5025, 4, 1)
+#define PH_DDR_DDR5                 STM8_FIELD(0x5025, 5, 1)
+#define PH_DDR_DDR6                 STM8_FIELD(0x5025, 6, 1)
+#define PH_DDR_DDR7                 STM8_FIELD(0x5025, 7, 1)
+#define PH_CR1                      STM8_REGISTER(0x5026)
+#define PH_CR1_C10                  STM8_FIELD(0x5026, 0, 1)
+#define PH_CR1_C11                  STM8_FIELD(0x5026, 1, 1)
+#define PH_CR1_C12                  STM8_FIELD(0x5026, 2, 1)
+#define PH_CR1_C13                  STM8_FIELD(0x5026, 3, 1)
+#define PH_CR1_C14                  STM8_FIELD(0x5026, 4, 1)
+#define PH_CR1_C15                  STM8_FIELD(0x5026, 5, 1)
+#define PH_CR1_C16                  STM8_FIELD(0x5026, 6, 1)
+#define PH_CR1_C17                  STM8_FIELD(0x5026, 7, 1)
+#define PH_CR2                      STM8_REGISTER(0x5027)
+#define PH_CR2_C20                  STM8_FIELD(0x5027, 0, 1)
+#define PH_CR2_C21                  STM8_FIELD(0x5027, 1, 1)
+#define PH_CR2_C22                  STM8_FIELD(0x5027, 2, 1)
+#define PH_CR2_C23                  STM8_FIELD(0x5027, 3, 1)
+#define PH_CR2_C24                  STM8_FIELD(0x5027, 4, 1)
+#define PH_CR2_C25                  STM8_FIELD(0x5027, 5, 1)
+#define PH_CR2_C26                  STM8_FIELD(0x5027, 6, 1)
+#define PH_CR2_C27                  STM8_FIELD(0x5027, 7, 1)
+#define PI_ODR                      STM8_REGISTER(0x5028)
+#define PI_ODR_ODR0                 STM8_FIELD(0x5028, 0, 1)
+#define PI_ODR_ODR1                 STM8_FIELD(0x5028, 1, 1)
+#define PI_ODR_ODR2                 STM8_FIELD(0x5028, 2, 1)
+#define PI_ODR_ODR3                 STM8_FIELD(0x5028, 3, 1)
+#define PI_ODR_ODR4                 STM8_FIELD(0x5028, 4, 1)
+#define PI_ODR_ODR5                 STM8_FIELD(0x5028, 5, 1)
+#define PI_ODR_ODR6                 STM8_FIELD(0x5028, 6, 1)
+#define PI_ODR_ODR7                 STM8_FIELD(0x5028, 7, 1)
+#define PI_IDR                      STM8_REGISTER(0x5029)
+#define PI_IDR_IDR0                 STM8_FIELD(0x5029, 0, 1)
+#define PI_IDR_IDR1                 STM8_FIELD(0x5029, 1, 1)
+#define PI_IDR_IDR2                 STM8_FIELD(0x5029, 2, 1)
+#define PI_IDR_IDR3                 STM8_FIELD(0x5029, 3, 1)
+#define PI_IDR_IDR4                 STM8_FIELD(0x5029, 4, 1)
+#define PI_IDR_IDR5                 STM8_FIELD(0x5029, 5, 1)
+#define PI_IDR_IDR6                 STM8_FIELD(0x5029, 6, 1)
+#define PI_IDR_IDR7                 STM8_FIELD(0x5029, 7, 1)
+#define PI_DDR                      STM8_REGISTER(0x502a)
+#define PI_DDR_DDR0                 STM8_FIELD(0x502a, 0, 1)
+#define PI_DDR_DDR1                 STM8_FIELD(0x502a, 1, 1)
+#define PI_DDR_DDR2                 STM8_FIELD(0x502a, 2, 1)
+#define PI_DDR_DDR3                 STM8_FIELD(0x502a, 3, 1)
+#define PI_DDR_DDR4                 STM8_FIELD(0x502a, 4, 1)
+#define PI_DDR_DDR5                 STM8_FIELD(0x502a, 5, 1)
+#define PI_DDR_DDR6                 STM8_FIELD(0x502a, 6, 1)
+#define PI_DDR_DDR7                 STM8_FIELD(0x502a, 7, 1)
+#define PI_CR1                      STM8_REGISTER(0x502b)
+#define PI_CR1_C10                  STM8_FIELD(0x502b, 0, 1)
+#define PI_CR1_C11                  STM8_FIELD(0x502b, 1, 1)
+#define PI_CR1_C12                  STM8_FIELD(0x502b, 2, 1)
+#define PI_CR1_C13                  STM8_FIELD(0x502b, 3, 1)
+#define PI_CR1_C14                  STM8_FIELD(0x502b, 4, 1)
+#define PI_CR1_C15                  STM8_FIELD(0x502b, 5, 1)
+#define PI_CR1_C16                  STM8_FIELD(0x502b, 6, 1)
+#define PI_CR1_C17                  STM8_FIELD(0x502b, 7, 1)
+#define PI_CR2                      STM8_REGISTER(0x502c)
+#define PI_CR2_C20                  STM8_FIELD(0x502c, 0, 1)
+#define PI_CR2_C21                  STM8_FIELD(0x502c, 1, 1)
+#define PI_CR2_C22                  STM8_FIELD(0x502c, 2, 1)
+#define PI_CR2_C23                  STM8_FIELD(0x502c, 3, 1)
+#define PI_CR2_C24                  STM8_FIELD(0x502c, 4, 1)
+#define PI_CR2_C25                  STM8_FIELD(0x502c, 5, 1)
+#define PI_CR2_C26                  STM8_FIELD(0x502c, 6, 1)
+#define PI_CR2_C27                  STM8_FIELD(0x502c, 7, 1)
+
+#else
+
+//
+//  GPIO ports A to F.
+//
+#define PA_ODR                      STM8_REGISTER(0x5000)
+#define PA_ODR_ODR0                 STM8_FIELD(0x5000, 0, 1)
+#define PA_ODR_ODR1                 STM8_FIELD(0x5000, 1, 1)
+#define PA_ODR_ODR2                 STM8_FIELD(0x5000, 2, 1)
+#define PA_ODR_ODR3                 STM8_FIELD(0x5000, 3, 1)
+#define PA_ODR_ODR4                 STM8_FIELD(0x5000, 4, 1)
+#define PA_ODR_ODR5                 STM8_FIELD(0x5000, 5, 1)
+#define PA_ODR_ODR6                 STM8_FIELD(0x5000, 6, 1)
+#define PA_ODR_ODR7                 STM8_FIELD(0x5000, 7, 1)
+#define PA_IDR                      STM8_REGISTER(0x5001)
+#define PA_IDR_IDR0                 STM8_FIELD(0x5001, 0, 1)
+#define PA_IDR_IDR1                 STM8_FIELD(0x5001, 1, 1)
+#define PA_IDR_IDR2                 STM8_FIELD(0x5001, 2, 1)
+#define PA_IDR_IDR3                 STM8_FIELD(0x5001, 3, 1)
+#define PA_IDR_IDR4                 STM8_FIELD(0x5001, 4, 1)
+#define PA_IDR_IDR5                 STM8_FIELD(0x5001, 5, 1)
+#define PA_IDR_IDR6                 STM8_FIELD(0x5001, 6, 1)
+#define PA_IDR_IDR7                 STM8_FIELD(0x5001, 7, 1)
+#define PA_DDR                      STM8_REGISTER(0x5002)
+#define PA_DDR_DDR0                 STM8_FIELD(0x5002, 0, 1)
+#define PA_DDR_DDR1                 STM8_FIELD(0x5002, 1, 1)
+#define PA_DDR_DDR2                 STM8_FIELD(0x5002, 2, 1)
+#define PA_DDR_DDR3                 STM8_FIELD(0x5002, 3, 1)
+#define PA_DDR_DDR4                 STM8_FIELD(0x5002, 4, 1)
+#define PA_DDR_DDR5                 STM8_FIELD(0x5002, 5, 1)
+#define PA_DDR_DDR6                 STM8_FIELD(0x5002, 6, 1)
+#define PA_DDR_DDR7                 STM8_FIELD(0x5002, 7, 1)
+#define PA_CR1                      STM8_REGISTER(0x5003)
+#define PA_CR1_C10                  STM8_FIELD(0x5003, 0, 1)
+#define PA_CR1_C11                  STM8_FIELD(0x5003, 1, 1)
+#define PA_CR1_C12                  STM8_FIELD(0x5003, 2, 1)
+#define PA_CR1_C13                  STM8_FIELD(0x5003, 3, 1)
+#define PA_CR1_C14                  STM8_FIELD(0x5003, 4, 1)
+#define PA_CR1_C15                  STM8_FIELD(0x5003, 5, 1)
+#define PA_CR1_C16                  STM8_FIELD(0x5003, 6, 1)
+#define PA_CR1_C17                  STM8_FIELD(0x5003, 7, 1)
+#define PA_CR2                      STM8_REGISTER(0x5004)
+#define PA_CR2_C20                  STM8_FIELD(0x5004, 0, 1)
+#define PA_CR2_C21                  STM8_FIELD(0x5004, 1, 1)
+#define PA_CR2_C22                  STM8_FIELD(0x5004, 2, 1)
+#define PA_CR2_C23                  STM8_FIELD(0x5004, 3, 1)
+#define PA_CR2_C24                  STM8_FIELD(0x5004, 4, 1)
+#define PA_CR2_C25                  STM8_FIELD(0x5004, 5, 1)
+#define PA_CR2_C26                  STM8_FIELD(0x5004, 6, 1)
+#define PA_CR2_C27                  STM8_FIELD(0x5004, 7, 1)
+#define PB_ODR                      STM8_REGISTER(0x5005)
+#define PB_ODR_ODR0                 STM8_FIELD(0x5005, 0, 1)
+#define PB_ODR_ODR1                 STM8_FIELD(0x5005, 1, 1)
+#define PB_ODR_ODR2                 STM8_FIELD(0x5005, 2, 1)
+#define PB_ODR_ODR3                 STM8_FIELD(0x5005, 3, 1)
+#define PB_ODR_ODR4                 STM8_FIELD(0x5005, 4, 1)
+#define PB_ODR_ODR5                 STM8_FIELD(0x5005, 5, 1)
+#define PB_ODR_ODR6                 STM8_FIELD(0x5005, 6, 1)
+#define PB_ODR_ODR7                 STM8_FIELD(0x5005, 7, 1)
+#define PB_IDR                      STM8_REGISTER(0x5006)
+#define PB_IDR_IDR0                 STM8_FIELD(0x5006, 0, 1)
+#define PB_IDR_IDR1                 STM8_FIELD(0x5006, 1, 1)
+#define PB_IDR_IDR2                 STM8_FIELD(0x5006, 2, 1)
+#define PB_IDR_IDR3                 STM8_FIELD(0x5006, 3, 1)
+#define PB_IDR_IDR4                 STM8_FIELD(0x5006, 4, 1)
+#define PB_IDR_IDR5                 STM8_FIELD(0x5006, 5, 1)
+#define PB_IDR_IDR6                 STM8_FIELD(0x5006, 6, 1)
+#define PB_IDR_IDR7                 STM8_FIELD(0x5006, 7, 1)
+#define PB_DDR                      STM8_REGISTER(0x5007)
+#define PB_DDR_DDR0                 STM8_FIELD(0x5007, 0, 1)
+#define PB_DDR_DDR1                 STM8_FIELD(0x5007, 1, 1)
+#define PB_DDR_DDR2                 STM8_FIELD(0x5007, 2, 1)
+#define PB_DDR_DDR3                 STM8_FIELD(0x5007, 3, 1)
+#define PB_DDR_DDR4                 STM8_FIELD(0x5007, 4, 1)
+#define PB_DDR_DDR5                 STM8_FIELD(0x5007, 5, 1)
+#define PB_DDR_DDR6                 STM8_FIELD(0x5007, 6, 1)
+#define PB_DDR_DDR7                 STM8_FIELD(0x5007, 7, 1)
+#define PB_CR1                      STM8_REGISTER(0x5008)
+#define PB_CR1_C10                  STM8_FIELD(0x5008, 0, 1)
+#define PB_CR1_C11                  STM8_FIELD(0x5008, 1, 1)
+#define PB_CR1_C12                  STM8_FIELD(0x5008, 2, 1)
+#define PB_CR1_C13                  STM8_FIELD(0x5008, 3, 1)
+#define PB_CR1_C14                  STM8_FIELD(0x5008, 4, 1)
+#define PB_CR1_C15                  STM8_FIELD(0x5008, 5, 1)
+#define PB_CR1_C16                  STM8_FIELD(0x5008, 6, 1)
+#define PB_CR1_C17                  STM8_FIELD(0x5008, 7, 1)
+#define PB_CR2                      STM8_REGISTER(0x5009)
+#define PB_CR2_C20                  STM8_FIELD(0x5009, 0, 1)
+#define PB_CR2_C21                  STM8_FIELD(0x5009, 1, 1)
+#define PB_CR2_C22                  STM8_FIELD(0x5009, 2, 1)
+#define PB_CR2_C23                  STM8_FIELD(0x5009, 3, 1)
+#define PB_CR2_C24                  STM8_FIELD(0x5009, 4, 1)
+#define PB_CR2_C25                  STM8_FIELD(0x5009, 5, 1)
+#define PB_CR2_C26                  STM8_FIELD(0x5009, 6, 1)
+#define PB_CR2_C27                  STM8_FIELD(0x5009, 7, 1)
+#define PC_ODR                      STM8_REGISTER(0x500a)
+#define PC_ODR_ODR0                 STM8_FIELD(0x500a, 0, 1)
+#define PC_ODR_ODR1                 STM8_FIELD(0x500a, 1, 1)
+#define PC_ODR_ODR2                 STM8_FIELD(0x500a, 2, 1)
+#define PC_ODR_ODR3                 STM8_FIELD(0x500a, 3, 1)
+#define PC_ODR_ODR4                 STM8_FIELD(0x500a, 4, 1)
+#define PC_ODR_ODR5                 STM8_FIELD(0x500a, 5, 1)
+#define PC_ODR_ODR6                 STM8_FIELD(0x500a, 6, 1)
+#define PC_ODR_ODR7                 STM8_FIELD(0x500a, 7, 1)
+#define PC_IDR                      STM8_REGISTER(0x500b)
+#define PC_IDR_IDR0                 STM8_FIELD(0x500b, 0, 1)
+#define PC_IDR_IDR1                 STM8_FIELD(0x500b, 1, 1)
+#define PC_IDR_IDR2                 STM8_FIELD(0x500b, 2, 1)
+#define PC_IDR_IDR3                 STM8_FIELD(0x500b, 3, 1)
+#define PC_IDR_IDR4                 STM8_FIELD(0x500b, 4, 1)
+#define PC_IDR_IDR5                 STM8_FIELD(0x500b, 5, 1)
+#define PC_IDR_IDR6                 STM8_FIELD(0x500b, 6, 1)
+#define PC_IDR_IDR7                 STM8_FIELD(0x500b, 7, 1)
+#define PC_DDR                      STM8_REGISTER(0x500c)
+#define PC_DDR_DDR0                 STM8_FIELD(0x500c, 0, 1)
+#define PC_DDR_DDR1                 STM8_FIELD(0x500c, 1, 1)
+#define PC_DDR_DDR2                 STM8_FIELD(0x500c, 2, 1)
+#define PC_DDR_DDR3                 STM8_FIELD(0x500c, 3, 1)
+#define PC_DDR_DDR4                 STM8_FIELD(0x500c, 4, 1)
+#define PC_DDR_DDR5                 STM8_FIELD(0x500c, 5, 1)
+#define PC_DDR_DDR6                 STM8_FIELD(0x500c, 6, 1)
+#define PC_DDR_DDR7                 STM8_FIELD(0x500c, 7, 1)
+#define PC_CR1                      STM8_REGISTER(0x500d)
+#define PC_CR1_C10                  STM8_FIELD(0x500d, 0, 1)
+#define PC_CR1_C11                  STM8_FIELD(0x500d, 1, 1)
+#define PC_CR1_C12                  STM8_FIELD(0x500d, 2, 1)
+#define PC_CR1_C13                  STM8_FIELD(0x500d, 3, 1)
+#define PC_CR1_C14                  STM8_FIELD(0x500d, 4, 1)
+#define PC_CR1_C15                  STM8_FIELD(0x500d, 5, 1)
+#define PC_CR1_C16                  STM8_FIELD(0x500d, 6, 1)
+#define PC_CR1_C17                  STM8_FIELD(0x500d, 7, 1)
+#define PC_CR2                      STM8_REGISTER(0x500e)
+#define PC_CR2_C20                  STM8_FIELD(0x500e, 0, 1)
+#define PC_CR2_C21                  STM8_FIELD(0x500e, 1, 1)
+#define PC_CR2_C22                  STM8_FIELD(0x500e, 2, 1)
+#define PC_CR2_C23                  STM8_FIELD(0x500e, 3, 1)
+#define PC_CR2_C24                  STM8_FIELD(0x500e, 4, 1)
+#define PC_CR2_C25                  STM8_FIELD(0x500e, 5, 1)
+#define PC_CR2_C26                  STM8_FIELD(0x500e, 6, 1)
+#define PC_CR2_C27                  STM8_FIELD(0x500e, 7, 1)
+#define PD_ODR                      STM8_REGISTER(0x500f)
+#define PD_ODR_ODR0                 STM8_FIELD(0x500f, 0, 1)
+#define PD_ODR_ODR1                 STM8_FIELD(0x500f, 1, 1)
+#define PD_ODR_ODR2                 STM8_FIELD(0x500f, 2, 1)
+#define PD_ODR_ODR3                 STM8_FIELD(0x500f, 3, 1)
+#define PD_ODR_ODR4                 STM8_FIELD(0x500f, 4, 1)
+#define PD_ODR_ODR5                 STM8_FIELD(0x500f, 5, 1)
+#define PD_ODR_ODR6                 STM8_FIELD(0x500f, 6, 1)
+#define PD_ODR_ODR7                 STM8_FIELD(0x500f, 7, 1)
+#define PD_IDR                      STM8_REGISTER(0x5010)
+#define PD_IDR_IDR0                 STM8_FIELD(0x5010, 0, 1)
+#define PD_IDR_IDR1                 STM8_FIELD(0x5010, 1, 1)
+#define PD_IDR_IDR2                 STM8_FIELD(0x5010, 2, 1)
+#define PD_IDR_IDR3                 STM8_FIELD(0x5010, 3, 1)
+#define PD_IDR_IDR4                 STM8_FIELD(0x5010, 4, 1)
+#define PD_IDR_IDR5                 STM8_FIELD(0x5010, 5, 1)
+#define PD_IDR_IDR6                 STM8_FIELD(0x5010, 6, 1)
+#define PD_IDR_IDR7                 STM8_FIELD(0x5010, 7, 1)
+#define PD_DDR                      STM8_REGISTER(0x5011)
+#define PD_DDR_DDR0                 STM8_FIELD(0x5011, 0, 1)
+#define PD_DDR_DDR1                 STM8_FIELD(0x5011, 1, 1)
+#define PD_DDR_DDR2                 STM8_FIELD(0x5011, 2, 1)
+#define PD_DDR_DDR3                 STM8_FIELD(0x5011, 3, 1)
+#define PD_DDR_DDR4                 STM8_FIELD(0x5011, 4, 1)
+#define PD_DDR_DDR5                 STM8_FIELD(0x5011, 5, 1)
+#define PD_DDR_DDR6                 STM8_FIELD(0x5011, 6, 1)
+#define PD_DDR_DDR7                 STM8_FIELD(0x5011, 7, 1)
+#define PD_CR1                      STM8_REGISTER(0x5012)
+#define PD_CR1_C10                  STM8_FIELD(0x5012, 0, 1)
+#define PD_CR1_C11                  STM8_FIELD(0x5012, 1, 1)
+#define PD_CR1_C12                  STM8_FIELD(0x5012, 2, 1)
+#define PD_CR1_C13                  STM8_FIELD(0x5012, 3, 1)
+#define PD_CR1_C14                  STM8_FIELD(0x5012, 4, 1)
+#define PD_CR1_C15                  STM8_FIELD(0x5012, 5, 1)
+#define PD_CR1_C16                  STM8_FIELD(0x5012, 6, 1)
+#define PD_CR1_C17                  STM8_FIELD(0x5012, 7, 1)
+#define PD_CR2                      STM8_REGISTER(0x5013)
+#define PD_CR2_C20                  STM8_FIELD(0x5013, 0, 1)
+#define PD_CR2_C21                  STM8_FIELD(0x5013, 1, 1)
+#define PD_CR2_C22                  STM8_FIELD(0x5013, 2, 1)
+#define PD_CR2_C23                  STM8_FIELD(0x5013, 3, 1)
+#define PD_CR2_C24                  STM8_FIELD(0x5013, 4, 1)
+#define PD_CR2_C25                  STM8_FIELD(0x5013, 5, 1)
+#define PD_CR2_C26                  STM8_FIELD(0x5013, 6, 1)
+#define PD_CR2_C27                  STM8_FIELD(0x5013, 7, 1)
+#define PE_ODR                      STM8_REGISTER(0x5014)
+#define PE_ODR_ODR0                 STM8_FIELD(0x5014, 0, 1)
+#define PE_ODR_ODR1                 STM8_FIELD(0x5014, 1, 1)
+#define PE_ODR_ODR2                 STM8_FIELD(0x5014, 2, 1)
+#define PE_ODR_ODR3                 STM8_FIELD(0x5014, 3, 1)
+#define PE_ODR_ODR4                 STM8_FIELD(0x5014, 4, 1)
+#define PE_ODR_ODR5                 STM8_FIELD(0x5014, 5, 1)
+#define PE_ODR_ODR6                 STM8_FIELD(0x5014, 6, 1)
+#define PE_ODR_ODR7                 STM8_FIELD(0x5014, 7, 1)
+#define PE_IDR                      STM8_REGISTER(0x5015)
+#define PE_IDR_IDR0                 STM8_FIELD(0x5015, 0, 1)
+#define PE_IDR_IDR1                 STM8_FIELD(0x5015, 1, 1)
+#define PE_IDR_IDR2                 STM8_FIELD(0x5015, 2, 1)
+#define PE_IDR_IDR3                 STM8_FIELD(0x5015, 3, 1)
+#define PE_IDR_IDR4                 STM8_FIELD(0x5015, 4, 1)
+#define PE_IDR_IDR5                 STM8_FIELD(0x5015, 5, 1)
+#define PE_IDR_IDR6                 STM8_FIELD(0x5015, 6, 1)
+#define PE_IDR_IDR7                 STM8_FIELD(0x5015, 7, 1)
+#define PE_DDR                      STM8_REGISTER(0x5016)
+#define PE_DDR_DDR0                 STM8_FIELD(0x5016, 0, 1)
+#define PE_DDR_DDR1                 STM8_FIELD(0x5016, 1, 1)
+#define PE_DDR_DDR2                 STM8_FIELD(0x5016, 2, 1)
+#define PE_DDR_DDR3                 STM8_FIELD(0x5016, 3, 1)
+#define PE_DDR_DDR4                 STM8_FIELD(0x5016, 4, 1)
+#define PE_DDR_DDR5                 STM8_FIELD(0x5016, 5, 1)
+#define PE_DDR_DDR6                 STM8_FIELD(0x5016, 6, 1)
+#define PE_DDR_DDR7                 STM8_FIELD(0x5016, 7, 1)
+#define PE_CR1                      STM8_REGISTER(0x5017)
+#define PE_CR1_C10                  STM8_FIELD(0x5017, 0, 1)
+#define PE_CR1_C11                  STM8_FIELD(0x5017, 1, 1)
+#define PE_CR1_C12                  STM8_FIELD(0x5017, 2, 1)
+#define PE_CR1_C13                  STM8_FIELD(0x5017, 3, 1)
+#define PE_CR1_C14                  STM8_FIELD(0x5017, 4, 1)
+#define PE_CR1_C15                  STM8_FIELD(0x5017, 5, 1)
+#define PE_CR1_C16                  STM8_FIELD(0x5017, 6, 1)
+#define PE_CR1_C17                  STM8_FIELD(0x5017, 7, 1)
+#define PE_CR2                      STM8_REGISTER(0x5018)
+#define PE_CR2_C20                  STM8_FIELD(0x5018, 0, 1)
+#define PE_CR2_C21                  STM8_FIELD(0x5018, 1, 1)
+#define PE_CR2_C22                  STM8_FIELD(0x5018, 2, 1)
+#define PE_CR2_C23                  STM8_FIELD(0x5018, 3, 1)
+#define PE_CR2_C24                  STM8_FIELD(0x5018, 4, 1)
+#define PE_CR2_C25                  STM8_FIELD(0x5018, 5, 1)
+#define PE_CR2_C26                  STM8_FIELD(0x5018, 6, 1)
+#define PE_CR2_C27                  STM8_FIELD(0x5018, 7, 1)
+#define PF_ODR                      STM8_REGISTER(0x5019)
+#define PF_ODR_ODR0                 STM8_FIELD(0x5019, 0, 1)
+#define PF_ODR_ODR1                 STM8_FIELD(0x5019, 1, 1)
+#define PF_ODR_ODR2                 STM8_FIELD(0x5019, 2, 1)
+#define PF_ODR_ODR3                 STM8_FIELD(0x5019, 3, 1)
+#define PF_ODR_ODR4                 STM8_FIELD(0x5019, 4, 1)
+#define PF_ODR_ODR5                 STM8_FIELD(0x5019, 5, 1)
+#define PF_ODR_ODR6                 STM8_FIELD(0x5019, 6, 1)
+#define PF_ODR_ODR7                 STM8_FIELD(0x5019, 7, 1)
+#define PF_IDR                      STM8_REGISTER(0x501a)
+#define PF_IDR_IDR0                 STM8_FIELD(0x501a, 0, 1)
+#define PF_IDR_IDR1                 STM8_FIELD(0x501a, 1, 1)
+#define PF_IDR_IDR2                 STM8_FIELD(0x501a, 2, 1)
+#define PF_IDR_IDR3                 STM8_FIELD(0x501a, 3, 1)
+#define PF_IDR_IDR4                 STM8_FIELD(0x501a, 4, 1)
+#define PF_IDR_IDR5                 STM8_FIELD(0x501a, 5, 1)
+#define PF_IDR_IDR6                 STM8_FIELD(0x501a, 6, 1)
+#define PF_IDR_IDR7                 STM8_FIELD(0x501a, 7, 1)
+#define PF_DDR                      STM8_REGISTER(0x501b)
+#define PF_DDR_DDR0                 STM8_FIELD(0x501b, 0, 1)
+#define PF_DDR_DDR1                 STM8_FIELD(0x501b, 1, 1)
+#define PF_DDR_DDR2                 STM8_FIELD(0x501b, 2, 1)
+#define PF_DDR_DDR3                 STM8_FIELD(0x501b, 3, 1)
+#define PF_DDR_DDR4                 STM8_FIELD(0x501b, 4, 1)
+#define PF_DDR_DDR5                 STM8_FIELD(0x501b, 5, 1)
+#define PF_DDR_DDR6                 STM8_FIELD(0x501b, 6, 1)
+#define PF_DDR_DDR7                 STM8_FIELD(0x501b, 7, 1)
+#define PF_CR1                      STM8_REGISTER(0x501c)
+#define PF_CR1_C10                  STM8_FIELD(0x501c, 0, 1)
+#define PF_CR1_C11                  STM8_FIELD(0x501c, 1, 1)
+#define PF_CR1_C12                  STM8_FIELD(0x501c, 2, 1)
+#define PF_CR1_C13                  STM8_FIELD(0x501c, 3, 1)
+#define PF_CR1_C14                  STM8_FIELD(0x501c, 4, 1)
+#define PF_CR1_C15                  STM8_FIELD(0x501c, 5, 1)
+#define PF_CR1_C16                  STM8_FIELD(0x501c, 6, 1)
+#define PF_CR1_C17                  STM8_FIELD(0x501c, 7, 1)
+#define PF_CR2                      STM8_REGISTER(0x501d)
+#define PF_CR2_C20                  STM8_FIELD(0x501d, 0, 1)
+#define PF_CR2_C21                  STM8_FIELD(0x501d, 1, 1)
+#define PF_CR2_C22                  STM8_FIELD(0x501d, 2, 1)
+#define PF_CR2_C23                  STM8_FIELD(0x501d, 3, 1)
+#define PF_CR2_C24                  STM8_FIELD(0x501d, 4, 1)
+#define PF_CR2_C25                  STM8_FIELD(0x501d, 5, 1)
+#define PF_CR2_C26                  STM8_FIELD(0x501d, 6, 1)
+#define PF_CR2_C27                  STM8_FIELD(0x501d, 7, 1)
+
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  Flash and data EEPROM.
+//
+#define FLASH_CR1                   STM8_REGISTER(0x505a)
+#define FLASH_CR1_FIX               STM8_FIELD(0x505a, 0, 1)
+#define FLASH_CR1_IE                STM8_FIELD(0x505a, 1, 1)
+#define FLASH_CR1_AHALT             STM8_FIELD(0x505a, 2, 1)
+#define FLASH_CR1_HALT              STM8_FIELD(0x505a, 3, 1)
+#define FLASH_CR2                   STM8_REGISTER(0x505b)
+#define FLASH_CR2_PRG               STM8_FIELD(0x505b, 0, 1)
+#define FLASH_CR2_FPRG              STM8_FIELD(0x505b, 4, 1)
+#define FLASH_CR2_ERASE             STM8_FIELD(0x505b, 5, 1)
+#define FLASH_CR2_WPRG              STM8_FIELD(0x505b, 6, 1)
+#define FLASH_CR2_OPT               STM8_FIELD(0x505b, 7, 1)
+#define FLASH_NCR2                  STM8_REGISTER(0x505c)
+#define FLASH_NCR2_NPRG             STM8_FIELD(0x505c, 0, 1)
+#define FLASH_NCR2_NFPRG            STM8_FIELD(0x505c, 4, 1)
+#define FLASH_NCR2_NERASE           STM8_FIELD(0x505c, 5, 1)
+#define FLASH_NCR2_NWPRG            STM8_FIELD(0x505c, 6, 1)
+#define FLASH_NCR2_NOPT             STM8_FIELD(0x505c, 7, 1)
+#define FLASH_FPR                   STM8_REGISTER(0x505d)
+#define FLASH_FPR_WPB               STM8_FIELD(0x505d, 0, 6)
+#define FLASH_NFPR                  STM8_REGISTER(0x505e)
+#define FLASH_NFPR_NWPB             STM8_FIELD(0x505e, 0, 6)
+#define FLASH_IAPSR                 STM8_REGISTER(0x505f)
+#define FLASH_IAPSR_WR_PG_DIS       STM8_FIELD(0x505f, 0, 1)
+#define FLASH_IAPSR_PUL             STM8_FIELD(0x505f, 1, 1)
+#define FLASH_IAPSR_EOP             STM8_FIELD(0x505f, 2, 1)
+#define FLASH_IAPSR_DUL             STM8_FIELD(0x505f, 3, 1)
+#define FLASH_IAPSR_HVOFF           STM8_FIELD(0x505f, 6, 1)
+#define FLASH_PUKR                  STM8_REGISTER(0x5062)
+#define FLASH_DUKR                  STM8_REGISTER(0x5064)
+
+//
+//  External interrupt controller.
+//
+#define EXTI_CR1                    STM8_REGISTER(0x50a0)
+#define EXTI_CR1_PAIS               STM8_FIELD(0x50a0, 0, 2)
+#define EXTI_CR1_PBIS               STM8_FIELD(0x50a0, 2, 2)
+#define EXTI_CR1_PCIS               STM8_FIELD(0x50a0, 4, 2)
+#define EXTI_CR1_PDIS               STM8_FIELD(0x50a0, 6, 2)
+#define EXTI_CR2                    STM8_REGISTER(0x50a1)
+#define EXTI_CR2_PEIS               STM8_FIELD(0x50a1, 0, 2)
+#define EXTI_CR2_TLIS               STM8_FIELD(0x50a1, 2, 1)
+
+//
+//  Reset status.
+//
+#define RST_SR                      STM8_REGISTER(0x50b3)
+#define RST_SR_WWDGF                STM8_FIELD(0x50b3, 0, 1)
+#define RST_SR_IWDGF                STM8_FIELD(0x50b3, 1, 1)
+#define RST_SR_ILLOPF               STM8_FIELD(0x50b3, 2, 1)
+#define RST_SR_SWIMF                STM8_FIELD(0x50b3, 3, 1)
+#define RST_SR_EMCVRF               STM8_FIELD(0x50b3, 4, 1)
+
+//
+//  Clock control.
+//
+#define CLK_ICKR                    STM8_REGISTER(0x50c0)
+#define CLK_ICKR_HSIEN              STM8_FIELD(0x50c0, 0, 1)
+#define CLK_ICKR_HSIRDY             STM8_FIELD(0x50c0, 1, 1)
+#define CLK_ICKR_FHW                STM8_FIELD(0x50c0, 2, 1)
+#define CLK_ICKR_LSIEN              STM8_FIELD(0x50c0, 3, 1)
+#define CLK_ICKR_LSIRDY             STM8_FIELD(0x50c0, 4, 1)
+#define CLK_ICKR_REGAH              STM8_FIELD(0x50c0, 5, 1)
+#define CLK_ECKR                    STM8_REGISTER(0x50c1)
+#define CLK_ECKR_HSEEN              STM8_FIELD(0x50c1, 0, 1)
+#define CLK_ECKR_HSERDY             STM8_FIELD(0x50c1, 1, 1)
+#define CLK_CMSR                    STM8_REGISTER(0x50c3)
+#define CLK_CMSR_CKM                STM8_FIELD(0x50c3, 0, 8)
+#define CLK_SWR                     STM8_REGISTER(0x50c4)
+#define CLK_SWR_SWI                 STM8_FIELD(0x50c4, 0, 8)
+#define CLK_SWCR                    STM8_REGISTER(0x50c5)
+#define CLK_SWCR_SWBSY              STM8_FIELD(0x50c5, 0, 1)
+#define CLK_SWCR_SWEN               STM8_FIELD(0x50c5, 1, 1)
+#define CLK_SWCR_SWIEN              STM8_FIELD(0x50c5, 2, 1)
+#define CLK_SWCR_SWIF               STM8_FIELD(0x50c5, 3, 1)
+#define CLK_CKDIVR                  STM8_REGISTER(0x50c6)
+#define CLK_CKDIVR_CPUDIV           STM8_FIELD(0x50c6, 0, 3)
+#define CLK_CKDIVR_HSIDIV           STM8_FIELD(0x50c6, 3, 2)
+#define CLK_PCKENR1                 STM8_REGISTER(0x50c7)
+#define CLK_PCKENR1_PCKEN10         STM8_FIELD(0x50c7, 0, 1)
+#define CLK_PCKENR1_PCKEN11         STM8_FIELD(0x50c7, 1, 1)
+#define CLK_PCKENR1_PCKEN12         STM8_FIELD(0x50c7, 2, 1)
+#define CLK_PCKENR1_PCKEN13         STM8_FIELD(0x50c7, 3, 1)
+#define CLK_PCKENR1_PCKEN14         STM8_FIELD(0x50c7, 4, 1)
+#define CLK_PCKENR1_PCKEN15         STM8_FIELD(0x50c7, 5, 1)
+#define CLK_PCKENR1_PCKEN16         STM8_FIELD(0x50c7, 6, 1)
+#define CLK_PCKENR1_PCKEN17         STM8_FIELD(0x50c7, 7, 1)
+#define CLK_CSSR                    STM8_REGISTER(0x50c8)
+#define CLK_CSSR_CSSEN              STM8_FIELD(0x50c8, 0, 1)
+#define CLK_CSSR_AUX                STM8_FIELD(0x50c8, 1, 1)
+#define CLK_CSSR_CSSDIE             STM8_FIELD(0x50c8, 2, 1)
+#define CLK_CSSR_CSSD               STM8_FIELD(0x50c8, 3, 1)
+#define CLK_CCOR                    STM8_REGISTER(0x50c9)
+#define CLK_CCOR_CCOEN              STM8_FIELD(0x50c9, 0, 1)
+#define CLK_CCOR_CCOSEL             STM8_FIELD(0x50c9, 1, 4)
+#define CLK_CCOR_CCORDY             STM8_FIELD(0x50c9, 5, 1)
+#define CLK_CCOR_CCOBSY             STM8_FIELD(0x50c9, 6, 1)
+#define CLK_PCKENR2                 STM8_REGISTER(0x50ca)
+#define CLK_PCKENR2_PCKEN20         STM8_FIELD(0x50ca, 0, 1)
+#define CLK_PCKENR2_PCKEN21         STM8_FIELD(0x50ca, 1, 1)
+#define CLK_PCKENR2_PCKEN22         STM8_FIELD(0x50ca, 2, 1)
+#define CLK_PCKENR2_PCKEN23         STM8_FIELD(0x50ca, 3, 1)
+#define CLK_PCKENR2_PCKEN24         STM8_FIELD(0x50ca, 4, 1)
+#define CLK_PCKENR2_PCKEN25         STM8_FIELD(0x50ca, 5, 1)
+#define CLK_PCKENR2_PCKEN26         STM8_FIELD(0x50ca, 6, 1)
+#define CLK_PCKENR2_PCKEN27         STM8_FIELD(0x50ca, 7, 1)
+#define CLK_HSITRIMR                STM8_REGISTER(0x50cc)
+#define CLK_HSITRIMR_HSITRIM        STM8_FIELD(0x50cc, 0, 4)
+#define CLK_SWIMCCR                 STM8_REGISTER(0x50cd)
+#define CLK_SWIMCCR_SWIMCLK         STM8_FIELD(0x50cd, 0, 1)
+
+//
+//  Window and independent watchdogs.
+//
+#define WWDG_CR                     STM8_REGISTER(0x50d1)
+#define WWDG_CR_T                   STM8_FIELD(0x50d1, 0, 7)
+#define WWDG_CR_WDGA                STM8_FIELD(0x50d1, 7, 1)
+#define WWDG_WR                     STM8_REGISTER(0x50d2)
+#define WWDG_WR_W                   STM8_FIELD(0x50d2, 0, 7)
+#define IWDG_KR                     STM8_REGISTER(0x50e0)
+#define IWDG_PR                     STM8_REGISTER(0x50e1)
+#define IWDG_PR_PR                  STM8_FIELD(0x50e1, 0, 3)
+#define IWDG_RLR                    STM8_REGISTER(0x50e2)
+
+//
+//  Auto-wakeup and beeper.
+//
+#define AWU_CSR1                    STM8_REGISTER(0x50f0)
+#define AWU_CSR1_MSR                STM8_FIELD(0x50f0, 0, 1)
+#define AWU_CSR1_AWUEN              STM8_FIELD(0x50f0, 4, 1)
+#define AWU_CSR1_AWUF               STM8_FIELD(0x50f0, 5, 1)
+#define AWU_APR                     STM8_REGISTER(0x50f1)
+#define AWU_APR_APR                 STM8_FIELD(0x50f1, 0, 6)
+#define AWU_TBR                     STM8_REGISTER(0x50f2)
+#define AWU_TBR_AWUTB               STM8_FIELD(0x50f2, 0, 4)
+#define BEEP_CSR                    STM8_REGISTER(0x50f3)
+#define BEEP_CSR_BEEPDIV            STM8_FIELD(0x50f3, 0, 5)
+#define BEEP_CSR_BEEPEN             STM8_FIELD(0x50f3, 5, 1)
+#define BEEP_CSR_BEEPSEL            STM8_FIELD(0x50f3, 6, 2)
+
+//
+//  SPI.
+//
+#define SPI_CR1                     STM8_REGISTER(0x5200)
+#define SPI_CR1_CPHA                STM8_FIELD(0x5200, 0, 1)
+#define SPI_CR1_CPOL                STM8_FIELD(0x5200, 1, 1)
+#define SPI_CR1_MSTR                STM8_FIELD(0x5200, 2, 1)
+#define SPI_CR1_BR                  STM8_FIELD(0x5200, 3, 3)
+#define SPI_CR1_SPE                 STM8_FIELD(0x5200, 6, 1)
+#define SPI_CR1_LSBFIRST            STM8_FIELD(0x5200, 7, 1)
+#define SPI_CR2                     STM8_REGISTER(0x5201)
+#define SPI_CR2_SSI                 STM8_FIELD(0x5201, 0, 1)
+#define SPI_CR2_SSM                 STM8_FIELD(0x5201, 1, 1)
+#define SPI_CR2_RXONLY              STM8_FIELD(0x5201, 2, 1)
+#define SPI_CR2_CRCNEXT             STM8_FIELD(0x5201, 4, 1)
+#define SPI_CR2_CECEN               STM8_FIELD(0x5201, 5, 1)
+#define SPI_CR2_CRCEN               STM8_FIELD(0x5201, 5, 1)
+#define SPI_CR2_BDOE                STM8_FIELD(0x5201, 6, 1)
+#define SPI_CR2_BDM                 STM8_FIELD(0x5201, 7, 1)
+#define SPI_ICR                     STM8_REGISTER(0x5202)
+#define SPI_ICR_WKIE                STM8_FIELD(0x5202, 4, 1)
+#define SPI_ICR_ERRIE               STM8_FIELD(0x5202, 5, 1)
+#define SPI_ICR_RXIE                STM8_FIELD(0x5202, 6, 1)
+#define SPI_ICR_TXIE                STM8_FIELD(0x5202, 7, 1)
+#define SPI_SR                      STM8_REGISTER(0x5203)
+#define SPI_SR_RXNE                 STM8_FIELD(0x5203, 0, 1)
+#define SPI_SR_TXE                  STM8_FIELD(0x5203, 1, 1)
+#define SPI_SR_WKUP                 STM8_FIELD(0x5203, 3, 1)
+#define SPI_SR_CRCERR               STM8_FIELD(0x5203, 4, 1)
+#define SPI_SR_MODF                 STM8_FIELD(0x5203, 5, 1)
+#define SPI_SR_OVR                  STM8_FIELD(0x5203, 6, 1)
+#define SPI_SR_BSY                  STM8_FIELD(0x5203, 7, 1)
+#define SPI_DR                      STM8_REGISTER(0x5204)
+#define SPI_CRCPR                   STM8_REGISTER(0x5205)
+#define SPI_RXCRCR                  STM8_REGISTER(0x5206)
+#define SPI_TXCRCR                  STM8_REGISTER(0x5207)
+
+//
+//  I2C.
+//
+#define I2C_CR1                     STM8_REGISTER(0x5210)
+#define I2C_CR1_PE                  STM8_FIELD(0x5210, 0, 1)
+#define I2C_CR1_ENGC                STM8_FIELD(0x5210, 6, 1)
+#define I2C_CR1_NOSTRETCH           STM8_FIELD(0x5210, 7, 1)
+#define I2C_CR2                     STM8_REGISTER(0x5211)
+#define I2C_CR2_START               STM8_FIELD(0x5211, 0, 1)
+#define I2C_CR2_STOP                STM8_FIELD(0x5211, 1, 1)
+#define I2C_CR2_ACK                 STM8_FIELD(0x5211, 2, 1)
+#define I2C_CR2_POS                 STM8_FIELD(0x5211, 3, 1)
+#define I2C_CR2_SWRST               STM8_FIELD(0x5211, 7, 1)
+#define I2C_FREQR                   STM8_REGISTER(0x5212)
+#define I2C_FREQR_FREQ              STM8_FIELD(0x5212, 0, 6)
+#define I2C_OARL                    STM8_REGISTER(0x5213)
+#define I2C_OARL_ADD0               STM8_FIELD(0x5213, 0, 1)
+#define I2C_OARL_ADD                STM8_FIELD(0x5213, 1, 7)
+#define I2C_OARH                    STM8_REGISTER(0x5214)
+#define I2C_OARH_ADD                STM8_FIELD(0x5214, 1, 2)
+#define I2C_OARH_ADDCONF            STM8_FIELD(0x5214, 6, 1)
+#define I2C_OARH_ADDMODE            STM8_FIELD(0x5214, 7, 1)
+#define I2C_DR                      STM8_REGISTER(0x5216)
+#define I2C_SR1                     STM8_REGISTER(0x5217)
+#define I2C_SR1_SB                  STM8_FIELD(0x5217, 0, 1)
+#define I2C_SR1_ADDR                STM8_FIELD(0x5217, 1, 1)
+#define I2C_SR1_BTF                 STM8_FIELD(0x5217, 2, 1)
+#define I2C_SR1_ADD10               STM8_FIELD(0x5217, 3, 1)
+#define I2C_SR1_STOPF               STM8_FIELD(0x5217, 4, 1)
+#define I2C_SR1_RXNE                STM8_FIELD(0x5217, 6, 1)
+#define I2C_SR1_TXE                 STM8_FIELD(0x5217, 7, 1)
+#define I2C_SR2                     STM8_REGISTER(0x5218)
+#define I2C_SR2_BERR                STM8_FIELD(0x5218, 0, 1)
+#define I2C_SR2_ARLO                STM8_FIELD(0x5218, 1, 1)
+#define I2C_SR2_AF                  STM8_FIELD(0x5218, 2, 1)
+#define I2C_SR2_OVR                 STM8_FIELD(0x5218, 3, 1)
+#define I2C_SR2_WUFH                STM8_FIELD(0x5218, 5, 1)
+#define I2C_SR3                     STM8_REGISTER(0x5219)
+#define I2C_SR3_MSL                 STM8_FIELD(0x5219, 0, 1)
+#define I2C_SR3_BUSY                STM8_FIELD(0x5219, 1, 1)
+#define I2C_SR3_TRA                 STM8_FIELD(0x5219, 2, 1)
+#define I2C_SR3_GENCALL             STM8_FIELD(0x5219, 4, 1)
+#define I2C_SR3_DUALF               STM8_FIELD(0x5219, 7, 1)
+#define I2C_ITR                     STM8_REGISTER(0x521a)
+#define I2C_ITR_ITERREN             STM8_FIELD(0x521a, 0, 1)
+#define I2C_ITR_ITEVTEN             STM8_FIELD(0x521a, 1, 1)
+#define I2C_ITR_ITBUFEN             STM8_FIELD(0x521a, 2, 1)
+#define I2C_CCRL                    STM8_REGISTER(0x521b)
+#define I2C_CCRL_CCR                STM8_FIELD(0x521b, 0, 8)
+#define I2C_CCRH                    STM8_REGISTER(0x521c)
+#define I2C_CCRH_CCR                STM8_FIELD(0x521c, 0, 4)
+#define I2C_CCRH_DUTY               STM8_FIELD(0x521c, 6, 1)
+#define I2C_CCRH_F_S                STM8_FIELD(0x521c, 7, 1)
+#define I2C_TRISER                  STM8_REGISTER(0x521d)
+#define I2C_TRISER_TRISE            STM8_FIELD(0x521d, 0, 6)
+#define I2C_PECR                    STM8_REGISTER(0x521e)
+
+//--------------------------------------------------------------------------------
+#if defined(STM8_HOST_MEDIUM_DENSITY)
+
+//
+//  UART2.
+//
+#define UART2_SR                    STM8_REGISTER(0x5240)
+#define UART2_SR_PE                 STM8_FIELD(0x5240, 0, 1)
+#define UART2_SR_FE                 STM8_FIELD(0x5240, 1, 1)
+#define UART2_SR_NF                 STM8_FIELD(0x5240, 2, 1)
+#define UART2_SR_OR                 STM8_FIELD(0x5240, 3, 1)
+#define UART2_SR_IDLE               STM8_FIELD(0x5240, 4, 1)
+#define UART2_SR_RXNE               STM8_FIELD(0x5240, 5, 1)
+#define UART2_SR_TC                 STM8_FIELD(0x5240, 6, 1)
+#define UART2_SR_TXE                STM8_FIELD(0x5240, 7, 1)
+#define UART2_DR                    STM8_REGISTER(0x5241)
+#define UART2_BRR1                  STM8_REGISTER(0x5242)
+#define UART2_BRR2                  STM8_REGISTER(0x5243)
+#define UART2_CR1                   STM8_REGISTER(0x5244)
+#define UART2_CR1_PIEN              STM8_FIELD(0x5244, 0, 1)
+#define UART2_CR1_PS                STM8_FIELD(0x5244, 1, 1)
+#define UART2_CR1_PCEN              STM8_FIELD(0x5244, 2, 1)
+#define UART2_CR1_WAKE              STM8_FIELD(0x5244, 3, 1)
+#define UART2_CR1_M                 STM8_FIELD(0x5244, 4, 1)
+#define UART2_CR1_UARTD             STM8_FIELD(0x5244, 5, 1)
+#define UART2_CR1_T8                STM8_FIELD(0x5244, 6, 1)
+#define UART2_CR1_R8                STM8_FIELD(0x5244, 7, 1)
+#define UART2_CR2                   STM8_REGISTER(0x5245)
+#define UART2_CR2_SBK               STM8_FIELD(0x5245, 0, 1)
+#define UART2_CR2_RWU               STM8_FIELD(0x5245, 1, 1)
+#define UART2_CR2_REN               STM8_FIELD(0x5245, 2, 1)
+#define UART2_CR2_TEN               STM8_FIELD(0x5245, 3, 1)
+#define UART2_CR2_ILIEN             STM8_FIELD(0x5245, 4, 1)
+#define UART2_CR2_RIEN              STM8_FIELD(0x5245, 5, 1)
+#define UART2_CR2_TCIEN             STM8_FIELD(0x5245, 6, 1)
+#define UART2_CR2_TIEN              STM8_FIELD(0x5245, 7, 1)
+#define UART2_CR3                   STM8_REGISTER(0x5246)
+#define UART2_CR3_LBCL              STM8_FIELD(0x5246, 0, 1)
+#define UART2_CR3_CPHA              STM8_FIELD(0x5246, 1, 1)
+#define UART2_CR3_CPOL              STM8_FIELD(0x5246, 2, 1)
+#define UART2_CR3_CKEN              STM8_FIELD(0x5246, 3, 1)
+#define UART2_CR3_STOP              STM8_FIELD(0x5246, 4, 2)
+#define UART2_CR3_LINEN             STM8_FIELD(0x5246, 6, 1)
+#define UART2_CR4                   STM8_REGISTER(0x5247)
+#define UART2_CR4_ADD               STM8_FIELD(0x5247, 0, 4)
+#define UART2_CR4_LBDF              STM8_FIELD(0x5247, 4, 1)
+#define UART2_CR4_LBDL              STM8_FIELD(0x5247, 5, 1)
+#define UART2_CR4_LBDIEN            STM8_FIELD(0x5247, 6, 1)
+#define UART2_CR5                   STM8_REGISTER(0x5248)
+#define UART2_CR5_IREN              STM8_FIELD(0x5248, 1, 1)
+#define UART2_CR5_IRLP              STM8_FIELD(0x5248, 2, 1)
+#define UART2_CR5_HDSEL             STM8_FIELD(0x5248, 3, 1)
+#define UART2_CR5_NACK              STM8_FIELD(0x5248, 4, 1)
+#define UART2_CR5_SCEN              STM8_FIELD(0x5248, 5, 1)
+#define UART2_CR6                   STM8_REGISTER(0x5249)
+#define UART2_CR6_LSF               STM8_FIELD(0x5249, 0, 1)
+#define UART2_CR6_LHDF              STM8_FIELD(0x5249, 1, 1)
+#define UART2_CR6_LHDIEN            STM8_FIELD(0x5249, 2, 1)
+#define UART2_CR6_LASE              STM8_FIELD(0x5249, 4, 1)
+#define UART2_CR6_LSLV              STM8_FIELD(0x5249, 5, 1)
+#define UART2_CR6_LDUM              STM8_FIELD(0x5249, 7, 1)
+#define UART2_GTR                   STM8_REGISTER(0x524a)
+#define UART2_PSCR                  STM8_REGISTER(0x524b)
+
+#else
+
+//
+//  UART1.
+//
+#define UART1_SR                    STM8_REGISTER(0x5230)
+#define UART1_SR_PE                 STM8_FIELD(0x5230, 0, 1)
+#define UART1_SR_FE                 STM8_FIELD(0x5230, 1, 1)
+#define UART1_SR_NF                 STM8_FIELD(0x5230, 2, 1)
+#define UART1_SR_OR                 STM8_FIELD(0x5230, 3, 1)
+#define UART1_SR_IDLE               STM8_FIELD(0x5230, 4, 1)
+#define UART1_SR_RXNE               STM8_FIELD(0x5230, 5, 1)
+#define UART1_SR_TC                 STM8_FIELD(0x5230, 6, 1)
+#define UART1_SR_TXE                STM8_FIELD(0x5230, 7, 1)
+#define UART1_DR                    STM8_REGISTER(0x5231)
+#define UART1_BRR1                  STM8_REGISTER(0x5232)
+#define UART1_BRR2                  STM8_REGISTER(0x5233)
+#define UART1_CR1                   STM8_REGISTER(0x5234)
+#define UART1_CR1_PIEN              STM8_FIELD(0x5234, 0, 1)
+#define UART1_CR1_PS                STM8_FIELD(0x5234, 1, 1)
+#define UART1_CR1_PCEN              STM8_FIELD(0x5234, 2, 1)
+#define UART1_CR1_WAKE              STM8_FIELD(0x5234, 3, 1)
+#define UART1_CR1_M                 STM8_FIELD(0x5234, 4, 1)
+#define UART1_CR1_UARTD             STM8_FIELD(0x5234, 5, 1)
+#define UART1_CR1_T8                STM8_FIELD(0x5234, 6, 1)
+#define UART1_CR1_R8                STM8_FIELD(0x5234, 7, 1)
+#define UART1_CR2                   STM8_REGISTER(0x5235)
+#define UART1_CR2_SBK               STM8_FIELD(0x5235, 0, 1)
+#define UART1_CR2_RWU               STM8_FIELD(0x5235, 1, 1)
+#define UART1_CR2_REN               STM8_FIELD(0x5235, 2, 1)
+#define UART1_CR2_TEN               STM8_FIELD(0x5235, 3, 1)
+#define UART1_CR2_ILIEN             STM8_FIELD(0x5235, 4, 1)
+#define UART1_CR2_RIEN              STM8_FIELD(0x5235, 5, 1)
+#define UART1_CR2_TCIEN             STM8_FIELD(0x5235, 6, 1)
+#define UART1_CR2_TIEN              STM8_FIELD(0x5235, 7, 1)
+#define UART1_CR3                   STM8_REGISTER(0x5236)
+#define UART1_CR3_LBCL              STM8_FIELD(0x5236, 0, 1)
+#define UART1_CR3_CPHA              STM8_FIELD(0x5236, 1, 1)
+#define UART1_CR3_CPOL              STM8_FIELD(0x5236, 2, 1)
+#define UART1_CR3_CKEN              STM8_FIELD(0x5236, 3, 1)
+#define UART1_CR3_STOP              STM8_FIELD(0x5236, 4, 2)
+#define UART1_CR3_LINEN             STM8_FIELD(0x5236, 6, 1)
+#define UART1_CR4                   STM8_REGISTER(0x5237)
+#define UART1_CR4_ADD               STM8_FIELD(0x5237, 0, 4)
+#define UART1_CR4_LBDF              STM8_FIELD(0x5237, 4, 1)
+#define UART1_CR4_LBDL              STM8_FIELD(0x5237, 5, 1)
+#define UART1_CR4_LBDIEN            STM8_FIELD(0x5237, 6, 1)
+#define UART1_CR5                   STM8_REGISTER(0x5238)
+#define UART1_CR5_IREN              STM8_FIELD(0x5238, 1, 1)
+#define UART1_CR5_IRLP              STM8_FIELD(0x5238, 2, 1)
+#define UART1_CR5_HDSEL             STM8_FIELD(0x5238, 3, 1)
+#define UART1_CR5_NACK              STM8_FIELD(0x5238, 4, 1)
+#define UART1_CR5_SCEN              STM8_FIELD(0x5238, 5, 1)
+#define UART1_GTR                   STM8_REGISTER(0x5239)
+#define UART1_PSCR                  STM8_REGISTER(0x523a)
+
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  Timer 1 (advanced control timer).
+//
+#define TIM1_CR1                    STM8_REGISTER(0x5250)
+#define TIM1_CR1_CEN                STM8_FIELD(0x5250, 0, 1)
+#define TIM1_CR1_UDIS               STM8_FIELD(0x5250, 1, 1)
+#define TIM1_CR1_URS                STM8_FIELD(0x5250, 2, 1)
+#define TIM1_CR1_OPM                STM8_FIELD(0x5250, 3, 1)
+#define TIM1_CR1_DIR                STM8_FIELD(0x5250, 4, 1)
+#define TIM1_CR1_CMS                STM8_FIELD(0x5250, 5, 2)
+#define TIM1_CR1_ARPE               STM8_FIELD(0x5250, 7, 1)
+#define TIM1_CR2                    STM8_REGISTER(0x5251)
+#define TIM1_CR2_CCPC               STM8_FIELD(0x5251, 0, 1)
+#define TIM1_CR2_COMS               STM8_FIELD(0x5251, 2, 1)
+#define TIM1_CR2_MMS                STM8_FIELD(0x5251, 4, 3)
+#define TIM1_SMCR                   STM8_REGISTER(0x5252)
+#define TIM1_SMCR_SMS               STM8_FIELD(0x5252, 0, 3)
+#define TIM1_SMCR_TS                STM8_FIELD(0x5252, 4, 3)
+#define TIM1_SMCR_MSM               STM8_FIELD(0x5252, 7, 1)
+#define TIM1_ETR                    STM8_REGISTER(0x5253)
+#define TIM1_ETR_ETF                STM8_FIELD(0x5253, 0, 4)
+#define TIM1_ETR_ETPS               STM8_FIELD(0x5253, 4, 2)
+#define TIM1_ETR_ECE                STM8_FIELD(0x5253, 6, 1)
+#define TIM1_ETR_ETP                STM8_FIELD(0x5253, 7, 1)
+#define TIM1_IER                    STM8_REGISTER(0x5254)
+#define TIM1_IER_UIE                STM8_FIELD(0x5254, 0, 1)
+#define TIM1_IER_CC1IE              STM8_FIELD(0x5254, 1, 1)
+#define TIM1_IER_CC2IE              STM8_FIELD(0x5254, 2, 1)
+#define TIM1_IER_CC3IE              STM8_FIELD(0x5254, 3, 1)
+#define TIM1_IER_CC4IE              STM8_FIELD(0x5254, 4, 1)
+#define TIM1_IER_COMIE              STM8_FIELD(0x5254, 5, 1)
+#define TIM1_IER_TIE                STM8_FIELD(0x5254, 6, 1)
+#define TIM1_IER_BIE                STM8_FIELD(0x5254, 7, 1)
+#define TIM1_SR1                    STM8_REGISTER(0x5255)
+#define TIM1_SR1_UIF                STM8_FIELD(0x5255, 0, 1)
+#define TIM1_SR1_CC1IF              STM8_FIELD(0x5255, 1, 1)
+#define TIM1_SR1_CC2IF              STM8_FIELD(0x5255, 2, 1)
+#define TIM1_SR1_CC3IF              STM8_FIELD(0x5255, 3, 1)
+#define TIM1_SR1_CC4IF              STM8_FIELD(0x5255, 4, 1)
+#define TIM1_SR1_COMIF              STM8_FIELD(0x5255, 5, 1)
+#define TIM1_SR1_TIF                STM8_FIELD(0x5255, 6, 1)
+#define TIM1_SR1_BIF                STM8_FIELD(0x5255, 7, 1)
+#define TIM1_SR2                    STM8_REGISTER(0x5256)
+#define TIM1_SR2_CC1OF              STM8_FIELD(0x5256, 1, 1)
+#define TIM1_SR2_CC2OF              STM8_FIELD(0x5256, 2, 1)
+#define TIM1_SR2_CC3OF              STM8_FIELD(0x5256, 3, 1)
+#define TIM1_SR2_CC4OF              STM8_FIELD(0x5256, 4, 1)
+#define TIM1_EGR                    STM8_REGISTER(0x5257)
+#define TIM1_EGR_UG                 STM8_FIELD(0x5257, 0, 1)
+#define TIM1_EGR_CC1G               STM8_FIELD(0x5257, 1, 1)
+#define TIM1_EGR_CC2G               STM8_FIELD(0x5257, 2, 1)
+#define TIM1_EGR_CC3G               STM8_FIELD(0x5257, 3, 1)
+#define TIM1_EGR_CC4G               STM8_FIELD(0x5257, 4, 1)
+#define TIM1_EGR_COMG               STM8_FIELD(0x5257, 5, 1)
+#define TIM1_EGR_TG                 STM8_FIELD(0x5257, 6, 1)
+#define TIM1_EGR_BG                 STM8_FIELD(0x5257, 7, 1)
+#define TIM1_CCMR1                  STM8_REGISTER(0x5258)
+#define TIM1_CCMR1_CC1S             STM8_FIELD(0x5258, 0, 2)
+#define TIM1_CCMR1_OC1FE            STM8_FIELD(0x5258, 2, 1)
+#define TIM1_CCMR1_OC1PE            STM8_FIELD(0x5258, 3, 1)
+#define TIM1_CCMR1_OC1M             STM8_FIELD(0x5258, 4, 3)
+#define TIM1_CCMR1_IC1PSC           STM8_FIELD(0x5258, 2, 2)
+#define TIM1_CCMR1_IC1F             STM8_FIELD(0x5258, 4, 4)
+#define TIM1_CCMR1_OC1CE            STM8_FIELD(0x5258, 7, 1)
+#define TIM1_CCMR2                  STM8_REGISTER(0x5259)
+#define TIM1_CCMR2_CC2S             STM8_FIELD(0x5259, 0, 2)
+#define TIM1_CCMR2_OC2FE            STM8_FIELD(0x5259, 2, 1)
+#define TIM1_CCMR2_OC2PE            STM8_FIELD(0x5259, 3, 1)
+#define TIM1_CCMR2_OC2M             STM8_FIELD(0x5259, 4, 3)
+#define TIM1_CCMR2_IC2PSC           STM8_FIELD(0x5259, 2, 2)
+#define TIM1_CCMR2_IC2F             STM8_FIELD(0x5259, 4, 4)
+#define TIM1_CCMR2_OC2CE            STM8_FIELD(0x5259, 7, 1)
+#define TIM1_CCMR3                  STM8_REGISTER(0x525a)
+#define TIM1_CCMR3_CC3S             STM8_FIELD(0x525a, 0, 2)
+#define TIM1_CCMR3_OC3FE            STM8_FIELD(0x525a, 2, 1)
+#define TIM1_CCMR3_OC3PE            STM8_FIELD(0x525a, 3, 1)
+#define TIM1_CCMR3_OC3M             STM8_FIELD(0x525a, 4, 3)
+#define TIM1_CCMR3_IC3PSC           STM8_FIELD(0x525a, 2, 2)
+#define TIM1_CCMR3_IC3F             STM8_FIELD(0x525a, 4, 4)
+#define TIM1_CCMR3_OC3CE            STM8_FIELD(0x525a, 7, 1)
+#define TIM1_CCMR4                  STM8_REGISTER(0x525b)
+#define TIM1_CCMR4_CC4S             STM8_FIELD(0x525b, 0, 2)
+#define TIM1_CCMR4_OC4FE            STM8_FIELD(0x525b, 2, 1)
+#define TIM1_CCMR4_OC4PE            STM8_FIELD(0x525b, 3, 1)
+#define TIM1_CCMR4_OC4M             STM8_FIELD(0x525b, 4, 3)
+#define TIM1_CCMR4_IC4PSC           STM8_FIELD(0x525b, 2, 2)
+#define TIM1_CCMR4_IC4F             STM8_FIELD(0x525b, 4, 4)
+#define TIM1_CCMR4_OC4CE            STM8_FIELD(0x525b, 7, 1)
+#define TIM1_CCER1                  STM8_REGISTER(0x525c)
+#define TIM1_CCER1_CC1E             STM8_FIELD(0x525c, 0, 1)
+#define TIM1_CCER1_CC1P             STM8_FIELD(0x525c, 1, 1)
+#define TIM1_CCER1_CC1NE            STM8_FIELD(0x525c, 2, 1)
+#define TIM1_CCER1_CC1NP            STM8_FIELD(0x525c, 3, 1)
+#define TIM1_CCER1_CC2E             STM8_FIELD(0x525c, 4, 1)
+#define TIM1_CCER1_CC2P             STM8_FIELD(0x525c, 5, 1)
+#define TIM1_CCER1_CC2NE            STM8_FIELD(0x525c, 6, 1)
+#define TIM1_CCER1_CC2NP            STM8_FIELD(0x525c, 7, 1)
+#define TIM1_CCER2                  STM8_REGISTER(0x525d)
+#define TIM1_CCER2_CC3E             STM8_FIELD(0x525d, 0, 1)
+#define TIM1_CCER2_CC3P             STM8_FIELD(0x525d, 1, 1)
+#define TIM1_CCER2_CC3NE            STM8_FIELD(0x525d, 2, 1)
+#define TIM1_CCER2_CC3NP            STM8_FIELD(0x525d, 3, 1)
+#define TIM1_CCER2_CC4E             STM8_FIELD(0x525d, 4, 1)
+#define TIM1_CCER2_CC4P             STM8_FIELD(0x525d, 5, 1)
+#define TIM1_CNTRH                  STM8_REGISTER(0x525e)
+#define TIM1_CNTRL                  STM8_REGISTER(0x525f)
+#define TIM1_PSCRH                  STM8_REGISTER(0x5260)
+#define TIM1_PSCRL                  STM8_REGISTER(0x5261)
+#define TIM1_ARRH                   STM8_REGISTER(0x5262)
+#define TIM1_ARRL                   STM8_REGISTER(0x5263)
+#define TIM1_RCR                    STM8_REGISTER(0x5264)
+#define TIM1_CCR1H                  STM8_REGISTER(0x5265)
+#define TIM1_CCR1L                  STM8_REGISTER(0x5266)
+#define TIM1_CCR2H                  STM8_REGISTER(0x5267)
+#define TIM1_CCR2L                  STM8_REGISTER(0x5268)
+#define TIM1_CCR3H                  STM8_REGISTER(0x5269)
+#define TIM1_CCR3L                  STM8_REGISTER(0x526a)
+#define TIM1_CCR4H                  STM8_REGISTER(0x526b)
+#define TIM1_CCR4L                  STM8_REGISTER(0x526c)
+#define TIM1_BKR                    STM8_REGISTER(0x526d)
+#define TIM1_BKR_LOCK               STM8_FIELD(0x526d, 0, 2)
+#define TIM1_BKR_OSSI               STM8_FIELD(0x526d, 2, 1)
+#define TIM1_BKR_OSSR               STM8_FIELD(0x526d, 3, 1)
+#define TIM1_BKR_BKE                STM8_FIELD(0x526d, 4, 1)
+#define TIM1_BKR_BKP                STM8_FIELD(0x526d, 5, 1)
+#define TIM1_BKR_AOE                STM8_FIELD(0x526d, 6, 1)
+#define TIM1_BKR_MOE                STM8_FIELD(0x526d, 7, 1)
+#define TIM1_DTR                    STM8_REGISTER(0x526e)
+#define TIM1_OISR                   STM8_REGISTER(0x526f)
+#define TIM1_OISR_OIS1              STM8_FIELD(0x526f, 0, 1)
+#define TIM1_OISR_OIS1N             STM8_FIELD(0x526f, 1, 1)
+#define TIM1_OISR_OIS2              STM8_FIELD(0x526f, 2, 1)
+#define TIM1_OISR_OIS2N             STM8_FIELD(0x526f, 3, 1)
+#define TIM1_OISR_OIS3              STM8_FIELD(0x526f, 4, 1)
+#define TIM1_OISR_OIS3N             STM8_FIELD(0x526f, 5, 1)
+#define TIM1_OISR_OIS4              STM8_FIELD(0x526f, 6, 1)
+
+#if defined(STM8_HOST_MEDIUM_DENSITY)
+
+//
+//  Timer 2.
+//
+#define TIM2_CR1                    STM8_REGISTER(0x5300)
+#define TIM2_CR1_CEN                STM8_FIELD(0x5300, 0, 1)
+#define TIM2_CR1_UDIS               STM8_FIELD(0x5300, 1, 1)
+#define TIM2_CR1_URS                STM8_FIELD(0x5300, 2, 1)
+#define TIM2_CR1_OPM                STM8_FIELD(0x5300, 3, 1)
+#define TIM2_CR1_ARPE               STM8_FIELD(0x5300, 7, 1)
+#define TIM2_IER                    STM8_REGISTER(0x5301)
+#define TIM2_IER_UIE                STM8_FIELD(0x5301, 0, 1)
+#define TIM2_IER_CC1IE              STM8_FIELD(0x5301, 1, 1)
+#define TIM2_IER_CC2IE              STM8_FIELD(0x5301, 2, 1)
+#define TIM2_IER_CC3IE              STM8_FIELD(0x5301, 3, 1)
+#define TIM2_SR1                    STM8_REGISTER(0x5302)
+#define TIM2_SR1_UIF                STM8_FIELD(0x5302, 0, 1)
+#define TIM2_SR1_CC1IF              STM8_FIELD(0x5302, 1, 1)
+#define TIM2_SR1_CC2IF              STM8_FIELD(0x5302, 2, 1)
+#define TIM2_SR1_CC3IF              STM8_FIELD(0x5302, 3, 1)
+#define TIM2_SR2                    STM8_REGISTER(0x5303)
+#define TIM2_SR2_CC1OF              STM8_FIELD(0x5303, 1, 1)
+#define TIM2_SR2_CC2OF              STM8_FIELD(0x5303, 2, 1)
+#define TIM2_SR2_CC3OF              STM8_FIELD(0x5303, 3, 1)
+#define TIM2_EGR                    STM8_REGISTER(0x5304)
+#define TIM2_EGR_UG                 STM8_FIELD(0x5304, 0, 1)
+#define TIM2_EGR_CC1G               STM8_FIELD(0x5304, 1, 1)
+#define TIM2_EGR_CC2G               STM8_FIELD(0x5304, 2, 1)
+#define TIM2_EGR_CC3G               STM8_FIELD(0x5304, 3, 1)
+#define TIM2_CCMR1                  STM8_REGISTER(0x5305)
+#define TIM2_CCMR1_CC1S             STM8_FIELD(0x5305, 0, 2)
+#define TIM2_CCMR1_OC1FE            STM8_FIELD(0x5305, 2, 1)
+#define TIM2_CCMR1_OC1PE            STM8_FIELD(0x5305, 3, 1)
+#define TIM2_CCMR1_OC1M             STM8_FIELD(0x5305, 4, 3)
+#define TIM2_CCMR1_IC1PSC           STM8_FIELD(0x5305, 2, 2)
+#define TIM2_CCMR1_IC1F             STM8_FIELD(0x5305, 4, 4)
+#define TIM2_CCMR2                  STM8_REGISTER(0x5306)
+#define TIM2_CCMR2_CC2S             STM8_FIELD(0x5306, 0, 2)
+#define TIM2_CCMR2_OC2FE            STM8_FIELD(0x5306, 2, 1)
+#define TIM2_CCMR2_OC2PE            STM8_FIELD(0x5306, 3, 1)
+#define TIM2_CCMR2_OC2M             STM8_FIELD(0x5306, 4, 3)
+#define TIM2_CCMR2_IC2PSC           STM8_FIELD(0x5306, 2, 2)
+#define TIM2_CCMR2_IC2F             STM8_FIELD(0x5306, 4, 4)
+#define TIM2_CCMR3                  STM8_REGISTER(0x5307)
+#define TIM2_CCMR3_CC3S             STM8_FIELD(0x5307, 0, 2)
+#define TIM2_CCMR3_OC3FE            STM8_FIELD(0x5307, 2, 1)
+#define TIM2_CCMR3_OC3PE            STM8_FIELD(0x5307, 3, 1)
+#define TIM2_CCMR3_OC3M             STM8_FIELD(0x5307, 4, 3)
+#define TIM2_CCMR3_IC3PSC           STM8_FIELD(0x5307, 2, 2)
+#define TIM2_CCMR3_IC3F             STM8_FIELD(0x5307, 4, 4)
+#define TIM2_CCER1                  STM8_REGISTER(0x5308)
+#define TIM2_CCER1_CC1E             STM8_FIELD(0x5308, 0, 1)
+#define TIM2_CCER1_CC1P             STM8_FIELD(0x5308, 1, 1)
+#define TIM2_CCER1_CC2E             STM8_FIELD(0x5308, 4, 1)
+#define TIM2_CCER1_CC2P             STM8_FIELD(0x5308, 5, 1)
+#define TIM2_CCER2                  STM8_REGISTER(0x5309)
+#define TIM2_CCER2_CC3E             STM8_FIELD(0x5309, 0, 1)
+#define TIM2_CCER2_CC3P             STM8_FIELD(0x5309, 1, 1)
+#define TIM2_CNTRH                  STM8_REGISTER(0x530a)
+#define TIM2_CNTRL                  STM8_REGISTER(0x530b)
+#define TIM2_PSCR                   STM8_REGISTER(0x530c)
+#define TIM2_PSCR_PSC               STM8_FIELD(0x530c, 0, 4)
+#define TIM2_ARRH                   STM8_REGISTER(0x530d)
+#define TIM2_ARRL                   STM8_REGISTER(0x530e)
+#define TIM2_CCR1H                  STM8_REGISTER(0x530f)
+#define TIM2_CCR1L                  STM8_REGISTER(0x5310)
+#define TIM2_CCR2H                  STM8_REGISTER(0x5311)
+#define TIM2_CCR2L                  STM8_REGISTER(0x5312)
+#define TIM2_CCR3H                  STM8_REGISTER(0x5313)
+#define TIM2_CCR3L                  STM8_REGISTER(0x5314)
+
+//
+//  Timer 3.
+//
+#define TIM3_CR1                    STM8_REGISTER(0x5320)
+#define TIM3_CR1_CEN                STM8_FIELD(0x5320, 0, 1)
+#define TIM3_CR1_UDIS               STM8_FIELD(0x5320, 1, 1)
+#define TIM3_CR1_URS                STM8_FIELD(0x5320, 2, 1)
+#define TIM3_CR1_OPM                STM8_FIELD(0x5320, 3, 1)
+#define TIM3_CR1_ARPE               STM8_FIELD(0x5320, 7, 1)
+#define TIM3_IER                    STM8_REGISTER(0x5321)
+#define TIM3_IER_UIE                STM8_FIELD(0x5321, 0, 1)
+#define TIM3_IER_CC1IE              STM8_FIELD(0x5321, 1, 1)
+#define TIM3_IER_CC2IE              STM8_FIELD(0x5321, 2, 1)
+#define TIM3_SR1                    STM8_REGISTER(0x5322)
+#define TIM3_SR1_UIF                STM8_FIELD(0x5322, 0, 1)
+#define TIM3_SR1_CC1IF              STM8_FIELD(0x5322, 1, 1)
+#define TIM3_SR1_CC2IF              STM8_FIELD(0x5322, 2, 1)
+#define TIM3_SR2                    STM8_REGISTER(0x5323)
+#define TIM3_SR2_CC1OF              STM8_FIELD(0x5323, 1, 1)
+#define TIM3_SR2_CC2OF              STM8_FIELD(0x5323, 2, 1)
+#define TIM3_EGR                    STM8_REGISTER(0x5324)
+#define TIM3_EGR_UG                 STM8_FIELD(0x5324, 0, 1)
+#define TIM3_EGR_CC1G               STM8_FIELD(0x5324, 1, 1)
+#define TIM3_EGR_CC2G               STM8_FIELD(0x5324, 2, 1)
+#define TIM3_CCMR1                  STM8_REGISTER(0x5325)
+#define TIM3_CCMR1_CC1S             STM8_FIELD(0x5325, 0, 2)
+#define TIM3_CCMR1_OC1FE            STM8_FIELD(0x5325, 2, 1)
+#define TIM3_CCMR1_OC1PE            STM8_FIELD(0x5325, 3, 1)
+#define TIM3_CCMR1_OC1M             STM8_FIELD(0x5325, 4, 3)
+#define TIM3_CCMR1_IC1PSC           STM8_FIELD(0x5325, 2, 2)
+#define TIM3_CCMR1_IC1F             STM8_FIELD(0x5325, 4, 4)
+#define TIM3_CCMR2                  STM8_REGISTER(0x5326)
+#define TIM3_CCMR2_CC2S             STM8_FIELD(0x5326, 0, 2)
+#define TIM3_CCMR2_OC2FE            STM8_FIELD(0x5326, 2, 1)
+#define TIM3_CCMR2_OC2PE            STM8_FIELD(0x5326, 3, 1)
+#define TIM3_CCMR2_OC2M             STM8_FIELD(0x5326, 4, 3)
+#define TIM3_CCMR2_IC2PSC           STM8_FIELD(0x5326, 2, 2)
+#define TIM3_CCMR2_IC2F             STM8_FIELD(0x5326, 4, 4)
+#define TIM3_CCER1                  STM8_REGISTER(0x5327)
+#define TIM3_CCER1_CC1E             STM8_FIELD(0x5327, 0, 1)
+#define TIM3_CCER1_CC1P             STM8_FIELD(0x5327, 1, 1)
+#define TIM3_CCER1_CC2E             STM8_FIELD(0x5327, 4, 1)
+#define TIM3_CCER1_CC2P             STM8_FIELD(0x5327, 5, 1)
+#define TIM3_CNTRH                  STM8_REGISTER(0x5328)
+#define TIM3_CNTRL                  STM8_REGISTER(0x5329)
+#define TIM3_PSCR                   STM8_REGISTER(0x532a)
+#define TIM3_PSCR_PSC               STM8_FIELD(0x532a, 0, 4)
+#define TIM3_ARRH                   STM8_REGISTER(0x532b)
+#define TIM3_ARRL                   STM8_REGISTER(0x532c)
+#define TIM3_CCR1H                  STM8_REGISTER(0x532d)
+#define TIM3_CCR1L                  STM8_REGISTER(0x532e)
+#define TIM3_CCR2H                  STM8_REGISTER(0x532f)
+#define TIM3_CCR2L                  STM8_REGISTER(0x5330)
+
+//
+//  Timer 4.
+//
+#define TIM4_CR1                    STM8_REGISTER(0x5340)
+#define TIM4_CR1_CEN                STM8_FIELD(0x5340, 0, 1)
+#define TIM4_CR1_UDIS               STM8_FIELD(0x5340, 1, 1)
+#define TIM4_CR1_URS                STM8_FIELD(0x5340, 2, 1)
+#define TIM4_CR1_OPM                STM8_FIELD(0x5340, 3, 1)
+#define TIM4_CR1_ARPE               STM8_FIELD(0x5340, 7, 1)
+#define TIM4_IER                    STM8_REGISTER(0x5341)
+#define TIM4_IER_UIE                STM8_FIELD(0x5341, 0, 1)
+#define TIM4_SR                     STM8_REGISTER(0x5342)
+#define TIM4_SR_UIF                 STM8_FIELD(0x5342, 0, 1)
+#define TIM4_EGR                    STM8_REGISTER(0x5343)
+#define TIM4_EGR_UG                 STM8_FIELD(0x5343, 0, 1)
+#define TIM4_CNTR                   STM8_REGISTER(0x5344)
+#define TIM4_PSCR                   STM8_REGISTER(0x5345)
+#define TIM4_PSCR_PSC               STM8_FIELD(0x5345, 0, 3)
+#define TIM4_ARR                    STM8_REGISTER(0x5346)
+
+#else
+
+//
+//  Timer 2.
+//
+#define TIM2_CR1                    STM8_REGISTER(0x5300)
+#define TIM2_CR1_CEN                STM8_FIELD(0x5300, 0, 1)
+#define TIM2_CR1_UDIS               STM8_FIELD(0x5300, 1, 1)
+#define TIM2_CR1_URS                STM8_FIELD(0x5300, 2, 1)
+#define TIM2_CR1_OPM                STM8_FIELD(0x5300, 3, 1)
+#define TIM2_CR1_ARPE               STM8_FIELD(0x5300, 7, 1)
+#define TIM2_IER                    STM8_REGISTER(0x5303)
+#define TIM2_IER_UIE                STM8_FIELD(0x5303, 0, 1)
+#define TIM2_IER_CC1IE              STM8_FIELD(0x5303, 1, 1)
+#define TIM2_IER_CC2IE              STM8_FIELD(0x5303, 2, 1)
+#define TIM2_IER_CC3IE              STM8_FIELD(0x5303, 3, 1)
+#define TIM2_SR1                    STM8_REGISTER(0x5304)
+#define TIM2_SR1_UIF                STM8_FIELD(0x5304, 0, 1)
+#define TIM2_SR1_CC1IF              STM8_FIELD(0x5304, 1, 1)
+#define TIM2_SR1_CC2IF              STM8_FIELD(0x5304, 2, 1)
+#define TIM2_SR1_CC3IF              STM8_FIELD(0x5304, 3, 1)
+#define TIM2_SR2                    STM8_REGISTER(0x5305)
+#define TIM2_SR2_CC1OF              STM8_FIELD(0x5305, 1, 1)
+#define TIM2_SR2_CC2OF              STM8_FIELD(0x5305, 2, 1)
+#define TIM2_SR2_CC3OF              STM8_FIELD(0x5305, 3, 1)
+#define TIM2_EGR                    STM8_REGISTER(0x5306)
+#define TIM2_EGR_UG                 STM8_FIELD(0x5306, 0, 1)
+#define TIM2_EGR_CC1G               STM8_FIELD(0x5306, 1, 1)
+#define TIM2_EGR_CC2G               STM8_FIELD(0x5306, 2, 1)
+#define TIM2_EGR_CC3G               STM8_FIELD(0x5306, 3, 1)
+#define TIM2_CCMR1                  STM8_REGISTER(0x5307)
+#define TIM2_CCMR1_CC1S             STM8_FIELD(0x5307, 0, 2)
+#define TIM2_CCMR1_OC1FE            STM8_FIELD(0x5307, 2, 1)
+#define TIM2_CCMR1_OC1PE            STM8_FIELD(0x5307, 3, 1)
+#define TIM2_CCMR1_OC1M             STM8_FIELD(0x5307, 4, 3)
+#define TIM2_CCMR1_IC1PSC           STM8_FIELD(0x5307, 2, 2)
+#define TIM2_CCMR1_IC1F             STM8_FIELD(0x5307, 4, 4)
+#define TIM2_CCMR2                  STM8_REGISTER(0x5308)
+#define TIM2_CCMR2_CC2S             STM8_FIELD(0x5308, 0, 2)
+#define TIM2_CCMR2_OC2FE            STM8_FIELD(0x5308, 2, 1)
+#define TIM2_CCMR2_OC2PE            STM8_FIELD(0x5308, 3, 1)
+#define TIM2_CCMR2_OC2M             STM8_FIELD(0x5308, 4, 3)
+#define TIM2_CCMR2_IC2PSC           STM8_FIELD(0x5308, 2, 2)
+#define TIM2_CCMR2_IC2F             STM8_FIELD(0x5308, 4, 4)
+#define TIM2_CCMR3                  STM8_REGISTER(0x5309)
+#define TIM2_CCMR3_CC3S             STM8_FIELD(0x5309, 0, 2)
+#define TIM2_CCMR3_OC3FE            STM8_FIELD(0x5309, 2, 1)
+#define TIM2_CCMR3_OC3PE            STM8_FIELD(0x5309, 3, 1)
+#define TIM2_CCMR3_OC3M             STM8_FIELD(0x5309, 4, 3)
+#define TIM2_CCMR3_IC3PSC           STM8_FIELD(0x5309, 2, 2)
+#define TIM2_CCMR3_IC3F             STM8_FIELD(0x5309, 4, 4)
+#define TIM2_CCER1                  STM8_REGISTER(0x530a)
+#define TIM2_CCER1_CC1E             STM8_FIELD(0x530a, 0, 1)
+#define TIM2_CCER1_CC1P             STM8_FIELD(0x530a, 1, 1)
+#define TIM2_CCER1_CC2E             STM8_FIELD(0x530a, 4, 1)
+#define TIM2_CCER1_CC2P             STM8_FIELD(0x530a, 5, 1)
+#define TIM2_CCER2                  STM8_REGISTER(0x530b)
+#define TIM2_CCER2_CC3E             STM8_FIELD(0x530b, 0, 1)
+#define TIM2_CCER2_CC3P             STM8_FIELD(0x530b, 1, 1)
+#define TIM2_CNTRH                  STM8_REGISTER(0x530c)
+#define TIM2_CNTRL                  STM8_REGISTER(0x530d)
+#define TIM2_PSCR                   STM8_REGISTER(0x530e)
+#define TIM2_PSCR_PSC               STM8_FIELD(0x530e, 0, 4)
+#define TIM2_ARRH                   STM8_REGISTER(0x530f)
+#define TIM2_ARRL                   STM8_REGISTER(0x5310)
+#define TIM2_CCR1H                  STM8_REGISTER(0x5311)
+#define TIM2_CCR1L                  STM8_REGISTER(0x5312)
+#define TIM2_CCR2H                  STM8_REGISTER(0x5313)
+#define TIM2_CCR2L                  STM8_REGISTER(0x5314)
+#define TIM2_CCR3H                  STM8_REGISTER(0x5315)
+#define TIM2_CCR3L                  STM8_REGISTER(0x5316)
+
+//
+//  Timer 4.
+//
+#define TIM4_CR1                    STM8_REGISTER(0x5340)
+#define TIM4_CR1_CEN                STM8_FIELD(0x5340, 0, 1)
+#define TIM4_CR1_UDIS               STM8_FIELD(0x5340, 1, 1)
+#define TIM4_CR1_URS                STM8_FIELD(0x5340, 2, 1)
+#define TIM4_CR1_OPM                STM8_FIELD(0x5340, 3, 1)
+#define TIM4_CR1_ARPE               STM8_FIELD(0x5340, 7, 1)
+#define TIM4_IER                    STM8_REGISTER(0x5343)
+#define TIM4_IER_UIE                STM8_FIELD(0x5343, 0, 1)
+#define TIM4_SR                     STM8_REGISTER(0x5344)
+#define TIM4_SR_UIF                 STM8_FIELD(0x5344, 0, 1)
+#define TIM4_EGR                    STM8_REGISTER(0x5345)
+#define TIM4_EGR_UG                 STM8_FIELD(0x5345, 0, 1)
+#define TIM4_CNTR                   STM8_REGISTER(0x5346)
+#define TIM4_PSCR                   STM8_REGISTER(0x5347)
+#define TIM4_PSCR_PSC               STM8_FIELD(0x5347, 0, 3)
+#define TIM4_ARR                    STM8_REGISTER(0x5348)
+
+#endif
+
+//--------------------------------------------------------------------------------
+//
+//  ADC1.
+//
+#define ADC_CSR                     STM8_REGISTER(0x5400)
+#define ADC_CSR_CH                  STM8_FIELD(0x5400, 0, 4)
+#define ADC_CSR_AWDIE               STM8_FIELD(0x5400, 4, 1)
+#define ADC_CSR_EOCIE               STM8_FIELD(0x5400, 5, 1)
+#define ADC_CSR_AWD                 STM8_FIELD(0x5400, 6, 1)
+#define ADC_CSR_EOC                 STM8_FIELD(0x5400, 7, 1)
+#define ADC_CR1                     STM8_REGISTER(0x5401)
+#define ADC_CR1_ADON                STM8_FIELD(0x5401, 0, 1)
+#define ADC_CR1_CONT                STM8_FIELD(0x5401, 1, 1)
+#define ADC_CR1_SPSEL               STM8_FIELD(0x5401, 4, 3)
+#define ADC_CR2                     STM8_REGISTER(0x5402)
+#define ADC_CR2_SCAN                STM8_FIELD(0x5402, 1, 1)
+#define ADC_CR2_ALIGN               STM8_FIELD(0x5402, 3, 1)
+#define ADC_CR2_EXTSEL              STM8_FIELD(0x5402, 4, 2)
+#define ADC_CR2_EXTTRIG             STM8_FIELD(0x5402, 6, 1)
+#define ADC_CR3                     STM8_REGISTER(0x5403)
+#define ADC_CR3_OVR                 STM8_FIELD(0x5403, 6, 1)
+#define ADC_CR3_DBUF                STM8_FIELD(0x5403, 7, 1)
+#define ADC_DRH                     STM8_REGISTER(0x5404)
+#define ADC_DRL                     STM8_REGISTER(0x5405)
+#define ADC_TDRH                    STM8_REGISTER(0x5406)
+#define ADC_TDRL                    STM8_REGISTER(0x5407)
+#define ADC_HTRH                    STM8_REGISTER(0x5408)
+#define ADC_HTRL                    STM8_REGISTER(0x5409)
+#define ADC_LTRH                    STM8_REGISTER(0x540a)
+#define ADC_LTRL                    STM8_REGISTER(0x540b)
+#define ADC_AWSRH                   STM8_REGISTER(0x540c)
+#define ADC_AWSRL                   STM8_REGISTER(0x540d)
+#define ADC_AWCRH                   STM8_REGISTER(0x540e)
+#define ADC_AWCRL                   STM8_REGISTER(0x540f)
+
+//
+//  Interrupt controller software priority registers.
+//
+#define ITC_SPR1                    STM8_REGISTER(0x7f70)
+#define ITC_SPR1_VECT0SPR           STM8_FIELD(0x7f70, 0, 2)
+#define ITC_SPR1_VECT1SPR           STM8_FIELD(0x7f70, 2, 2)
+#define ITC_SPR1_VECT2SPR           STM8_FIELD(0x7f70, 4, 2)
+#define ITC_SPR1_VECT3SPR           STM8_FIELD(0x7f70, 6, 2)
+#define ITC_SPR2                    STM8_REGISTER(0x7f71)
+#define ITC_SPR2_VECT4SPR           STM8_FIELD(0x7f71, 0, 2)
+#define ITC_SPR2_VECT5SPR           STM8_FIELD(0x7f71, 2, 2)
+#define ITC_SPR2_VECT6SPR           STM8_FIELD(0x7f71, 4, 2)
+#define ITC_SPR2_VECT7SPR           STM8_FIELD(0x7f71, 6, 2)
+#define ITC_SPR3                    STM8_REGISTER(0x7f72)
+#define ITC_SPR3_VECT8SPR           STM8_FIELD(0x7f72, 0, 2)
+#define ITC_SPR3_VECT9SPR           STM8_FIELD(0x7f72, 2, 2)
+#define ITC_SPR3_VECT10SPR          STM8_FIELD(0x7f72, 4, 2)
+#define ITC_SPR3_VECT11SPR          STM8_FIELD(0x7f72, 6, 2)
+#define ITC_SPR4                    STM8_REGISTER(0x7f73)
+#define ITC_SPR4_VECT12SPR          STM8_FIELD(0x7f73, 0, 2)
+#define ITC_SPR4_VECT13SPR          STM8_FIELD(0x7f73, 2, 2)
+#define ITC_SPR4_VECT14SPR          STM8_FIELD(0x7f73, 4, 2)
+#define ITC_SPR4_VECT15SPR          STM8_FIELD(0x7f73, 6, 2)
+#define ITC_SPR5                    STM8_REGISTER(0x7f74)
+#define ITC_SPR5_VECT16SPR          STM8_FIELD(0x7f74, 0, 2)
+#define ITC_SPR5_VECT17SPR          STM8_FIELD(0x7f74, 2, 2)
+#define ITC_SPR5_VECT18SPR          STM8_FIELD(0x7f74, 4, 2)
+#define ITC_SPR5_VECT19SPR          STM8_FIELD(0x7f74, 6, 2)
+#define ITC_SPR6                    STM8_REGISTER(0x7f75)
+#define ITC_SPR6_VECT20SPR          STM8_FIELD(0x7f75, 0, 2)
+#define ITC_SPR6_VECT21SPR          STM8_FIELD(0x7f75, 2, 2)
+#define ITC_SPR6_VECT22SPR          STM8_FIELD(0x7f75, 4, 2)
+#define ITC_SPR6_VECT23SPR          STM8_FIELD(0x7f75, 6, 2)
+#define ITC_SPR7                    STM8_REGISTER(0x7f76)
+#define ITC_SPR7_VECT24SPR          STM8_FIELD(0x7f76, 0, 2)
+#define ITC_SPR7_VECT25SPR          STM8_FIELD(0x7f76, 2, 2)
+#define ITC_SPR7_VECT26SPR          STM8_FIELD(0x7f76, 4, 2)
+#define ITC_SPR7_VECT27SPR          STM8_FIELD(0x7f76, 6, 2)
+#define ITC_SPR8                    STM8_REGISTER(0x7f77)
+#define ITC_SPR8_VECT28SPR          STM8_FIELD(0x7f77, 0, 2)
+#define ITC_SPR8_VECT29SPR          STM8_FIELD(0x7f77, 2, 2)
+#define ITC_SPR8_VECT30SPR          STM8_FIELD(0x7f77, 4, 2)
+#define ITC_SPR8_VECT31SPR          STM8_FIELD(0x7f77, 6, 2)
+
+//
+//  Global configuration.
+//
+#define CFG_GCR                     STM8_REGISTER(0x7f60)
+#define CFG_GCR_SWD                 STM8_FIELD(0x7f60, 0, 1)
+#define CFG_GCR_AL                  STM8_FIELD(0x7f60, 1, 1)
+
+//--------------------------------------------------------------------------------
+//
+//  Interrupt vector numbers, as used by #pragma vector.  These are the IAR
+//  numbers which are the IRQ number plus two.
+//
+#define TRAP_vector                 0x01
+#define TLI_vector                  0x02
+#define AWU_vector                  0x03
+#define CLK_CSS_vector              0x04
+#define CLK_SWITCH_vector           0x04
+#define EXTI0_vector                0x05
+#define EXTI1_vector                0x06
+#define EXTI2_vector                0x07
+#define EXTI3_vector                0x08
+#define EXTI4_vector                0x09
+#define SPI_CRCERR_vector           0x0c
+#define SPI_MODF_vector             0x0c
+#define SPI_OVR_vector              0x0c
+#define SPI_RXNE_vector             0x0c
+#define SPI_TXE_vector              0x0c
+#define SPI_WKUP_vector             0x0c
+#define TIM1_OVR_UIF_vector         0x0d
+#define TIM1_OVR_BIF_vector         0x0d
+#define TIM1_OVR_TIF_vector         0x0d
+#define TIM1_CAPCOM_CC1IF_vector    0x0e
+#define TIM1_CAPCOM_CC2IF_vector    0x0e
+#define TIM1_CAPCOM_CC3IF_vector    0x0e
+#define TIM1_CAPCOM_CC4IF_vector    0x0e
+#define TIM1_CAPCOM_COMIF_vector    0x0e
+#define TIM2_OVR_UIF_vector         0x0f
+#define TIM2_CAPCOM_CC1IF_vector    0x10
+#define TIM2_CAPCOM_CC2IF_vector    0x10
+#define TIM2_CAPCOM_CC3IF_vector    0x10
+#if defined(STM8_HOST_MEDIUM_DENSITY)
+    #define TIM3_OVR_UIF_vector         0x11
+    #define TIM3_CAPCOM_CC1IF_vector    0x12
+    #define TIM3_CAPCOM_CC2IF_vector    0x12
+#else
+    #define UART1_T_TC_vector           0x13
+    #define UART1_T_TXE_vector          0x13
+    #define UART1_R_IDLE_vector         0x14
+    #define UART1_R_LBDF_vector         0x14
+    #define UART1_R_OR_vector           0x14
+    #define UART1_R_PE_vector           0x14
+    #define UART1_R_RXNE_vector         0x14
+#endif
+#define I2C_ADD10_vector            0x15
+#define I2C_ADDR_vector             0x15
+#define I2C_AF_vector               0x15
+#define I2C_ARLO_vector             0x15
+#define I2C_BERR_vector             0x15
+#define I2C_BTF_vector              0x15
+#define I2C_OVR_vector              0x15
+#define I2C_RXNE_vector             0x15
+#define I2C_SB_vector               0x15
+#define I2C_STOPF_vector            0x15
+#define I2C_TXE_vector              0x15
+#define I2C_WUFH_vector             0x15
+#if defined(STM8_HOST_MEDIUM_DENSITY)
+    #define UART2_T_TC_vector           0x16
+    #define UART2_T_TXE_vector          0x16
+    #define UART2_R_IDLE_vector         0x17
+    #define UART2_R_LBDF_vector         0x17
+    #define UART2_R_LHDF_vector         0x17
+    #define UART2_R_OR_vector           0x17
+    #define UART2_R_PE_vector           0x17
+    #define UART2_R_RXNE_vector         0x17
+#endif
+#define ADC1_AWDG_vector            0x18
+#define ADC1_AWS0_vector            0x18
+#define ADC1_EOC_vector             0x18
+#define TIM4_OVR_UIF_vector         0x19
+#define FLASH_EOP_vector            0x1a
+#define FLASH_WR_PG_DIS_vector      0x1a
+
+#endif